@@ -1,6 +1,11 @@
 #ifndef __JCFW_CONFIG_H__
 #define __JCFW_CONFIG_H__
 
+// AGGREGATE ---------------------------------------------------------------------------------------
+
+/// @brief The maximum number of hops in one aggregation window.
+#define JCFW_AGGREGATE_PANE_COUNT_MAX        8
+
 // ASSERT ------------------------------------------------------------------------------------------
 
 #define JCFW_DEBUG
@@ -9,22 +14,218 @@
 // CLI ---------------------------------------------------------------------------------------------
 
 /// @brief The maximum length for one command.
-#define JCFW_CLI_MAX_LINE_LEN          120
+#define JCFW_CLI_MAX_LINE_LEN                120
 
 /// @brief The size of the history buffer in bytes.
-#define JCFW_CLI_HISTORY_BUFFER_SIZE   1024
+#define JCFW_CLI_HISTORY_BUFFER_SIZE         1024
 
 /// @brief The maximum number of tokens allowed within a command.
-#define JCFW_CLI_ARGC_MAX              16
+#define JCFW_CLI_ARGC_MAX                    16
 
 /// @brief The maximum length of the prompt string.
-#define JCFW_CLI_PROMPT_LEN_MAX        16
+#define JCFW_CLI_PROMPT_LEN_MAX              16
 
 /// @brief Translate '\\r' to '\\n' for input and output "\\r\\n".
-#define JCFW_CLI_SERIAL_TERM_TRANSLATE 1
+#define JCFW_CLI_SERIAL_TERM_TRANSLATE       1
+
+// ENDPOINT ----------------------------------------------------------------------------------------
+
+/// @brief The maximum number of endpoints in a set (see: jcfw/net/endpoint.h).
+#define JCFW_ENDPOINT_COUNT_MAX              4
+
+/// @brief The number of probes in a row which an endpoint can miss before it is considered down.
+#define JCFW_ENDPOINT_PROBE_MISS_MAX         2
+
+// EVENT -------------------------------------------------------------------------------------------
+
+/// @brief The maximum number of events which can exist at once.
+#define JCFW_EVENT_COUNT_MAX                 4
+
+// FLASH -------------------------------------------------------------------------------------------
+
+/// @brief The size of the file which backs a flash region on host builds, in bytes.
+#define JCFW_FLASH_POSIX_REGION_SIZE         (256 * 1024)
+
+/// @brief The erase unit of a flash region on host builds, in bytes.
+#define JCFW_FLASH_POSIX_SECTOR_SIZE         4096
+
+// FILTER ------------------------------------------------------------------------------------------
+
+/// @brief The longest window of a moving average or median filter, in samples.
+#define JCFW_FILTER_LENGTH_MAX               15
+
+// I2C ---------------------------------------------------------------------------------------------
+
+/// @brief The maximum number of I2C buses which can be managed at once.
+#define JCFW_I2C_BUS_COUNT_MAX               2
+
+/// @brief The maximum number of I2C transactions which can be queued on one bus at once.
+#define JCFW_I2C_QUEUE_DEPTH                 8
+
+/// @brief How long a blocking I2C call waits for its transaction to reach the bus (on top of the
+/// timeout of the bus operation itself), in milliseconds.
+#define JCFW_I2C_QUEUE_TIMEOUT_MS            100
+
+/// @brief The maximum size of the data of merged I2C writes, in bytes.
+#define JCFW_I2C_MERGE_SIZE_MAX              16
+
+/// @brief The maximum number of data segments in one I2C write (including merged writes).
+#define JCFW_I2C_SEGMENT_COUNT_MAX           8
+
+/// @brief The maximum size of an I2C write (including the "memory address") when the platform has
+/// to copy its segments into one buffer, in bytes.
+#define JCFW_I2C_WRITE_COPY_SIZE_MAX         32
+
+/// @brief The stack size of the I2C bus worker tasks, in bytes.
+#define JCFW_I2C_TASK_STACK_SIZE             3072
+
+/// @brief The priority of the I2C bus worker tasks.
+#define JCFW_I2C_TASK_PRIORITY               10
+
+// MUTEX -------------------------------------------------------------------------------------------
+
+/// @brief The maximum number of mutexes which can exist at once.
+#define JCFW_MUTEX_COUNT_MAX                 4
+
+// NET ---------------------------------------------------------------------------------------------
+
+/// @brief The longest host name which the resolver caches, in characters.
+#define JCFW_NET_HOST_LENGTH_MAX             64
+
+/// @brief The number of host names which the resolver remembers.
+#define JCFW_NET_RESOLVER_CACHE_SIZE         4
+
+/// @brief How long a resolved address is used before it is looked up again, in milliseconds.
+#define JCFW_NET_RESOLVER_TTL_MS             (5 * 60 * 1000)
+
+/// @brief The largest datagram (or chunk of a stream) which a socket receives at once, in bytes.
+#define JCFW_NET_RECEIVE_SIZE_MAX            1472
+
+/// @brief How long a socket waits before it retries a send which the stack had no buffers for, in
+/// milliseconds.
+#define JCFW_NET_RETRY_MS                    10
+
+// PIPELINE ----------------------------------------------------------------------------------------
+
+/// @brief The size of the samples of one pipeline block, in bytes.
+#define JCFW_PIPELINE_BLOCK_SIZE             128
+
+/// @brief The maximum number of stages which can feed one pipeline stage.
+#define JCFW_PIPELINE_INPUT_COUNT_MAX        4
+
+/// @brief The number of blocks which can wait at each input of a pipeline stage. Must be a power
+/// of two.
+#define JCFW_PIPELINE_QUEUE_CAPACITY         16
+
+// RDP ---------------------------------------------------------------------------------------------
+
+/// @brief The largest payload of a reliable datagram, in bytes.
+#define JCFW_RDP_PAYLOAD_SIZE_MAX            JCFW_TELEMETRY_FRAME_SIZE_MAX
+
+/// @brief The maximum number of unacknowledged datagrams in flight (at most 32).
+#define JCFW_RDP_WINDOW_SIZE                 8
+
+/// @brief The retransmit timeout before the first round trip has been measured, in milliseconds.
+#define JCFW_RDP_RTO_INITIAL_MS              1000
+
+/// @brief The bounds of the retransmit timeout, in milliseconds. RFC 6298 asks for at least a
+/// second on the open internet; Telemetry stays on the LAN, where round trips take a few ms.
+#define JCFW_RDP_RTO_MIN_MS                  50
+#define JCFW_RDP_RTO_MAX_MS                  8000
+
+/// @brief The number of retransmits of a datagram before it is dropped.
+#define JCFW_RDP_RETRY_MAX                   6
+
+/// @brief The number of later datagrams acknowledged before a missing one is retransmitted early.
+#define JCFW_RDP_FAST_RETRANSMIT_COUNT       3
+
+// REGMAP ------------------------------------------------------------------------------------------
+
+/// @brief The maximum number of undescribed registers which a register map reads over rather than
+/// starting another burst read.
+#define JCFW_REGMAP_READ_GAP_MAX             4
+
+// SKETCH ------------------------------------------------------------------------------------------
+
+/// @brief The number of buckets in a quantile sketch. With 128 buckets, a sketch spanning 0.1 to
+/// 64000 answers quantiles within about 5%.
+#define JCFW_SKETCH_BUCKET_COUNT             128
+
+// TELEMETRY ---------------------------------------------------------------------------------------
+
+/// @brief The largest telemetry frame which can be batched, in bytes. Frames are sent as single
+/// datagrams, so this should stay below the path MTU.
+#define JCFW_TELEMETRY_FRAME_SIZE_MAX        512
+
+/// @brief The largest record which can be spooled to flash, in bytes.
+#define JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX JCFW_TELEMETRY_FRAME_SIZE_MAX
+
+/// @brief The maximum number of fields in a record compressed by the telemetry codec.
+#define JCFW_TELEMETRY_FIELD_COUNT_MAX       8
+
+// TIMESYNC ----------------------------------------------------------------------------------------
+
+/// @brief The number of clock probes which the offset and the drift are estimated from.
+#define JCFW_TIMESYNC_SAMPLE_COUNT           16
+
+/// @brief The largest difference between a probe and the model of the server's clock, beyond the
+/// error of the probe, before the server's clock is taken to have been stepped, in microseconds.
+#define JCFW_TIMESYNC_STEP_US                (128 * 1000)
+
+/// @brief The largest drift between the two clocks which is believed, in parts per billion.
+#define JCFW_TIMESYNC_DRIFT_MAX_PPB          500000
 
 // TRACE -------------------------------------------------------------------------------------------
 
-#define JCFW_TRACE_MAX_TAG_LEN         6
+#define JCFW_TRACE_MAX_TAG_LEN               6
+
+// WIFI --------------------------------------------------------------------------------------------
+
+/// @brief How long a connection straight to the last access point may take before falling back to
+/// a scan, in ms.
+#define JCFW_WIFI_FAST_CONNECT_TIMEOUT_MS    2000
+
+/// @brief The range of connection times which the statistics tell apart, in ms.
+#define JCFW_WIFI_CONNECT_TIME_MIN_MS        10
+#define JCFW_WIFI_CONNECT_TIME_MAX_MS        (60 * 1000)
+
+/// @brief How long a connection attempt which scans may take before it is abandoned, in ms.
+#define JCFW_WIFI_CONNECT_TIMEOUT_MS         15000
+
+/// @brief The range of delays before retrying a failed connection attempt, in ms.
+#define JCFW_WIFI_BACKOFF_MIN_MS             500
+#define JCFW_WIFI_BACKOFF_MAX_MS             (10 * 1000)
+
+/// @brief The number of authentication failures in a row after which the manager gives up.
+#define JCFW_WIFI_AUTH_FAILURE_MAX           3
+
+/// @brief The maximum number of subscribers to the state of the STA.
+#define JCFW_WIFI_SUBSCRIBER_COUNT_MAX       4
+
+/// @brief The stack size of the WIFI manager task, in bytes.
+#define JCFW_WIFI_TASK_STACK_SIZE            4096
+
+/// @brief The priority of the WIFI manager task.
+#define JCFW_WIFI_TASK_PRIORITY              8
+
+/// @brief How long an access point stays in the scan cache without being seen again, in ms.
+#define JCFW_WIFI_SCAN_AGE_MAX_MS            (5 * 60 * 1000)
+
+/// @brief How long jcfw_wifi_sta_scan() waits for a scan to complete, in ms.
+#define JCFW_WIFI_SCAN_TIMEOUT_MS            10000
+
+/// @brief How often the signal strength of the access point is sampled while connected, in ms.
+#define JCFW_WIFI_ROAM_SAMPLE_PERIOD_MS      5000
+
+/// @brief The signal strength below which the STA looks for a better access point, in dBm, and the
+/// number of samples in a row which have to be below it.
+#define JCFW_WIFI_ROAM_RSSI_MIN_DBM          (-70)
+#define JCFW_WIFI_ROAM_LOW_COUNT_MIN         3
+
+/// @brief How much stronger than the access point another one has to be to roam to it, in dB.
+#define JCFW_WIFI_ROAM_HYSTERESIS_DB         8
+
+/// @brief The shortest time between scans for a better access point, in ms.
+#define JCFW_WIFI_ROAM_SCAN_PERIOD_MS        (60 * 1000)
 
 #endif // __JCFW_CONFIG_H__
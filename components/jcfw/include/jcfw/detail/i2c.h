@@ -0,0 +1,99 @@
+#ifndef __JCFW_DETAIL_I2C_H__
+#define __JCFW_DETAIL_I2C_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/platform/i2c.h"
+
+/* Notes:
+ * Shared between the portable I2C bus manager (src/platform/i2c.c) and the platform ports
+ * (src/platform/<platform>/i2c.c). Not part of the public API.
+ *
+ * The port provides the bus lock, the worker task, and the execution of a single transaction. The
+ * portable layer provides everything else.
+ */
+
+struct jcfw_i2c_bus_s
+{
+    /// @brief The platform bus handle.
+    void *handle;
+
+    /// @brief The platform state of the bus (lock, worker task, ...). Owned by the port.
+    void *port;
+
+    /// @brief The queued transactions, in submission order.
+    jcfw_i2c_xfer_t *queue_head;
+    jcfw_i2c_xfer_t *queue_tail;
+    size_t           queue_count;
+
+    /// @brief The devices registered on the bus.
+    jcfw_i2c_device_t *devices;
+
+    /// @brief Holds the data segments of merged writes while they are on the bus.
+    jcfw_i2c_segment_t merge_segments[JCFW_I2C_SEGMENT_COUNT_MAX];
+
+    bool is_used;
+};
+
+// Portable layer ----------------------------------------------------------------------------------
+
+/// @brief Queue a transaction on the bus of its device.
+/// @param xfer The transaction to queue.
+/// @param ignore_depth True to queue the transaction even if JCFW_I2C_QUEUE_DEPTH transactions are
+/// already pending.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e _jcfw_i2c_enqueue(jcfw_i2c_xfer_t *xfer, bool ignore_depth);
+
+/// @brief Execute a transaction immediately, bypassing the queue. Only call this from the worker
+/// task of the bus.
+/// @param xfer The transaction to execute.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e _jcfw_i2c_execute(jcfw_i2c_xfer_t *xfer);
+
+/// @brief Get the total size of a list of segments.
+/// @param segments The segments.
+/// @param segment_count The number of segments.
+/// @return The total size of the segments, in bytes.
+size_t _jcfw_i2c_segments_size(const jcfw_i2c_segment_t *segments, size_t segment_count);
+
+/// @brief Copy a list of segments back to back into one buffer. For platforms which can't send the
+/// segments directly.
+/// @param segments The segments.
+/// @param segment_count The number of segments.
+/// @param o_buffer Required; The buffer to copy into.
+/// @param buffer_size The size of the buffer.
+/// @return JCFW_RESULT_OK if the operation is successful, or JCFW_RESULT_OUT_OF_BOUNDS if the
+/// segments don't fit in the buffer.
+jcfw_result_e _jcfw_i2c_segments_gather(
+    const jcfw_i2c_segment_t *segments,
+    size_t                    segment_count,
+    uint8_t                  *o_buffer,
+    size_t                    buffer_size);
+
+/// @brief Execute queued transactions until the queue of the bus is empty. Called by the worker
+/// task of the bus.
+/// @param bus The bus to service.
+void _jcfw_i2c_service(jcfw_i2c_bus_t *bus);
+
+// Port --------------------------------------------------------------------------------------------
+
+/// @brief Create the lock and start the worker task of a bus, and set `bus->port`.
+jcfw_result_e _jcfw_i2c_port_start(jcfw_i2c_bus_t *bus);
+
+/// @brief Lock the state of a bus. Held only for short, non-blocking critical sections.
+void _jcfw_i2c_port_lock(jcfw_i2c_bus_t *bus);
+
+/// @brief Unlock the state of a bus.
+void _jcfw_i2c_port_unlock(jcfw_i2c_bus_t *bus);
+
+/// @brief Wake the worker task of a bus. Called without the lock held, after queueing.
+void _jcfw_i2c_port_notify(jcfw_i2c_bus_t *bus);
+
+/// @brief Put a single read transaction on the bus.
+jcfw_result_e _jcfw_i2c_port_read(const jcfw_i2c_xfer_t *xfer);
+
+/// @brief Put a single write transaction on the bus. The data comes from `segments`, rather than
+/// from the data fields of the transaction.
+jcfw_result_e _jcfw_i2c_port_write(
+    const jcfw_i2c_xfer_t *xfer, const jcfw_i2c_segment_t *segments, size_t segment_count);
+
+#endif // __JCFW_DETAIL_I2C_H__
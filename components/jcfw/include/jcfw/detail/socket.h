@@ -0,0 +1,53 @@
+#ifndef __JCFW_DETAIL_SOCKET_H__
+#define __JCFW_DETAIL_SOCKET_H__
+
+#include "jcfw/detail/common.h"
+
+/* Notes:
+ * The BSD socket API, from lwIP on the ESP32 and from the OS on host builds, so that the network
+ * library (src/net/) is the same code on both. Not part of the public API.
+ *
+ * On the ESP32, close(), fcntl() and select() go through the VFS, which hands lwIP sockets to
+ * lwIP.
+ */
+
+#include <errno.h>
+
+#if __has_include("lwip/sockets.h")
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "jcfw/net/resolver.h"
+
+/// @brief Fill in the socket address of an address.
+/// @param address The address.
+/// @param o_sockaddr Required; The socket address.
+static inline void
+_jcfw_net_address_to_sockaddr(const jcfw_net_address_t *address, struct sockaddr_in *o_sockaddr)
+{
+    memset(o_sockaddr, 0x00, sizeof(*o_sockaddr));
+    o_sockaddr->sin_family = AF_INET;
+    o_sockaddr->sin_port   = htons(address->port);
+    memcpy(&o_sockaddr->sin_addr, address->ip, sizeof(address->ip));
+}
+
+/// @brief Check whether a socket error only means "not now".
+/// @param error The error (errno).
+/// @return True if the operation may succeed if it is retried later.
+static inline bool _jcfw_net_is_transient_error(int error)
+{
+    return error == EAGAIN || error == EWOULDBLOCK || error == ENOMEM || error == ENOBUFS
+        || error == EINTR;
+}
+
+#endif // __JCFW_DETAIL_SOCKET_H__
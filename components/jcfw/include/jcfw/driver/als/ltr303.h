@@ -3,21 +3,61 @@
 
 #include "jcfw/detail/common.h"
 
+#include "jcfw/driver/regmap.h"
+#include "jcfw/platform/i2c.h"
 #include "jcfw/util/bit.h"
 #include "jcfw/util/result.h"
 
 #define JCFW_LTR303_INTR_PERSIST_DEFAULT 0x00
 
+/// @brief The first register address mirrored by the driver's register shadow.
+#define JCFW_LTR303_SHADOW_BASE          0x80
+
+/// @brief The number of registers mirrored by the driver's register shadow (0x80 - 0x9E).
+#define JCFW_LTR303_SHADOW_SIZE          0x1F
+
+/// @brief The configuration of the adaptive threshold window. See
+/// jcfw_ltr303_enable_adaptive_window().
+typedef struct
+{
+    /// @brief The half-width of the window as a percentage of the latest channel 0 reading.
+    uint8_t deadband_percent;
+
+    /// @brief The minimum half-width of the window in raw channel 0 counts. Keeps the window from
+    /// collapsing in the dark.
+    uint16_t deadband_abs;
+
+    /// @brief The number of consecutive readings outside of the window, minus one, needed to
+    /// trigger an interrupt. Range 0x00 - 0x0F.
+    uint8_t persistance;
+} jcfw_ltr303_window_config_t;
+
 typedef struct
 {
-    void    *i2c_arg;
-    uint32_t i2c_timeout_ms;
+    /// @brief The register map of the device (see: jcfw/driver/regmap.h), and the storage of its
+    /// shadow and staged copies, indexed by `reg - JCFW_LTR303_SHADOW_BASE`.
+    jcfw_regmap_t regs;
+    uint8_t       shadow[JCFW_LTR303_SHADOW_SIZE];
+    uint8_t       staged[JCFW_LTR303_SHADOW_SIZE];
+
+    jcfw_ltr303_window_config_t window;
+    bool                        is_window_enabled;
+
+    /// @brief The in-flight asynchronous write (used for threshold window updates), and the buffers
+    /// it points to.
+    jcfw_i2c_xfer_t async_xfer;
+    uint8_t         async_reg;
+    uint8_t         async_data[4];
+
+    /// @brief Set by the I2C worker task when an asynchronous write fails; Consumed by the task
+    /// which owns the device.
+    volatile bool is_async_write_failed;
 } jcfw_ltr303_t;
 
 typedef enum
 {
     JCFW_LTR303_MODE_STANDBY = 0,
-    JCFW_LTR303_MODE_ACTIVE  = JCFW_BIT(0),
+    JCFW_LTR303_MODE_ACTIVE  = 0x01,
 } jcfw_ltr303_mode_e;
 
 typedef enum
@@ -61,6 +101,44 @@ typedef enum
     JCFW_LTR303_MEAS_RATE_2000MS  = 0x05,
 } jcfw_ltr303_measurement_rate_e;
 
+/// @brief The complete desired state of an LTR303. See jcfw_ltr303_apply_config().
+typedef struct
+{
+    jcfw_ltr303_mode_e               mode;
+    jcfw_ltr303_gain_e               gain;
+    jcfw_ltr303_integration_time_e   integration_time;
+    jcfw_ltr303_measurement_rate_e   measurement_rate;
+    bool                             interrupt_enable;
+    jcfw_ltr303_interrupt_polarity_e interrupt_polarity;
+    uint16_t                         threshold_low;
+    uint16_t                         threshold_high;
+    uint8_t                          persistance;
+} jcfw_ltr303_config_t;
+
+/// @brief A configuration matching the LTR303's power-on reset state.
+#define JCFW_LTR303_CONFIG_DEFAULT                                                                 \
+    {                                                                                              \
+        .mode               = JCFW_LTR303_MODE_STANDBY,                                            \
+        .gain               = JCFW_LTR303_GAIN_DEFAULT,                                            \
+        .integration_time   = JCFW_LTR303_INTEGRATION_TIME_DEFAULT,                                \
+        .measurement_rate   = JCFW_LTR303_MEAS_RATE_DEFAULT,                                       \
+        .interrupt_enable   = false,                                                               \
+        .interrupt_polarity = JCFW_LTR303_INTR_POL_LOW,                                            \
+        .threshold_low      = 0x0000,                                                              \
+        .threshold_high     = 0xFFFF,                                                              \
+        .persistance        = JCFW_LTR303_INTR_PERSIST_DEFAULT,                                    \
+    }
+
+/// @brief Verify the identity of an LTR303 and set up the driver structure without changing the
+/// state of the device.
+/// @note Be sure to wait until at least 100ms after power on to probe the device (see: datasheet
+/// page 25/26)
+/// @param dev A pointer to the structure to initialize.
+/// @param i2c_arg Optional; The argument to be used by the I2C platform function for this device.
+/// @param i2c_timeout_ms The timeout to be used for I2C operations.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_ltr303_probe(jcfw_ltr303_t *dev, void *i2c_arg, uint32_t i2c_timeout_ms);
+
 /// @brief Initialize the LTR303 driver.
 /// @note Be sure to wait until at least 100ms after power on to initialize the device (see:
 /// datasheet page 25/26)
@@ -70,6 +148,21 @@ typedef enum
 /// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
 jcfw_result_e jcfw_ltr303_init(jcfw_ltr303_t *dev, void *i2c_arg, uint32_t i2c_timeout_ms);
 
+/// @brief Bring the LTR303 to the state described by `cfg` using as few I2C transactions as
+/// possible. Only registers which differ from the driver's register shadow are written, and runs of
+/// adjacent registers (such as the threshold pairs) are combined into a single multi-byte write.
+/// @note If the interrupt configuration changes while the device is active, the device is briefly
+/// put in standby mode, as required by the datasheet.
+/// @param dev The device to configure. Must have been set up by jcfw_ltr303_probe() or
+/// jcfw_ltr303_init().
+/// @param cfg Required; The desired state of the device.
+/// @param skip_reset If false, the device is soft reset before being configured. If true, the
+/// current state of the device is kept (warm start); it is read back from the device if the driver
+/// does not already know it.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_ltr303_apply_config(
+    jcfw_ltr303_t *dev, const jcfw_ltr303_config_t *cfg, bool skip_reset);
+
 /// @brief Perform a soft reset on the LTR303.
 /// @param dev The device to perform the soft reset on.
 /// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
@@ -96,12 +189,14 @@ jcfw_result_e jcfw_ltr303_is_data_ready(jcfw_ltr303_t *dev, bool *o_is_data_read
 /// @brief Read the registers of the LTR303. So long as the I2C operation is successful, the
 /// registers will always be read, regardless of whether or not the data will be returned.
 /// @note To calculate visible light, subtract channel 1 from channel 0. Be sure to handle clamping.
-/// @note Setting `o_gain_factor == NULL` saves an I2C transaction, but you will be in charge of
-/// handling the gain calculation.
+/// @note The data and the gain are read in one burst. Setting `o_gain_factor == NULL` saves a byte
+/// on the bus, but you will be in charge of handling the gain calculation.
 /// @param dev The device to read.
 /// @param o_channel0_lux Optional; The data in channel 0 (visible + IR).
 /// @param o_channel1_lux Optional; The data in channel 1 (IR only).
 /// @param o_gain_factor Optional; The factor to divide readings by to calculate the reading in lux.
+/// @note If the adaptive threshold window is enabled, the window is re-centered on the channel 0
+/// reading (see: jcfw_ltr303_update_window()).
 /// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
 jcfw_result_e jcfw_ltr303_read(
     jcfw_ltr303_t *dev, uint16_t *o_channel0_lux, uint16_t *o_channel1_lux, uint8_t *o_gain_factor);
@@ -156,4 +251,25 @@ jcfw_result_e jcfw_ltr303_set_thresholds(
 /// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
 jcfw_result_e jcfw_ltr303_set_persistance(jcfw_ltr303_t *dev, size_t persistance);
 
+/// @brief Enable report-on-change mode. In this mode, the interrupt thresholds follow the latest
+/// channel 0 reading, so an interrupt only fires once the light level leaves the window
+/// `reading +/- max(reading * deadband_percent / 100, deadband_abs)`. The window is re-centered by
+/// every jcfw_ltr303_read().
+/// @note Interrupts must also be enabled (see: jcfw_ltr303_enable_interrupt()). Until the first
+/// read, the thresholds configured by the application remain in effect.
+/// @param dev The device to enable the adaptive window for.
+/// @param cfg Optional; The window configuration. Pass NULL to disable the adaptive window.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_ltr303_enable_adaptive_window(jcfw_ltr303_t *dev, const jcfw_ltr303_window_config_t *cfg);
+
+/// @brief Re-center the adaptive threshold window on a channel 0 reading. Only the threshold bytes
+/// which change are written. The write is queued asynchronously (see: jcfw/platform/i2c.h), so it
+/// overlaps with whatever the caller does next instead of blocking it. After a failed write, the
+/// registers are first read back, which blocks.
+/// @param dev The device to update the window of.
+/// @param channel0 The channel 0 reading to center the window on.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_ltr303_update_window(jcfw_ltr303_t *dev, uint16_t channel0);
+
 #endif // __JCFW_DRIVER_ALS_LTR303_H__
@@ -0,0 +1,249 @@
+#ifndef __JCFW_DRIVER_REGMAP_H__
+#define __JCFW_DRIVER_REGMAP_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A register map describes the register file of an I2C device with 8-bit registers and 8-bit
+ * auto-incrementing register addresses. A driver declares its registers and fields once, as
+ * X-macro lists, and everything else is generated from those lists:
+ *
+ *     // X(name, address, reset value, flags)
+ *     #define _MY_DEVICE_REGISTERS(X)                       \
+ *         X(CTRL,   0x10, 0x00, 0)                           \
+ *         X(STATUS, 0x11, 0x00, JCFW_REGMAP_FLAG_VOLATILE)
+ *
+ *     // X(name, register, offset, width, type)
+ *     #define _MY_DEVICE_FIELDS(X)                          \
+ *         X(ctrl_enable, MY_DEVICE_REG_CTRL, 0, 1, bool)     \
+ *         X(ctrl_gain,   MY_DEVICE_REG_CTRL, 1, 3, my_gain_e)
+ *
+ * - JCFW_REGMAP_DESC_REG() turns the register list into the descriptor table.
+ * - JCFW_REGMAP_DEFINE_FIELD() turns each field into a pair of typed accessors
+ *   (`<prefix>_get_<name>()` and `<prefix>_set_<name>()`), and checks at compile time that the
+ *   field fits in its register. Masks and shifts are never written by hand.
+ *
+ * The map keeps two copies of the register file: the shadow (the last known contents of the
+ * device) and the staged copy (the contents the driver wants). Field setters only touch the staged
+ * copy. jcfw_regmap_flush() then writes the difference using as few transactions as possible:
+ * each run of adjacent registers which contains a change becomes one multi-byte write, and
+ * unchanged registers in the middle of a run are rewritten, since an extra byte on the bus is much
+ * cheaper than an extra transaction.
+ *
+ * The map is not thread safe; Drivers are expected to serialize access to their devices.
+ */
+
+/// @brief The register can't be written.
+#define JCFW_REGMAP_FLAG_READ_ONLY JCFW_BIT(0)
+
+/// @brief The device changes the register on its own (data, status, ...), so the shadow is only a
+/// snapshot of the last read.
+#define JCFW_REGMAP_FLAG_VOLATILE  JCFW_BIT(1)
+
+/// @brief The register is never written by jcfw_regmap_flush(), because the driver needs to control
+/// when it is written (e.g. a mode register which must be written last). See:
+/// jcfw_regmap_flush_reg().
+#define JCFW_REGMAP_FLAG_MANUAL    JCFW_BIT(2)
+
+/// @brief The description of one register.
+typedef struct
+{
+    uint8_t addr;
+    uint8_t reset;
+    uint8_t flags;
+} jcfw_regmap_reg_t;
+
+/// @brief The description of a register file.
+typedef struct
+{
+    /// @brief The registers of the device, in ascending address order.
+    const jcfw_regmap_reg_t *regs;
+    size_t                   reg_count;
+
+    /// @brief The first address mirrored by the shadow, and the number of addresses mirrored.
+    uint8_t base;
+    size_t  size;
+} jcfw_regmap_desc_t;
+
+/// @brief A register map instance. The storage of the shadow and staged copies is owned by the
+/// driver, and is indexed by `addr - desc->base`.
+typedef struct
+{
+    const jcfw_regmap_desc_t *desc;
+
+    void    *i2c_arg;
+    uint32_t i2c_timeout_ms;
+
+    uint8_t *shadow;
+    uint8_t *staged;
+    bool     is_shadow_valid;
+} jcfw_regmap_t;
+
+/// @brief X-macro callback producing the descriptor of one register.
+#define JCFW_REGMAP_DESC_REG(_name, _addr, _reset, _flags)                                         \
+    {.addr = (_addr), .reset = (_reset), .flags = (_flags)},
+
+/// @brief Produce the accessors of one field.
+/// @param _prefix The prefix of the accessor names.
+/// @param _name The name of the field.
+/// @param _reg The address of the register that the field is in.
+/// @param _offset The offset of the least significant bit of the field.
+/// @param _width The width of the field, in bits.
+/// @param _type The type of the field's value.
+#define JCFW_REGMAP_DEFINE_FIELD(_prefix, _name, _reg, _offset, _width, _type)                     \
+    _Static_assert(                                                                                \
+        (_width) > 0 && (_offset) + (_width) <= 8, "Field " #_name " does not fit its register");  \
+                                                                                                   \
+    static inline _type _prefix##_get_##_name(const jcfw_regmap_t *map)                            \
+    {                                                                                              \
+        return (_type)jcfw_regmap_get_bits(map, (_reg), (_offset), (_width));                      \
+    }                                                                                              \
+                                                                                                   \
+    static inline void _prefix##_set_##_name(jcfw_regmap_t *map, _type value)                      \
+    {                                                                                              \
+        jcfw_regmap_set_bits(map, (_reg), (_offset), (_width), (uint8_t)value);                    \
+    }
+
+/// @brief Set up a register map. The shadow starts out invalid.
+/// @param map The map to set up.
+/// @param desc The description of the register file. Must outlive the map.
+/// @param shadow The storage of the shadow (`desc->size` bytes).
+/// @param staged The storage of the staged copy (`desc->size` bytes).
+/// @param i2c_arg Optional; The argument to be used by the I2C platform function for this device.
+/// @param i2c_timeout_ms The timeout to be used for I2C operations.
+void jcfw_regmap_init(
+    jcfw_regmap_t            *map,
+    const jcfw_regmap_desc_t *desc,
+    uint8_t                  *shadow,
+    uint8_t                  *staged,
+    void                     *i2c_arg,
+    uint32_t                  i2c_timeout_ms);
+
+/// @brief Load the reset values of every register into the shadow and the staged copy, and mark
+/// the shadow as valid. Call this after the device has been reset.
+/// @param map The map to load.
+void jcfw_regmap_load_reset(jcfw_regmap_t *map);
+
+/// @brief Mark the shadow as no longer matching the device.
+/// @param map The map to invalidate.
+static inline void jcfw_regmap_invalidate(jcfw_regmap_t *map)
+{
+    map->is_shadow_valid = false;
+}
+
+/// @brief If the shadow is not valid, read every described register back from the device. Nearby
+/// registers are read in one burst, up to JCFW_REGMAP_READ_GAP_MAX undescribed registers apart.
+/// @note Discards any staged changes.
+/// @param map The map to synchronize.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_regmap_sync(jcfw_regmap_t *map);
+
+/// @brief Read a block of adjacent registers into the shadow and the staged copy.
+/// @note Discards any staged changes to the registers read.
+/// @param map The map to read into.
+/// @param addr The address of the first register to read.
+/// @param count The number of registers to read.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_regmap_read(jcfw_regmap_t *map, uint8_t addr, size_t count);
+
+/// @brief Write a block of adjacent registers immediately, regardless of the shadow, and update
+/// the shadow and the staged copy to match.
+/// @param map The map to write through.
+/// @param addr The address of the first register to write.
+/// @param data The data to write.
+/// @param count The number of registers to write.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_regmap_write(jcfw_regmap_t *map, uint8_t addr, const uint8_t *data, size_t count);
+
+/// @brief Record that a block of registers has been (or is about to be) written by other means,
+/// such as an asynchronous transaction.
+/// @param map The map to update.
+/// @param addr The address of the first register written.
+/// @param data The data written.
+/// @param count The number of registers written.
+void jcfw_regmap_assume_written(
+    jcfw_regmap_t *map, uint8_t addr, const uint8_t *data, size_t count);
+
+/// @brief Write every staged change to the device, except for read-only, volatile and manual
+/// registers, using as few transactions as possible. If the shadow is not valid, every writable
+/// register is written, and the shadow is valid again afterwards (unless the map has manual
+/// registers, which are left to jcfw_regmap_sync()).
+/// @param map The map to flush.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_regmap_flush(jcfw_regmap_t *map);
+
+/// @brief Write the staged value of one register to the device if it has changed.
+/// @param map The map to flush.
+/// @param addr The address of the register to flush.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_regmap_flush_reg(jcfw_regmap_t *map, uint8_t addr);
+
+/// @brief Return true if the staged value of a register differs from the shadow (or the shadow is
+/// not valid).
+/// @param map The map to check.
+/// @param addr The address of the register to check.
+/// @return True if the register would be written by a flush, and false otherwise.
+static inline bool jcfw_regmap_is_dirty(const jcfw_regmap_t *map, uint8_t addr)
+{
+    const size_t idx = addr - map->desc->base;
+    return !map->is_shadow_valid || map->staged[idx] != map->shadow[idx];
+}
+
+/// @brief Get the staged value of a register.
+/// @param map The map to read from.
+/// @param addr The address of the register.
+/// @return The staged value of the register.
+static inline uint8_t jcfw_regmap_get(const jcfw_regmap_t *map, uint8_t addr)
+{
+    JCFW_DASSERT(
+        addr >= map->desc->base && addr - map->desc->base < map->desc->size,
+        "Register 0x%02x is outside of the map",
+        addr);
+
+    return map->staged[addr - map->desc->base];
+}
+
+/// @brief Set the staged value of a register.
+/// @param map The map to write to.
+/// @param addr The address of the register.
+/// @param value The value to stage.
+static inline void jcfw_regmap_set(jcfw_regmap_t *map, uint8_t addr, uint8_t value)
+{
+    JCFW_DASSERT(
+        addr >= map->desc->base && addr - map->desc->base < map->desc->size,
+        "Register 0x%02x is outside of the map",
+        addr);
+
+    map->staged[addr - map->desc->base] = value;
+}
+
+/// @brief Get the staged value of a bit field. Prefer the accessors generated by
+/// JCFW_REGMAP_DEFINE_FIELD().
+static inline uint8_t
+jcfw_regmap_get_bits(const jcfw_regmap_t *map, uint8_t addr, uint8_t offset, uint8_t width)
+{
+    const uint8_t mask = (uint8_t)((1U << width) - 1);
+    return (jcfw_regmap_get(map, addr) >> offset) & mask;
+}
+
+/// @brief Set the staged value of a bit field. Prefer the accessors generated by
+/// JCFW_REGMAP_DEFINE_FIELD().
+static inline void
+jcfw_regmap_set_bits(jcfw_regmap_t *map, uint8_t addr, uint8_t offset, uint8_t width, uint8_t value)
+{
+    const uint8_t mask = (uint8_t)((1U << width) - 1);
+    JCFW_DASSERT(value <= mask, "Value 0x%02x does not fit a %u-bit field", value, width);
+
+    uint8_t reg = jcfw_regmap_get(map, addr);
+    JCFW_BITCLEAR(reg, mask << offset);
+    JCFW_BITSET(reg, (value & mask) << offset);
+    jcfw_regmap_set(map, addr, reg);
+}
+
+#endif // __JCFW_DRIVER_REGMAP_H__
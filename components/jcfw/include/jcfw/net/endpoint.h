@@ -0,0 +1,158 @@
+#ifndef __JCFW_NET_ENDPOINT_H__
+#define __JCFW_NET_ENDPOINT_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/net/resolver.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * Picks which of several equivalent servers (endpoints, e.g. telemetry collectors) a client talks
+ * to, and fails over to another one when it stops answering. Like the reliable datagram protocol
+ * (see: jcfw/net/rdp.h), it is independent of the socket layer: The caller reports what it hears
+ * from the endpoints, and sends the probes which the set asks for.
+ *
+ * - Each client ranks the endpoints by weighted rendezvous hashing of its key (e.g. its device
+ *   id) and their addresses. Every client computes its ranking on its own, each endpoint comes
+ *   first (is the primary) for a share of the clients in proportion to its weight, and adding or
+ *   removing an endpoint only moves the clients which it comes first for.
+ * - The active endpoint is the best ranked one which is up. All endpoints start out up, so the
+ *   primary is used straight away.
+ * - An endpoint goes down when something sent to it timed out (e.g. a retransmit timeout) and it
+ *   hasn't been heard from since it was sent, so a single lost datagram doesn't count when others
+ *   were answered. This fails over within one retransmit timeout of the endpoint going quiet.
+ * - Every endpoint, up or down, is probed once per probe period. An endpoint which misses
+ *   JCFW_ENDPOINT_PROBE_MISS_MAX probes in a row goes down, and one which answers goes up; A
+ *   better ranked endpoint which comes back up becomes active again.
+ *
+ * A set is not thread safe; It should be driven by one task.
+ */
+
+/// @brief No endpoint.
+#define JCFW_ENDPOINT_NONE UINT32_MAX
+
+/// @brief Asks the caller to probe an endpoint; Any answer should be reported with
+/// jcfw_endpoint_set_on_heard().
+typedef void (*jcfw_endpoint_probe_f)(uint32_t index, void *arg);
+
+/// @brief Called when the active endpoint changes (either may be JCFW_ENDPOINT_NONE).
+typedef void (*jcfw_endpoint_change_f)(uint32_t from, uint32_t to, void *arg);
+
+typedef struct
+{
+    jcfw_net_address_t address;
+
+    /// @brief The share of clients which the endpoint is the primary of, relative to the other
+    /// endpoints. An endpoint of weight 0 is only used when all others are down.
+    uint32_t weight;
+} jcfw_endpoint_config_t;
+
+typedef struct
+{
+    /// @brief Ranks the endpoints; Should be unique to the client (e.g. its device id).
+    uint32_t key;
+
+    /// @brief The endpoints (up to JCFW_ENDPOINT_COUNT_MAX). They are referred to by their index
+    /// in this array.
+    const jcfw_endpoint_config_t *endpoints;
+    uint32_t                      endpoint_count;
+
+    uint32_t probe_period_ms;
+
+    jcfw_endpoint_probe_f probe_cb;
+
+    /// @brief Optional.
+    jcfw_endpoint_change_f change_cb;
+
+    void *cb_arg;
+} jcfw_endpoint_set_config_t;
+
+typedef struct
+{
+    jcfw_endpoint_config_t config;
+
+    bool     is_up;
+    bool     has_been_heard;
+    bool     has_been_probed;
+    uint64_t heard_us;
+    uint64_t probed_us;
+
+    /// @brief The number of probes in a row which the endpoint hasn't answered.
+    uint32_t miss_count;
+
+    /// @brief The number of times the endpoint went down.
+    uint32_t down_count;
+} jcfw_endpoint_t;
+
+typedef struct
+{
+    /// @brief The number of times the active endpoint changed.
+    uint32_t change_count;
+
+    uint32_t probe_count;
+} jcfw_endpoint_stats_t;
+
+typedef struct
+{
+    jcfw_endpoint_set_config_t config;
+
+    jcfw_endpoint_t endpoints[JCFW_ENDPOINT_COUNT_MAX];
+
+    /// @brief The indices of the endpoints, best ranked first.
+    uint32_t ranking[JCFW_ENDPOINT_COUNT_MAX];
+
+    uint32_t active;
+    bool     has_probed;
+    uint64_t probed_us;
+
+    jcfw_endpoint_stats_t stats;
+} jcfw_endpoint_set_t;
+
+/// @brief Set up a set of endpoints, all up.
+/// @param set The set to set up.
+/// @param config The configuration of the set.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_endpoint_set_init(jcfw_endpoint_set_t *set, const jcfw_endpoint_set_config_t *config);
+
+/// @brief Get the endpoint which the client should talk to.
+/// @param set The set.
+/// @return The index of the active endpoint, or JCFW_ENDPOINT_NONE if all endpoints are down.
+uint32_t jcfw_endpoint_set_get_active(const jcfw_endpoint_set_t *set);
+
+/// @brief Get an endpoint of a set.
+/// @param set The set.
+/// @param index The index of the endpoint.
+/// @return The endpoint, or NULL if there is no such endpoint.
+const jcfw_endpoint_t *jcfw_endpoint_set_get(const jcfw_endpoint_set_t *set, uint32_t index);
+
+/// @brief Get the rank of an endpoint for this client.
+/// @param set The set.
+/// @param index The index of the endpoint.
+/// @return The rank of the endpoint (0 for the primary), or JCFW_ENDPOINT_NONE if there is no such
+/// endpoint.
+uint32_t jcfw_endpoint_set_get_rank(const jcfw_endpoint_set_t *set, uint32_t index);
+
+/// @brief Report that an endpoint was heard from (e.g. it acknowledged data or answered a probe).
+/// @param set The set.
+/// @param index The index of the endpoint.
+/// @param now_us The current time.
+void jcfw_endpoint_set_on_heard(jcfw_endpoint_set_t *set, uint32_t index, uint64_t now_us);
+
+/// @brief Report that something sent to an endpoint timed out.
+/// @param set The set.
+/// @param index The index of the endpoint.
+/// @param sent_us The time at which what timed out was sent.
+void jcfw_endpoint_set_on_timeout(jcfw_endpoint_set_t *set, uint32_t index, uint64_t sent_us);
+
+/// @brief Probe the endpoints if the probe period has passed.
+/// @param set The set.
+/// @param now_us The current time.
+void jcfw_endpoint_set_poll(jcfw_endpoint_set_t *set, uint64_t now_us);
+
+/// @brief Get the statistics of a set.
+/// @param set The set to check.
+/// @param o_stats Required; The statistics.
+void jcfw_endpoint_set_get_stats(const jcfw_endpoint_set_t *set, jcfw_endpoint_stats_t *o_stats);
+
+#endif // __JCFW_NET_ENDPOINT_H__
@@ -0,0 +1,246 @@
+#ifndef __JCFW_NET_RDP_H__
+#define __JCFW_NET_RDP_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A lightweight reliable datagram protocol (RDP) for telemetry over UDP. It is independent of the
+ * socket layer: datagrams go out through a callback, and received datagrams and the current time
+ * are fed in by the caller.
+ *
+ * All multi-byte fields are little endian.
+ *
+ *     DATA: type (0x01), reserved (0), session (u32), sequence number (u32), send time (u64),
+ *           payload
+ *     ACK:  type (0x02), reserved (0), session (u32), cumulative ack (u32), selective acks (u32)
+ *
+ * - The sender numbers each datagram and keeps up to JCFW_RDP_WINDOW_SIZE of them in flight. When
+ *   the window is full, jcfw_rdp_sender_send() returns JCFW_RESULT_FULL, which is the caller's
+ *   backpressure signal.
+ * - The receiver acknowledges every DATA datagram. The cumulative ack is the lowest sequence
+ *   number not yet received; bit i of the selective acks is set if `cumulative ack + 1 + i` has
+ *   been received. Duplicates are acknowledged again but only delivered once.
+ * - Only datagrams which are still unacknowledged are retransmitted: once their retransmit timeout
+ *   (RTO) expires, or straight away if JCFW_RDP_FAST_RETRANSMIT_COUNT later datagrams were
+ *   acknowledged before them. Datagrams which are still unacknowledged after JCFW_RDP_RETRY_MAX
+ *   retransmits are dropped (and handed to the drop callback, if there is one). The timeout
+ *   callback, if there is one, hears of each expired RTO before the datagram is retransmitted or
+ *   dropped.
+ * - The RTO adapts to the round trip time as in RFC 6298 (smoothed RTT plus four times its
+ *   variance; no samples from retransmitted datagrams), and backs off exponentially for each
+ *   retransmit of a datagram.
+ * - Datagrams are delivered as they arrive, not in sequence order; Each telemetry frame stands on
+ *   its own, so waiting for a lost frame would only add latency.
+ * - The send time is the `now_us` of the call which (re)transmitted the datagram, on the sender's
+ *   clock (or on the clock which the stamp callback maps it onto). It is handed to the receiver
+ *   along with the payload, so that the time between sending and receiving can be measured once
+ *   the two clocks are aligned (see: jcfw/net/timesync.h).
+ *
+ * The session is a random number chosen by the sender when it starts, so that a receiver notices a
+ * sender which restarted its sequence numbers.
+ *
+ * Neither side is thread safe; Each should be driven by one task.
+ */
+
+#define JCFW_RDP_TYPE_DATA        0x01
+#define JCFW_RDP_TYPE_ACK         0x02
+
+#define JCFW_RDP_DATA_HEADER_SIZE 18
+#define JCFW_RDP_ACK_SIZE         14
+
+/// @brief The largest datagram sent by the protocol, in bytes.
+#define JCFW_RDP_DATAGRAM_SIZE_MAX (JCFW_RDP_DATA_HEADER_SIZE + JCFW_RDP_PAYLOAD_SIZE_MAX)
+
+_Static_assert(JCFW_RDP_WINDOW_SIZE <= 32, "The selective acks cover at most 32 datagrams");
+
+/// @brief Sends one datagram.
+/// @return JCFW_RESULT_OK if the datagram was handed to the network, or an error code otherwise. A
+/// datagram which wasn't sent is retransmitted like a lost one.
+typedef jcfw_result_e (*jcfw_rdp_send_f)(const uint8_t *datagram, size_t length, void *arg);
+
+/// @brief Called with the payload of each new DATA datagram, and the time at which the sender sent
+/// it (on the sender's clock).
+typedef void (*jcfw_rdp_deliver_f)(
+    const uint8_t *payload, size_t length, uint64_t send_us, void *arg);
+
+/// @brief Maps the time of a transmission onto the clock which its send time is stamped with.
+typedef uint64_t (*jcfw_rdp_stamp_f)(uint64_t now_us, void *arg);
+
+/// @brief Called with the payload of each datagram which is dropped unacknowledged.
+typedef void (*jcfw_rdp_drop_f)(const uint8_t *payload, size_t length, void *arg);
+
+/// @brief Called when the retransmit timeout of a datagram expires, with the time at which it was
+/// last (re)transmitted.
+typedef void (*jcfw_rdp_timeout_f)(uint64_t sent_us, void *arg);
+
+// SENDER ------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    /// @brief The session of the sender; Should be random.
+    uint32_t session;
+
+    jcfw_rdp_send_f send_cb;
+    void           *send_cb_arg;
+
+    /// @brief Optional; Lets the caller keep the payloads which the peer never acknowledged.
+    jcfw_rdp_drop_f drop_cb;
+    void           *drop_cb_arg;
+
+    /// @brief Optional; Stamps transmissions with another clock than the one which times the
+    /// retransmits (e.g. a synchronized one, which may step).
+    jcfw_rdp_stamp_f stamp_cb;
+    void            *stamp_cb_arg;
+
+    /// @brief Optional; Lets the caller notice a peer which went quiet (e.g. to fail over to
+    /// another one; see: jcfw/net/endpoint.h) before the datagram is retransmitted.
+    jcfw_rdp_timeout_f timeout_cb;
+    void              *timeout_cb_arg;
+} jcfw_rdp_sender_config_t;
+
+typedef struct
+{
+    uint32_t datagram_count;
+    uint32_t ack_count;
+    uint32_t retransmit_count;
+    uint32_t fast_retransmit_count;
+    uint32_t send_failure_count;
+
+    /// @brief The number of datagrams dropped after JCFW_RDP_RETRY_MAX retransmits.
+    uint32_t drop_count;
+
+    uint32_t srtt_us;
+    uint32_t rto_us;
+} jcfw_rdp_sender_stats_t;
+
+/// @brief One datagram in flight.
+typedef struct
+{
+    bool     is_in_flight;
+    bool     is_fast_retransmitted;
+    uint8_t  retransmit_count;
+    uint16_t length;
+    uint64_t sent_us;
+    uint8_t  datagram[JCFW_RDP_DATAGRAM_SIZE_MAX];
+} jcfw_rdp_slot_t;
+
+typedef struct
+{
+    jcfw_rdp_sender_config_t config;
+
+    /// @brief The datagram with sequence number `seq` lives in `slots[seq % JCFW_RDP_WINDOW_SIZE]`.
+    jcfw_rdp_slot_t slots[JCFW_RDP_WINDOW_SIZE];
+    uint32_t        base_seq;
+    uint32_t        next_seq;
+
+    bool     has_rtt;
+    uint32_t srtt_us;
+    uint32_t rttvar_us;
+    uint32_t rto_us;
+
+    jcfw_rdp_sender_stats_t stats;
+} jcfw_rdp_sender_t;
+
+/// @brief Set up a sender.
+/// @param sender The sender to set up.
+/// @param config The configuration of the sender.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_rdp_sender_init(jcfw_rdp_sender_t *sender, const jcfw_rdp_sender_config_t *config);
+
+/// @brief Send a payload reliably.
+/// @param sender The sender to send with.
+/// @param payload The payload to send (copied).
+/// @param length The length of the payload, at most JCFW_RDP_PAYLOAD_SIZE_MAX bytes.
+/// @param now_us The current time.
+/// @return JCFW_RESULT_OK if the payload was queued (even if the first transmission failed),
+/// JCFW_RESULT_FULL if the window is full, or an error code otherwise.
+jcfw_result_e jcfw_rdp_sender_send(
+    jcfw_rdp_sender_t *sender, const void *payload, size_t length, uint64_t now_us);
+
+/// @brief Handle a datagram received from the peer.
+/// @param sender The sender which the datagram is for.
+/// @param datagram The datagram.
+/// @param length The length of the datagram, in bytes.
+/// @param now_us The current time.
+/// @return JCFW_RESULT_OK if the datagram was an ACK for this session, or an error code otherwise.
+jcfw_result_e jcfw_rdp_sender_on_receive(
+    jcfw_rdp_sender_t *sender, const uint8_t *datagram, size_t length, uint64_t now_us);
+
+/// @brief Retransmit datagrams whose RTO has expired. Call at least every few tens of ms.
+/// @param sender The sender to poll.
+/// @param now_us The current time.
+void jcfw_rdp_sender_poll(jcfw_rdp_sender_t *sender, uint64_t now_us);
+
+/// @brief Get the number of datagrams in flight.
+/// @param sender The sender to check.
+/// @return The number of datagrams which are neither acknowledged nor dropped.
+static inline uint32_t jcfw_rdp_sender_get_in_flight(const jcfw_rdp_sender_t *sender)
+{
+    return sender->next_seq - sender->base_seq;
+}
+
+/// @brief Get the statistics of a sender.
+/// @param sender The sender to check.
+/// @param o_stats Required; The statistics.
+void jcfw_rdp_sender_get_stats(const jcfw_rdp_sender_t *sender, jcfw_rdp_sender_stats_t *o_stats);
+
+// RECEIVER ----------------------------------------------------------------------------------------
+
+typedef struct
+{
+    jcfw_rdp_deliver_f deliver_cb;
+    void              *deliver_cb_arg;
+
+    /// @brief Sends ACKs back to the sender.
+    jcfw_rdp_send_f send_cb;
+    void           *send_cb_arg;
+} jcfw_rdp_receiver_config_t;
+
+typedef struct
+{
+    uint32_t datagram_count;
+    uint32_t delivered_count;
+    uint32_t duplicate_count;
+    uint32_t session_count;
+
+    /// @brief The number of sequence numbers skipped without ever being received.
+    uint32_t lost_count;
+} jcfw_rdp_receiver_stats_t;
+
+typedef struct
+{
+    jcfw_rdp_receiver_config_t config;
+
+    bool     has_session;
+    uint32_t session;
+    uint32_t next_seq;
+    uint32_t sack_bits;
+
+    jcfw_rdp_receiver_stats_t stats;
+} jcfw_rdp_receiver_t;
+
+/// @brief Set up a receiver for one sender.
+/// @param receiver The receiver to set up.
+/// @param config The configuration of the receiver.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_rdp_receiver_init(jcfw_rdp_receiver_t *receiver, const jcfw_rdp_receiver_config_t *config);
+
+/// @brief Handle a datagram received from the sender, delivering and acknowledging it.
+/// @param receiver The receiver which the datagram is for.
+/// @param datagram The datagram.
+/// @param length The length of the datagram, in bytes.
+/// @return JCFW_RESULT_OK if the datagram was a DATA datagram, or an error code otherwise.
+jcfw_result_e
+jcfw_rdp_receiver_on_receive(jcfw_rdp_receiver_t *receiver, const uint8_t *datagram, size_t length);
+
+/// @brief Get the statistics of a receiver.
+/// @param receiver The receiver to check.
+/// @param o_stats Required; The statistics.
+void jcfw_rdp_receiver_get_stats(
+    const jcfw_rdp_receiver_t *receiver, jcfw_rdp_receiver_stats_t *o_stats);
+
+#endif // __JCFW_NET_RDP_H__
@@ -0,0 +1,58 @@
+#ifndef __JCFW_NET_RESOLVER_H__
+#define __JCFW_NET_RESOLVER_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * IPv4 addresses, and a cache in front of the system resolver (getaddrinfo()), which blocks the
+ * calling task until the DNS server answers.
+ *
+ * - Numeric addresses (e.g. "192.168.1.10") are parsed without a lookup.
+ * - A name is looked up at most once every JCFW_NET_RESOLVER_TTL_MS; The system resolver doesn't
+ *   report the TTL of the record, so this stands in for it.
+ * - If a lookup fails (e.g. the network is down), the last address of the name is used until the
+ *   name can be looked up again.
+ * - When the cache is full, the name which was looked up longest ago is forgotten.
+ *
+ * The cache isn't thread safe; Resolve names from one task.
+ */
+
+typedef struct
+{
+    /// @brief The IPv4 address, in network order (e.g. {192, 168, 1, 10}).
+    uint8_t ip[4];
+
+    uint16_t port;
+} jcfw_net_address_t;
+
+/// @brief The format of an address, for traces (see: JCFW_NET_ADDRESS_ARGS()).
+#define JCFW_NET_ADDRESS_FORMAT "%u.%u.%u.%u:%u"
+
+/// @brief The arguments which JCFW_NET_ADDRESS_FORMAT takes.
+/// @param _address The address (a `const jcfw_net_address_t *`).
+#define JCFW_NET_ADDRESS_ARGS(_address)                                                            \
+    (_address)->ip[0], (_address)->ip[1], (_address)->ip[2], (_address)->ip[3], (_address)->port
+
+/// @brief Parse a numeric address.
+/// @param host The address (e.g. "192.168.1.10").
+/// @param port The port.
+/// @param o_address Required; The address.
+/// @return JCFW_RESULT_OK if the address is numeric, or an error code otherwise.
+jcfw_result_e
+jcfw_net_address_parse(const char *host, uint16_t port, jcfw_net_address_t *o_address);
+
+/// @brief Resolve a host name (or a numeric address), through the cache.
+/// @param host The host name.
+/// @param port The port.
+/// @param o_address Required; The address.
+/// @return JCFW_RESULT_OK if the host has an address, or an error code otherwise.
+jcfw_result_e jcfw_net_resolve(const char *host, uint16_t port, jcfw_net_address_t *o_address);
+
+/// @brief Forget the cached address of a host name, so that it is looked up again (e.g. once the
+/// host stops answering).
+/// @param host The host name.
+void jcfw_net_resolver_forget(const char *host);
+
+#endif // __JCFW_NET_RESOLVER_H__
@@ -0,0 +1,199 @@
+#ifndef __JCFW_NET_SOCKET_H__
+#define __JCFW_NET_SOCKET_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/net/resolver.h"
+#include "jcfw/platform/mutex.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * Non-blocking, connected UDP and TCP sockets, driven by an event loop around select(). The same
+ * code runs on lwIP and on host builds.
+ *
+ * - Sockets are connected to their one peer, so the stack looks up the route (and the ARP entry)
+ *   once rather than for every datagram, and datagrams from anyone else are filtered out.
+ * - Sending never blocks. A send goes straight to the stack if nothing is queued ahead of it, and
+ *   is queued in the socket's send buffer if the stack can't take it yet. The loop sends queued
+ *   data once the socket is writable, or after JCFW_NET_RETRY_MS when the stack was out of
+ *   buffers (lwIP doesn't report that through select()).
+ * - The send buffer is the backpressure: A send which doesn't fit in it is refused whole with
+ *   JCFW_RESULT_FULL, and once the buffer has drained, the writable callback says so. UDP sends
+ *   are queued as whole datagrams; TCP sends as bytes of the stream.
+ * - A TCP socket connects in the background; Sends are queued until it is connected. The state
+ *   callback reports the connection, and its loss (the socket is closed).
+ * - Received data is handed to the receive callback with the time at which it was read.
+ *
+ * One task runs the loop (see: jcfw_net_loop_poll()), and the callbacks run on it. Sockets are
+ * opened and closed by that task (or before the loop runs). Any task may send; The loop's mutex
+ * keeps the send buffers consistent, and the loop is woken through a loopback socket when it has
+ * to start watching for writability (on lwIP, this needs CONFIG_LWIP_NETIF_LOOPBACK).
+ *
+ * Addresses are IPv4 (see: jcfw/net/resolver.h).
+ */
+
+/// @brief Wait without a timeout.
+#define JCFW_NET_WAIT_FOREVER UINT32_MAX
+
+typedef enum
+{
+    JCFW_NET_SOCKET_TYPE_UDP = 0,
+    JCFW_NET_SOCKET_TYPE_TCP,
+} jcfw_net_socket_type_e;
+
+typedef enum
+{
+    JCFW_NET_SOCKET_STATE_CLOSED = 0,
+    JCFW_NET_SOCKET_STATE_CONNECTING,
+    JCFW_NET_SOCKET_STATE_CONNECTED,
+} jcfw_net_socket_state_e;
+
+typedef struct jcfw_net_socket_s jcfw_net_socket_t;
+typedef struct jcfw_net_loop_s   jcfw_net_loop_t;
+
+/// @brief Called with each datagram (UDP) or chunk of the stream (TCP) received by a socket.
+typedef void (*jcfw_net_receive_f)(
+    jcfw_net_socket_t *sock, const uint8_t *data, size_t length, uint64_t receive_us, void *arg);
+
+/// @brief Called when a socket connects, or is closed by an error or by its peer.
+typedef void (*jcfw_net_state_f)(
+    jcfw_net_socket_t *sock, jcfw_net_socket_state_e state, void *arg);
+
+/// @brief Called when the send buffer of a socket has drained after it refused a send.
+typedef void (*jcfw_net_writable_f)(jcfw_net_socket_t *sock, void *arg);
+
+typedef struct
+{
+    jcfw_net_socket_type_e type;
+
+    /// @brief The peer of the socket.
+    jcfw_net_address_t remote;
+
+    /// @brief Holds what the stack can't take yet. Each queued UDP datagram takes two bytes more
+    /// than its length.
+    uint8_t *send_buffer;
+    size_t   send_buffer_size;
+
+    jcfw_net_receive_f receive_cb;
+
+    /// @brief Optional.
+    jcfw_net_state_f state_cb;
+
+    /// @brief Optional.
+    jcfw_net_writable_f writable_cb;
+
+    void *cb_arg;
+} jcfw_net_socket_config_t;
+
+typedef struct
+{
+    /// @brief The number of sends which went to the stack, straight away or from the buffer.
+    uint32_t sent_count;
+
+    /// @brief The number of sends which had to wait in the send buffer.
+    uint32_t queued_count;
+
+    /// @brief The number of sends refused because the send buffer was full.
+    uint32_t refused_count;
+
+    uint32_t receive_count;
+
+    /// @brief The number of sends and receives which failed (e.g. the peer's port was closed).
+    uint32_t error_count;
+} jcfw_net_socket_stats_t;
+
+struct jcfw_net_socket_s
+{
+    jcfw_net_socket_config_t config;
+    jcfw_net_loop_t         *loop;
+    jcfw_net_socket_t       *next;
+
+    int                     fd;
+    jcfw_net_socket_state_e state;
+
+    /// @brief The send buffer is a ring of `queue_used` bytes from `queue_tail` to `queue_head`.
+    size_t queue_head;
+    size_t queue_tail;
+    size_t queue_used;
+
+    /// @brief When a send which the stack had no buffers for is retried, or 0 to wait for the
+    /// socket to become writable.
+    uint64_t retry_us;
+
+    /// @brief Whether a send was refused since the send buffer last drained.
+    bool was_refused;
+
+    jcfw_net_socket_stats_t stats;
+};
+
+struct jcfw_net_loop_s
+{
+    jcfw_net_socket_t *sockets;
+    jcfw_mutex_t      *lock;
+
+    /// @brief The socket which jcfw_net_loop_poll() handles next; Closing it moves this on.
+    jcfw_net_socket_t *poll_next;
+
+    /// @brief A UDP socket connected to itself; A datagram on it wakes the loop.
+    int wake_fd;
+
+    uint8_t receive_buffer[JCFW_NET_RECEIVE_SIZE_MAX];
+};
+
+// LOOP --------------------------------------------------------------------------------------------
+
+/// @brief Set up an event loop with no sockets.
+/// @param loop The loop to set up.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_net_loop_init(jcfw_net_loop_t *loop);
+
+/// @brief Wait for the sockets of a loop to become readable or writable, and handle them.
+/// @param loop The loop.
+/// @param timeout_ms The longest time to wait for, or JCFW_NET_WAIT_FOREVER.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_net_loop_poll(jcfw_net_loop_t *loop, uint32_t timeout_ms);
+
+/// @brief Wake a loop which is waiting in jcfw_net_loop_poll(), from any task.
+/// @param loop The loop to wake.
+void jcfw_net_loop_wake(jcfw_net_loop_t *loop);
+
+// SOCKET ------------------------------------------------------------------------------------------
+
+/// @brief Open a socket, connect it, and add it to a loop.
+/// @param loop The loop which drives the socket.
+/// @param sock The socket to open.
+/// @param config Required; The configuration of the socket.
+/// @return JCFW_RESULT_OK if the socket is connected (UDP) or connecting (TCP), or an error code
+/// otherwise.
+jcfw_result_e jcfw_net_socket_open(
+    jcfw_net_loop_t *loop, jcfw_net_socket_t *sock, const jcfw_net_socket_config_t *config);
+
+/// @brief Close a socket, dropping whatever is still in its send buffer, and remove it from its
+/// loop.
+/// @param sock The socket to close.
+void jcfw_net_socket_close(jcfw_net_socket_t *sock);
+
+/// @brief Send a datagram (UDP) or data on the stream (TCP), from any task.
+/// @param sock The socket to send with.
+/// @param data The data to send.
+/// @param length The length of the data, in bytes.
+/// @return JCFW_RESULT_OK if the data was sent or queued, JCFW_RESULT_FULL if the send buffer has
+/// no room for it, JCFW_RESULT_NOT_CONNECTED if the socket is closed, or an error code otherwise.
+jcfw_result_e jcfw_net_socket_send(jcfw_net_socket_t *sock, const uint8_t *data, size_t length);
+
+/// @brief Get the state of a socket.
+/// @param sock The socket to check.
+/// @return The state of the socket.
+jcfw_net_socket_state_e jcfw_net_socket_get_state(jcfw_net_socket_t *sock);
+
+/// @brief Get the number of bytes waiting in the send buffer of a socket.
+/// @param sock The socket to check.
+/// @return The number of bytes queued.
+size_t jcfw_net_socket_get_queued(jcfw_net_socket_t *sock);
+
+/// @brief Get the statistics of a socket.
+/// @param sock The socket to check.
+/// @param o_stats Required; The statistics.
+void jcfw_net_socket_get_stats(jcfw_net_socket_t *sock, jcfw_net_socket_stats_t *o_stats);
+
+#endif // __JCFW_NET_SOCKET_H__
@@ -0,0 +1,167 @@
+#ifndef __JCFW_NET_TIMESYNC_H__
+#define __JCFW_NET_TIMESYNC_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * Estimates the offset between the clock of this side (the client) and the clock of a peer (the
+ * server) with NTP-style probes. Like the reliable datagram protocol (see: jcfw/net/rdp.h), it is
+ * independent of the socket layer, and its datagrams can share a socket with RDP datagrams; The
+ * first byte tells them apart.
+ *
+ * All multi-byte fields are little endian.
+ *
+ *     REQUEST:  type (0x03), reserved (0), sequence number (u32), origin time (u64)
+ *     RESPONSE: type (0x04), reserved (0), sequence number (u32), origin time (u64),
+ *               receive time (u64), transmit time (u64)
+ *
+ * - The client stamps each request with its own clock (t1). The server stamps the response with
+ *   its clock when the request arrived (t2) and when the response is sent (t3), and the client
+ *   notes when the response arrived (t4).
+ * - The offset of the server's clock is `((t2 - t1) + (t3 - t4)) / 2`, and the round trip delay is
+ *   `(t4 - t1) - (t3 - t2)`. The offset is exact if both legs of the trip took equally long, and
+ *   off by at most half the delay otherwise.
+ * - Queueing makes trips lopsided, so the estimate is taken from the probe with the shortest delay
+ *   out of the last JCFW_TIMESYNC_SAMPLE_COUNT (NTP's clock filter).
+ * - No two crystals tick at quite the same rate, so the offset drifts between probes. The drift is
+ *   the slope of a least-squares line through the offsets of the quicker half of the probes, and
+ *   the model (see: jcfw_timesync_get_model()) extrapolates the offset with it once the slope
+ *   stands out from the jitter (until the probes span enough time, it doesn't).
+ * - When a probe disagrees with the model by more than JCFW_TIMESYNC_STEP_US (more than its delay
+ *   explains), the server's clock was stepped (e.g. it restarted), so the older probes are
+ *   forgotten.
+ * - Only the response to the latest request is accepted, so a late response can't be mistaken for
+ *   a fresh one.
+ *
+ * A client is not thread safe; It should be driven by one task. Responding needs no state.
+ */
+
+#define JCFW_TIMESYNC_TYPE_REQUEST   0x03
+#define JCFW_TIMESYNC_TYPE_RESPONSE  0x04
+
+#define JCFW_TIMESYNC_REQUEST_SIZE   14
+#define JCFW_TIMESYNC_RESPONSE_SIZE  30
+
+typedef struct
+{
+    /// @brief The client time at which the probe was halfway through its round trip.
+    uint64_t local_us;
+
+    /// @brief The offset of the server's clock (server time minus client time), in microseconds.
+    int64_t offset_us;
+
+    /// @brief The round trip time, less the time spent in the server, in microseconds.
+    uint32_t delay_us;
+} jcfw_timesync_sample_t;
+
+/// @brief Maps client time onto server time (see: jcfw_timesync_model_apply()).
+typedef struct
+{
+    /// @brief The client time at which the model is anchored.
+    uint64_t local_us;
+
+    /// @brief The offset of the server's clock at `local_us`, in microseconds.
+    int64_t offset_us;
+
+    /// @brief How fast the server's clock runs relative to the client's, in parts per billion.
+    int32_t drift_ppb;
+
+    /// @brief The largest error of the offset at `local_us` (half the round trip delay).
+    uint32_t error_us;
+} jcfw_timesync_model_t;
+
+typedef struct
+{
+    uint32_t request_count;
+    uint32_t response_count;
+
+    /// @brief The number of responses ignored because they didn't answer the latest request.
+    uint32_t stale_count;
+
+    /// @brief The number of times the server's clock was found to have been stepped.
+    uint32_t step_count;
+} jcfw_timesync_stats_t;
+
+typedef struct
+{
+    uint32_t next_seq;
+    bool     has_request;
+    uint64_t request_us;
+
+    /// @brief The latest probes, oldest first once `sample_count` reaches the capacity.
+    jcfw_timesync_sample_t samples[JCFW_TIMESYNC_SAMPLE_COUNT];
+    uint32_t               sample_count;
+    uint32_t               next_sample;
+
+    jcfw_timesync_stats_t stats;
+} jcfw_timesync_t;
+
+// CLIENT ------------------------------------------------------------------------------------------
+
+/// @brief Set up a client with no samples.
+/// @param timesync The client to set up.
+void jcfw_timesync_init(jcfw_timesync_t *timesync);
+
+/// @brief Build a request to send to the server, replacing any request still unanswered.
+/// @param timesync The client.
+/// @param now_us The current time.
+/// @param o_datagram Required; The request (JCFW_TIMESYNC_REQUEST_SIZE bytes).
+void jcfw_timesync_make_request(jcfw_timesync_t *timesync, uint64_t now_us, uint8_t *o_datagram);
+
+/// @brief Handle a datagram received from the server.
+/// @param timesync The client.
+/// @param datagram The datagram.
+/// @param length The length of the datagram, in bytes.
+/// @param now_us The time at which the datagram arrived.
+/// @return JCFW_RESULT_OK if the datagram answered the latest request and was added as a sample,
+/// or an error code otherwise.
+jcfw_result_e jcfw_timesync_on_receive(
+    jcfw_timesync_t *timesync, const uint8_t *datagram, size_t length, uint64_t now_us);
+
+/// @brief Get the best estimate of the offset of the server's clock.
+/// @param timesync The client.
+/// @param o_sample Required; The probe with the shortest delay out of the latest ones.
+/// @return True if there is an estimate, or false if no response has arrived yet.
+bool jcfw_timesync_get_estimate(const jcfw_timesync_t *timesync, jcfw_timesync_sample_t *o_sample);
+
+/// @brief Get the model of the server's clock, compensated for drift.
+/// @param timesync The client.
+/// @param o_model Required; The model.
+/// @return True if there is a model, or false if no response has arrived yet.
+bool jcfw_timesync_get_model(const jcfw_timesync_t *timesync, jcfw_timesync_model_t *o_model);
+
+/// @brief Map a client time onto the server's clock.
+/// @param model The model of the server's clock.
+/// @param local_us The client time.
+/// @return The server time.
+static inline uint64_t
+jcfw_timesync_model_apply(const jcfw_timesync_model_t *model, uint64_t local_us)
+{
+    const int64_t elapsed_us = (int64_t)(local_us - model->local_us);
+    return local_us + model->offset_us + elapsed_us * model->drift_ppb / 1000000000;
+}
+
+/// @brief Get the statistics of a client.
+/// @param timesync The client to check.
+/// @param o_stats Required; The statistics.
+void jcfw_timesync_get_stats(const jcfw_timesync_t *timesync, jcfw_timesync_stats_t *o_stats);
+
+// SERVER ------------------------------------------------------------------------------------------
+
+/// @brief Answer a request from a client.
+/// @param request The datagram received from the client.
+/// @param length The length of the datagram, in bytes.
+/// @param receive_us The time at which the request arrived.
+/// @param transmit_us The time at which the response will be sent; As late as possible.
+/// @param o_response Required; The response (JCFW_TIMESYNC_RESPONSE_SIZE bytes).
+/// @return JCFW_RESULT_OK if the datagram was a request, or an error code otherwise.
+jcfw_result_e jcfw_timesync_respond(
+    const uint8_t *request,
+    size_t         length,
+    uint64_t       receive_us,
+    uint64_t       transmit_us,
+    uint8_t       *o_response);
+
+#endif // __JCFW_NET_TIMESYNC_H__
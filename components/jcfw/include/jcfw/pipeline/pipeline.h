@@ -0,0 +1,263 @@
+#ifndef __JCFW_PIPELINE_PIPELINE_H__
+#define __JCFW_PIPELINE_PIPELINE_H__
+
+#include <stdatomic.h>
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/platform/event.h"
+#include "jcfw/platform/task.h"
+#include "jcfw/util/result.h"
+#include "jcfw/util/spsc.h"
+
+/* Notes:
+ * A pipeline is a chain of stages (sources, filters and sinks) which pass blocks of samples from
+ * one to the next. Each stage runs on its own task, so a slow stage (e.g. a network sink) never
+ * stalls a fast one (e.g. a sensor source); It only fills up its own queue.
+ *
+ * Blocks:
+ * - A block holds up to JCFW_PIPELINE_BLOCK_SIZE bytes of fixed-size samples of one stream.
+ * - Blocks come from pools which are allocated up front (see: jcfw_pipeline_pool_init()). Taking
+ *   a block from a pool and giving it back never blocks and never takes a lock, so either may be
+ *   done from any task or ISR.
+ * - Stages pass blocks by pointer, so samples are never copied between stages. Whichever stage
+ *   holds a block owns it, and must either emit it (see: jcfw_pipeline_emit()) or release it.
+ *
+ * Stages:
+ * - Stages are connected when they are set up, each to at most one next stage. Up to
+ *   JCFW_PIPELINE_INPUT_COUNT_MAX stages may feed the same stage (e.g. two sensors into one
+ *   network sink), so set up a stage before the stages which feed it.
+ * - Each input of a stage is its own lock-free queue of JCFW_PIPELINE_QUEUE_CAPACITY blocks. When
+ *   a queue is full, the emitted block is dropped (and counted) rather than stalling the stage
+ *   which emitted it.
+ * - A stage task sleeps until a block arrives, until it is notified (e.g. by a sensor ISR), or
+ *   until the time which its poll callback asked for. Then it processes every waiting block, and
+ *   polls.
+ * - The callbacks of a stage always run on its task, so a stage needs no locking for its own
+ *   state. jcfw_pipeline_emit() may only be called from them.
+ */
+
+/// @brief The maximum number of blocks in one pool.
+#define JCFW_PIPELINE_POOL_BLOCK_COUNT_MAX 32
+
+typedef struct jcfw_pipeline_pool_s  jcfw_pipeline_pool_t;
+typedef struct jcfw_pipeline_stage_s jcfw_pipeline_stage_t;
+
+typedef struct
+{
+    /// @brief The pool which the block belongs to.
+    jcfw_pipeline_pool_t *pool;
+
+    /// @brief The time of the first sample of the block (see: jcfw_platform_get_time_us()).
+    uint64_t timestamp_us;
+
+    /// @brief The time at which the block was last emitted. Set by jcfw_pipeline_emit().
+    uint64_t emit_us;
+
+    /// @brief Identifies what the samples are, for stages which take more than one stream.
+    uint16_t stream;
+
+    /// @brief The size of each sample, in bytes.
+    uint16_t sample_size;
+
+    /// @brief The number of samples in the block.
+    uint16_t sample_count;
+
+    _Alignas(8) uint8_t data[JCFW_PIPELINE_BLOCK_SIZE];
+} jcfw_pipeline_block_t;
+
+struct jcfw_pipeline_pool_s
+{
+    jcfw_pipeline_block_t *blocks;
+    uint32_t               block_count;
+
+    /// @brief Bit i is set while blocks[i] is free.
+    _Atomic uint32_t free_mask;
+
+    /// @brief The number of times that a block was wanted while every block was in use.
+    _Atomic uint32_t exhausted_count;
+};
+
+/// @brief Handle the next block at the input of a stage.
+/// @param stage The stage.
+/// @param block The block. The stage now owns it, and must emit or release it.
+/// @param arg The argument given in the configuration of the stage.
+typedef void (*jcfw_pipeline_process_f)(
+    jcfw_pipeline_stage_t *stage, jcfw_pipeline_block_t *block, void *arg);
+
+/// @brief Do the work of a stage which isn't driven by blocks arriving (e.g. reading a sensor, or
+/// flushing a batch which has grown too old).
+/// @param stage The stage.
+/// @param now_us The current time.
+/// @param arg The argument given in the configuration of the stage.
+/// @return The longest time to wait before polling again, in ms, or JCFW_EVENT_WAIT_FOREVER to
+/// only poll once blocks arrive or the stage is notified.
+typedef uint32_t (*jcfw_pipeline_poll_f)(jcfw_pipeline_stage_t *stage, uint64_t now_us, void *arg);
+
+typedef struct
+{
+    /// @brief The task which the stage runs on. The name of the task names the stage.
+    jcfw_task_config_t task;
+
+    /// @brief Called for every block which arrives. Required if any stage feeds this one.
+    jcfw_pipeline_process_f process_cb;
+
+    /// @brief Called whenever the stage wakes, after the blocks which arrived are processed.
+    /// Optional.
+    jcfw_pipeline_poll_f poll_cb;
+
+    void *cb_arg;
+
+    /// @brief The stage which this one emits blocks to, or NULL to release them.
+    jcfw_pipeline_stage_t *next;
+} jcfw_pipeline_stage_config_t;
+
+typedef struct
+{
+    /// @brief The number of blocks (and samples in them) processed.
+    uint32_t block_count;
+    uint32_t sample_count;
+
+    /// @brief The number of blocks emitted to the next stage, and those dropped because its
+    /// queue was full.
+    uint32_t emit_count;
+    uint32_t emit_drop_count;
+
+    /// @brief The number of blocks dropped at the inputs of this stage because it fell behind.
+    uint32_t drop_count;
+
+    /// @brief The number of blocks waiting at the inputs of this stage, and the most which have
+    /// ever waited at any one input.
+    uint32_t queue_depth;
+    uint32_t queue_high_water;
+
+    /// @brief The time which blocks spent waiting at the inputs of this stage.
+    uint32_t queue_latency_max_us;
+    uint64_t queue_latency_total_us;
+
+    /// @brief The number of times the stage woke, and the time spent in its callbacks.
+    uint32_t wake_count;
+    uint64_t busy_us;
+} jcfw_pipeline_stage_stats_t;
+
+struct jcfw_pipeline_stage_s
+{
+    jcfw_pipeline_stage_config_t config;
+    jcfw_event_t                *event;
+
+    /// @brief The input of the next stage which this stage feeds.
+    jcfw_spsc_t *next_input;
+
+    jcfw_spsc_t            inputs[JCFW_PIPELINE_INPUT_COUNT_MAX];
+    jcfw_pipeline_block_t *input_buffers[JCFW_PIPELINE_INPUT_COUNT_MAX]
+                                        [JCFW_PIPELINE_QUEUE_CAPACITY];
+    uint32_t               input_count;
+
+    /// @brief Odd while the stage task is updating `stats`.
+    _Atomic uint32_t            stats_seq;
+    jcfw_pipeline_stage_stats_t stats;
+};
+
+// POOL --------------------------------------------------------------------------------------------
+
+/// @brief Set up a pool of blocks.
+/// @param pool The pool to set up.
+/// @param blocks The blocks of the pool.
+/// @param block_count The number of blocks, at most JCFW_PIPELINE_POOL_BLOCK_COUNT_MAX.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_pipeline_pool_init(
+    jcfw_pipeline_pool_t *pool, jcfw_pipeline_block_t *blocks, uint32_t block_count);
+
+/// @brief Take a free block from a pool.
+/// @param pool The pool to take from.
+/// @param stream The stream of the block.
+/// @param sample_size The size of each sample of the block, in bytes.
+/// @param timestamp_us The time of the first sample of the block.
+/// @return The block (with no samples), or NULL if every block of the pool is in use.
+jcfw_pipeline_block_t *jcfw_pipeline_block_acquire(
+    jcfw_pipeline_pool_t *pool, uint16_t stream, uint16_t sample_size, uint64_t timestamp_us);
+
+/// @brief Give a block back to its pool.
+/// @param block The block to release.
+void jcfw_pipeline_block_release(jcfw_pipeline_block_t *block);
+
+/// @brief Get the number of free blocks of a pool.
+/// @param pool The pool to check.
+/// @return The number of free blocks.
+static inline uint32_t jcfw_pipeline_pool_get_free_count(jcfw_pipeline_pool_t *pool)
+{
+    return __builtin_popcount(atomic_load_explicit(&pool->free_mask, memory_order_relaxed));
+}
+
+/// @brief Get the address of a sample of a block.
+/// @param block The block.
+/// @param index The index of the sample.
+/// @return The sample.
+static inline void *jcfw_pipeline_block_get_sample(jcfw_pipeline_block_t *block, uint16_t index)
+{
+    return &block->data[(size_t)index * block->sample_size];
+}
+
+/// @brief Copy a sample onto the end of a block.
+/// @param block The block to add to.
+/// @param sample The sample (`sample_size` bytes).
+/// @return JCFW_RESULT_OK if the sample was added, or JCFW_RESULT_FULL if the block has no room.
+static inline jcfw_result_e
+jcfw_pipeline_block_append(jcfw_pipeline_block_t *block, const void *sample)
+{
+    const size_t offset = (size_t)block->sample_count * block->sample_size;
+    if (offset + block->sample_size > sizeof(block->data))
+    {
+        return JCFW_RESULT_FULL;
+    }
+
+    memcpy(&block->data[offset], sample, block->sample_size);
+    block->sample_count++;
+    return JCFW_RESULT_OK;
+}
+
+// STAGE -------------------------------------------------------------------------------------------
+
+/// @brief Set up a stage, and connect it to the next one. The stage doesn't run until started.
+/// @param stage The stage to set up.
+/// @param config Required; The configuration of the stage.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_pipeline_stage_init(jcfw_pipeline_stage_t *stage, const jcfw_pipeline_stage_config_t *config);
+
+/// @brief Start the task of a stage. It polls once straight away.
+/// @param stage The stage to start.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_pipeline_stage_start(jcfw_pipeline_stage_t *stage);
+
+/// @brief Pass a block to the next stage. Only call this from the callbacks of `stage`.
+/// @param stage The stage which owns the block.
+/// @param block The block. The stage no longer owns it, even if this fails.
+/// @return JCFW_RESULT_OK if the block was emitted (or released, when there is no next stage),
+/// JCFW_RESULT_FULL if the next stage's queue was full and the block was dropped, or an error
+/// code otherwise.
+jcfw_result_e jcfw_pipeline_emit(jcfw_pipeline_stage_t *stage, jcfw_pipeline_block_t *block);
+
+/// @brief Wake a stage so that it polls, from a task.
+/// @param stage The stage to wake.
+void jcfw_pipeline_stage_notify(jcfw_pipeline_stage_t *stage);
+
+/// @brief Wake a stage so that it polls, from an ISR.
+/// @param stage The stage to wake.
+void jcfw_pipeline_stage_notify_from_isr(jcfw_pipeline_stage_t *stage);
+
+/// @brief Get a snapshot of the statistics of a stage. Safe to call from any task.
+/// @param stage The stage to check.
+/// @param o_stats Required; The statistics.
+void jcfw_pipeline_stage_get_stats(
+    jcfw_pipeline_stage_t *stage, jcfw_pipeline_stage_stats_t *o_stats);
+
+/// @brief Get the name of a stage.
+/// @param stage The stage.
+/// @return The name of the task of the stage.
+static inline const char *jcfw_pipeline_stage_get_name(const jcfw_pipeline_stage_t *stage)
+{
+    return stage->config.task.name;
+}
+
+#endif // __JCFW_PIPELINE_PIPELINE_H__
@@ -0,0 +1,49 @@
+#ifndef __JCFW_PLATFORM_EVENT_H__
+#define __JCFW_PLATFORM_EVENT_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A set of 32 event bits which one task waits on, and which any task or ISR may signal. Waiting
+ * blocks the task until a bit is signalled, so it wakes within microseconds of the signal rather
+ * than on its next poll, and doesn't wake at all otherwise.
+ *
+ * - Signals are latched: bits signalled while the task isn't waiting are returned by its next
+ *   wait. Signalling a bit which is already set has no further effect.
+ * - Each event has exactly one waiter; The first task to wait on an event becomes its waiter.
+ * - The bits carry no data. Pair them with a queue (e.g. jcfw/util/spsc.h) to pass data along.
+ *
+ * On FreeRTOS, the waiter sleeps on its task notification, which is the cheapest way to wake a
+ * task from an ISR. The waiting task shouldn't use its task notification for anything else. On
+ * host builds, events are a condition variable, and there are no ISRs (signalling "from an ISR" is
+ * the same as from a task).
+ */
+
+/// @brief Wait without a timeout.
+#define JCFW_EVENT_WAIT_FOREVER UINT32_MAX
+
+typedef struct jcfw_event_s jcfw_event_t;
+
+/// @brief Create an event, with no bits set.
+/// @param o_event Required; The new event.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_event_create(jcfw_event_t **o_event);
+
+/// @brief Signal bits of an event from a task.
+/// @param event The event to signal.
+/// @param bits The bits to set.
+void jcfw_event_signal(jcfw_event_t *event, uint32_t bits);
+
+/// @brief Signal bits of an event from an ISR.
+/// @param event The event to signal.
+/// @param bits The bits to set.
+void jcfw_event_signal_from_isr(jcfw_event_t *event, uint32_t bits);
+
+/// @brief Wait for bits of an event to be signalled, then clear them.
+/// @param event The event to wait on.
+/// @param timeout_ms The longest time to wait for, or JCFW_EVENT_WAIT_FOREVER.
+/// @return The bits which were signalled, or 0 if the wait timed out.
+uint32_t jcfw_event_wait(jcfw_event_t *event, uint32_t timeout_ms);
+
+#endif // __JCFW_PLATFORM_EVENT_H__
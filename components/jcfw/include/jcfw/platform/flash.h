@@ -0,0 +1,68 @@
+#ifndef __JCFW_PLATFORM_FLASH_H__
+#define __JCFW_PLATFORM_FLASH_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A named region of NOR flash, with NOR flash semantics:
+ * - Erasing works on whole sectors, and sets every bit of them to 1.
+ * - Writing can only clear bits; Writing a 1 over a 0 leaves the 0. So a byte can be written
+ *   again only to clear more of its bits (e.g. to mark a record as used).
+ *
+ * On the ESP32, a region is a data partition of the given label (see: partitions.csv). On host
+ * builds, it is a file of the given path, which is created erased (JCFW_FLASH_POSIX_REGION_SIZE
+ * bytes) if it doesn't exist, and which can simulate losing power (see:
+ * jcfw/platform/posix/flash.h).
+ *
+ * Regions are not thread safe.
+ */
+
+typedef struct
+{
+    /// @brief The size of the region, in bytes; A multiple of `sector_size`.
+    size_t size;
+
+    /// @brief The size of the erase unit, in bytes.
+    size_t sector_size;
+
+    /// @brief Platform specific.
+    void *handle;
+} jcfw_flash_region_t;
+
+/// @brief Open a region of flash.
+/// @param region The region to open.
+/// @param name The name of the region (the partition label, or the path of the file).
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_flash_open(jcfw_flash_region_t *region, const char *name);
+
+/// @brief Close a region of flash.
+/// @param region The region to close.
+void jcfw_flash_close(jcfw_flash_region_t *region);
+
+/// @brief Read from a region of flash.
+/// @param region The region to read from.
+/// @param offset The offset to read from, in bytes.
+/// @param o_data Required; The data read.
+/// @param size The number of bytes to read.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_flash_read(const jcfw_flash_region_t *region, size_t offset, void *o_data, size_t size);
+
+/// @brief Write to a region of flash (clearing bits only).
+/// @param region The region to write to.
+/// @param offset The offset to write to, in bytes.
+/// @param data The data to write.
+/// @param size The number of bytes to write.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_flash_write(const jcfw_flash_region_t *region, size_t offset, const void *data, size_t size);
+
+/// @brief Erase sectors of a region of flash.
+/// @param region The region to erase.
+/// @param offset The offset of the first sector, in bytes; A multiple of `sector_size`.
+/// @param size The number of bytes to erase; A multiple of `sector_size`.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_flash_erase(const jcfw_flash_region_t *region, size_t offset, size_t size);
+
+#endif // __JCFW_PLATFORM_FLASH_H__
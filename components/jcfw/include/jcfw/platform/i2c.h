@@ -0,0 +1,239 @@
+#ifndef __JCFW_PLATFORM_I2C_H__
+#define __JCFW_PLATFORM_I2C_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * Each bus is owned by the I2C layer and has its own worker task, which is the only thing that
+ * touches the bus. Devices are registered on a bus with a priority, and any number of tasks may
+ * queue transactions for them.
+ *
+ * Transactions are described by caller-owned descriptors which are queued (without copying). The
+ * descriptor and the buffers it points to must stay valid until the completion callback runs.
+ *
+ * Scheduling:
+ * - Transactions for the same device always execute in submission order.
+ * - Across devices, the device with the highest priority goes first. Between devices of equal
+ *   priority, the transaction with the earliest deadline goes first, and transactions without a
+ *   deadline go last (in submission order).
+ * - If a device allows it, back-to-back writes to adjacent registers are merged into a single bus
+ *   transaction (up to JCFW_I2C_MERGE_SIZE_MAX bytes of data). This relies on the device
+ *   auto-incrementing its register address.
+ *
+ * Writes may gather their data from a list of segments instead of a single buffer, so a block of
+ * registers can be written straight out of the caller's own structures. The segments are copied
+ * into a bounded buffer (JCFW_I2C_WRITE_COPY_SIZE_MAX bytes, including the "memory address") on
+ * the way to the bus.
+ *
+ * The blocking jcfw_platform_i2c_mstr_mem_read() and jcfw_platform_i2c_mstr_mem_write() functions
+ * (see: jcfw/platform/platform.h) are implemented on top of this API, and take a
+ * `jcfw_i2c_device_t *` as their argument. They wait at most JCFW_I2C_QUEUE_TIMEOUT_MS for the
+ * transaction to reach the bus (on top of its own timeout), and return JCFW_RESULT_TIMEOUT if it
+ * does not; With JCFW_I2C_WAIT_FOREVER, they wait for as long as it takes.
+ */
+
+/// @brief A bus operation timeout which never expires.
+#define JCFW_I2C_WAIT_FOREVER UINT32_MAX
+
+typedef enum
+{
+    JCFW_I2C_XFER_TYPE_READ = 0,
+    JCFW_I2C_XFER_TYPE_WRITE,
+} jcfw_i2c_xfer_type_e;
+
+typedef enum
+{
+    JCFW_I2C_XFER_STATE_IDLE = 0,
+    JCFW_I2C_XFER_STATE_QUEUED,
+    JCFW_I2C_XFER_STATE_ACTIVE,
+    JCFW_I2C_XFER_STATE_DONE,
+} jcfw_i2c_xfer_state_e;
+
+typedef struct jcfw_i2c_bus_s    jcfw_i2c_bus_t;
+typedef struct jcfw_i2c_device_s jcfw_i2c_device_t;
+typedef struct jcfw_i2c_xfer_s   jcfw_i2c_xfer_t;
+
+/// @brief A function called when a transaction completes.
+/// @note This function is called from the worker task of the bus. It must not block, and must not
+/// call the blocking I2C functions.
+/// @param xfer The transaction which completed. It is already marked as done, so an owner polling
+/// jcfw_platform_i2c_is_done() may have reused it; Only use it to identify the transaction.
+/// @param result The result of the transaction.
+/// @param arg The callback argument from the transaction descriptor.
+typedef void (*jcfw_i2c_xfer_cb_f)(jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg);
+
+/// @brief A piece of the data of a scatter-gather write.
+typedef struct
+{
+    const uint8_t *data;
+    size_t         size;
+} jcfw_i2c_segment_t;
+
+/// @brief Per-device bus statistics.
+typedef struct
+{
+    /// @brief The number of bus transactions executed (merged writes count once).
+    uint32_t transaction_count;
+
+    /// @brief The number of submitted writes which were merged into another transaction.
+    uint32_t merged_count;
+
+    /// @brief The number of bus transactions which failed.
+    uint32_t failure_count;
+
+    /// @brief The number of bytes moved, including the "memory address".
+    uint64_t byte_count;
+
+    /// @brief The time spent on the bus, in microseconds.
+    uint64_t busy_us;
+} jcfw_i2c_device_stats_t;
+
+/// @brief A device on a managed bus.
+struct jcfw_i2c_device_s
+{
+    /// @brief The platform device handle (`i2c_master_dev_handle_t` on ESP32,
+    /// `jcfw_posix_i2c_device_t *` on POSIX).
+    void *handle;
+
+    /// @brief The bus that the device is on.
+    jcfw_i2c_bus_t *bus;
+
+    /// @brief The scheduling priority of the device. Higher goes first.
+    uint8_t priority;
+
+    /// @brief Whether back-to-back writes to adjacent registers may be merged. Only enable this for
+    /// devices which auto-increment their register address on multi-byte writes.
+    bool is_write_merge_enabled;
+
+    /// @brief Owned by the I2C layer; Use jcfw_platform_i2c_device_get_stats().
+    jcfw_i2c_device_stats_t _stats;
+
+    /// @brief Owned by the I2C layer.
+    jcfw_i2c_device_t *_next;
+};
+
+/// @brief An I2C "memory" transaction descriptor.
+struct jcfw_i2c_xfer_s
+{
+    /// @brief The device to address.
+    jcfw_i2c_device_t *device;
+
+    /// @brief Whether this is a read or a write.
+    jcfw_i2c_xfer_type_e type;
+
+    /// @brief The "memory address" to read from or write to.
+    const uint8_t *mem_addr;
+
+    /// @brief The size of the "memory address".
+    size_t mem_addr_size;
+
+    /// @brief Read transactions; The buffer to read into.
+    uint8_t *o_data;
+
+    /// @brief Write transactions; The data to write.
+    const uint8_t *data;
+
+    /// @brief Optional, write transactions; The data to write as a list of segments, which is used
+    /// instead of `data`.
+    const jcfw_i2c_segment_t *segments;
+
+    /// @brief The number of segments (at most JCFW_I2C_SEGMENT_COUNT_MAX).
+    size_t segment_count;
+
+    /// @brief The size of the data to read or write. Set by the I2C layer when `segments` is used.
+    size_t data_size;
+
+    /// @brief The maximum timeout of the bus operation itself (not including queueing), or
+    /// JCFW_I2C_WAIT_FOREVER.
+    uint32_t timeout_ms;
+
+    /// @brief Optional; The time (see: jcfw_platform_get_time_us()) by which the transaction should
+    /// start. 0 for no deadline. Only used to order transactions; Late transactions still run.
+    uint64_t deadline_us;
+
+    /// @brief Optional; The function to call when the transaction completes.
+    jcfw_i2c_xfer_cb_f callback;
+
+    /// @brief Optional; The argument to pass to the callback.
+    void *callback_arg;
+
+    /// @brief The result of the transaction. JCFW_RESULT_IN_PROGRESS until the transaction
+    /// completes. Owned by the I2C layer.
+    volatile jcfw_result_e result;
+
+    /// @brief The state of the transaction. Owned by the I2C layer.
+    volatile jcfw_i2c_xfer_state_e state;
+
+    /// @brief Owned by the I2C layer.
+    jcfw_i2c_xfer_t *_next;
+};
+
+/// @brief Take ownership of a bus and start its worker task.
+/// @param handle The platform bus handle (`i2c_master_bus_handle_t` on ESP32, unused on POSIX).
+/// @param o_bus Required; The managed bus.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_FULL if
+/// JCFW_I2C_BUS_COUNT_MAX buses are already managed, or an error code otherwise.
+jcfw_result_e jcfw_platform_i2c_bus_create(void *handle, jcfw_i2c_bus_t **o_bus);
+
+/// @brief Register a device on a managed bus.
+/// @param dev The device to register. Must stay valid for as long as the bus is in use.
+/// @param bus The bus that the device is on.
+/// @param handle The platform device handle. (see: jcfw_i2c_device_t)
+/// @param priority The scheduling priority of the device. Higher goes first.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_platform_i2c_device_init(
+    jcfw_i2c_device_t *dev, jcfw_i2c_bus_t *bus, void *handle, uint8_t priority);
+
+/// @brief Get a consistent snapshot of the bus statistics of a device.
+/// @param dev The device to get the statistics of.
+/// @param o_stats Required; The statistics.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_platform_i2c_device_get_stats(jcfw_i2c_device_t *dev, jcfw_i2c_device_stats_t *o_stats);
+
+/// @brief Reset the bus statistics of a device.
+/// @param dev The device to reset the statistics of.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_platform_i2c_device_reset_stats(jcfw_i2c_device_t *dev);
+
+/// @brief Queue a transaction to be executed asynchronously. (see: Scheduling)
+/// @param xfer The transaction to queue. The I2C layer owns the descriptor until the transaction
+/// completes.
+/// @return JCFW_RESULT_OK if the transaction was queued, JCFW_RESULT_FULL if
+/// JCFW_I2C_QUEUE_DEPTH transactions are already pending on the bus, or an error code otherwise.
+jcfw_result_e jcfw_platform_i2c_submit(jcfw_i2c_xfer_t *xfer);
+
+/// @brief Perform a blocking scatter-gather I2C master write to a "memory address". The segments
+/// are written back to back, in order, after the "memory address".
+/// @param arg The device to write to (a `jcfw_i2c_device_t *`).
+/// @param mem_addr The "memory address" to write to the device at.
+/// @param mem_addr_size The size of the "memory address".
+/// @param segments The data to write.
+/// @param segment_count The number of segments (at most JCFW_I2C_SEGMENT_COUNT_MAX).
+/// @param timeout_ms The maximum timeout of the I2C operation.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_platform_i2c_mstr_mem_writev(
+    void                     *arg,
+    const uint8_t            *mem_addr,
+    size_t                    mem_addr_size,
+    const jcfw_i2c_segment_t *segments,
+    size_t                    segment_count,
+    uint32_t                  timeout_ms);
+
+/// @brief Remove a transaction from the queue if it has not started yet.
+/// @param xfer The transaction to cancel.
+/// @return JCFW_RESULT_OK if the transaction was removed (its callback will not be called),
+/// JCFW_RESULT_IN_PROGRESS if it is already on the bus, or JCFW_RESULT_INVALID_ARGS if it is not
+/// queued.
+jcfw_result_e jcfw_platform_i2c_cancel(jcfw_i2c_xfer_t *xfer);
+
+/// @brief Return true if the transaction has completed, and false otherwise.
+/// @param xfer The transaction to check.
+/// @return True if the transaction has completed, and false otherwise.
+static inline bool jcfw_platform_i2c_is_done(const jcfw_i2c_xfer_t *xfer)
+{
+    return xfer->state == JCFW_I2C_XFER_STATE_DONE;
+}
+
+#endif // __JCFW_PLATFORM_I2C_H__
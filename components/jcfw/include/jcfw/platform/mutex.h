@@ -0,0 +1,31 @@
+#ifndef __JCFW_PLATFORM_MUTEX_H__
+#define __JCFW_PLATFORM_MUTEX_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A lock which tasks (never ISRs) hold for short stretches, e.g. around a queue which more than
+ * one task fills.
+ *
+ * On FreeRTOS, a mutex inherits the priority of the tasks waiting on it, so a low priority holder
+ * can't keep a high priority waiter out for long. On host builds, a mutex is a pthread mutex.
+ * Mutexes aren't recursive.
+ */
+
+typedef struct jcfw_mutex_s jcfw_mutex_t;
+
+/// @brief Create a mutex, unlocked.
+/// @param o_mutex Required; The new mutex.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_mutex_create(jcfw_mutex_t **o_mutex);
+
+/// @brief Lock a mutex, waiting for as long as another task holds it.
+/// @param mutex The mutex to lock.
+void jcfw_mutex_lock(jcfw_mutex_t *mutex);
+
+/// @brief Unlock a mutex held by the calling task.
+/// @param mutex The mutex to unlock.
+void jcfw_mutex_unlock(jcfw_mutex_t *mutex);
+
+#endif // __JCFW_PLATFORM_MUTEX_H__
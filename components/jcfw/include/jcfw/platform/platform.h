@@ -36,8 +36,14 @@ bool jcfw_platform_trace_validate(const char *tag);
 /// @param delay_ms The amount of time to block for.
 void jcfw_platform_delay_ms(uint32_t delay_ms);
 
+/// @brief Get a monotonic timestamp in microseconds.
+/// @return The time since an arbitrary (but fixed) point, in microseconds.
+uint64_t jcfw_platform_get_time_us(void);
+
 /// @brief Perform an I2C master read from a "memory address" using the given argument.
-/// @param arg The argument to use for the read. Use this for platform-dependent arguments.
+/// @note Provided by the jcfw I2C backend; Blocks until the transaction has been executed by the
+/// worker task of the bus. (see: jcfw/platform/i2c.h)
+/// @param arg The device to read from (a `jcfw_i2c_device_t *`).
 /// @param mem_addr The "memory address" to read from the device at.
 /// @param mem_addr_size The size of the "memory address".
 /// @param o_data Required. The data returned by the read.
@@ -54,7 +60,9 @@ jcfw_result_e jcfw_platform_i2c_mstr_mem_read(
     uint32_t       timeout_ms);
 
 /// @brief Perform an I2C master write from a "memory address" using the given argument.
-/// @param arg The argument to use for the write. Use this for platform-dependent arguments.
+/// @note Provided by the jcfw I2C backend; Blocks until the transaction has been executed by the
+/// worker task of the bus. (see: jcfw/platform/i2c.h)
+/// @param arg The device to write to (a `jcfw_i2c_device_t *`).
 /// @param mem_addr The "memory address" to write to the device at.
 /// @param mem_addr_size The size of the "memory address".
 /// @param data The data to write to the "memory address".
@@ -0,0 +1,23 @@
+#ifndef __JCFW_PLATFORM_POSIX_FLASH_H__
+#define __JCFW_PLATFORM_POSIX_FLASH_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/platform/flash.h"
+
+/* Notes:
+ * On host builds, a flash region is a file. Writes AND the new data into the file, so a region
+ * behaves like NOR flash, and the file survives the process for replay after a "reboot".
+ *
+ * To test crash consistency, a region can be given a budget of bytes which may still be written or
+ * erased before the power "goes out". The operation which runs out of budget is torn part way
+ * through (as on a real device), and it and every operation after it fail with JCFW_RESULT_ERROR
+ * until the region is reopened.
+ */
+
+/// @brief Simulate losing power after some number of bytes have been written or erased.
+/// @param region The region to set the budget of.
+/// @param byte_count The number of bytes which may still be written or erased, or SIZE_MAX for no
+/// limit.
+void jcfw_posix_flash_set_power_budget(jcfw_flash_region_t *region, size_t byte_count);
+
+#endif // __JCFW_PLATFORM_POSIX_FLASH_H__
@@ -0,0 +1,68 @@
+#ifndef __JCFW_PLATFORM_POSIX_I2C_H__
+#define __JCFW_PLATFORM_POSIX_I2C_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * On host builds there is no I2C bus. Instead, the `arg` passed to the jcfw I2C functions is a
+ * pointer to a `jcfw_posix_i2c_device_t`, which routes transactions to a simulated device. The
+ * worker task sleeps for the time the transaction would have occupied a real bus, so that
+ * pipelining and overlap can be observed on the host.
+ */
+
+/// @brief Handle a "memory" read on a simulated device.
+/// @param ctx The context of the simulated device.
+/// @param mem_addr The "memory address" to read from.
+/// @param mem_addr_size The size of the "memory address".
+/// @param o_data The buffer to read into.
+/// @param data_size The number of bytes to read.
+/// @return JCFW_RESULT_OK if the device acknowledged the transaction, or an error code otherwise.
+typedef jcfw_result_e (*jcfw_posix_i2c_read_f)(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size);
+
+/// @brief Handle a "memory" write on a simulated device.
+/// @param ctx The context of the simulated device.
+/// @param mem_addr The "memory address" to write to.
+/// @param mem_addr_size The size of the "memory address".
+/// @param data The data written.
+/// @param data_size The number of bytes written.
+/// @return JCFW_RESULT_OK if the device acknowledged the transaction, or an error code otherwise.
+typedef jcfw_result_e (*jcfw_posix_i2c_write_f)(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size);
+
+/// @brief A simulated I2C device.
+typedef struct
+{
+    /// @brief Required; The read handler of the device.
+    jcfw_posix_i2c_read_f read;
+
+    /// @brief Required; The write handler of the device.
+    jcfw_posix_i2c_write_f write;
+
+    /// @brief Optional; The context to pass to the handlers.
+    void *ctx;
+
+    /// @brief The simulated SCL frequency. Defaults to 100kHz if 0.
+    uint32_t scl_speed_hz;
+} jcfw_posix_i2c_device_t;
+
+/// @brief Set the factor by which simulated bus time is scaled. 0 disables the simulated latency
+/// altogether; values below 100 run the simulation faster than real time.
+/// @param percent The scale factor, as a percentage of real time. Defaults to 100.
+void jcfw_posix_i2c_set_time_scale(uint32_t percent);
+
+/// @brief Get the time that a transaction would occupy a real bus, in microseconds.
+/// @param dev The device that the transaction is addressed to.
+/// @param is_read Whether the transaction is a read (which includes a repeated start).
+/// @param mem_addr_size The size of the "memory address".
+/// @param data_size The size of the data read or written.
+/// @return The bus time of the transaction, in microseconds.
+uint32_t jcfw_posix_i2c_bus_time_us(
+    const jcfw_posix_i2c_device_t *dev, bool is_read, size_t mem_addr_size, size_t data_size);
+
+#endif // __JCFW_PLATFORM_POSIX_I2C_H__
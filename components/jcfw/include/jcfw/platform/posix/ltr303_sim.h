@@ -0,0 +1,165 @@
+#ifndef __JCFW_PLATFORM_POSIX_LTR303_SIM_H__
+#define __JCFW_PLATFORM_POSIX_LTR303_SIM_H__
+
+#include <pthread.h>
+
+#include "jcfw/detail/common.h"
+#include "jcfw/platform/posix/i2c.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A simulated LTR303 for host builds. It sits behind a `jcfw_posix_i2c_device_t`, so the real
+ * driver (jcfw/driver/als/ltr303.h) talks to it through the normal jcfw_platform_i2c_* API.
+ *
+ * Modelled:
+ * - The register file, including reset values, read-only registers, the self-clearing soft reset,
+ *   and register address auto-increment.
+ * - Conversion timing. Once active (after the wake up time), a conversion completes every
+ *   max(measurement rate, integration time), and each conversion integrates the light level over
+ *   its integration time.
+ * - Gain and integration time scaling, and saturation at 0xFFFF counts (which also marks the data
+ *   as invalid in ALS_STATUS).
+ * - The threshold and persistence interrupt logic, ALS_STATUS new data/interrupt flags (cleared by
+ *   reading the data and status registers, respectively), and the INT line with its polarity.
+ *
+ * The light level comes from a trace of samples which is linearly interpolated. At gain 1x and a
+ * 100ms integration time, one lux is one count on channel 0 (see the gain ranges in ltr303.h).
+ *
+ * The simulation runs lazily: its state is brought up to date whenever the device is accessed, or
+ * when jcfw_posix_ltr303_sim_update() is called. Time comes from `get_time_us` (see:
+ * jcfw_posix_ltr303_sim_config_t), so a test can drive a virtual clock and run much faster than
+ * real time (pair with jcfw_posix_i2c_set_time_scale(0)).
+ */
+
+/// @brief One point of a light level trace.
+typedef struct
+{
+    /// @brief The time of the sample, relative to the start of the trace.
+    uint64_t time_us;
+
+    /// @brief The total (visible + IR) light level.
+    float lux;
+
+    /// @brief The fraction of the light which is IR (channel 1 / channel 0). Range 0.0 - 1.0.
+    float ir_ratio;
+} jcfw_posix_ltr303_sim_sample_t;
+
+/// @brief Returns the current simulation time in microseconds.
+typedef uint64_t (*jcfw_posix_ltr303_sim_clock_f)(void *ctx);
+
+/// @brief The configuration of a simulated LTR303.
+typedef struct
+{
+    /// @brief Required; The light level trace, in ascending time order.
+    const jcfw_posix_ltr303_sim_sample_t *trace;
+    size_t                                trace_len;
+
+    /// @brief Whether the trace repeats once it ends. Otherwise, the last sample is held.
+    bool is_trace_looped;
+
+    /// @brief Optional; The clock of the simulation. Defaults to jcfw_platform_get_time_us().
+    jcfw_posix_ltr303_sim_clock_f get_time_us;
+    void                         *clock_ctx;
+
+    /// @brief The simulated SCL frequency. Defaults to 100kHz if 0.
+    uint32_t scl_speed_hz;
+} jcfw_posix_ltr303_sim_config_t;
+
+/// @brief Statistics of a simulated LTR303.
+typedef struct
+{
+    /// @brief The number of conversions completed.
+    uint32_t conversion_count;
+
+    /// @brief The number of conversions which were overwritten before being read.
+    uint32_t missed_count;
+
+    /// @brief The number of conversions which saturated.
+    uint32_t saturated_count;
+
+    /// @brief The number of interrupts raised.
+    uint32_t interrupt_count;
+
+    /// @brief The number of reads and writes addressed to the device.
+    uint32_t read_count;
+    uint32_t write_count;
+
+    /// @brief The time from the end of a conversion to the first read of its data, over every
+    /// conversion which was read.
+    uint64_t latency_total_us;
+    uint32_t latency_max_us;
+    uint32_t latency_count;
+} jcfw_posix_ltr303_sim_stats_t;
+
+/// @brief A simulated LTR303. All fields are private; Use the functions below.
+typedef struct
+{
+    jcfw_posix_i2c_device_t        device;
+    jcfw_posix_ltr303_sim_config_t cfg;
+    pthread_mutex_t                lock;
+
+    uint8_t regs[0x20];
+    uint8_t persist_count;
+
+    uint64_t start_us;
+    uint64_t now_us;
+    uint64_t next_conversion_us;
+    uint64_t last_conversion_us;
+    bool     is_active;
+    bool     is_data_read;
+
+    jcfw_posix_ltr303_sim_stats_t stats;
+} jcfw_posix_ltr303_sim_t;
+
+/// @brief Set up a simulated LTR303 in its power on state (standby).
+/// @param sim The simulated device to set up.
+/// @param cfg Required; The configuration of the simulated device. Copied.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_posix_ltr303_sim_init(jcfw_posix_ltr303_sim_t *sim, const jcfw_posix_ltr303_sim_config_t *cfg);
+
+/// @brief Release the resources of a simulated LTR303.
+/// @param sim The simulated device to release.
+void jcfw_posix_ltr303_sim_deinit(jcfw_posix_ltr303_sim_t *sim);
+
+/// @brief Get the simulated I2C device to register on a bus (see: jcfw_platform_i2c_device_init()).
+/// @param sim The simulated LTR303.
+/// @return The simulated I2C device.
+jcfw_posix_i2c_device_t *jcfw_posix_ltr303_sim_get_device(jcfw_posix_ltr303_sim_t *sim);
+
+/// @brief Bring the simulation up to the current time. Call this after advancing a virtual clock to
+/// observe conversions and interrupts without accessing the device.
+/// @param sim The simulated LTR303.
+void jcfw_posix_ltr303_sim_update(jcfw_posix_ltr303_sim_t *sim);
+
+/// @brief Get the electrical level of the INT line (true for high).
+/// @param sim The simulated LTR303.
+/// @return The level of the INT line.
+bool jcfw_posix_ltr303_sim_get_int_level(jcfw_posix_ltr303_sim_t *sim);
+
+/// @brief Get the time at which the next conversion completes.
+/// @param sim The simulated LTR303.
+/// @return The completion time of the next conversion, or UINT64_MAX if the device is in standby.
+uint64_t jcfw_posix_ltr303_sim_get_next_conversion_us(jcfw_posix_ltr303_sim_t *sim);
+
+/// @brief Get a snapshot of the statistics of a simulated LTR303.
+/// @param sim The simulated LTR303.
+/// @param o_stats Required; The statistics.
+void jcfw_posix_ltr303_sim_get_stats(
+    jcfw_posix_ltr303_sim_t *sim, jcfw_posix_ltr303_sim_stats_t *o_stats);
+
+/// @brief Load a recorded light level trace from a CSV file with one `time_ms,lux[,ir_ratio]`
+/// sample per line. Lines starting with '#' are skipped, and the IR ratio defaults to 0.
+/// @param path The path of the file.
+/// @param o_trace Required; The buffer to load the samples into.
+/// @param capacity The number of samples which fit in the buffer.
+/// @param o_trace_len Required; The number of samples loaded.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_OUT_OF_BOUNDS if the trace
+/// does not fit in the buffer, or an error code otherwise.
+jcfw_result_e jcfw_posix_ltr303_sim_load_trace(
+    const char                     *path,
+    jcfw_posix_ltr303_sim_sample_t *o_trace,
+    size_t                          capacity,
+    size_t                         *o_trace_len);
+
+#endif // __JCFW_PLATFORM_POSIX_LTR303_SIM_H__
@@ -0,0 +1,43 @@
+#ifndef __JCFW_PLATFORM_TASK_H__
+#define __JCFW_PLATFORM_TASK_H__
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * Tasks run forever; A task function must never return.
+ *
+ * On FreeRTOS, a task can be pinned to one core. On host builds, tasks are threads, and the
+ * priority and core of a task are ignored.
+ */
+
+/// @brief Let the scheduler pick the core which a task runs on.
+#define JCFW_TASK_CORE_ANY (-1)
+
+/// @brief The body of a task.
+/// @param arg The argument passed to jcfw_task_create().
+typedef void (*jcfw_task_f)(void *arg);
+
+typedef struct
+{
+    /// @brief The name of the task, for debugging.
+    const char *name;
+
+    /// @brief The stack size of the task, in bytes.
+    size_t stack_size;
+
+    /// @brief The priority of the task; Higher numbers preempt lower ones.
+    uint32_t priority;
+
+    /// @brief The core which the task runs on, or JCFW_TASK_CORE_ANY.
+    int32_t core;
+} jcfw_task_config_t;
+
+/// @brief Create a task and start running it.
+/// @param config Required; The configuration of the task.
+/// @param task The body of the task.
+/// @param arg The argument to pass to `task`.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_task_create(const jcfw_task_config_t *config, jcfw_task_f task, void *arg);
+
+#endif // __JCFW_PLATFORM_TASK_H__
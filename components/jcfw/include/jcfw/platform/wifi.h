@@ -3,19 +3,90 @@
 
 #include "jcfw/detail/common.h"
 #include "jcfw/util/result.h"
+#include "jcfw/util/sketch.h"
 
 /* Notes:
  * jcfw_wifi_sta_*
  * jcfw_wifi_ap_*
  *
- * Configuration:
- * - retry count
+ * Waiting:
+ * - Initializing, connecting and disconnecting each come in two forms. The *_start() form returns
+ *   JCFW_RESULT_IN_PROGRESS straight away, and calls back once the operation completes; The other
+ *   form waits for it, but only for as long as it is told to (or JCFW_WIFI_WAIT_FOREVER).
+ * - A wait which times out returns JCFW_RESULT_TIMEOUT, but the operation carries on in the
+ *   background; E.g. the manager keeps trying to connect.
+ *
+ * Connection manager:
+ * - The STA connection is owned by a task of its own. jcfw_wifi_sta_connect_start() hands it the
+ *   network to connect to and returns straight away; From then on, the manager keeps the STA
+ *   connected until it is told to disconnect, and nothing else ever has to wait on connectivity.
+ * - Every connection attempt has a timeout (see: JCFW_WIFI_CONNECT_TIMEOUT_MS). A failed attempt
+ *   is retried after a backoff which doubles with each failure in a row, from
+ *   JCFW_WIFI_BACKOFF_MIN_MS up to JCFW_WIFI_BACKOFF_MAX_MS, and is jittered so that devices which
+ *   lost the same access point don't all come back at once.
+ * - A lost connection is retried straight away, first with the access point it was lost from, so
+ *   that it comes back as soon as the access point does (e.g. after it reboots).
+ * - Failures which retrying can't fix (e.g. the network's security isn't supported) stop the
+ *   manager in JCFW_WIFI_STA_STATE_FAILED. So do JCFW_WIFI_AUTH_FAILURE_MAX authentication
+ *   failures in a row, which most likely mean that the password is wrong. Starting again (e.g.
+ *   with other credentials) resets it.
+ * - Subscribers (see: jcfw_wifi_sta_subscribe()) are told about every change of state.
+ *
+ * Scanning:
+ * - A scan runs in the background (see: jcfw_wifi_sta_scan_start()). As it completes, each access
+ *   point it found is merged straight into the scan cache, which is kept sorted by RSSI, strongest
+ *   first.
+ * - The cache remembers when it last saw each access point (by BSSID). Access points which
+ *   haven't been seen for JCFW_WIFI_SCAN_AGE_MAX_MS are dropped from it.
+ * - Any task may read the cache (see: jcfw_wifi_sta_get_scan_cache()) without starting a scan.
+ *
+ * Connecting:
+ * - The access point (BSSID, channel and auth mode) and address of the last successful connection
+ *   are kept in NVS, so they survive a reboot. NVS must be initialized before WIFI.
+ * - A connection to the same SSID first goes straight to that access point, on its one channel,
+ *   for up to JCFW_WIFI_FAST_CONNECT_TIMEOUT_MS. Only if that fails are all channels scanned for
+ *   the strongest access point of the SSID.
+ * - The address comes from DHCP, unless a static one is set (see: jcfw_wifi_sta_set_static_ip()).
+ *   With CONFIG_LWIP_DHCP_RESTORE_LAST_IP, lwIP asks for the last lease again rather than
+ *   discovering a new one; The statistics count the connections which got the same address back.
+ *
+ * Roaming:
+ * - While connected, the manager samples the signal strength of the access point every
+ *   JCFW_WIFI_ROAM_SAMPLE_PERIOD_MS. Once JCFW_WIFI_ROAM_LOW_COUNT_MIN samples in a row are below
+ *   JCFW_WIFI_ROAM_RSSI_MIN_DBM, it scans for the SSID in the background (at most once every
+ *   JCFW_WIFI_ROAM_SCAN_PERIOD_MS), without dropping the connection.
+ * - It roams to the strongest other access point of the SSID which the scan found, but only if
+ *   that one is at least JCFW_WIFI_ROAM_HYSTERESIS_DB stronger, so that the STA doesn't flap
+ *   between two access points which are about as strong.
+ * - A roam goes straight to the new access point, on its one channel, and asks for the same
+ *   address again; Should that fail, the manager falls back to connecting as usual. Subscribers
+ *   see the STA go through JCFW_WIFI_STA_STATE_CONNECTING.
  */
 
 #define JCFW_WIFI_SSID_LEN_MAX      32
 #define JCFW_WIFI_BSSID_LEN         6
 #define JCFW_WIFI_STA_SCAN_SIZE_MAX 32
 
+#define JCFW_WIFI_WAIT_FOREVER      UINT32_MAX
+
+typedef enum
+{
+    /// @brief Not connected, and not trying to be.
+    JCFW_WIFI_STA_STATE_IDLE,
+
+    /// @brief A connection attempt is running.
+    JCFW_WIFI_STA_STATE_CONNECTING,
+
+    /// @brief Connected, with an address.
+    JCFW_WIFI_STA_STATE_CONNECTED,
+
+    /// @brief Waiting to retry after a failed connection attempt.
+    JCFW_WIFI_STA_STATE_BACKOFF,
+
+    /// @brief Gave up on connecting; Retrying wouldn't help.
+    JCFW_WIFI_STA_STATE_FAILED,
+} jcfw_wifi_sta_state_e;
+
 // TODO(Caleb): Add auth mode to this struct
 typedef struct
 {
@@ -23,21 +94,160 @@ typedef struct
     uint8_t bssid[JCFW_WIFI_BSSID_LEN];
     int8_t  rssi_dBm;
     uint8_t channel;
+
+    /// @brief When the access point was last seen by a scan (see: jcfw_platform_get_time_us()).
+    uint64_t seen_us;
 } jcfw_wifi_sta_scan_result_t;
 
-jcfw_result_e jcfw_wifi_init(void);
+typedef struct
+{
+    uint8_t ip[4];
+    uint8_t netmask[4];
+    uint8_t gateway[4];
+    uint8_t dns[4];
+} jcfw_wifi_ip_config_t;
+
+typedef struct
+{
+    uint32_t connect_count;
+
+    /// @brief The number of connections made straight to the last access point.
+    uint32_t fast_connect_count;
+
+    /// @brief The number of connections which had to scan after the last access point failed.
+    uint32_t fallback_count;
+
+    /// @brief The number of connections which got the same address as the last one.
+    uint32_t lease_reuse_count;
+
+    /// @brief The number of connection attempts which failed.
+    uint32_t failure_count;
+
+    /// @brief The number of connections which were lost (rather than disconnected from).
+    uint32_t drop_count;
+
+    /// @brief The time from starting to connect to having an address, in ms, of the connections
+    /// made straight to the last access point, and of those which scanned.
+    jcfw_sketch_t fast_connect_ms;
+    jcfw_sketch_t full_connect_ms;
+
+    /// @brief The number of scans for a better access point.
+    uint32_t roam_scan_count;
+
+    /// @brief The number of roams to a better access point which succeeded, and the number which
+    /// failed and had to connect as usual.
+    uint32_t roam_count;
+    uint32_t roam_failure_count;
+
+    /// @brief The time from leaving the access point to having an address again, in ms, of the
+    /// roams which succeeded.
+    jcfw_sketch_t roam_ms;
+} jcfw_wifi_sta_stats_t;
+
+/// @brief Called when a scan completes, from the WIFI event task; Must not block.
+/// @param result JCFW_RESULT_OK if the scan completed, or an error code otherwise.
+/// @param ap_count The number of access points in the scan cache.
+typedef void (*jcfw_wifi_sta_scan_f)(jcfw_result_e result, size_t ap_count, void *arg);
+
+/// @brief Called when an operation started in the background completes; Must not block.
+/// @param result JCFW_RESULT_OK if the operation completed, or an error code otherwise.
+typedef void (*jcfw_wifi_done_f)(jcfw_result_e result, void *arg);
+
+/// @brief Called when the state of the STA changes, from the WIFI manager task; Must not block.
+typedef void (*jcfw_wifi_sta_state_f)(
+    jcfw_wifi_sta_state_e from, jcfw_wifi_sta_state_e to, void *arg);
+
+/// @brief Start initializing WIFI in the background.
+/// @param cb Optional; Called from the WIFI event task once WIFI is initialized.
+/// @param arg The argument passed to the callback.
+/// @return JCFW_RESULT_OK if WIFI is already initialized (the callback isn't called),
+/// JCFW_RESULT_IN_PROGRESS if it is initializing and the callback will be called,
+/// JCFW_RESULT_FULL if it is already initializing with a callback, or an error code otherwise.
+jcfw_result_e jcfw_wifi_init_start(jcfw_wifi_done_f cb, void *arg);
+
+/// @brief Initialize WIFI, and wait for it to be initialized.
+/// @param timeout_ms The longest time to wait for, or JCFW_WIFI_WAIT_FOREVER.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_TIMEOUT if WIFI is still
+/// initializing, or an error code otherwise.
+jcfw_result_e jcfw_wifi_init(uint32_t timeout_ms);
 
 jcfw_result_e jcfw_wifi_deinit(void);
 
-jcfw_result_e jcfw_wifi_sta_connect(const char *ssid, const char *password);
+/// @brief Start connecting to a network, and keep connected to it from then on.
+/// @param ssid Required; The SSID of the network.
+/// @param password Optional; The password of the network, or NULL if it is open.
+/// @param cb Optional; Called from the WIFI manager task once the STA is connected, or once the
+/// manager gives up. Retryable failures are retried without calling it.
+/// @param arg The argument passed to the callback.
+/// @return JCFW_RESULT_IN_PROGRESS if the manager is connecting and the callback will be called,
+/// JCFW_RESULT_FULL if a request with a callback is still waiting for the manager, or an error
+/// code otherwise.
+jcfw_result_e jcfw_wifi_sta_connect_start(
+    const char *ssid, const char *password, jcfw_wifi_done_f cb, void *arg);
+
+/// @brief Stop connecting, and disconnect from the network.
+/// @param cb Optional; Called from the WIFI manager task once the STA is disconnected.
+/// @param arg The argument passed to the callback.
+/// @return JCFW_RESULT_IN_PROGRESS if the manager is disconnecting and the callback will be
+/// called, JCFW_RESULT_FULL if a request with a callback is still waiting for the manager, or an
+/// error code otherwise.
+jcfw_result_e jcfw_wifi_sta_disconnect_start(jcfw_wifi_done_f cb, void *arg);
+
+/// @brief Start connecting to a network, and wait for the STA to be connected.
+/// @param ssid Required; The SSID of the network.
+/// @param password Optional; The password of the network, or NULL if it is open.
+/// @param timeout_ms The longest time to wait for, or JCFW_WIFI_WAIT_FOREVER.
+/// @return JCFW_RESULT_OK if the STA connected, JCFW_RESULT_TIMEOUT if it is still connecting,
+/// or an error code otherwise.
+jcfw_result_e jcfw_wifi_sta_connect(const char *ssid, const char *password, uint32_t timeout_ms);
+
+/// @brief Stop connecting, and wait for the STA to be disconnected.
+/// @param timeout_ms The longest time to wait for, or JCFW_WIFI_WAIT_FOREVER.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_TIMEOUT if the STA is still
+/// disconnecting, or an error code otherwise.
+jcfw_result_e jcfw_wifi_sta_disconnect(uint32_t timeout_ms);
 
-jcfw_result_e jcfw_wifi_sta_disconnect(void);
+/// @brief Get the state of the STA.
+/// @return The state of the STA.
+jcfw_wifi_sta_state_e jcfw_wifi_sta_get_state(void);
 
-// TODO(Caleb): Implement nonblocking WIFI scanning
-// typedef void (*jcfw_wifi_sta_scan_cb_t)(jcfw_wifi_sta_scan_result_t *aps, size_t num_aps);
+/// @brief Be told about every change of state of the STA, from now on.
+/// @param cb Required; Called with each change.
+/// @param arg The argument passed to the callback.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_FULL if there are already
+/// JCFW_WIFI_SUBSCRIBER_COUNT_MAX subscribers, or an error code otherwise.
+jcfw_result_e jcfw_wifi_sta_subscribe(jcfw_wifi_sta_state_f cb, void *arg);
 
+/// @brief Use a static address rather than DHCP, from the next connection on.
+/// @param config The address, or NULL to use DHCP again.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_NOT_INITIALIZED if WIFI has
+/// never been initialized, or an error code otherwise.
+jcfw_result_e jcfw_wifi_sta_set_static_ip(const jcfw_wifi_ip_config_t *config);
+
+/// @brief Get the connection statistics of the STA.
+/// @param o_stats Required; The statistics, all 0 if WIFI has never been initialized.
+void jcfw_wifi_sta_get_stats(jcfw_wifi_sta_stats_t *o_stats);
+
+/// @brief Start a scan in the background.
+/// @param cb Optional; Called when the scan completes.
+/// @param arg The argument passed to the callback.
+/// @return JCFW_RESULT_IN_PROGRESS if the scan is running and the callback will be called,
+/// JCFW_RESULT_FULL if another scan with a callback is already running, or an error code otherwise.
+jcfw_result_e jcfw_wifi_sta_scan_start(jcfw_wifi_sta_scan_f cb, void *arg);
+
+/// @brief Scan, and wait for the scan to complete (up to JCFW_WIFI_SCAN_TIMEOUT_MS).
+/// @param o_aps Required; The access points, strongest first (see: jcfw_wifi_sta_get_scan_cache()).
+/// @param io_num_aps Required; In: The size of `o_aps`. Out: The number of access points.
+/// @return JCFW_RESULT_OK if the operation is successful, JCFW_RESULT_TIMEOUT if the scan is still
+/// running, or an error code otherwise.
 jcfw_result_e jcfw_wifi_sta_scan(jcfw_wifi_sta_scan_result_t *o_aps, size_t *io_num_aps);
 
+/// @brief Get the access points in the scan cache, without scanning.
+/// @param o_aps Required; The access points, strongest first.
+/// @param io_num_aps Required; In: The size of `o_aps`. Out: The number of access points.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_wifi_sta_get_scan_cache(jcfw_wifi_sta_scan_result_t *o_aps, size_t *io_num_aps);
+
 bool jcfw_wifi_is_initialized(void);
 
 jcfw_result_e jcfw_wifi_sta_is_connected(void);
@@ -0,0 +1,106 @@
+#ifndef __JCFW_TELEMETRY_AGGREGATE_H__
+#define __JCFW_TELEMETRY_AGGREGATE_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+#include "jcfw/util/sketch.h"
+
+/* Notes:
+ * An aggregator summarizes a stream of timestamped values over windows of `window_ms`, reporting
+ * once every `hop_ms`:
+ * - Tumbling windows: `hop_ms == window_ms`; every value is in exactly one report.
+ * - Sliding windows: `hop_ms < window_ms`; each report covers the last `window_ms`, so the reports
+ *   overlap.
+ *
+ * Internally, the window is split into `window_ms / hop_ms` panes of `hop_ms` each, and every
+ * report merges the panes of its window. Memory is fixed: a sliding window may have at most
+ * JCFW_AGGREGATE_PANE_COUNT_MAX panes. Panes are aligned to multiples of `hop_ms` in the values'
+ * time base, and windows without any values are not reported.
+ *
+ * The aggregator is not thread safe; It should be fed and polled by the same task.
+ */
+
+/// @brief The summary of one window.
+typedef struct
+{
+    /// @brief The window covers [start_us, end_us).
+    uint64_t start_us;
+    uint64_t end_us;
+
+    uint32_t count;
+    float    min;
+    float    max;
+    float    mean;
+    float    last;
+
+    /// @brief Estimated percentiles (see: jcfw/util/sketch.h).
+    float p50;
+    float p90;
+    float p99;
+} jcfw_aggregate_report_t;
+
+/// @brief Called with the summary of each window as it closes.
+typedef void (*jcfw_aggregate_report_f)(const jcfw_aggregate_report_t *report, void *arg);
+
+typedef struct
+{
+    /// @brief The length of each window, in milliseconds. Must be a multiple of `hop_ms`.
+    uint32_t window_ms;
+
+    /// @brief The time between reports, in milliseconds.
+    uint32_t hop_ms;
+
+    /// @brief The range over which percentiles are told apart (see: jcfw_sketch_init()).
+    float value_min;
+    float value_max;
+
+    jcfw_aggregate_report_f report_cb;
+    void                   *report_cb_arg;
+} jcfw_aggregate_config_t;
+
+/// @brief The values which arrived during one hop.
+typedef struct
+{
+    uint32_t      count;
+    float         min;
+    float         max;
+    float         sum;
+    float         last;
+    jcfw_sketch_t sketch;
+} jcfw_aggregate_pane_t;
+
+typedef struct
+{
+    jcfw_aggregate_config_t config;
+
+    jcfw_aggregate_pane_t panes[JCFW_AGGREGATE_PANE_COUNT_MAX];
+    size_t                pane_count;
+    size_t                current_pane;
+    uint64_t              pane_start_us;
+    bool                  is_started;
+
+    /// @brief Scratch space for merging the panes of a window.
+    jcfw_sketch_t merged;
+} jcfw_aggregate_t;
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Set up an aggregator, or reconfigure one (which drops the windows in progress).
+/// @param agg The aggregator to set up.
+/// @param config The configuration of the aggregator.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_aggregate_init(jcfw_aggregate_t *agg, const jcfw_aggregate_config_t *config);
+
+/// @brief Add a value, reporting any windows which closed before it.
+/// @param agg The aggregator to add to.
+/// @param time_us The timestamp of the value. Values earlier than the current pane are dropped.
+/// @param value The value to add.
+void jcfw_aggregate_add(jcfw_aggregate_t *agg, uint64_t time_us, float value);
+
+/// @brief Report any windows which have closed, even if no values arrived since.
+/// @param agg The aggregator to poll.
+/// @param now_us The current time, in the same time base as the values' timestamps.
+void jcfw_aggregate_poll(jcfw_aggregate_t *agg, uint64_t now_us);
+
+#endif // __JCFW_TELEMETRY_AGGREGATE_H__
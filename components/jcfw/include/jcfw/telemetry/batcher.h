@@ -0,0 +1,118 @@
+#ifndef __JCFW_TELEMETRY_BATCHER_H__
+#define __JCFW_TELEMETRY_BATCHER_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/telemetry/frame.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A batcher collects records into telemetry frames and hands each frame to a callback once one of
+ * these is true:
+ * - Size: the frame can't be guaranteed to fit another record.
+ * - Count: the frame holds `record_count_max` records.
+ * - Age: the frame's first record is `age_max_us` old (checked by jcfw_telemetry_batcher_poll()).
+ *
+ * The age limit bounds the latency that batching adds; the size and count limits bound the size of
+ * each datagram. Frame sequence numbers increase by one for every frame handed to the callback.
+ *
+ * The batcher is not thread safe; It should be fed and polled by the same task.
+ */
+
+/// @brief Called with each finished frame. The frame is only valid for the duration of the call.
+typedef void (*jcfw_telemetry_batcher_flush_f)(const uint8_t *frame, size_t length, void *arg);
+
+/// @brief Why a frame was flushed.
+typedef enum
+{
+    JCFW_TELEMETRY_FLUSH_SIZE = 0,
+    JCFW_TELEMETRY_FLUSH_COUNT,
+    JCFW_TELEMETRY_FLUSH_AGE,
+    JCFW_TELEMETRY_FLUSH_MANUAL,
+    JCFW_TELEMETRY_FLUSH_REASON_COUNT,
+} jcfw_telemetry_flush_reason_e;
+
+typedef struct
+{
+    /// @brief The ID of the sending device.
+    uint32_t device_id;
+
+    /// @brief The kind of records being batched (see: jcfw/telemetry/frame.h).
+    uint8_t stream;
+
+    /// @brief The size of each record's payload, in bytes.
+    uint8_t record_size;
+
+    /// @brief The fields of each record, to compress frames with JCFW_TELEMETRY_ENCODING_DELTA, or
+    /// NULL to send records as they are. Must stay valid for the lifetime of the batcher.
+    const jcfw_telemetry_codec_layout_t *layout;
+
+    /// @brief The largest frame to build, in bytes (at most JCFW_TELEMETRY_FRAME_SIZE_MAX).
+    size_t frame_size_max;
+
+    /// @brief The largest number of records in one frame, or 0 for no limit.
+    uint16_t record_count_max;
+
+    /// @brief The longest time a record may wait in a frame, or 0 for no limit.
+    uint32_t age_max_us;
+
+    jcfw_telemetry_batcher_flush_f flush_cb;
+    void                          *flush_cb_arg;
+} jcfw_telemetry_batcher_config_t;
+
+typedef struct
+{
+    uint32_t frame_count;
+    uint32_t record_count;
+    uint64_t byte_count;
+
+    /// @brief The number of frames flushed for each jcfw_telemetry_flush_reason_e.
+    uint32_t flush_counts[JCFW_TELEMETRY_FLUSH_REASON_COUNT];
+} jcfw_telemetry_batcher_stats_t;
+
+typedef struct
+{
+    jcfw_telemetry_batcher_config_t config;
+
+    uint8_t                       buffer[JCFW_TELEMETRY_FRAME_SIZE_MAX];
+    jcfw_telemetry_frame_writer_t writer;
+    uint32_t                      sequence;
+
+    jcfw_telemetry_batcher_stats_t stats;
+} jcfw_telemetry_batcher_t;
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Set up a batcher.
+/// @param batcher The batcher to set up.
+/// @param config The configuration of the batcher.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_batcher_init(
+    jcfw_telemetry_batcher_t *batcher, const jcfw_telemetry_batcher_config_t *config);
+
+/// @brief Add a record, flushing the current frame first or afterwards if needed.
+/// @param batcher The batcher to add to.
+/// @param time_us The timestamp of the record. Must not be earlier than the previous record's.
+/// @param record The payload of the record (`record_size` bytes).
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_telemetry_batcher_add(jcfw_telemetry_batcher_t *batcher, uint64_t time_us, const void *record);
+
+/// @brief Flush the current frame if its first record has waited for too long.
+/// @param batcher The batcher to poll.
+/// @param now_us The current time, in the same time base as the records' timestamps.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_batcher_poll(jcfw_telemetry_batcher_t *batcher, uint64_t now_us);
+
+/// @brief Flush the current frame, if it holds any records.
+/// @param batcher The batcher to flush.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_batcher_flush(jcfw_telemetry_batcher_t *batcher);
+
+/// @brief Get the statistics of a batcher.
+/// @param batcher The batcher to check.
+/// @param o_stats Required; The statistics.
+void jcfw_telemetry_batcher_get_stats(
+    const jcfw_telemetry_batcher_t *batcher, jcfw_telemetry_batcher_stats_t *o_stats);
+
+#endif // __JCFW_TELEMETRY_BATCHER_H__
@@ -0,0 +1,109 @@
+#ifndef __JCFW_TELEMETRY_CODEC_H__
+#define __JCFW_TELEMETRY_CODEC_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A streaming codec for timestamped records made of little endian unsigned integer fields (1, 2 or
+ * 4 bytes each, as described by a layout). It is the JCFW_TELEMETRY_ENCODING_DELTA encoding of
+ * telemetry frames, but has no dependency on them.
+ *
+ * Each record is encoded as:
+ * - The delta-of-delta of its timestamp (the change in the time between records), as a zigzag
+ *   varint. Samples which arrive at a steady rate cost one byte, however long the period is.
+ * - For each field, the difference from the same field of the previous record (modulo the width of
+ *   the field), as a zigzag varint. Slowly changing readings cost one byte per field.
+ *
+ * Everything is relative to the previous record, so the encoder and the decoder have to see the
+ * same records in the same order from the same reset. Telemetry frames reset the codec at the
+ * start of every frame, so that each frame can be decoded on its own.
+ *
+ * The codec uses no heap and a fixed amount of state, and has no platform dependencies.
+ */
+
+/// @brief The largest encoded record, in bytes.
+#define JCFW_TELEMETRY_CODEC_RECORD_SIZE_MAX (10 + 5 * JCFW_TELEMETRY_FIELD_COUNT_MAX)
+
+/// @brief The fields of a record.
+typedef struct
+{
+    uint8_t field_count;
+
+    /// @brief The size of each field, in bytes (1, 2 or 4).
+    uint8_t field_sizes[JCFW_TELEMETRY_FIELD_COUNT_MAX];
+} jcfw_telemetry_codec_layout_t;
+
+/// @brief The state of one encoder or decoder.
+typedef struct
+{
+    jcfw_telemetry_codec_layout_t layout;
+    size_t                        record_size;
+
+    uint64_t prev_time_us;
+    int64_t  prev_delta_us;
+    uint32_t prev_fields[JCFW_TELEMETRY_FIELD_COUNT_MAX];
+} jcfw_telemetry_codec_t;
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Set up a codec, reset to a base time of 0.
+/// @param codec The codec to set up.
+/// @param layout The fields of each record.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_codec_init(
+    jcfw_telemetry_codec_t *codec, const jcfw_telemetry_codec_layout_t *layout);
+
+/// @brief Forget the previous records, so that the next record is encoded on its own.
+/// @param codec The codec to reset.
+/// @param base_time_us The time which the next record's timestamp is relative to. The encoder and
+/// the decoder must use the same base time.
+void jcfw_telemetry_codec_reset(jcfw_telemetry_codec_t *codec, uint64_t base_time_us);
+
+/// @brief Get the size of the records of a layout.
+/// @param layout The layout to check.
+/// @return The size of each record, in bytes, or 0 if the layout is invalid.
+size_t jcfw_telemetry_codec_get_record_size(const jcfw_telemetry_codec_layout_t *layout);
+
+/// @brief Get the largest encoded size of one record of a layout.
+/// @param layout The layout to check.
+/// @return The largest encoded record, in bytes.
+size_t jcfw_telemetry_codec_get_encoded_size_max(const jcfw_telemetry_codec_layout_t *layout);
+
+/// @brief Encode a record.
+/// @param codec The codec to encode with.
+/// @param time_us The timestamp of the record. Must not be earlier than the previous record's (or
+/// the base time).
+/// @param record The record (`record_size` bytes).
+/// @param o_buffer Required; The encoded record.
+/// @param capacity The size of `o_buffer`, in bytes.
+/// @param o_length Required; The length of the encoded record, in bytes.
+/// @return JCFW_RESULT_OK if the record was encoded, JCFW_RESULT_FULL if it doesn't fit (the codec
+/// is unchanged), or an error code otherwise.
+jcfw_result_e jcfw_telemetry_codec_encode(
+    jcfw_telemetry_codec_t *codec,
+    uint64_t                time_us,
+    const void             *record,
+    uint8_t                *o_buffer,
+    size_t                  capacity,
+    size_t                 *o_length);
+
+/// @brief Decode a record.
+/// @param codec The codec to decode with.
+/// @param buffer The encoded records.
+/// @param length The length of `buffer`, in bytes.
+/// @param o_time_us Required; The timestamp of the record.
+/// @param o_record Required; The record (`record_size` bytes).
+/// @param o_consumed Required; The number of bytes of `buffer` which were decoded.
+/// @return JCFW_RESULT_OK if a record was decoded, JCFW_RESULT_OUT_OF_BOUNDS if `buffer` ends in
+/// the middle of a record (the codec is unchanged), or an error code otherwise.
+jcfw_result_e jcfw_telemetry_codec_decode(
+    jcfw_telemetry_codec_t *codec,
+    const uint8_t          *buffer,
+    size_t                  length,
+    uint64_t               *o_time_us,
+    void                   *o_record,
+    size_t                 *o_consumed);
+
+#endif // __JCFW_TELEMETRY_CODEC_H__
@@ -0,0 +1,172 @@
+#ifndef __JCFW_TELEMETRY_FRAME_H__
+#define __JCFW_TELEMETRY_FRAME_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/telemetry/codec.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A telemetry frame carries a batch of fixed-size records from one device in one datagram. All
+ * multi-byte fields are little endian.
+ *
+ *     offset  size  field
+ *     0       2     magic ('J', 'T')
+ *     2       1     version (JCFW_TELEMETRY_FRAME_VERSION)
+ *     3       1     encoding (jcfw_telemetry_encoding_e)
+ *     4       1     record size, in bytes
+ *     5       1     stream (what the records are; chosen by the application)
+ *     6       2     record count
+ *     8       4     device ID
+ *     12      4     frame sequence number
+ *     16      8     base timestamp, in microseconds (the timestamp of the first record)
+ *     24      ...   records
+ *
+ * With JCFW_TELEMETRY_ENCODING_RAW, each record is the time since the previous record (the first
+ * record's delta is always 0) as an unsigned LEB128 varint, followed by the record's payload as
+ * given to jcfw_telemetry_frame_append(). A delta under 16 ms takes two bytes and a delta under 2 s
+ * takes three, instead of eight for an absolute timestamp.
+ *
+ * With JCFW_TELEMETRY_ENCODING_DELTA, the header is followed by the layout of the records (the
+ * field count, then the size of each field, one byte each), and the records are compressed with
+ * jcfw/telemetry/codec.h, starting from the base timestamp. Periodic, slowly changing readings
+ * cost about one byte per field plus one byte of timestamp.
+ *
+ * The reader has no platform dependencies, so the same code decodes frames on the device and on
+ * the host.
+ */
+
+#define JCFW_TELEMETRY_FRAME_MAGIC_0        'J'
+#define JCFW_TELEMETRY_FRAME_MAGIC_1        'T'
+#define JCFW_TELEMETRY_FRAME_VERSION        1
+#define JCFW_TELEMETRY_FRAME_HEADER_SIZE    24
+
+/// @brief The largest encoded time delta, in bytes.
+#define JCFW_TELEMETRY_FRAME_DELTA_SIZE_MAX 5
+
+/// @brief How the records of a frame are encoded.
+typedef enum
+{
+    JCFW_TELEMETRY_ENCODING_RAW   = 0x00,
+    JCFW_TELEMETRY_ENCODING_DELTA = 0x01,
+} jcfw_telemetry_encoding_e;
+
+/// @brief The header of a telemetry frame.
+typedef struct
+{
+    uint8_t  version;
+    uint8_t  encoding;
+    uint8_t  record_size;
+    uint8_t  stream;
+    uint16_t record_count;
+    uint32_t device_id;
+    uint32_t sequence;
+    uint64_t base_time_us;
+} jcfw_telemetry_frame_header_t;
+
+/// @brief Builds one frame in a caller-provided buffer.
+typedef struct
+{
+    jcfw_telemetry_frame_header_t header;
+
+    uint8_t *buffer;
+    size_t   capacity;
+    size_t   length;
+
+    uint64_t last_time_us;
+
+    /// @brief The encoder of the records, if the frame is JCFW_TELEMETRY_ENCODING_DELTA.
+    jcfw_telemetry_codec_t codec;
+} jcfw_telemetry_frame_writer_t;
+
+/// @brief Walks the records of one received frame.
+typedef struct
+{
+    jcfw_telemetry_frame_header_t header;
+
+    const uint8_t *buffer;
+    size_t         length;
+    size_t         offset;
+
+    uint16_t record_index;
+    uint64_t time_us;
+
+    /// @brief The decoder of the records, and the last record it decoded, if the frame is
+    /// JCFW_TELEMETRY_ENCODING_DELTA.
+    jcfw_telemetry_codec_t codec;
+    uint8_t                record[JCFW_TELEMETRY_FIELD_COUNT_MAX * sizeof(uint32_t)];
+} jcfw_telemetry_frame_reader_t;
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Start a new frame.
+/// @param writer The writer to start the frame with.
+/// @param buffer The storage of the frame.
+/// @param capacity The size of the storage, in bytes. This is the largest frame which will be
+/// built, so it should fit in one datagram.
+/// @param device_id The ID of the sending device.
+/// @param sequence The sequence number of the frame.
+/// @param stream The kind of records in the frame.
+/// @param record_size The size of each record's payload, in bytes.
+/// @param layout The fields of each record, to compress the records with
+/// JCFW_TELEMETRY_ENCODING_DELTA, or NULL to send them as they are (JCFW_TELEMETRY_ENCODING_RAW).
+/// Must add up to `record_size`.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_frame_begin(
+    jcfw_telemetry_frame_writer_t       *writer,
+    uint8_t                             *buffer,
+    size_t                               capacity,
+    uint32_t                             device_id,
+    uint32_t                             sequence,
+    uint8_t                              stream,
+    uint8_t                              record_size,
+    const jcfw_telemetry_codec_layout_t *layout);
+
+/// @brief Add a record to a frame.
+/// @param writer The writer of the frame.
+/// @param time_us The timestamp of the record. Must not be earlier than the previous record's.
+/// @param record The payload of the record (`record_size` bytes).
+/// @return JCFW_RESULT_OK if the record was added, JCFW_RESULT_FULL if it doesn't fit in this frame
+/// (the frame is unchanged), or an error code otherwise.
+jcfw_result_e jcfw_telemetry_frame_append(
+    jcfw_telemetry_frame_writer_t *writer, uint64_t time_us, const void *record);
+
+/// @brief Write the header of a frame, making it ready to send.
+/// @param writer The writer of the frame.
+/// @param o_length Required; The length of the frame, in bytes.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_frame_finish(jcfw_telemetry_frame_writer_t *writer, size_t *o_length);
+
+/// @brief Get the number of bytes left in a frame.
+/// @param writer The writer of the frame.
+/// @return The number of unused bytes in the frame's buffer.
+static inline size_t
+jcfw_telemetry_frame_get_free_space(const jcfw_telemetry_frame_writer_t *writer)
+{
+    return writer->capacity - writer->length;
+}
+
+/// @brief Get the most bytes that the next record of a frame could take.
+/// @param writer The writer of the frame.
+/// @return The largest encoded size of one record, in bytes.
+size_t jcfw_telemetry_frame_get_record_size_max(const jcfw_telemetry_frame_writer_t *writer);
+
+/// @brief Check a received frame and prepare to read its records.
+/// @param reader The reader to open the frame with.
+/// @param buffer The frame.
+/// @param length The length of the frame, in bytes.
+/// @return JCFW_RESULT_OK if the frame's header is valid, or an error code otherwise.
+jcfw_result_e
+jcfw_telemetry_frame_open(jcfw_telemetry_frame_reader_t *reader, const void *buffer, size_t length);
+
+/// @brief Read the next record of a frame.
+/// @param reader The reader of the frame.
+/// @param o_time_us Required; The timestamp of the record.
+/// @param o_record Required; The payload of the record (`header.record_size` bytes). Only valid
+/// until the next call.
+/// @return JCFW_RESULT_OK if a record was read, JCFW_RESULT_EMPTY if every record has been read, or
+/// JCFW_RESULT_OUT_OF_BOUNDS if the frame is truncated.
+jcfw_result_e jcfw_telemetry_frame_next(
+    jcfw_telemetry_frame_reader_t *reader, uint64_t *o_time_us, const uint8_t **o_record);
+
+#endif // __JCFW_TELEMETRY_FRAME_H__
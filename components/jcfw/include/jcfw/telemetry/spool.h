@@ -0,0 +1,136 @@
+#ifndef __JCFW_TELEMETRY_SPOOL_H__
+#define __JCFW_TELEMETRY_SPOOL_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/platform/flash.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A persistent FIFO of telemetry frames (or any other records of up to
+ * JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX bytes), for holding on to them while the network is down.
+ *
+ * The spool is an append-only log in a flash region (see: jcfw/platform/flash.h), split into
+ * segments of one erase sector each:
+ * - Each segment starts with a header: a magic number, the sequence number of the segment (one
+ *   more than that of the previous segment), the number of times the segment has been erased, and
+ *   a CRC-32 of the header.
+ * - Records follow one after another: their length (u16), a state byte, a reserved byte, a CRC-32
+ *   of the length and the data, and then the data, padded to 4 bytes. The space after the last
+ *   record is erased (a length of 0xFFFF).
+ * - A record is consumed by clearing its state byte, which needs no erase.
+ * - The log moves through the segments in a circle, so every segment is erased equally often.
+ *   When the segment after the newest one still holds records which haven't been consumed (the
+ *   spool is full), the oldest of them are dropped.
+ *
+ * Power can be lost at any point. When the spool is opened, the segments are scanned and:
+ * - A segment with a bad header (torn while being erased or started) is treated as free.
+ * - A record with a bad CRC (torn while being written) ends its segment. If that is the newest
+ *   segment, new records go to the next one.
+ * - A record whose state byte was being cleared is either consumed or not; So records are
+ *   delivered at least once.
+ *
+ * Spools are not thread safe.
+ */
+
+/// @brief The size of the header of each segment, in bytes.
+#define JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE 16
+
+/// @brief The size of the header of each record, in bytes.
+#define JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE  8
+
+typedef struct
+{
+    /// @brief The number of records appended.
+    uint32_t append_count;
+
+    /// @brief The number of records consumed.
+    uint32_t consume_count;
+
+    /// @brief The number of records dropped, unconsumed, to make room for new ones.
+    uint32_t drop_count;
+
+    /// @brief The number of torn records or segment headers found when the spool was opened.
+    uint32_t corrupt_count;
+
+    /// @brief The number of segments erased.
+    uint32_t erase_count;
+
+    /// @brief The highest number of times that any one segment has been erased, over the life of
+    /// the region.
+    uint32_t wear_max;
+} jcfw_telemetry_spool_stats_t;
+
+typedef struct
+{
+    jcfw_flash_region_t region;
+    uint32_t            segment_count;
+    size_t              segment_size;
+
+    /// @brief Whether any segment has been started.
+    bool     has_segment;
+    uint32_t write_segment;
+    uint32_t write_seq;
+    size_t   write_offset;
+
+    /// @brief Always at the oldest record which hasn't been consumed, or at the write position.
+    uint32_t read_segment;
+    size_t   read_offset;
+
+    uint32_t pending_count;
+
+    jcfw_telemetry_spool_stats_t stats;
+} jcfw_telemetry_spool_t;
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Open a spool, recovering the records which were stored before the last reset.
+/// @param spool The spool to open.
+/// @param region_name The name of the flash region which holds the spool. (see:
+/// jcfw_flash_open())
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_spool_open(jcfw_telemetry_spool_t *spool, const char *region_name);
+
+/// @brief Close a spool.
+/// @param spool The spool to close.
+void jcfw_telemetry_spool_close(jcfw_telemetry_spool_t *spool);
+
+/// @brief Append a record to a spool, dropping the oldest records if the spool is full.
+/// @param spool The spool to append to.
+/// @param data The record.
+/// @param size The size of the record, at most JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX bytes.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e
+jcfw_telemetry_spool_append(jcfw_telemetry_spool_t *spool, const void *data, size_t size);
+
+/// @brief Read the oldest record of a spool which hasn't been consumed, without consuming it.
+/// @param spool The spool to read from.
+/// @param o_data Required; The record.
+/// @param capacity The size of `o_data`, in bytes.
+/// @param o_size Required; The size of the record, in bytes.
+/// @return JCFW_RESULT_OK if a record was read, JCFW_RESULT_EMPTY if every record has been
+/// consumed, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_spool_peek(
+    jcfw_telemetry_spool_t *spool, void *o_data, size_t capacity, size_t *o_size);
+
+/// @brief Consume the oldest record of a spool (the one returned by jcfw_telemetry_spool_peek()).
+/// @param spool The spool to consume from.
+/// @return JCFW_RESULT_OK if a record was consumed, JCFW_RESULT_EMPTY if every record has already
+/// been consumed, or an error code otherwise.
+jcfw_result_e jcfw_telemetry_spool_consume(jcfw_telemetry_spool_t *spool);
+
+/// @brief Get the number of records of a spool which haven't been consumed.
+/// @param spool The spool to check.
+/// @return The number of records waiting.
+static inline uint32_t jcfw_telemetry_spool_get_pending_count(const jcfw_telemetry_spool_t *spool)
+{
+    return spool->pending_count;
+}
+
+/// @brief Get the statistics of a spool.
+/// @param spool The spool to check.
+/// @param o_stats Required; The statistics.
+void jcfw_telemetry_spool_get_stats(
+    const jcfw_telemetry_spool_t *spool, jcfw_telemetry_spool_stats_t *o_stats);
+
+#endif // __JCFW_TELEMETRY_SPOOL_H__
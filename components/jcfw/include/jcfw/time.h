@@ -0,0 +1,40 @@
+#ifndef __JCFW_TIME_H__
+#define __JCFW_TIME_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/net/timesync.h"
+
+/* Notes:
+ * The time which samples are stamped with: the local clock (see: jcfw_platform_get_time_us())
+ * mapped onto the clock of a time server by the latest model from a timesync client (see:
+ * jcfw/net/timesync.h). Until the first model is set, it is the local clock.
+ *
+ * One task (whichever drives the timesync client) sets the model, and any task may read the time
+ * without blocking. ISRs may not; An ISR should take jcfw_platform_get_time_us() and leave it to a
+ * task to convert with jcfw_time_from_local_us().
+ *
+ * Each new model may move the time by up to the error of the previous one, in either direction,
+ * so readings taken across a model update aren't guaranteed to be in order.
+ */
+
+/// @brief Replace the model which maps the local clock onto the server's clock.
+/// @param model Required; The model (see: jcfw_timesync_get_model()).
+void jcfw_time_set_model(const jcfw_timesync_model_t *model);
+
+/// @brief Get the model which maps the local clock onto the server's clock.
+/// @param o_model Required; The model.
+/// @return True if a model has been set, or false if the time is still the local clock.
+bool jcfw_time_get_model(jcfw_timesync_model_t *o_model);
+
+/// @brief Map a time taken from the local clock onto the synchronized clock.
+/// @param local_us The local time (see: jcfw_platform_get_time_us()).
+/// @return The synchronized time, in microseconds.
+uint64_t jcfw_time_from_local_us(uint64_t local_us);
+
+/// @brief Get the synchronized time.
+/// @return The time on the server's clock, in microseconds, or the local time if no model has been
+/// set.
+uint64_t jcfw_time_now_us(void);
+
+#endif // __JCFW_TIME_H__
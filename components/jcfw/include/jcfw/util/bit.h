@@ -8,6 +8,19 @@
 
 #if __has_include("endian.h")
 #include <endian.h>
+
+// NOTE(Caleb): glibc (host builds) spells these differently than newlib
+#if defined(__GLIBC__) && !defined(_BYTE_ORDER)
+#define _BYTE_ORDER        __BYTE_ORDER
+#define _LITTLE_ENDIAN     __LITTLE_ENDIAN
+#define _BIG_ENDIAN        __BIG_ENDIAN
+#define __bswap16(_x)      __bswap_16(_x)
+#define __bswap32(_x)      __bswap_32(_x)
+#define __htonl(_x)        htobe32(_x)
+#define __htons(_x)        htobe16(_x)
+#define __ntohl(_x)        be32toh(_x)
+#define __ntohs(_x)        be16toh(_x)
+#endif
 #else
 #ifndef JCFW_BYTE_ORDER
 #error No endian.h found. Please #define JCFW_BYTE_ORDER as JCFW_LITTLE_ENDIAN or JFCW_BIG_ENDIAN
@@ -52,7 +65,7 @@ static inline uint32_t __bswap32(uint32_t x)
 #define JCFW_HTONL(_v)         __htonl(_v)
 #define JCFW_NTOHL(_v)         __ntohl(_v)
 
-static inline void _jcfw_itob(void *dest, uint32_t src, size_t size)
+static inline void _jcfw_itob(void *dest, uint64_t src, size_t size)
 {
     for (size_t i = 0; i < size; i++)
     {
@@ -60,6 +73,17 @@ static inline void _jcfw_itob(void *dest, uint32_t src, size_t size)
     }
 }
 
+static inline uint64_t _jcfw_btoi(const void *src, size_t size)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        value |= (uint64_t)((const uint8_t *)src)[i] << (i * 8);
+    }
+
+    return value;
+}
+
 #define JCFW_ITOB16(_dest, _src) _jcfw_itob((_dest), (_src), sizeof(uint16_t))
 #define JCFW_ITOB32(_dest, _src) _jcfw_itob((_dest), (_src), sizeof(uint32_t))
 
@@ -80,4 +104,9 @@ static inline void _jcfw_itob(void *dest, uint32_t src, size_t size)
 #endif
 #endif
 
+// NOTE(Caleb): A byte at a time, least significant first, so these are little-endian whatever the
+// byte order of the host. For wire and flash formats, with fields of up to 8 bytes.
+#define JCFW_PUT_LE(_dest, _src, _size) _jcfw_itob((_dest), (_src), (_size))
+#define JCFW_GET_LE(_src, _size)        _jcfw_btoi((_src), (_size))
+
 #endif //  __JCFW_UTIL_BIT_H__
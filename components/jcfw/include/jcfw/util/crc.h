@@ -0,0 +1,16 @@
+#ifndef __JCFW_UTIL_CRC_H__
+#define __JCFW_UTIL_CRC_H__
+
+#include "jcfw/detail/common.h"
+
+/// @brief The initial value of a CRC-32 which is computed in pieces.
+#define JCFW_CRC32_INIT 0
+
+/// @brief Compute a CRC-32 (IEEE 802.3, as used by zlib), or continue one computed in pieces.
+/// @param crc The CRC of the data so far, or JCFW_CRC32_INIT.
+/// @param data The data.
+/// @param size The size of the data, in bytes.
+/// @return The CRC of the data so far, including `data`.
+uint32_t jcfw_crc32(uint32_t crc, const void *data, size_t size);
+
+#endif // __JCFW_UTIL_CRC_H__
@@ -0,0 +1,143 @@
+#ifndef __JCFW_UTIL_FILTER_H__
+#define __JCFW_UTIL_FILTER_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * Smoothing filters for integer sensor streams. They use integer math only (so they cost the same
+ * with or without an FPU, and give the same answers on every target), and keep all of their state
+ * in the filter itself.
+ *
+ * - EMA: An exponential moving average, `y += alpha * (x - y)`.
+ * - Moving average: The mean of the last `length` samples.
+ * - Median: The median of the last `length` samples, which passes steps through but removes
+ *   spikes (e.g. flicker or a passing shadow) shorter than half the window.
+ * - Hysteresis: Holds its output until a sample differs from it by more than `threshold`, so that
+ *   noise around a steady value doesn't cause updates downstream.
+ * - Kalman: A one-dimensional Kalman filter for a value which drifts slowly (a random walk) and is
+ *   measured with noise. It smooths as much as the noise allows, and follows real changes faster
+ *   than an EMA with the same steady-state smoothing.
+ *
+ * Every filter takes its first sample as its output (rather than starting from 0), and samples
+ * must be within +/-2^30. EMA and Kalman keep 16 fractional bits of state, and every filter rounds
+ * its output to the nearest integer.
+ *
+ * Filter one sample at a time with jcfw_filter_apply(), or a batch with jcfw_filter_apply_block(),
+ * which only decides which filter to run once per batch.
+ */
+
+typedef enum
+{
+    JCFW_FILTER_TYPE_NONE = 0,
+    JCFW_FILTER_TYPE_EMA,
+    JCFW_FILTER_TYPE_MOVING_AVERAGE,
+    JCFW_FILTER_TYPE_MEDIAN,
+    JCFW_FILTER_TYPE_HYSTERESIS,
+    JCFW_FILTER_TYPE_KALMAN,
+} jcfw_filter_type_e;
+
+typedef struct
+{
+    jcfw_filter_type_e type;
+
+    union
+    {
+        struct
+        {
+            /// @brief The weight of each new sample, in 1/65536ths (from 1 to 65536).
+            uint32_t alpha_q16;
+        } ema;
+
+        struct
+        {
+            /// @brief The number of samples averaged (from 1 to JCFW_FILTER_LENGTH_MAX).
+            uint32_t length;
+        } moving_average;
+
+        struct
+        {
+            /// @brief The number of samples to take the median of (odd, from 1 to
+            /// JCFW_FILTER_LENGTH_MAX).
+            uint32_t length;
+        } median;
+
+        struct
+        {
+            /// @brief The largest difference from the output which doesn't change it.
+            uint32_t threshold;
+        } hysteresis;
+
+        struct
+        {
+            /// @brief How much the true value drifts between samples (a variance, in squared
+            /// sample units), in 1/256ths.
+            uint32_t process_variance_q8;
+
+            /// @brief The noise of each sample (a variance, in squared sample units), in 1/256ths.
+            /// Must not be 0.
+            uint32_t measurement_variance_q8;
+        } kalman;
+    };
+} jcfw_filter_config_t;
+
+typedef struct
+{
+    jcfw_filter_config_t config;
+    bool                 has_sample;
+
+    union
+    {
+        struct
+        {
+            int64_t value_q16;
+        } ema;
+
+        struct
+        {
+            int32_t  window[JCFW_FILTER_LENGTH_MAX];
+            int32_t  sorted[JCFW_FILTER_LENGTH_MAX];
+            uint32_t next;
+            uint32_t count;
+            int64_t  sum;
+        } window;
+
+        struct
+        {
+            int32_t value;
+        } hysteresis;
+
+        struct
+        {
+            int64_t  value_q16;
+            uint64_t variance_q16;
+        } kalman;
+    };
+} jcfw_filter_t;
+
+/// @brief Set up a filter.
+/// @param filter The filter to set up.
+/// @param config Required; The configuration of the filter.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_filter_init(jcfw_filter_t *filter, const jcfw_filter_config_t *config);
+
+/// @brief Forget every sample a filter has seen, so that its next sample starts it over.
+/// @param filter The filter to reset.
+void jcfw_filter_reset(jcfw_filter_t *filter);
+
+/// @brief Filter one sample.
+/// @param filter The filter.
+/// @param sample The sample.
+/// @return The output of the filter.
+int32_t jcfw_filter_apply(jcfw_filter_t *filter, int32_t sample);
+
+/// @brief Filter a batch of samples, in order.
+/// @param filter The filter.
+/// @param samples The samples.
+/// @param o_samples Required; The output of the filter for each sample. May be `samples`.
+/// @param count The number of samples.
+void jcfw_filter_apply_block(
+    jcfw_filter_t *filter, const int32_t *samples, int32_t *o_samples, size_t count);
+
+#endif // __JCFW_UTIL_FILTER_H__
@@ -8,6 +8,7 @@ typedef enum
     JCFW_RESULT_ERROR,
     JCFW_RESULT_INVALID_ARGS,
     JCFW_RESULT_IN_PROGRESS,
+    JCFW_RESULT_TIMEOUT,
 
     // System
     JCFW_RESULT_NOT_INITIALIZED = 0x00000100,
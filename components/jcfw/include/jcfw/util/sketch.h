@@ -0,0 +1,57 @@
+#ifndef __JCFW_UTIL_SKETCH_H__
+#define __JCFW_UTIL_SKETCH_H__
+
+#include "jcfw/detail/common.h"
+
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A fixed-memory quantile sketch over non-negative values. Values are counted in logarithmically
+ * sized buckets between `min` and `max`, so every quantile is answered with the same relative
+ * error (about half of `gamma - 1`, where `gamma = (max / min) ^ (1 / (bucket count - 2))`) no
+ * matter how many values were added. Values at or below `min` share the first bucket, and values
+ * above `max` share the last one.
+ *
+ * Sketches with the same range can be merged, which is how sliding windows are built from the
+ * sketches of their panes.
+ */
+
+typedef struct
+{
+    float min;
+    float gamma;
+    float log_gamma;
+
+    uint32_t count;
+    uint16_t buckets[JCFW_SKETCH_BUCKET_COUNT];
+} jcfw_sketch_t;
+
+/// @brief Set up an empty sketch.
+/// @param sketch The sketch to set up.
+/// @param min The smallest value which is told apart from 0. Must be positive.
+/// @param max The largest value which is told apart from larger values. Must be above `min`.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_sketch_init(jcfw_sketch_t *sketch, float min, float max);
+
+/// @brief Remove every value from a sketch, keeping its range.
+/// @param sketch The sketch to clear.
+void jcfw_sketch_clear(jcfw_sketch_t *sketch);
+
+/// @brief Add a value to a sketch. Bucket counts saturate rather than wrap.
+/// @param sketch The sketch to add to.
+/// @param value The value to add. Negative values are counted as 0.
+void jcfw_sketch_add(jcfw_sketch_t *sketch, float value);
+
+/// @brief Add every value of one sketch to another.
+/// @param sketch The sketch to add to.
+/// @param other The sketch to add. Must have the same range as `sketch`.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_sketch_merge(jcfw_sketch_t *sketch, const jcfw_sketch_t *other);
+
+/// @brief Estimate a quantile of the values in a sketch.
+/// @param sketch The sketch to check.
+/// @param q The quantile, from 0 to 1 (e.g. 0.9 for the 90th percentile).
+/// @return The estimated quantile, or 0 if the sketch is empty.
+float jcfw_sketch_quantile(const jcfw_sketch_t *sketch, float q);
+
+#endif // __JCFW_UTIL_SKETCH_H__
@@ -0,0 +1,90 @@
+#ifndef __JCFW_UTIL_SPSC_H__
+#define __JCFW_UTIL_SPSC_H__
+
+#include <stdatomic.h>
+
+#include "jcfw/detail/common.h"
+#include "jcfw/util/result.h"
+
+/* Notes:
+ * A lock-free ring of fixed-size records with exactly one producer and one consumer. The producer
+ * only writes `head` and the consumer only writes `tail`, so neither side ever blocks or takes a
+ * lock, and the producer may be an ISR or a high priority task.
+ *
+ * When the ring is full, the producer drops the new record and counts it as an overflow. The
+ * consumer never loses records which are already in the ring.
+ */
+
+typedef struct
+{
+    uint8_t *buffer;
+    size_t   elem_size;
+    uint32_t mask;
+
+    /// @brief The number of records ever pushed. Written by the producer only.
+    _Atomic uint32_t head;
+
+    /// @brief The number of records ever popped. Written by the consumer only.
+    _Atomic uint32_t tail;
+
+    /// @brief The number of records dropped because the ring was full.
+    _Atomic uint32_t overflow_count;
+
+    /// @brief The highest number of records which were in the ring at once.
+    _Atomic uint32_t high_water;
+} jcfw_spsc_t;
+
+/// @brief Set up a ring.
+/// @param ring The ring to set up.
+/// @param buffer The storage of the ring (`elem_size * capacity` bytes).
+/// @param elem_size The size of one record, in bytes.
+/// @param capacity The number of records which fit in the ring. Must be a power of two.
+/// @return JCFW_RESULT_OK if the operation is successful, or an error code otherwise.
+jcfw_result_e jcfw_spsc_init(jcfw_spsc_t *ring, void *buffer, size_t elem_size, uint32_t capacity);
+
+/// @brief Copy a record into the ring. Producer only.
+/// @param ring The ring to push to.
+/// @param elem The record to push (`elem_size` bytes).
+/// @return JCFW_RESULT_OK if the record was pushed, or JCFW_RESULT_FULL if it was dropped.
+jcfw_result_e jcfw_spsc_push(jcfw_spsc_t *ring, const void *elem);
+
+/// @brief Copy the oldest record out of the ring. Consumer only.
+/// @param ring The ring to pop from.
+/// @param o_elem Required; The record (`elem_size` bytes).
+/// @return JCFW_RESULT_OK if a record was popped, or JCFW_RESULT_EMPTY if the ring is empty.
+jcfw_result_e jcfw_spsc_pop(jcfw_spsc_t *ring, void *o_elem);
+
+/// @brief Get the number of records in the ring. Only a snapshot if called by neither side.
+/// @param ring The ring to check.
+/// @return The number of records in the ring.
+static inline uint32_t jcfw_spsc_count(jcfw_spsc_t *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire)
+         - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/// @brief Get the number of records dropped because the ring was full.
+/// @param ring The ring to check.
+/// @return The number of records dropped.
+static inline uint32_t jcfw_spsc_get_overflow_count(jcfw_spsc_t *ring)
+{
+    return atomic_load_explicit(&ring->overflow_count, memory_order_relaxed);
+}
+
+/// @brief Get the highest number of records which were in the ring at once.
+/// @param ring The ring to check.
+/// @return The high water mark of the ring.
+static inline uint32_t jcfw_spsc_get_high_water(jcfw_spsc_t *ring)
+{
+    return atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+}
+
+/// @brief Reset the overflow count and the high water mark of a ring.
+/// @param ring The ring to reset the counters of.
+static inline void jcfw_spsc_reset_counters(jcfw_spsc_t *ring)
+{
+    atomic_store_explicit(&ring->overflow_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->high_water, 0, memory_order_relaxed);
+}
+
+#endif // __JCFW_UTIL_SPSC_H__
@@ -485,10 +485,14 @@ void jcfw_cli_printf(const jcfw_cli_t *cli, const char *format, ...)
     JCFW_ERROR_IF_FALSE(format, , "No format provided");
 
     va_list args;
+    va_list size_args;
     va_start(args, format);
 
-    size_t size = (size_t)vsnprintf(NULL, 0, format, args) + 1;
-    char   buffer[size];
+    va_copy(size_args, args);
+    size_t size = (size_t)vsnprintf(NULL, 0, format, size_args) + 1;
+    va_end(size_args);
+
+    char buffer[size];
     vsnprintf(buffer, size, format, args);
 
     va_end(args);
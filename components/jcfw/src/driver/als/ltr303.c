@@ -1,28 +1,68 @@
 #include "jcfw/driver/als/ltr303.h"
 
+#include "jcfw/platform/i2c.h"
 #include "jcfw/platform/platform.h"
 #include "jcfw/util/assert.h"
 #include "jcfw/util/math.h"
 
+// NOTE(Caleb): Register contents after a power on or soft reset (see datasheet page 14)
+// X(name, address, reset value, flags)
+#define _JCFW_LTR303_REGISTERS(X)                                                                  \
+    X(ALS_CONTR,             0x80, 0x00, JCFW_REGMAP_FLAG_MANUAL)                                  \
+    X(ALS_MEAS_RATE,         0x85, 0x03, 0)                                                        \
+    X(PART_ID,               0x86, 0xA0, JCFW_REGMAP_FLAG_READ_ONLY)                               \
+    X(MANUFAC_ID,            0x87, 0x05, JCFW_REGMAP_FLAG_READ_ONLY)                               \
+    X(ALS_DATA_CH1_0,        0x88, 0x00, _JCFW_LTR303_FLAGS_DATA)                                  \
+    X(ALS_DATA_CH1_1,        0x89, 0x00, _JCFW_LTR303_FLAGS_DATA)                                  \
+    X(ALS_DATA_CH0_0,        0x8A, 0x00, _JCFW_LTR303_FLAGS_DATA)                                  \
+    X(ALS_DATA_CH0_1,        0x8B, 0x00, _JCFW_LTR303_FLAGS_DATA)                                  \
+    X(ALS_STATUS,            0x8C, 0x00, _JCFW_LTR303_FLAGS_DATA)                                  \
+    X(ALS_INTERRUPT,         0x8F, 0x08, 0)                                                        \
+    X(ALS_THRES_UP_0,        0x97, 0xFF, 0)                                                        \
+    X(ALS_THRES_UP_1,        0x98, 0xFF, 0)                                                        \
+    X(ALS_THRES_LOW_0,       0x99, 0x00, 0)                                                        \
+    X(ALS_THRES_LOW_1,       0x9A, 0x00, 0)                                                        \
+    X(ALS_INTERRUPT_PERSIST, 0x9E, 0x00, 0)
+
+// NOTE(Caleb): See datasheet pages 17 - 24
+// X(name, register, offset, width, type)
+#define _JCFW_LTR303_FIELDS(X)                                                                     \
+    X(mode,               ALS_CONTR,             0, 1, jcfw_ltr303_mode_e)                         \
+    X(sw_reset,           ALS_CONTR,             1, 1, bool)                                       \
+    X(gain,               ALS_CONTR,             2, 3, jcfw_ltr303_gain_e)                         \
+    X(measurement_rate,   ALS_MEAS_RATE,         0, 3, jcfw_ltr303_measurement_rate_e)             \
+    X(integration_time,   ALS_MEAS_RATE,         3, 3, jcfw_ltr303_integration_time_e)             \
+    X(status_new_data,    ALS_STATUS,            2, 1, bool)                                       \
+    X(status_interrupt,   ALS_STATUS,            3, 1, bool)                                       \
+    X(status_gain,        ALS_STATUS,            4, 3, jcfw_ltr303_gain_e)                         \
+    X(interrupt_enable,   ALS_INTERRUPT,         1, 1, bool)                                       \
+    X(interrupt_high,     ALS_INTERRUPT,         2, 1, bool)                                       \
+    X(persistance,        ALS_INTERRUPT_PERSIST, 0, 4, uint8_t)
+
+#define _JCFW_LTR303_FLAGS_DATA (JCFW_REGMAP_FLAG_READ_ONLY | JCFW_REGMAP_FLAG_VOLATILE)
+
+#define _JCFW_LTR303_REG_ENUM(_name, _addr, _reset, _flags) JCFW_LTR303_REG_##_name = (_addr),
+
+#define _JCFW_LTR303_DEFINE_FIELD(_name, _reg, _offset, _width, _type)                             \
+    JCFW_REGMAP_DEFINE_FIELD(                                                                      \
+        _jcfw_ltr303_regs, _name, JCFW_LTR303_REG_##_reg, _offset, _width, _type)
+
 typedef enum
 {
-    JCFW_LTR303_REG_ALS_CONTR             = 0x80,
-    JCFW_LTR303_REG_ALS_MEAS_RATE         = 0x85,
-    JCFW_LTR303_REG_PART_ID               = 0x86,
-    JCFW_LTR303_REG_MANUFAC_ID            = 0x87,
-    JCFW_LTR303_REG_ALS_DATA_CH1_0        = 0x88,
-    JCFW_LTR303_REG_ALS_DATA_CH1_1        = 0x89,
-    JCFW_LTR303_REG_ALS_DATA_CH0_0        = 0x8A,
-    JCFW_LTR303_REG_ALS_DATA_CH0_1        = 0x8B,
-    JCFW_LTR303_REG_ALS_STATUS            = 0x8C,
-    JCFW_LTR303_REG_ALS_INTERRUPT         = 0x8F,
-    JCFW_LTR303_REG_ALS_THRES_UP_0        = 0x97,
-    JCFW_LTR303_REG_ALS_THRES_UP_1        = 0x98,
-    JCFW_LTR303_REG_ALS_THRES_LOW_0       = 0x99,
-    JCFW_LTR303_REG_ALS_THRES_LOW_1       = 0x9A,
-    JCFW_LTR303_REG_ALS_INTERRUPT_PERSIST = 0x9E,
+    _JCFW_LTR303_REGISTERS(_JCFW_LTR303_REG_ENUM)
 } jcfw_ltr303_register_e;
 
+_JCFW_LTR303_FIELDS(_JCFW_LTR303_DEFINE_FIELD)
+
+static const jcfw_regmap_reg_t S_REGS[] = {_JCFW_LTR303_REGISTERS(JCFW_REGMAP_DESC_REG)};
+
+static const jcfw_regmap_desc_t S_REGMAP_DESC = {
+    .regs      = S_REGS,
+    .reg_count = JCFW_ARRAYSIZE(S_REGS),
+    .base      = JCFW_LTR303_SHADOW_BASE,
+    .size      = JCFW_LTR303_SHADOW_SIZE,
+};
+
 static uint8_t S_GAIN_FACTORS[] = {
     [JCFW_LTR303_GAIN_1X]  = 1,
     [JCFW_LTR303_GAIN_2X]  = 2,
@@ -32,80 +72,122 @@ static uint8_t S_GAIN_FACTORS[] = {
     [JCFW_LTR303_GAIN_96X] = 96,
 };
 
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_ltr303_sync(jcfw_ltr303_t *dev);
+
+static jcfw_result_e
+_jcfw_ltr303_write_async(jcfw_ltr303_t *dev, uint8_t reg, const uint8_t *data, size_t size);
+
+static void _jcfw_ltr303_on_async_write_done(
+    jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg);
+
+static void _jcfw_ltr303_stage_config(jcfw_regmap_t *map, const jcfw_ltr303_config_t *cfg);
+
+static void _jcfw_ltr303_stage_u16(jcfw_regmap_t *map, uint8_t reg, uint16_t value);
+
+static uint16_t _jcfw_ltr303_get_u16(const jcfw_regmap_t *map, uint8_t reg);
+
+// -------------------------------------------------------------------------------------------------
+
 jcfw_result_e jcfw_ltr303_init(jcfw_ltr303_t *dev, void *i2c_arg, uint32_t i2c_timeout_ms)
+{
+    jcfw_result_e err = jcfw_ltr303_probe(dev, i2c_arg, i2c_timeout_ms);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    return jcfw_ltr303_reset(dev);
+}
+
+jcfw_result_e jcfw_ltr303_probe(jcfw_ltr303_t *dev, void *i2c_arg, uint32_t i2c_timeout_ms)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    dev->i2c_arg        = i2c_arg;
-    dev->i2c_timeout_ms = i2c_timeout_ms;
+    jcfw_regmap_init(
+        &dev->regs, &S_REGMAP_DESC, dev->shadow, dev->staged, i2c_arg, i2c_timeout_ms);
+    dev->is_window_enabled     = false;
+    dev->is_async_write_failed = false;
 
-    jcfw_result_e err;
+    // NOTE(Caleb): PART_ID and MANUFAC_ID are adjacent, so both are read in one transaction
+    jcfw_result_e err = jcfw_regmap_read(&dev->regs, JCFW_LTR303_REG_PART_ID, 2);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    uint8_t reg     = JCFW_LTR303_REG_PART_ID;
-    uint8_t part_id = 0x00;
-    err = jcfw_platform_i2c_mstr_mem_read(dev->i2c_arg, &reg, 1, &part_id, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    const uint8_t part_id    = jcfw_regmap_get(&dev->regs, JCFW_LTR303_REG_PART_ID);
+    const uint8_t manufac_id = jcfw_regmap_get(&dev->regs, JCFW_LTR303_REG_MANUFAC_ID);
     JCFW_ERROR_IF_FALSE(
         part_id == 0xA0,
         JCFW_RESULT_ERROR, // NOTE(Caleb): Should this be a different error?
         "LTR303 - Invalid part ID %02x (expected 0xA0)",
         part_id);
-
-    reg            = JCFW_LTR303_REG_MANUFAC_ID;
-    uint8_t man_id = 0x00;
-    err = jcfw_platform_i2c_mstr_mem_read(dev->i2c_arg, &reg, 1, &man_id, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
     JCFW_ERROR_IF_FALSE(
-        man_id == 0x05,
+        manufac_id == 0x05,
         JCFW_RESULT_ERROR, // NOTE(Caleb): Should this be a different error?
         "LTR303 - Invalid manufacturer ID %02x (expected 0x05)",
-        man_id);
+        manufac_id);
 
-    return jcfw_ltr303_reset(dev);
+    return JCFW_RESULT_OK;
 }
 
 jcfw_result_e jcfw_ltr303_reset(jcfw_ltr303_t *dev)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    jcfw_result_e err;
+    // NOTE(Caleb): The reset bit clears itself, so the shadow is invalidated to force the write
+    // through regardless of what the driver thinks is in the register.
+    jcfw_regmap_set(&dev->regs, JCFW_LTR303_REG_ALS_CONTR, 0x00);
+    _jcfw_ltr303_regs_set_sw_reset(&dev->regs, true);
+    jcfw_regmap_invalidate(&dev->regs);
 
-    uint8_t reg = JCFW_LTR303_REG_ALS_CONTR;
-    uint8_t cmd = JCFW_BIT(1);
-    err = jcfw_platform_i2c_mstr_mem_write(dev->i2c_arg, &reg, 1, &cmd, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    jcfw_result_e err = jcfw_regmap_flush_reg(&dev->regs, JCFW_LTR303_REG_ALS_CONTR);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
     jcfw_platform_delay_ms(10); // See datasheet page 25/26
 
+    jcfw_regmap_load_reset(&dev->regs);
     return JCFW_RESULT_OK;
 }
 
-jcfw_result_e jcfw_ltr303_set_mode(jcfw_ltr303_t *dev, jcfw_ltr303_mode_e mode)
+jcfw_result_e jcfw_ltr303_apply_config(
+    jcfw_ltr303_t *dev, const jcfw_ltr303_config_t *cfg, bool skip_reset)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
+    JCFW_ERROR_IF_FALSE(cfg, JCFW_RESULT_INVALID_ARGS, "No configuration provided");
 
-    jcfw_result_e err;
-    uint8_t       reg         = JCFW_LTR303_REG_ALS_CONTR;
-    uint8_t       control_reg = 0x00;
+    jcfw_result_e err = (skip_reset) ? _jcfw_ltr303_sync(dev) : jcfw_ltr303_reset(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &control_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    const bool is_active = _jcfw_ltr303_regs_get_mode(&dev->regs) == JCFW_LTR303_MODE_ACTIVE;
+    _jcfw_ltr303_stage_config(&dev->regs, cfg);
 
-    if (mode == JCFW_LTR303_MODE_ACTIVE)
+    // NOTE(Caleb): The interrupt register may only be changed in standby mode (see datasheet page
+    // 20). The final ALS_CONTR write below restores the requested mode.
+    if (is_active && jcfw_regmap_is_dirty(&dev->regs, JCFW_LTR303_REG_ALS_INTERRUPT))
     {
-        JCFW_BITSET(control_reg, JCFW_BIT(0));
-    }
-    else
-    {
-        JCFW_BITCLEAR(control_reg, JCFW_BIT(0));
+        const uint8_t contr = jcfw_regmap_get(&dev->regs, JCFW_LTR303_REG_ALS_CONTR);
+
+        _jcfw_ltr303_regs_set_mode(&dev->regs, JCFW_LTR303_MODE_STANDBY);
+        err = jcfw_regmap_flush_reg(&dev->regs, JCFW_LTR303_REG_ALS_CONTR);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+        jcfw_regmap_set(&dev->regs, JCFW_LTR303_REG_ALS_CONTR, contr);
     }
 
-    err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, &control_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    // NOTE(Caleb): ALS_CONTR is a manual register, so it is not part of the flush and can be
+    // written last.
+    err = jcfw_regmap_flush(&dev->regs);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    return JCFW_RESULT_OK;
+    return jcfw_regmap_flush_reg(&dev->regs, JCFW_LTR303_REG_ALS_CONTR);
+}
+
+jcfw_result_e jcfw_ltr303_set_mode(jcfw_ltr303_t *dev, jcfw_ltr303_mode_e mode)
+{
+    JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
+
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    _jcfw_ltr303_regs_set_mode(&dev->regs, mode);
+    return jcfw_regmap_flush_reg(&dev->regs, JCFW_LTR303_REG_ALS_CONTR);
 }
 
 jcfw_result_e jcfw_ltr303_get_mode(jcfw_ltr303_t *dev, jcfw_ltr303_mode_e *o_mode)
@@ -114,14 +196,10 @@ jcfw_result_e jcfw_ltr303_get_mode(jcfw_ltr303_t *dev, jcfw_ltr303_mode_e *o_mod
     JCFW_ERROR_IF_FALSE(
         o_mode, JCFW_RESULT_INVALID_ARGS, "No memory provided for required return values");
 
-    uint8_t reg         = JCFW_LTR303_REG_ALS_CONTR;
-    uint8_t control_reg = 0x00;
+    jcfw_result_e err = jcfw_regmap_read(&dev->regs, JCFW_LTR303_REG_ALS_CONTR, 1);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    jcfw_result_e err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &control_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
-
-    *o_mode = (control_reg & JCFW_BIT(0)) ? JCFW_LTR303_MODE_ACTIVE : JCFW_LTR303_MODE_STANDBY;
+    *o_mode = _jcfw_ltr303_regs_get_mode(&dev->regs);
     return JCFW_RESULT_OK;
 }
 
@@ -133,17 +211,11 @@ jcfw_result_e jcfw_ltr303_is_data_ready(jcfw_ltr303_t *dev, bool *o_is_data_read
 
     *o_is_data_ready = false;
 
-    uint8_t reg    = JCFW_LTR303_REG_ALS_STATUS;
-    uint8_t status = 0x00;
+    jcfw_result_e err = jcfw_regmap_read(&dev->regs, JCFW_LTR303_REG_ALS_STATUS, 1);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    jcfw_result_e err =
-        jcfw_platform_i2c_mstr_mem_read(dev->i2c_arg, &reg, 1, &status, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
-
-    if (status & JCFW_BIT(2) || status & JCFW_BIT(3)) // NEW/INT
-    {
-        *o_is_data_ready = true;
-    }
+    *o_is_data_ready = _jcfw_ltr303_regs_get_status_new_data(&dev->regs)
+                    || _jcfw_ltr303_regs_get_status_interrupt(&dev->regs);
 
     return JCFW_RESULT_OK;
 }
@@ -153,40 +225,37 @@ jcfw_result_e jcfw_ltr303_read(
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    // TODO(Caleb): May have to add a byteswap to make this function endianness-independent
-
-    jcfw_result_e err;
-    uint8_t       reg;
+    // NOTE(Caleb): ALS_STATUS directly follows the data registers, so the gain of the data comes
+    // along in the same burst read.
+    const uint8_t last =
+        (o_gain_factor) ? JCFW_LTR303_REG_ALS_STATUS : JCFW_LTR303_REG_ALS_DATA_CH0_1;
 
-    if (o_gain_factor)
-    {
-        reg            = JCFW_LTR303_REG_ALS_STATUS;
-        uint8_t status = 0x00;
+    jcfw_result_e err = jcfw_regmap_read(
+        &dev->regs, JCFW_LTR303_REG_ALS_DATA_CH1_0, last - JCFW_LTR303_REG_ALS_DATA_CH1_0 + 1);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-        jcfw_result_e err =
-            jcfw_platform_i2c_mstr_mem_read(dev->i2c_arg, &reg, 1, &status, 1, dev->i2c_timeout_ms);
-        JCFW_ERROR_IF_FALSE(
-            err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    const uint16_t channel0 = _jcfw_ltr303_get_u16(&dev->regs, JCFW_LTR303_REG_ALS_DATA_CH0_0);
+    const uint16_t channel1 = _jcfw_ltr303_get_u16(&dev->regs, JCFW_LTR303_REG_ALS_DATA_CH1_0);
 
-        jcfw_ltr303_gain_e gain = (status >> 4) & 0x07; // See datasheet page 21
-        *o_gain_factor          = S_GAIN_FACTORS[gain];
+    if (o_channel0_lux)
+    {
+        *o_channel0_lux = channel0;
     }
 
-    reg             = JCFW_LTR303_REG_ALS_DATA_CH1_0;
-    uint16_t data[] = {0x0000, 0x0000};
-
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, (uint8_t *)data, 4, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    if (o_channel1_lux)
+    {
+        *o_channel1_lux = channel1;
+    }
 
-    if (o_channel0_lux)
+    if (o_gain_factor)
     {
-        *o_channel0_lux = data[1];
+        *o_gain_factor = S_GAIN_FACTORS[_jcfw_ltr303_regs_get_status_gain(&dev->regs)];
     }
 
-    if (o_channel1_lux)
+    if (dev->is_window_enabled)
     {
-        *o_channel1_lux = data[0];
+        err = jcfw_ltr303_update_window(dev, channel0);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
     }
 
     return JCFW_RESULT_OK;
@@ -196,28 +265,11 @@ jcfw_result_e jcfw_ltr303_enable_interrupt(jcfw_ltr303_t *dev, bool enable)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    jcfw_result_e err;
-    uint8_t       reg           = JCFW_LTR303_REG_ALS_INTERRUPT;
-    uint8_t       interrupt_cfg = 0x00;
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &interrupt_cfg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
-
-    if (enable)
-    {
-        JCFW_BITSET(interrupt_cfg, JCFW_BIT(1));
-    }
-    else
-    {
-        JCFW_BITCLEAR(interrupt_cfg, JCFW_BIT(1));
-    }
-
-    err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, &interrupt_cfg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
-
-    return JCFW_RESULT_OK;
+    _jcfw_ltr303_regs_set_interrupt_enable(&dev->regs, enable);
+    return jcfw_regmap_flush(&dev->regs);
 }
 
 jcfw_result_e
@@ -225,139 +277,241 @@ jcfw_ltr303_set_interrupt_polarity(jcfw_ltr303_t *dev, jcfw_ltr303_interrupt_pol
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    jcfw_result_e err;
-    uint8_t       reg           = JCFW_LTR303_REG_ALS_INTERRUPT;
-    uint8_t       interrupt_cfg = 0x00;
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &interrupt_cfg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    _jcfw_ltr303_regs_set_interrupt_high(&dev->regs, polarity == JCFW_LTR303_INTR_POL_HIGH);
+    return jcfw_regmap_flush(&dev->regs);
+}
 
-    if (polarity == JCFW_LTR303_INTR_POL_HIGH)
-    {
-        JCFW_BITSET(interrupt_cfg, JCFW_BIT(2));
-    }
-    else
-    {
-        JCFW_BITCLEAR(interrupt_cfg, JCFW_BIT(2));
-    }
+jcfw_result_e jcfw_ltr303_set_gain(jcfw_ltr303_t *dev, jcfw_ltr303_gain_e gain)
+{
+    JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, &interrupt_cfg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    return JCFW_RESULT_OK;
+    _jcfw_ltr303_regs_set_gain(&dev->regs, gain);
+    return jcfw_regmap_flush_reg(&dev->regs, JCFW_LTR303_REG_ALS_CONTR);
 }
 
-jcfw_result_e jcfw_ltr303_set_gain(jcfw_ltr303_t *dev, jcfw_ltr303_gain_e gain)
+jcfw_result_e jcfw_ltr303_set_integration_time(
+    jcfw_ltr303_t *dev, jcfw_ltr303_integration_time_e integration_time)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    jcfw_result_e err;
-    uint8_t       reg         = JCFW_LTR303_REG_ALS_CONTR;
-    uint8_t       control_reg = 0x00;
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &control_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    _jcfw_ltr303_regs_set_integration_time(&dev->regs, integration_time);
+    return jcfw_regmap_flush(&dev->regs);
+}
 
-    JCFW_BITCLEAR(control_reg, 0x1C /* 0b00011100 */);
-    JCFW_BITSET(control_reg, (uint8_t)gain << 2);
+jcfw_result_e jcfw_ltr303_set_measurement_rate(
+    jcfw_ltr303_t *dev, jcfw_ltr303_measurement_rate_e measurement_rate)
+{
+    JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, &control_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    return JCFW_RESULT_OK;
+    _jcfw_ltr303_regs_set_measurement_rate(&dev->regs, measurement_rate);
+    return jcfw_regmap_flush(&dev->regs);
 }
 
-jcfw_result_e jcfw_ltr303_set_integration_time(
-    jcfw_ltr303_t *dev, jcfw_ltr303_integration_time_e integration_time)
+jcfw_result_e jcfw_ltr303_set_thresholds(
+    jcfw_ltr303_t *dev, const uint16_t *threshold_low, const uint16_t *threshold_high)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    jcfw_result_e err;
-    uint8_t       reg           = JCFW_LTR303_REG_ALS_MEAS_RATE;
-    uint8_t       meas_rate_reg = 0x00;
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &meas_rate_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    if (threshold_low)
+    {
+        _jcfw_ltr303_stage_u16(&dev->regs, JCFW_LTR303_REG_ALS_THRES_LOW_0, *threshold_low);
+    }
 
-    JCFW_BITCLEAR(meas_rate_reg, 0x38 /* 0b00111000 */);
-    JCFW_BITSET(meas_rate_reg, (uint8_t)integration_time << 3);
+    if (threshold_high)
+    {
+        _jcfw_ltr303_stage_u16(&dev->regs, JCFW_LTR303_REG_ALS_THRES_UP_0, *threshold_high);
+    }
 
-    err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, &meas_rate_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    // NOTE(Caleb): The threshold registers are adjacent, so changing both takes one transaction
+    return jcfw_regmap_flush(&dev->regs);
+}
 
-    return JCFW_RESULT_OK;
+jcfw_result_e jcfw_ltr303_set_persistance(jcfw_ltr303_t *dev, size_t persistance)
+{
+    JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
+
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    _jcfw_ltr303_regs_set_persistance(&dev->regs, JCFW_MIN(persistance, 15));
+    return jcfw_regmap_flush(&dev->regs);
 }
 
-jcfw_result_e jcfw_ltr303_set_measurement_rate(
-    jcfw_ltr303_t *dev, jcfw_ltr303_measurement_rate_e measurement_rate)
+jcfw_result_e
+jcfw_ltr303_enable_adaptive_window(jcfw_ltr303_t *dev, const jcfw_ltr303_window_config_t *cfg)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
 
-    jcfw_result_e err;
-    uint8_t       reg           = JCFW_LTR303_REG_ALS_MEAS_RATE;
-    uint8_t       meas_rate_reg = 0x00;
+    if (!cfg)
+    {
+        dev->is_window_enabled = false;
+        return JCFW_RESULT_OK;
+    }
 
-    err = jcfw_platform_i2c_mstr_mem_read(
-        dev->i2c_arg, &reg, 1, &meas_rate_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+    JCFW_ERROR_IF_FALSE(
+        cfg->deadband_percent <= 100,
+        JCFW_RESULT_INVALID_ARGS,
+        "Invalid deadband percentage %u",
+        cfg->deadband_percent);
 
-    JCFW_BITCLEAR(meas_rate_reg, 0x07 /* 0b00000111 */);
-    JCFW_BITSET(meas_rate_reg, (uint8_t)measurement_rate << 3);
+    jcfw_result_e err = jcfw_ltr303_set_persistance(dev, cfg->persistance);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, &meas_rate_reg, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    dev->window            = *cfg;
+    dev->is_window_enabled = true;
 
     return JCFW_RESULT_OK;
 }
 
-jcfw_result_e jcfw_ltr303_set_thresholds(
-    jcfw_ltr303_t *dev, const uint16_t *threshold_low, const uint16_t *threshold_high)
+jcfw_result_e jcfw_ltr303_update_window(jcfw_ltr303_t *dev, uint16_t channel0)
 {
     JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
+    JCFW_ERROR_IF_FALSE(
+        dev->is_window_enabled, JCFW_RESULT_NOT_INITIALIZED, "Adaptive window is not enabled");
 
-    // TODO(Caleb): May have to add a byteswap to make this function endianness-independent
+    // NOTE(Caleb): Only does anything after a failed write, which leaves the shadow invalid; The
+    // registers are read back once so that later updates go back to writing only what moved.
+    jcfw_result_e err = _jcfw_ltr303_sync(dev);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
 
-    jcfw_result_e err;
-    uint8_t       reg;
+    uint32_t deadband = ((uint32_t)channel0 * dev->window.deadband_percent) / 100;
+    deadband          = JCFW_MAX(deadband, dev->window.deadband_abs);
 
-    if (threshold_low)
+    uint16_t threshold_low  = (channel0 > deadband) ? channel0 - deadband : 0x0000;
+    uint16_t threshold_high = JCFW_MIN((uint32_t)channel0 + deadband, 0xFFFF);
+
+    _jcfw_ltr303_stage_u16(&dev->regs, JCFW_LTR303_REG_ALS_THRES_UP_0, threshold_high);
+    _jcfw_ltr303_stage_u16(&dev->regs, JCFW_LTR303_REG_ALS_THRES_LOW_0, threshold_low);
+
+    // NOTE(Caleb): Only the span of bytes which actually moved is written.
+    uint8_t first = JCFW_LTR303_REG_ALS_THRES_UP_0;
+    uint8_t last  = JCFW_LTR303_REG_ALS_THRES_LOW_1;
+
+    while (first <= last && !jcfw_regmap_is_dirty(&dev->regs, first))
     {
-        reg = JCFW_LTR303_REG_ALS_THRES_LOW_0;
-        err = jcfw_platform_i2c_mstr_mem_write(
-            dev->i2c_arg, &reg, 1, (uint8_t *)threshold_low, 2, dev->i2c_timeout_ms);
-        JCFW_ERROR_IF_FALSE(
-            err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+        first++;
     }
 
-    if (threshold_high)
+    JCFW_RETURN_IF_TRUE(first > last, JCFW_RESULT_OK);
+
+    while (!jcfw_regmap_is_dirty(&dev->regs, last))
     {
-        reg = JCFW_LTR303_REG_ALS_THRES_UP_0;
-        err = jcfw_platform_i2c_mstr_mem_write(
-            dev->i2c_arg, &reg, 1, (uint8_t *)threshold_high, 2, dev->i2c_timeout_ms);
-        JCFW_ERROR_IF_FALSE(
-            err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+        last--;
     }
 
-    return JCFW_RESULT_OK;
+    return _jcfw_ltr303_write_async(
+        dev, first, &dev->staged[first - JCFW_LTR303_SHADOW_BASE], last - first + 1);
 }
 
-jcfw_result_e jcfw_ltr303_set_persistance(jcfw_ltr303_t *dev, size_t persistance)
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_ltr303_sync(jcfw_ltr303_t *dev)
 {
-    JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
+    // NOTE(Caleb): A failed asynchronous write is only recorded by the I2C worker task; The shadow
+    // belongs to this task, so this is where it gets invalidated.
+    if (dev->is_async_write_failed)
+    {
+        dev->is_async_write_failed = false;
+        jcfw_regmap_invalidate(&dev->regs);
+    }
+
+    return jcfw_regmap_sync(&dev->regs);
+}
 
-    uint8_t reg = JCFW_LTR303_REG_ALS_INTERRUPT_PERSIST;
-    persistance = JCFW_CLAMP(persistance, 0, 15);
+static jcfw_result_e
+_jcfw_ltr303_write_async(jcfw_ltr303_t *dev, uint8_t reg, const uint8_t *data, size_t size)
+{
+    jcfw_i2c_xfer_t *xfer = &dev->async_xfer;
 
-    jcfw_result_e err = jcfw_platform_i2c_mstr_mem_write(
-        dev->i2c_arg, &reg, 1, (uint8_t *)&persistance, 1, dev->i2c_timeout_ms);
-    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+    // NOTE(Caleb): If the previous asynchronous write is still pending, fall back to a blocking
+    // write. Transactions execute in submission order, so it still lands after the previous one.
+    if (size > sizeof(dev->async_data) || xfer->state == JCFW_I2C_XFER_STATE_QUEUED
+        || xfer->state == JCFW_I2C_XFER_STATE_ACTIVE)
+    {
+        return jcfw_regmap_write(&dev->regs, reg, data, size);
+    }
 
+    dev->async_reg = reg;
+    memcpy(dev->async_data, data, size);
+
+    *xfer = (jcfw_i2c_xfer_t) {
+        .device        = dev->regs.i2c_arg,
+        .type          = JCFW_I2C_XFER_TYPE_WRITE,
+        .mem_addr      = &dev->async_reg,
+        .mem_addr_size = 1,
+        .data          = dev->async_data,
+        .data_size     = size,
+        .timeout_ms    = dev->regs.i2c_timeout_ms,
+        .callback      = _jcfw_ltr303_on_async_write_done,
+        .callback_arg  = dev,
+    };
+
+    jcfw_result_e err = jcfw_platform_i2c_submit(xfer);
+    if (err == JCFW_RESULT_FULL)
+    {
+        return jcfw_regmap_write(&dev->regs, reg, data, size);
+    }
+
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C submit failed (jcfw rc %u)", err);
+
+    jcfw_regmap_assume_written(&dev->regs, reg, dev->async_data, size);
     return JCFW_RESULT_OK;
 }
+
+static void _jcfw_ltr303_on_async_write_done(
+    jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg)
+{
+    jcfw_ltr303_t *dev = arg;
+
+    // NOTE(Caleb): The shadow was updated optimistically on submission. If the write failed, the
+    // shadow no longer matches the device, so the registers are read back on the next operation.
+    if (result != JCFW_RESULT_OK)
+    {
+        dev->is_async_write_failed = true;
+    }
+}
+
+static void _jcfw_ltr303_stage_config(jcfw_regmap_t *map, const jcfw_ltr303_config_t *cfg)
+{
+    _jcfw_ltr303_regs_set_mode(map, cfg->mode);
+    _jcfw_ltr303_regs_set_sw_reset(map, false);
+    _jcfw_ltr303_regs_set_gain(map, cfg->gain);
+
+    _jcfw_ltr303_regs_set_integration_time(map, cfg->integration_time);
+    _jcfw_ltr303_regs_set_measurement_rate(map, cfg->measurement_rate);
+
+    _jcfw_ltr303_regs_set_interrupt_enable(map, cfg->interrupt_enable);
+    _jcfw_ltr303_regs_set_interrupt_high(map, cfg->interrupt_polarity == JCFW_LTR303_INTR_POL_HIGH);
+
+    _jcfw_ltr303_stage_u16(map, JCFW_LTR303_REG_ALS_THRES_UP_0, cfg->threshold_high);
+    _jcfw_ltr303_stage_u16(map, JCFW_LTR303_REG_ALS_THRES_LOW_0, cfg->threshold_low);
+
+    _jcfw_ltr303_regs_set_persistance(map, JCFW_MIN(cfg->persistance, 15));
+}
+
+static void _jcfw_ltr303_stage_u16(jcfw_regmap_t *map, uint8_t reg, uint16_t value)
+{
+    // NOTE(Caleb): 16-bit values are stored LSB first
+    jcfw_regmap_set(map, reg, value & 0xFF);
+    jcfw_regmap_set(map, reg + 1, value >> 8);
+}
+
+static uint16_t _jcfw_ltr303_get_u16(const jcfw_regmap_t *map, uint8_t reg)
+{
+    return (uint16_t)jcfw_regmap_get(map, reg) | ((uint16_t)jcfw_regmap_get(map, reg + 1) << 8);
+}
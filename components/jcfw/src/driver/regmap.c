@@ -0,0 +1,202 @@
+#include "jcfw/driver/regmap.h"
+
+#include "jcfw/platform/platform.h"
+
+// -------------------------------------------------------------------------------------------------
+
+static bool _jcfw_regmap_is_flushable(const jcfw_regmap_reg_t *reg);
+
+// -------------------------------------------------------------------------------------------------
+
+void jcfw_regmap_init(
+    jcfw_regmap_t            *map,
+    const jcfw_regmap_desc_t *desc,
+    uint8_t                  *shadow,
+    uint8_t                  *staged,
+    void                     *i2c_arg,
+    uint32_t                  i2c_timeout_ms)
+{
+    JCFW_ASSERT(map && desc && shadow && staged, "Invalid register map");
+
+    for (size_t i = 0; i < desc->reg_count; i++)
+    {
+        JCFW_ASSERT(
+            desc->regs[i].addr >= desc->base && desc->regs[i].addr - desc->base < desc->size,
+            "Register 0x%02x is outside of the map",
+            desc->regs[i].addr);
+        JCFW_ASSERT(
+            i == 0 || desc->regs[i].addr > desc->regs[i - 1].addr,
+            "Registers must be in ascending address order (0x%02x)",
+            desc->regs[i].addr);
+    }
+
+    map->desc            = desc;
+    map->i2c_arg         = i2c_arg;
+    map->i2c_timeout_ms  = i2c_timeout_ms;
+    map->shadow          = shadow;
+    map->staged          = staged;
+    map->is_shadow_valid = false;
+}
+
+void jcfw_regmap_load_reset(jcfw_regmap_t *map)
+{
+    memset(map->shadow, 0x00, map->desc->size);
+
+    for (size_t i = 0; i < map->desc->reg_count; i++)
+    {
+        const jcfw_regmap_reg_t *reg = &map->desc->regs[i];
+        map->shadow[reg->addr - map->desc->base] = reg->reset;
+    }
+
+    memcpy(map->staged, map->shadow, map->desc->size);
+    map->is_shadow_valid = true;
+}
+
+jcfw_result_e jcfw_regmap_sync(jcfw_regmap_t *map)
+{
+    JCFW_RETURN_IF_TRUE(map->is_shadow_valid, JCFW_RESULT_OK);
+
+    const jcfw_regmap_desc_t *desc = map->desc;
+
+    // NOTE(Caleb): Reading over a few undescribed registers is harmless, and much cheaper than
+    // starting another transaction.
+    size_t i = 0;
+    while (i < desc->reg_count)
+    {
+        const uint8_t start = desc->regs[i].addr;
+        uint8_t       end   = start;
+
+        for (i++; i < desc->reg_count && desc->regs[i].addr - end - 1 <= JCFW_REGMAP_READ_GAP_MAX;
+             i++)
+        {
+            end = desc->regs[i].addr;
+        }
+
+        jcfw_result_e err = jcfw_regmap_read(map, start, end - start + 1);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+    }
+
+    map->is_shadow_valid = true;
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_regmap_read(jcfw_regmap_t *map, uint8_t addr, size_t count)
+{
+    const size_t idx = addr - map->desc->base;
+    JCFW_ERROR_IF_FALSE(
+        addr >= map->desc->base && idx + count <= map->desc->size,
+        JCFW_RESULT_OUT_OF_BOUNDS,
+        "Registers 0x%02x + %u are outside of the map",
+        addr,
+        (unsigned)count);
+
+    jcfw_result_e err = jcfw_platform_i2c_mstr_mem_read(
+        map->i2c_arg, &addr, 1, &map->shadow[idx], count, map->i2c_timeout_ms);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C read operation failed (jcfw rc %u)", err);
+
+    memcpy(&map->staged[idx], &map->shadow[idx], count);
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e
+jcfw_regmap_write(jcfw_regmap_t *map, uint8_t addr, const uint8_t *data, size_t count)
+{
+    const size_t idx = addr - map->desc->base;
+    JCFW_ERROR_IF_FALSE(
+        addr >= map->desc->base && idx + count <= map->desc->size,
+        JCFW_RESULT_OUT_OF_BOUNDS,
+        "Registers 0x%02x + %u are outside of the map",
+        addr,
+        (unsigned)count);
+
+    jcfw_result_e err = jcfw_platform_i2c_mstr_mem_write(
+        map->i2c_arg, &addr, 1, data, count, map->i2c_timeout_ms);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "I2C write operation failed (jcfw rc %u)", err);
+
+    jcfw_regmap_assume_written(map, addr, data, count);
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_regmap_assume_written(
+    jcfw_regmap_t *map, uint8_t addr, const uint8_t *data, size_t count)
+{
+    const size_t idx = addr - map->desc->base;
+    JCFW_ASSERT(
+        addr >= map->desc->base && idx + count <= map->desc->size,
+        "Registers 0x%02x + %u are outside of the map",
+        addr,
+        (unsigned)count);
+
+    // NOTE(Caleb): `data` may point into the staged copy (see: jcfw_regmap_flush()).
+    memmove(&map->shadow[idx], data, count);
+    memmove(&map->staged[idx], data, count);
+}
+
+jcfw_result_e jcfw_regmap_flush(jcfw_regmap_t *map)
+{
+    const jcfw_regmap_desc_t *desc = map->desc;
+
+    // NOTE(Caleb): Without a valid shadow, every flushable register is written, after which the
+    // shadow matches the device again; Unless there are manual registers, which the flush can't
+    // vouch for.
+    bool is_full_write = !map->is_shadow_valid;
+
+    size_t i = 0;
+    while (i < desc->reg_count)
+    {
+        const jcfw_regmap_reg_t *first = &desc->regs[i];
+        if (first->flags & JCFW_REGMAP_FLAG_MANUAL)
+        {
+            is_full_write = false;
+        }
+
+        if (!_jcfw_regmap_is_flushable(first) || !jcfw_regmap_is_dirty(map, first->addr))
+        {
+            i++;
+            continue;
+        }
+
+        // Extend the write over the following adjacent, flushable registers, up to the last one
+        // which has changed.
+        size_t run_len = 1;
+        for (size_t j = i + 1; j < desc->reg_count && desc->regs[j].addr == first->addr + (j - i)
+                               && _jcfw_regmap_is_flushable(&desc->regs[j]);
+             j++)
+        {
+            if (jcfw_regmap_is_dirty(map, desc->regs[j].addr))
+            {
+                run_len = j - i + 1;
+            }
+        }
+
+        jcfw_result_e err = jcfw_regmap_write(
+            map, first->addr, &map->staged[first->addr - desc->base], run_len);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+        i += run_len;
+    }
+
+    if (is_full_write)
+    {
+        map->is_shadow_valid = true;
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_regmap_flush_reg(jcfw_regmap_t *map, uint8_t addr)
+{
+    JCFW_RETURN_IF_FALSE(jcfw_regmap_is_dirty(map, addr), JCFW_RESULT_OK);
+
+    return jcfw_regmap_write(map, addr, &map->staged[addr - map->desc->base], 1);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool _jcfw_regmap_is_flushable(const jcfw_regmap_reg_t *reg)
+{
+    const uint8_t skip_flags =
+        JCFW_REGMAP_FLAG_READ_ONLY | JCFW_REGMAP_FLAG_VOLATILE | JCFW_REGMAP_FLAG_MANUAL;
+
+    return (reg->flags & skip_flags) == 0;
+}
@@ -0,0 +1,218 @@
+#include "jcfw/net/endpoint.h"
+
+#include <math.h>
+
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+
+#define TRACE_TAG "JCFW-NET"
+
+// -------------------------------------------------------------------------------------------------
+
+static float _jcfw_endpoint_get_score(uint32_t key, const jcfw_endpoint_config_t *config);
+static void  _jcfw_endpoint_set_mark_down(jcfw_endpoint_set_t *set, uint32_t index);
+static void  _jcfw_endpoint_set_update_active(jcfw_endpoint_set_t *set);
+
+static inline uint64_t _jcfw_endpoint_mix(uint64_t value)
+{
+    // NOTE(Caleb): The splitmix64 finalizer; Every bit of the input flips about half of the output.
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ULL;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBULL;
+    value ^= value >> 31;
+    return value;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e
+jcfw_endpoint_set_init(jcfw_endpoint_set_t *set, const jcfw_endpoint_set_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(set && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        config->endpoints && config->endpoint_count > 0
+            && config->endpoint_count <= JCFW_ENDPOINT_COUNT_MAX,
+        JCFW_RESULT_INVALID_ARGS,
+        "Invalid endpoints");
+    JCFW_ERROR_IF_FALSE(
+        config->probe_cb && config->probe_period_ms > 0,
+        JCFW_RESULT_INVALID_ARGS,
+        "Invalid probe configuration");
+
+    memset(set, 0x00, sizeof(*set));
+    set->config = *config;
+
+    float scores[JCFW_ENDPOINT_COUNT_MAX];
+    for (uint32_t i = 0; i < config->endpoint_count; i++)
+    {
+        set->endpoints[i].config = config->endpoints[i];
+        set->endpoints[i].is_up  = true;
+        scores[i]                = _jcfw_endpoint_get_score(config->key, &config->endpoints[i]);
+
+        // NOTE(Caleb): Insertion sort, best score first; Ties go to the lower index.
+        uint32_t rank = i;
+        while (rank > 0 && scores[set->ranking[rank - 1]] < scores[i])
+        {
+            set->ranking[rank] = set->ranking[rank - 1];
+            rank--;
+        }
+        set->ranking[rank] = i;
+    }
+
+    set->active = set->ranking[0];
+
+    return JCFW_RESULT_OK;
+}
+
+uint32_t jcfw_endpoint_set_get_active(const jcfw_endpoint_set_t *set)
+{
+    JCFW_RETURN_IF_FALSE(set, JCFW_ENDPOINT_NONE);
+    return set->active;
+}
+
+const jcfw_endpoint_t *jcfw_endpoint_set_get(const jcfw_endpoint_set_t *set, uint32_t index)
+{
+    JCFW_RETURN_IF_FALSE(set && index < set->config.endpoint_count, NULL);
+    return &set->endpoints[index];
+}
+
+uint32_t jcfw_endpoint_set_get_rank(const jcfw_endpoint_set_t *set, uint32_t index)
+{
+    JCFW_RETURN_IF_FALSE(set, JCFW_ENDPOINT_NONE);
+
+    for (uint32_t rank = 0; rank < set->config.endpoint_count; rank++)
+    {
+        if (set->ranking[rank] == index)
+        {
+            return rank;
+        }
+    }
+
+    return JCFW_ENDPOINT_NONE;
+}
+
+void jcfw_endpoint_set_on_heard(jcfw_endpoint_set_t *set, uint32_t index, uint64_t now_us)
+{
+    JCFW_RETURN_IF_FALSE(set && index < set->config.endpoint_count);
+
+    jcfw_endpoint_t *endpoint = &set->endpoints[index];
+    endpoint->has_been_heard  = true;
+    endpoint->heard_us        = now_us;
+    endpoint->miss_count      = 0;
+    JCFW_RETURN_IF_TRUE(endpoint->is_up);
+
+    endpoint->is_up = true;
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "Endpoint " JCFW_NET_ADDRESS_FORMAT " is up",
+        JCFW_NET_ADDRESS_ARGS(&endpoint->config.address));
+
+    _jcfw_endpoint_set_update_active(set);
+}
+
+void jcfw_endpoint_set_on_timeout(jcfw_endpoint_set_t *set, uint32_t index, uint64_t sent_us)
+{
+    JCFW_RETURN_IF_FALSE(set && index < set->config.endpoint_count);
+
+    // NOTE(Caleb): Anything heard since the send means the endpoint is alive, and only that one
+    // datagram was lost.
+    const jcfw_endpoint_t *endpoint = &set->endpoints[index];
+    JCFW_RETURN_IF_FALSE(endpoint->is_up);
+    JCFW_RETURN_IF_TRUE(endpoint->has_been_heard && endpoint->heard_us >= sent_us);
+
+    _jcfw_endpoint_set_mark_down(set, index);
+    _jcfw_endpoint_set_update_active(set);
+}
+
+void jcfw_endpoint_set_poll(jcfw_endpoint_set_t *set, uint64_t now_us)
+{
+    JCFW_RETURN_IF_FALSE(set);
+    JCFW_RETURN_IF_TRUE(
+        set->has_probed
+        && now_us - set->probed_us < (uint64_t)set->config.probe_period_ms * 1000);
+
+    set->has_probed = true;
+    set->probed_us  = now_us;
+
+    for (uint32_t i = 0; i < set->config.endpoint_count; i++)
+    {
+        jcfw_endpoint_t *endpoint = &set->endpoints[i];
+        if (endpoint->has_been_probed
+            && (!endpoint->has_been_heard || endpoint->heard_us < endpoint->probed_us))
+        {
+            endpoint->miss_count++;
+            if (endpoint->is_up && endpoint->miss_count >= JCFW_ENDPOINT_PROBE_MISS_MAX)
+            {
+                _jcfw_endpoint_set_mark_down(set, i);
+            }
+        }
+
+        endpoint->has_been_probed = true;
+        endpoint->probed_us       = now_us;
+        set->stats.probe_count++;
+        set->config.probe_cb(i, set->config.cb_arg);
+    }
+
+    _jcfw_endpoint_set_update_active(set);
+}
+
+void jcfw_endpoint_set_get_stats(const jcfw_endpoint_set_t *set, jcfw_endpoint_stats_t *o_stats)
+{
+    *o_stats = set->stats;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static float _jcfw_endpoint_get_score(uint32_t key, const jcfw_endpoint_config_t *config)
+{
+    JCFW_RETURN_IF_TRUE(config->weight == 0, 0.0f);
+
+    // NOTE(Caleb): Weighted rendezvous hashing: Hash the client and the endpoint to u in (0, 1);
+    // -w / ln(u) is then the largest of all endpoints' with probability w / (sum of all w), and
+    // stays put for a given client and endpoint no matter which other endpoints there are.
+    const uint64_t endpoint = ((uint64_t)config->address.ip[0] << 40)
+                              | ((uint64_t)config->address.ip[1] << 32)
+                              | ((uint64_t)config->address.ip[2] << 24)
+                              | ((uint64_t)config->address.ip[3] << 16) | config->address.port;
+    const uint64_t hash = _jcfw_endpoint_mix(_jcfw_endpoint_mix(key) ^ endpoint);
+    const float    u    = ((float)(hash >> 40) + 0.5f) / (float)(1 << 24);
+
+    return -(float)config->weight / logf(u);
+}
+
+static void _jcfw_endpoint_set_mark_down(jcfw_endpoint_set_t *set, uint32_t index)
+{
+    jcfw_endpoint_t *endpoint = &set->endpoints[index];
+    endpoint->is_up           = false;
+    endpoint->down_count++;
+
+    JCFW_TRACELN_WARN(
+        TRACE_TAG,
+        "Endpoint " JCFW_NET_ADDRESS_FORMAT " is down",
+        JCFW_NET_ADDRESS_ARGS(&endpoint->config.address));
+}
+
+static void _jcfw_endpoint_set_update_active(jcfw_endpoint_set_t *set)
+{
+    uint32_t active = JCFW_ENDPOINT_NONE;
+    for (uint32_t rank = 0; rank < set->config.endpoint_count; rank++)
+    {
+        if (set->endpoints[set->ranking[rank]].is_up)
+        {
+            active = set->ranking[rank];
+            break;
+        }
+    }
+
+    JCFW_RETURN_IF_TRUE(active == set->active);
+
+    const uint32_t from = set->active;
+    set->active         = active;
+    set->stats.change_count++;
+
+    if (set->config.change_cb)
+    {
+        set->config.change_cb(from, active, set->config.cb_arg);
+    }
+}
@@ -0,0 +1,378 @@
+#include "jcfw/net/rdp.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
+
+#define _JCFW_RDP_SACK_BIT_COUNT 32
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_rdp_sender_transmit(jcfw_rdp_sender_t *sender, uint32_t seq, uint64_t now_us);
+static bool _jcfw_rdp_sender_is_acked(uint32_t seq, uint32_t cumulative_ack, uint32_t sack_bits);
+static void _jcfw_rdp_sender_on_rtt(jcfw_rdp_sender_t *sender, uint32_t rtt_us);
+static void _jcfw_rdp_sender_slide(jcfw_rdp_sender_t *sender);
+
+static void _jcfw_rdp_receiver_advance(jcfw_rdp_receiver_t *receiver);
+static void _jcfw_rdp_receiver_send_ack(jcfw_rdp_receiver_t *receiver);
+
+static inline jcfw_rdp_slot_t *_jcfw_rdp_sender_get_slot(jcfw_rdp_sender_t *sender, uint32_t seq)
+{
+    return &sender->slots[seq % JCFW_RDP_WINDOW_SIZE];
+}
+
+// SENDER ------------------------------------------------------------------------------------------
+
+jcfw_result_e
+jcfw_rdp_sender_init(jcfw_rdp_sender_t *sender, const jcfw_rdp_sender_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(sender && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(config->send_cb, JCFW_RESULT_INVALID_ARGS, "No send callback provided");
+
+    memset(sender, 0x00, sizeof(*sender));
+    sender->config = *config;
+    sender->rto_us = JCFW_RDP_RTO_INITIAL_MS * 1000;
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_rdp_sender_send(
+    jcfw_rdp_sender_t *sender, const void *payload, size_t length, uint64_t now_us)
+{
+    JCFW_ERROR_IF_FALSE(sender && payload, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        length <= JCFW_RDP_PAYLOAD_SIZE_MAX, JCFW_RESULT_INVALID_ARGS, "Payload too large");
+    JCFW_RETURN_IF_TRUE(
+        jcfw_rdp_sender_get_in_flight(sender) >= JCFW_RDP_WINDOW_SIZE, JCFW_RESULT_FULL);
+
+    const uint32_t   seq  = sender->next_seq++;
+    jcfw_rdp_slot_t *slot = _jcfw_rdp_sender_get_slot(sender, seq);
+
+    slot->is_in_flight          = true;
+    slot->is_fast_retransmitted = false;
+    slot->retransmit_count      = 0;
+    slot->length                = JCFW_RDP_DATA_HEADER_SIZE + length;
+
+    slot->datagram[0] = JCFW_RDP_TYPE_DATA;
+    slot->datagram[1] = 0;
+    JCFW_PUT_LE(&slot->datagram[2], sender->config.session, sizeof(uint32_t));
+    JCFW_PUT_LE(&slot->datagram[6], seq, sizeof(uint32_t));
+    memcpy(&slot->datagram[JCFW_RDP_DATA_HEADER_SIZE], payload, length);
+
+    sender->stats.datagram_count++;
+    _jcfw_rdp_sender_transmit(sender, seq, now_us);
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_rdp_sender_on_receive(
+    jcfw_rdp_sender_t *sender, const uint8_t *datagram, size_t length, uint64_t now_us)
+{
+    JCFW_ERROR_IF_FALSE(sender && datagram, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_FALSE(length == JCFW_RDP_ACK_SIZE, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(datagram[0] == JCFW_RDP_TYPE_ACK, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(
+        JCFW_GET_LE(&datagram[2], sizeof(uint32_t)) == sender->config.session, JCFW_RESULT_ERROR);
+
+    const uint32_t cumulative_ack = JCFW_GET_LE(&datagram[6], sizeof(uint32_t));
+    const uint32_t sack_bits      = JCFW_GET_LE(&datagram[10], sizeof(uint32_t));
+
+    sender->stats.ack_count++;
+
+    // NOTE(Caleb): Retire everything in the window which this ACK covers. Karn's rule: only
+    // datagrams which were sent once give an unambiguous round trip time.
+    uint32_t highest_acked = 0;
+    bool     has_acked     = false;
+    for (uint32_t seq = sender->base_seq; seq != sender->next_seq; seq++)
+    {
+        jcfw_rdp_slot_t *slot = _jcfw_rdp_sender_get_slot(sender, seq);
+        if (!_jcfw_rdp_sender_is_acked(seq, cumulative_ack, sack_bits))
+        {
+            continue;
+        }
+
+        highest_acked = seq;
+        has_acked     = true;
+        if (!slot->is_in_flight)
+        {
+            continue;
+        }
+
+        if (slot->retransmit_count == 0)
+        {
+            _jcfw_rdp_sender_on_rtt(sender, (uint32_t)(now_us - slot->sent_us));
+        }
+
+        slot->is_in_flight = false;
+    }
+
+    // NOTE(Caleb): A datagram which enough later datagrams overtook was most likely lost, so resend
+    // it now rather than waiting out the RTO. Only once, though; After that the timer takes over.
+    if (has_acked)
+    {
+        for (uint32_t seq = sender->base_seq; seq != highest_acked; seq++)
+        {
+            jcfw_rdp_slot_t *slot = _jcfw_rdp_sender_get_slot(sender, seq);
+            if (!slot->is_in_flight || slot->is_fast_retransmitted)
+            {
+                continue;
+            }
+
+            uint32_t overtaken_count = 0;
+            for (uint32_t later = seq + 1; later != highest_acked + 1; later++)
+            {
+                overtaken_count += !_jcfw_rdp_sender_get_slot(sender, later)->is_in_flight;
+            }
+
+            if (overtaken_count >= JCFW_RDP_FAST_RETRANSMIT_COUNT)
+            {
+                slot->is_fast_retransmitted = true;
+                slot->retransmit_count++;
+                sender->stats.fast_retransmit_count++;
+                _jcfw_rdp_sender_transmit(sender, seq, now_us);
+            }
+        }
+    }
+
+    _jcfw_rdp_sender_slide(sender);
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_rdp_sender_poll(jcfw_rdp_sender_t *sender, uint64_t now_us)
+{
+    for (uint32_t seq = sender->base_seq; seq != sender->next_seq; seq++)
+    {
+        jcfw_rdp_slot_t *slot = _jcfw_rdp_sender_get_slot(sender, seq);
+        if (!slot->is_in_flight)
+        {
+            continue;
+        }
+
+        // NOTE(Caleb): Back off for each retransmit of this datagram, so that a dead collector
+        // isn't hammered; Other datagrams keep their own timers.
+        uint64_t timeout_us = (uint64_t)sender->rto_us << slot->retransmit_count;
+        timeout_us          = JCFW_MIN(timeout_us, (uint64_t)JCFW_RDP_RTO_MAX_MS * 1000);
+        if (now_us - slot->sent_us < timeout_us)
+        {
+            continue;
+        }
+
+        if (sender->config.timeout_cb)
+        {
+            sender->config.timeout_cb(slot->sent_us, sender->config.timeout_cb_arg);
+        }
+
+        if (slot->retransmit_count >= JCFW_RDP_RETRY_MAX)
+        {
+            slot->is_in_flight = false;
+            sender->stats.drop_count++;
+
+            if (sender->config.drop_cb)
+            {
+                sender->config.drop_cb(
+                    &slot->datagram[JCFW_RDP_DATA_HEADER_SIZE],
+                    slot->length - JCFW_RDP_DATA_HEADER_SIZE,
+                    sender->config.drop_cb_arg);
+            }
+
+            continue;
+        }
+
+        slot->retransmit_count++;
+        sender->stats.retransmit_count++;
+        _jcfw_rdp_sender_transmit(sender, seq, now_us);
+    }
+
+    _jcfw_rdp_sender_slide(sender);
+}
+
+void jcfw_rdp_sender_get_stats(const jcfw_rdp_sender_t *sender, jcfw_rdp_sender_stats_t *o_stats)
+{
+    *o_stats         = sender->stats;
+    o_stats->srtt_us = sender->srtt_us;
+    o_stats->rto_us  = sender->rto_us;
+}
+
+// RECEIVER ----------------------------------------------------------------------------------------
+
+jcfw_result_e
+jcfw_rdp_receiver_init(jcfw_rdp_receiver_t *receiver, const jcfw_rdp_receiver_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(receiver && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        config->deliver_cb && config->send_cb,
+        JCFW_RESULT_INVALID_ARGS,
+        "No deliver or send callback provided");
+
+    memset(receiver, 0x00, sizeof(*receiver));
+    receiver->config = *config;
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e
+jcfw_rdp_receiver_on_receive(jcfw_rdp_receiver_t *receiver, const uint8_t *datagram, size_t length)
+{
+    JCFW_ERROR_IF_FALSE(receiver && datagram, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_FALSE(length >= JCFW_RDP_DATA_HEADER_SIZE, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(datagram[0] == JCFW_RDP_TYPE_DATA, JCFW_RESULT_ERROR);
+
+    const uint32_t session = JCFW_GET_LE(&datagram[2], sizeof(uint32_t));
+    const uint32_t seq     = JCFW_GET_LE(&datagram[6], sizeof(uint32_t));
+
+    receiver->stats.datagram_count++;
+
+    if (!receiver->has_session || session != receiver->session)
+    {
+        receiver->has_session = true;
+        receiver->session     = session;
+        receiver->next_seq    = 0;
+        receiver->sack_bits   = 0;
+        receiver->stats.session_count++;
+    }
+
+    // NOTE(Caleb): The sender never has more than a window in flight, so a datagram beyond what the
+    // selective acks cover means that the ones before it were given up on (or that this receiver
+    // restarted mid-session). Skip ahead, counting whatever was never received as lost.
+    uint32_t offset = seq - receiver->next_seq;
+    if ((int32_t)offset > 2 * _JCFW_RDP_SACK_BIT_COUNT)
+    {
+        receiver->stats.lost_count += offset - __builtin_popcount(receiver->sack_bits);
+        receiver->next_seq  = seq;
+        receiver->sack_bits = 0;
+        offset              = 0;
+    }
+
+    while ((int32_t)offset > _JCFW_RDP_SACK_BIT_COUNT)
+    {
+        receiver->stats.lost_count++;
+        _jcfw_rdp_receiver_advance(receiver);
+        offset = seq - receiver->next_seq;
+    }
+
+    bool is_new = false;
+    if (offset == 0)
+    {
+        is_new = true;
+        _jcfw_rdp_receiver_advance(receiver);
+    }
+    else if ((int32_t)offset > 0)
+    {
+        const uint32_t bit = 1u << (offset - 1);
+
+        is_new = !(receiver->sack_bits & bit);
+        receiver->sack_bits |= bit;
+    }
+
+    if (is_new)
+    {
+        receiver->stats.delivered_count++;
+        receiver->config.deliver_cb(
+            &datagram[JCFW_RDP_DATA_HEADER_SIZE],
+            length - JCFW_RDP_DATA_HEADER_SIZE,
+            JCFW_GET_LE(&datagram[10], sizeof(uint64_t)),
+            receiver->config.deliver_cb_arg);
+    }
+    else
+    {
+        receiver->stats.duplicate_count++;
+    }
+
+    // NOTE(Caleb): Duplicates are acknowledged too; The sender resent because an ACK got lost.
+    _jcfw_rdp_receiver_send_ack(receiver);
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_rdp_receiver_get_stats(
+    const jcfw_rdp_receiver_t *receiver, jcfw_rdp_receiver_stats_t *o_stats)
+{
+    *o_stats = receiver->stats;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_rdp_sender_transmit(jcfw_rdp_sender_t *sender, uint32_t seq, uint64_t now_us)
+{
+    jcfw_rdp_slot_t *slot = _jcfw_rdp_sender_get_slot(sender, seq);
+    slot->sent_us         = now_us;
+
+    const uint64_t send_us = sender->config.stamp_cb
+                                 ? sender->config.stamp_cb(now_us, sender->config.stamp_cb_arg)
+                                 : now_us;
+    JCFW_PUT_LE(&slot->datagram[10], send_us, sizeof(uint64_t));
+
+    jcfw_result_e err =
+        sender->config.send_cb(slot->datagram, slot->length, sender->config.send_cb_arg);
+    if (err != JCFW_RESULT_OK)
+    {
+        sender->stats.send_failure_count++;
+    }
+}
+
+static bool _jcfw_rdp_sender_is_acked(uint32_t seq, uint32_t cumulative_ack, uint32_t sack_bits)
+{
+    JCFW_RETURN_IF_TRUE((int32_t)(cumulative_ack - seq) > 0, true);
+
+    const uint32_t offset = seq - cumulative_ack - 1;
+    return offset < _JCFW_RDP_SACK_BIT_COUNT && (sack_bits & (1u << offset));
+}
+
+static void _jcfw_rdp_sender_on_rtt(jcfw_rdp_sender_t *sender, uint32_t rtt_us)
+{
+    // NOTE(Caleb): RFC 6298, section 2, with alpha = 1/8 and beta = 1/4.
+    if (!sender->has_rtt)
+    {
+        sender->has_rtt   = true;
+        sender->srtt_us   = rtt_us;
+        sender->rttvar_us = rtt_us / 2;
+    }
+    else
+    {
+        const uint32_t error_us =
+            (sender->srtt_us > rtt_us) ? sender->srtt_us - rtt_us : rtt_us - sender->srtt_us;
+
+        sender->rttvar_us = sender->rttvar_us - (sender->rttvar_us / 4) + (error_us / 4);
+        sender->srtt_us   = sender->srtt_us - (sender->srtt_us / 8) + (rtt_us / 8);
+    }
+
+    const uint64_t rto_us = (uint64_t)sender->srtt_us + 4 * (uint64_t)sender->rttvar_us;
+    sender->rto_us        = JCFW_CLAMP(
+        rto_us, (uint64_t)JCFW_RDP_RTO_MIN_MS * 1000, (uint64_t)JCFW_RDP_RTO_MAX_MS * 1000);
+}
+
+/// @brief Move the window past the datagrams at its start which are no longer in flight.
+static void _jcfw_rdp_sender_slide(jcfw_rdp_sender_t *sender)
+{
+    while (sender->base_seq != sender->next_seq
+           && !_jcfw_rdp_sender_get_slot(sender, sender->base_seq)->is_in_flight)
+    {
+        sender->base_seq++;
+    }
+}
+
+/// @brief Move past `next_seq`, along with every datagram after it which has been received.
+static void _jcfw_rdp_receiver_advance(jcfw_rdp_receiver_t *receiver)
+{
+    // NOTE(Caleb): Bit i of `sack_bits` stands for `next_seq + 1 + i`, so once `next_seq` moves on,
+    // bit 0 stands for the new `next_seq` until the final shift.
+    receiver->next_seq++;
+    while (receiver->sack_bits & 1)
+    {
+        receiver->sack_bits >>= 1;
+        receiver->next_seq++;
+    }
+
+    receiver->sack_bits >>= 1;
+}
+
+static void _jcfw_rdp_receiver_send_ack(jcfw_rdp_receiver_t *receiver)
+{
+    uint8_t ack[JCFW_RDP_ACK_SIZE];
+    ack[0] = JCFW_RDP_TYPE_ACK;
+    ack[1] = 0;
+    JCFW_PUT_LE(&ack[2], receiver->session, sizeof(uint32_t));
+    JCFW_PUT_LE(&ack[6], receiver->next_seq, sizeof(uint32_t));
+    JCFW_PUT_LE(&ack[10], receiver->sack_bits, sizeof(uint32_t));
+
+    receiver->config.send_cb(ack, sizeof(ack), receiver->config.send_cb_arg);
+}
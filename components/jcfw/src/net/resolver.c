@@ -0,0 +1,154 @@
+#include "jcfw/net/resolver.h"
+
+#include "jcfw/detail/socket.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG "JCFW-NET"
+
+typedef struct
+{
+    char     host[JCFW_NET_HOST_LENGTH_MAX + 1];
+    uint8_t  ip[4];
+    bool     is_used;
+    uint64_t resolved_us;
+} _jcfw_net_resolver_entry_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static _jcfw_net_resolver_entry_t *_jcfw_net_resolver_find(const char *host);
+static _jcfw_net_resolver_entry_t *_jcfw_net_resolver_claim(const char *host);
+static jcfw_result_e               _jcfw_net_resolver_lookup(const char *host, uint8_t *o_ip);
+
+// -------------------------------------------------------------------------------------------------
+
+static _jcfw_net_resolver_entry_t s_jcfw_net_resolver_cache[JCFW_NET_RESOLVER_CACHE_SIZE];
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e
+jcfw_net_address_parse(const char *host, uint16_t port, jcfw_net_address_t *o_address)
+{
+    JCFW_ERROR_IF_FALSE(host && o_address, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    struct in_addr addr;
+    JCFW_RETURN_IF_FALSE(inet_pton(AF_INET, host, &addr) == 1, JCFW_RESULT_ERROR);
+
+    memcpy(o_address->ip, &addr, sizeof(o_address->ip));
+    o_address->port = port;
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_net_resolve(const char *host, uint16_t port, jcfw_net_address_t *o_address)
+{
+    JCFW_ERROR_IF_FALSE(host && o_address, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    JCFW_RETURN_IF_TRUE(
+        jcfw_net_address_parse(host, port, o_address) == JCFW_RESULT_OK, JCFW_RESULT_OK);
+
+    const uint64_t              now_us = jcfw_platform_get_time_us();
+    _jcfw_net_resolver_entry_t *entry  = _jcfw_net_resolver_find(host);
+    if (!entry || now_us - entry->resolved_us >= (uint64_t)JCFW_NET_RESOLVER_TTL_MS * 1000)
+    {
+        uint8_t       ip[4];
+        jcfw_result_e err = _jcfw_net_resolver_lookup(host, ip);
+        if (err == JCFW_RESULT_OK)
+        {
+            entry = entry ? entry : _jcfw_net_resolver_claim(host);
+            if (entry)
+            {
+                memcpy(entry->ip, ip, sizeof(entry->ip));
+                entry->resolved_us = now_us;
+            }
+
+            memcpy(o_address->ip, ip, sizeof(o_address->ip));
+            o_address->port = port;
+            return JCFW_RESULT_OK;
+        }
+
+        // NOTE(Caleb): The host most likely still lives where it did; An old address beats none.
+        JCFW_RETURN_IF_FALSE(entry, err);
+        JCFW_TRACELN_WARN(TRACE_TAG, "Unable to look up %s; Using its last address", host);
+    }
+
+    memcpy(o_address->ip, entry->ip, sizeof(o_address->ip));
+    o_address->port = port;
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_net_resolver_forget(const char *host)
+{
+    JCFW_RETURN_IF_FALSE(host);
+
+    _jcfw_net_resolver_entry_t *entry = _jcfw_net_resolver_find(host);
+    if (entry)
+    {
+        entry->is_used = false;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static _jcfw_net_resolver_entry_t *_jcfw_net_resolver_find(const char *host)
+{
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(s_jcfw_net_resolver_cache); i++)
+    {
+        _jcfw_net_resolver_entry_t *entry = &s_jcfw_net_resolver_cache[i];
+        if (entry->is_used && strcmp(entry->host, host) == 0)
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static _jcfw_net_resolver_entry_t *_jcfw_net_resolver_claim(const char *host)
+{
+    JCFW_ERROR_IF_TRUE(
+        strlen(host) > JCFW_NET_HOST_LENGTH_MAX, NULL, "Host name too long to cache: %s", host);
+
+    _jcfw_net_resolver_entry_t *oldest = &s_jcfw_net_resolver_cache[0];
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(s_jcfw_net_resolver_cache); i++)
+    {
+        _jcfw_net_resolver_entry_t *entry = &s_jcfw_net_resolver_cache[i];
+        if (!entry->is_used)
+        {
+            oldest = entry;
+            break;
+        }
+
+        if (entry->resolved_us < oldest->resolved_us)
+        {
+            oldest = entry;
+        }
+    }
+
+    strcpy(oldest->host, host);
+    oldest->is_used = true;
+
+    return oldest;
+}
+
+static jcfw_result_e _jcfw_net_resolver_lookup(const char *host, uint8_t *o_ip)
+{
+    struct addrinfo hints = {
+        .ai_family   = AF_INET,
+        .ai_socktype = SOCK_DGRAM,
+    };
+    struct addrinfo *result = NULL;
+
+    int rv = getaddrinfo(host, NULL, &hints, &result);
+    JCFW_ERROR_IF_FALSE(
+        rv == 0 && result, JCFW_RESULT_ERROR, "Unable to look up %s; rv %d", host, rv);
+
+    const struct sockaddr_in *addr = (const struct sockaddr_in *)result->ai_addr;
+    memcpy(o_ip, &addr->sin_addr, 4);
+    freeaddrinfo(result);
+
+    return JCFW_RESULT_OK;
+}
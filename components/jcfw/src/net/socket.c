@@ -0,0 +1,638 @@
+#include "jcfw/net/socket.h"
+
+#include "jcfw/detail/socket.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG                   "JCFW-NET"
+
+/// @brief Each queued UDP datagram is its length (u16, native order) followed by its data.
+#define _JCFW_NET_QUEUE_HEADER_SIZE 2
+
+/// @brief Marks the rest of the send buffer as unused; The next datagram is at its start.
+#define _JCFW_NET_QUEUE_WRAP        0xFFFF
+
+/// @brief The most datagrams (or chunks of a stream) read from one socket per poll, so that a busy
+/// socket can't keep the loop from the others.
+#define _JCFW_NET_RECEIVE_BURST_MAX 16
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_net_set_nonblocking(int fd);
+static jcfw_result_e _jcfw_net_socket_try_send(
+    jcfw_net_socket_t *sock, const uint8_t *data, size_t length, bool *o_should_wake);
+static bool _jcfw_net_socket_enqueue(jcfw_net_socket_t *sock, const uint8_t *data, size_t length);
+static bool _jcfw_net_socket_flush(jcfw_net_socket_t *sock, uint64_t now_us);
+static void _jcfw_net_socket_service(jcfw_net_socket_t *sock, bool is_writable, uint64_t now_us);
+static void _jcfw_net_socket_on_connect(jcfw_net_socket_t *sock);
+static void _jcfw_net_socket_receive(jcfw_net_socket_t *sock);
+static void _jcfw_net_socket_fail(jcfw_net_socket_t *sock);
+
+static inline bool _jcfw_net_socket_is_tcp(const jcfw_net_socket_t *sock)
+{
+    return sock->config.type == JCFW_NET_SOCKET_TYPE_TCP;
+}
+
+// LOOP --------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_net_loop_init(jcfw_net_loop_t *loop)
+{
+    JCFW_ERROR_IF_FALSE(loop, JCFW_RESULT_INVALID_ARGS, "No loop provided");
+
+    memset(loop, 0x00, sizeof(*loop));
+    loop->wake_fd = -1;
+
+    jcfw_result_e err = jcfw_mutex_create(&loop->lock);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "Unable to create the mutex of the loop");
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    JCFW_ERROR_IF_FALSE(fd >= 0, JCFW_RESULT_ERROR, "Unable to create a socket; errno %d", errno);
+
+    // NOTE(Caleb): Bind to an ephemeral loopback port, then connect the socket to itself.
+    struct sockaddr_in local = {
+        .sin_family      = AF_INET,
+        .sin_port        = 0,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t local_len = sizeof(local);
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) != 0
+        || getsockname(fd, (struct sockaddr *)&local, &local_len) != 0
+        || connect(fd, (struct sockaddr *)&local, local_len) != 0
+        || _jcfw_net_set_nonblocking(fd) != JCFW_RESULT_OK)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to set up the wake socket; errno %d", errno);
+        close(fd);
+        return JCFW_RESULT_ERROR;
+    }
+
+    loop->wake_fd = fd;
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_net_loop_poll(jcfw_net_loop_t *loop, uint32_t timeout_ms)
+{
+    JCFW_ERROR_IF_FALSE(loop, JCFW_RESULT_INVALID_ARGS, "No loop provided");
+    JCFW_ERROR_IF_FALSE(loop->wake_fd >= 0, JCFW_RESULT_NOT_INITIALIZED, "Loop not set up");
+
+    fd_set read_fds;
+    fd_set write_fds;
+    FD_ZERO(&read_fds);
+    FD_ZERO(&write_fds);
+    FD_SET(loop->wake_fd, &read_fds);
+    int fd_max = loop->wake_fd;
+
+    uint64_t now_us  = jcfw_platform_get_time_us();
+    uint64_t wait_us = (timeout_ms == JCFW_NET_WAIT_FOREVER) ? UINT64_MAX
+                                                             : (uint64_t)timeout_ms * 1000;
+
+    jcfw_mutex_lock(loop->lock);
+    for (jcfw_net_socket_t *sock = loop->sockets; sock; sock = sock->next)
+    {
+        FD_SET(sock->fd, &read_fds);
+        fd_max = JCFW_MAX(fd_max, sock->fd);
+
+        if (sock->state == JCFW_NET_SOCKET_STATE_CONNECTING
+            || (sock->queue_used > 0 && sock->retry_us == 0))
+        {
+            FD_SET(sock->fd, &write_fds);
+        }
+        else if (sock->queue_used > 0)
+        {
+            wait_us = JCFW_MIN(wait_us, (sock->retry_us > now_us) ? sock->retry_us - now_us : 0);
+        }
+    }
+    jcfw_mutex_unlock(loop->lock);
+
+    struct timeval timeout = {
+        .tv_sec  = (wait_us == UINT64_MAX) ? 0 : wait_us / (1000 * 1000),
+        .tv_usec = (wait_us == UINT64_MAX) ? 0 : wait_us % (1000 * 1000),
+    };
+    int rv = select(
+        fd_max + 1, &read_fds, &write_fds, NULL, (wait_us == UINT64_MAX) ? NULL : &timeout);
+    if (rv < 0)
+    {
+        JCFW_RETURN_IF_TRUE(errno == EINTR, JCFW_RESULT_OK);
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to wait on the sockets; errno %d", errno);
+        return JCFW_RESULT_ERROR;
+    }
+
+    // NOTE(Caleb): Nothing needs doing for a wake beyond rebuilding the sets on the next poll, and
+    // the sets are rebuilt after this has drained the wake socket, so no wake can be missed.
+    if (FD_ISSET(loop->wake_fd, &read_fds))
+    {
+        while (recv(loop->wake_fd, loop->receive_buffer, sizeof(loop->receive_buffer), 0) > 0)
+        {
+        }
+    }
+
+    // NOTE(Caleb): The walk holds the mutex, but the callbacks run without it, and may close any
+    // socket: Closing the one which is due next moves `poll_next` past it. Sockets opened by a
+    // callback are added at the head of the list, so they aren't visited until the next poll.
+    now_us = jcfw_platform_get_time_us();
+
+    jcfw_mutex_lock(loop->lock);
+    loop->poll_next = loop->sockets;
+    while (loop->poll_next)
+    {
+        jcfw_net_socket_t *sock = loop->poll_next;
+        loop->poll_next         = sock->next;
+
+        const int  fd            = sock->fd;
+        const bool is_connecting = sock->state == JCFW_NET_SOCKET_STATE_CONNECTING;
+        jcfw_mutex_unlock(loop->lock);
+
+        // NOTE(Caleb): Only the loop's task closes sockets (or connects them), so `fd` and `state`
+        // can be checked between the callbacks without the mutex.
+        if (is_connecting && FD_ISSET(fd, &write_fds))
+        {
+            _jcfw_net_socket_on_connect(sock);
+        }
+
+        if (sock->fd == fd && FD_ISSET(fd, &read_fds))
+        {
+            _jcfw_net_socket_receive(sock);
+        }
+
+        if (sock->fd == fd && sock->state == JCFW_NET_SOCKET_STATE_CONNECTED)
+        {
+            _jcfw_net_socket_service(sock, FD_ISSET(fd, &write_fds), now_us);
+        }
+
+        jcfw_mutex_lock(loop->lock);
+    }
+    jcfw_mutex_unlock(loop->lock);
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_net_loop_wake(jcfw_net_loop_t *loop)
+{
+    JCFW_RETURN_IF_FALSE(loop && loop->wake_fd >= 0);
+
+    // NOTE(Caleb): If the wake socket is full, the loop has plenty of wakes waiting already.
+    const uint8_t wake = 0;
+    send(loop->wake_fd, &wake, sizeof(wake), 0);
+}
+
+// SOCKET ------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_net_socket_open(
+    jcfw_net_loop_t *loop, jcfw_net_socket_t *sock, const jcfw_net_socket_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(loop && sock && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        config->receive_cb, JCFW_RESULT_INVALID_ARGS, "No receive callback provided");
+    JCFW_ERROR_IF_FALSE(
+        config->send_buffer && config->send_buffer_size > _JCFW_NET_QUEUE_HEADER_SIZE,
+        JCFW_RESULT_INVALID_ARGS,
+        "No send buffer provided");
+
+    memset(sock, 0x00, sizeof(*sock));
+    sock->config = *config;
+    sock->loop   = loop;
+    sock->fd     = -1;
+
+    const bool is_tcp = _jcfw_net_socket_is_tcp(sock);
+
+    int fd = socket(AF_INET, is_tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    JCFW_ERROR_IF_FALSE(fd >= 0, JCFW_RESULT_ERROR, "Unable to create a socket; errno %d", errno);
+
+    if (_jcfw_net_set_nonblocking(fd) != JCFW_RESULT_OK)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to make a socket non-blocking; errno %d", errno);
+        close(fd);
+        return JCFW_RESULT_ERROR;
+    }
+
+    // NOTE(Caleb): Writes are small and latency matters more than header overhead, so don't let
+    // Nagle's algorithm hold them back.
+    if (is_tcp)
+    {
+        const int is_enabled = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &is_enabled, sizeof(is_enabled));
+    }
+
+    struct sockaddr_in remote;
+    _jcfw_net_address_to_sockaddr(&config->remote, &remote);
+
+    const int rv = connect(fd, (struct sockaddr *)&remote, sizeof(remote));
+    if (rv != 0 && !(is_tcp && errno == EINPROGRESS))
+    {
+        JCFW_TRACELN_ERROR(
+            TRACE_TAG,
+            "Unable to connect to " JCFW_NET_ADDRESS_FORMAT "; errno %d",
+            JCFW_NET_ADDRESS_ARGS(&config->remote),
+            errno);
+        close(fd);
+        return JCFW_RESULT_NOT_CONNECTED;
+    }
+
+    jcfw_mutex_lock(loop->lock);
+    sock->fd      = fd;
+    sock->state   = (rv == 0) ? JCFW_NET_SOCKET_STATE_CONNECTED : JCFW_NET_SOCKET_STATE_CONNECTING;
+    sock->next    = loop->sockets;
+    loop->sockets = sock;
+    jcfw_mutex_unlock(loop->lock);
+
+    if (is_tcp && rv == 0 && sock->config.state_cb)
+    {
+        sock->config.state_cb(sock, JCFW_NET_SOCKET_STATE_CONNECTED, sock->config.cb_arg);
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_net_socket_close(jcfw_net_socket_t *sock)
+{
+    JCFW_RETURN_IF_FALSE(sock && sock->loop);
+
+    jcfw_net_loop_t *loop = sock->loop;
+
+    jcfw_mutex_lock(loop->lock);
+    if (sock->fd >= 0)
+    {
+        close(sock->fd);
+    }
+
+    sock->fd         = -1;
+    sock->state      = JCFW_NET_SOCKET_STATE_CLOSED;
+    sock->queue_head = 0;
+    sock->queue_tail = 0;
+    sock->queue_used = 0;
+
+    for (jcfw_net_socket_t **link = &loop->sockets; *link; link = &(*link)->next)
+    {
+        if (*link == sock)
+        {
+            *link = sock->next;
+            break;
+        }
+    }
+
+    if (loop->poll_next == sock)
+    {
+        loop->poll_next = sock->next;
+    }
+    jcfw_mutex_unlock(loop->lock);
+}
+
+jcfw_result_e jcfw_net_socket_send(jcfw_net_socket_t *sock, const uint8_t *data, size_t length)
+{
+    JCFW_ERROR_IF_FALSE(sock && (data || !length), JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_FALSE(sock->loop, JCFW_RESULT_NOT_CONNECTED);
+
+    bool should_wake = false;
+
+    jcfw_mutex_lock(sock->loop->lock);
+    jcfw_result_e result = _jcfw_net_socket_try_send(sock, data, length, &should_wake);
+    jcfw_mutex_unlock(sock->loop->lock);
+
+    if (should_wake)
+    {
+        jcfw_net_loop_wake(sock->loop);
+    }
+
+    return result;
+}
+
+jcfw_net_socket_state_e jcfw_net_socket_get_state(jcfw_net_socket_t *sock)
+{
+    JCFW_RETURN_IF_FALSE(sock && sock->loop, JCFW_NET_SOCKET_STATE_CLOSED);
+
+    jcfw_mutex_lock(sock->loop->lock);
+    jcfw_net_socket_state_e state = sock->state;
+    jcfw_mutex_unlock(sock->loop->lock);
+
+    return state;
+}
+
+size_t jcfw_net_socket_get_queued(jcfw_net_socket_t *sock)
+{
+    JCFW_RETURN_IF_FALSE(sock && sock->loop, 0);
+
+    jcfw_mutex_lock(sock->loop->lock);
+    size_t queue_used = sock->queue_used;
+    jcfw_mutex_unlock(sock->loop->lock);
+
+    return queue_used;
+}
+
+void jcfw_net_socket_get_stats(jcfw_net_socket_t *sock, jcfw_net_socket_stats_t *o_stats)
+{
+    JCFW_RETURN_IF_FALSE(sock && sock->loop && o_stats);
+
+    jcfw_mutex_lock(sock->loop->lock);
+    *o_stats = sock->stats;
+    jcfw_mutex_unlock(sock->loop->lock);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_net_set_nonblocking(int fd)
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    JCFW_RETURN_IF_FALSE(flags >= 0, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0, JCFW_RESULT_ERROR);
+
+    return JCFW_RESULT_OK;
+}
+
+/// @brief Send or queue data. The mutex of the loop must be held.
+static jcfw_result_e _jcfw_net_socket_try_send(
+    jcfw_net_socket_t *sock, const uint8_t *data, size_t length, bool *o_should_wake)
+{
+    JCFW_RETURN_IF_TRUE(sock->state == JCFW_NET_SOCKET_STATE_CLOSED, JCFW_RESULT_NOT_CONNECTED);
+
+    // NOTE(Caleb): Whatever part of a TCP send the stack doesn't take has to be queued, or the
+    // stream would have a hole in it, so only start a send which fits in the buffer.
+    const bool is_tcp = _jcfw_net_socket_is_tcp(sock);
+    if (is_tcp && length > sock->config.send_buffer_size - sock->queue_used)
+    {
+        sock->stats.refused_count++;
+        sock->was_refused = true;
+        return JCFW_RESULT_FULL;
+    }
+
+    const bool was_empty = (sock->queue_used == 0);
+    if (sock->state == JCFW_NET_SOCKET_STATE_CONNECTED && was_empty)
+    {
+        const ssize_t sent  = send(sock->fd, data, length, 0);
+        const int     error = errno;
+        if (sent == (ssize_t)length)
+        {
+            sock->stats.sent_count++;
+            return JCFW_RESULT_OK;
+        }
+
+        if (sent < 0 && !_jcfw_net_is_transient_error(error))
+        {
+            sock->stats.error_count++;
+            return JCFW_RESULT_ERROR;
+        }
+
+        if (sent > 0)
+        {
+            data += sent;
+            length -= (size_t)sent;
+        }
+
+        sock->retry_us = (sent < 0 && (error == ENOMEM || error == ENOBUFS))
+                           ? jcfw_platform_get_time_us() + JCFW_NET_RETRY_MS * 1000
+                           : 0;
+    }
+
+    if (!_jcfw_net_socket_enqueue(sock, data, length))
+    {
+        sock->stats.refused_count++;
+        sock->was_refused = true;
+        return JCFW_RESULT_FULL;
+    }
+
+    sock->stats.queued_count++;
+
+    // NOTE(Caleb): The loop already watches a connecting socket, and one with queued data.
+    *o_should_wake = was_empty && sock->state == JCFW_NET_SOCKET_STATE_CONNECTED;
+    return JCFW_RESULT_OK;
+}
+
+/// @brief Append data to the send buffer. The mutex of the loop must be held.
+static bool _jcfw_net_socket_enqueue(jcfw_net_socket_t *sock, const uint8_t *data, size_t length)
+{
+    uint8_t     *buffer   = sock->config.send_buffer;
+    const size_t capacity = sock->config.send_buffer_size;
+
+    if (sock->queue_used == 0)
+    {
+        sock->queue_head = 0;
+        sock->queue_tail = 0;
+    }
+
+    if (_jcfw_net_socket_is_tcp(sock))
+    {
+        JCFW_RETURN_IF_TRUE(length > capacity - sock->queue_used, false);
+
+        const size_t first = JCFW_MIN(length, capacity - sock->queue_head);
+        memcpy(&buffer[sock->queue_head], data, first);
+        memcpy(buffer, &data[first], length - first);
+
+        sock->queue_head = (sock->queue_head + length) % capacity;
+        sock->queue_used += length;
+        return true;
+    }
+
+    // NOTE(Caleb): Datagrams are sent from the buffer in one piece, so one which doesn't fit
+    // before the end of the buffer goes to its start, and the rest of the end goes unused.
+    const size_t size = _JCFW_NET_QUEUE_HEADER_SIZE + length;
+    JCFW_RETURN_IF_TRUE(length >= _JCFW_NET_QUEUE_WRAP || sock->queue_used == capacity, false);
+
+    if (sock->queue_head >= sock->queue_tail && capacity - sock->queue_head < size)
+    {
+        JCFW_RETURN_IF_TRUE(sock->queue_tail < size, false);
+
+        const size_t unused = capacity - sock->queue_head;
+        if (unused >= _JCFW_NET_QUEUE_HEADER_SIZE)
+        {
+            const uint16_t wrap = _JCFW_NET_QUEUE_WRAP;
+            memcpy(&buffer[sock->queue_head], &wrap, sizeof(wrap));
+        }
+
+        sock->queue_used += unused;
+        sock->queue_head = 0;
+    }
+    else if (sock->queue_head < sock->queue_tail)
+    {
+        JCFW_RETURN_IF_TRUE(sock->queue_tail - sock->queue_head < size, false);
+    }
+
+    const uint16_t length16 = (uint16_t)length;
+    memcpy(&buffer[sock->queue_head], &length16, sizeof(length16));
+    memcpy(&buffer[sock->queue_head + _JCFW_NET_QUEUE_HEADER_SIZE], data, length);
+
+    sock->queue_head = (sock->queue_head + size) % capacity;
+    sock->queue_used += size;
+    return true;
+}
+
+/// @brief Send as much of the send buffer as the stack takes. The mutex of the loop must be held.
+/// @return False if the connection failed (TCP), or true otherwise.
+static bool _jcfw_net_socket_flush(jcfw_net_socket_t *sock, uint64_t now_us)
+{
+    const uint8_t *buffer   = sock->config.send_buffer;
+    const size_t   capacity = sock->config.send_buffer_size;
+    const bool     is_tcp   = _jcfw_net_socket_is_tcp(sock);
+
+    while (sock->queue_used > 0)
+    {
+        const uint8_t *data;
+        size_t         length;
+        size_t         size;
+        if (is_tcp)
+        {
+            data   = &buffer[sock->queue_tail];
+            length = JCFW_MIN(sock->queue_used, capacity - sock->queue_tail);
+            size   = length;
+        }
+        else
+        {
+            uint16_t length16 = _JCFW_NET_QUEUE_WRAP;
+            if (capacity - sock->queue_tail >= _JCFW_NET_QUEUE_HEADER_SIZE)
+            {
+                memcpy(&length16, &buffer[sock->queue_tail], sizeof(length16));
+            }
+
+            if (length16 == _JCFW_NET_QUEUE_WRAP)
+            {
+                sock->queue_used -= capacity - sock->queue_tail;
+                sock->queue_tail = 0;
+                continue;
+            }
+
+            data   = &buffer[sock->queue_tail + _JCFW_NET_QUEUE_HEADER_SIZE];
+            length = length16;
+            size   = _JCFW_NET_QUEUE_HEADER_SIZE + length;
+        }
+
+        const ssize_t sent = send(sock->fd, data, length, 0);
+        if (sent < 0)
+        {
+            const int error = errno;
+            if (_jcfw_net_is_transient_error(error))
+            {
+                sock->retry_us = (error == ENOMEM || error == ENOBUFS)
+                                   ? now_us + JCFW_NET_RETRY_MS * 1000
+                                   : 0;
+                return true;
+            }
+
+            // NOTE(Caleb): A datagram which can't be sent at all (e.g. the peer's port is closed)
+            // is dropped, like one lost on the way.
+            sock->stats.error_count++;
+            JCFW_RETURN_IF_TRUE(is_tcp, false);
+        }
+        else
+        {
+            sock->stats.sent_count++;
+            size = is_tcp ? (size_t)sent : size;
+        }
+
+        sock->queue_tail = (sock->queue_tail + size) % capacity;
+        sock->queue_used -= size;
+    }
+
+    sock->retry_us = 0;
+    return true;
+}
+
+/// @brief Send whatever is due from the send buffer of a connected socket.
+static void _jcfw_net_socket_service(jcfw_net_socket_t *sock, bool is_writable, uint64_t now_us)
+{
+    jcfw_net_loop_t *loop = sock->loop;
+
+    jcfw_mutex_lock(loop->lock);
+    const bool is_due  = sock->queue_used > 0
+                     && ((sock->retry_us == 0) ? is_writable : now_us >= sock->retry_us);
+    const bool is_ok   = !is_due || _jcfw_net_socket_flush(sock, now_us);
+    const bool is_open = is_ok && sock->queue_used == 0 && sock->was_refused;
+    if (is_open)
+    {
+        sock->was_refused = false;
+    }
+    jcfw_mutex_unlock(loop->lock);
+
+    if (!is_ok)
+    {
+        JCFW_TRACELN_WARN(
+            TRACE_TAG,
+            "Lost the connection to " JCFW_NET_ADDRESS_FORMAT,
+            JCFW_NET_ADDRESS_ARGS(&sock->config.remote));
+        _jcfw_net_socket_fail(sock);
+        return;
+    }
+
+    if (is_open && sock->config.writable_cb)
+    {
+        sock->config.writable_cb(sock, sock->config.cb_arg);
+    }
+}
+
+static void _jcfw_net_socket_on_connect(jcfw_net_socket_t *sock)
+{
+    int       error     = 0;
+    socklen_t error_len = sizeof(error);
+    if (getsockopt(sock->fd, SOL_SOCKET, SO_ERROR, &error, &error_len) != 0 || error != 0)
+    {
+        JCFW_TRACELN_WARN(
+            TRACE_TAG,
+            "Unable to connect to " JCFW_NET_ADDRESS_FORMAT "; errno %d",
+            JCFW_NET_ADDRESS_ARGS(&sock->config.remote),
+            error);
+        _jcfw_net_socket_fail(sock);
+        return;
+    }
+
+    jcfw_mutex_lock(sock->loop->lock);
+    sock->state = JCFW_NET_SOCKET_STATE_CONNECTED;
+    jcfw_mutex_unlock(sock->loop->lock);
+
+    if (sock->config.state_cb)
+    {
+        sock->config.state_cb(sock, JCFW_NET_SOCKET_STATE_CONNECTED, sock->config.cb_arg);
+    }
+}
+
+static void _jcfw_net_socket_receive(jcfw_net_socket_t *sock)
+{
+    jcfw_net_loop_t *loop   = sock->loop;
+    const int        fd     = sock->fd;
+    const bool       is_tcp = _jcfw_net_socket_is_tcp(sock);
+
+    for (uint32_t i = 0; i < _JCFW_NET_RECEIVE_BURST_MAX && sock->fd == fd; i++)
+    {
+        const ssize_t  received   = recv(fd, loop->receive_buffer, sizeof(loop->receive_buffer), 0);
+        const int      error      = errno;
+        const uint64_t receive_us = jcfw_platform_get_time_us();
+        if (received > 0 || (received == 0 && !is_tcp))
+        {
+            jcfw_mutex_lock(loop->lock);
+            sock->stats.receive_count++;
+            jcfw_mutex_unlock(loop->lock);
+
+            sock->config.receive_cb(
+                sock, loop->receive_buffer, (size_t)received, receive_us, sock->config.cb_arg);
+            continue;
+        }
+
+        JCFW_RETURN_IF_TRUE(received < 0 && _jcfw_net_is_transient_error(error));
+
+        // NOTE(Caleb): On a UDP socket, an error is about an earlier datagram (e.g. an ICMP port
+        // unreachable), and the socket can go on. On a TCP socket, it is the end of the stream.
+        if (received < 0)
+        {
+            jcfw_mutex_lock(loop->lock);
+            sock->stats.error_count++;
+            jcfw_mutex_unlock(loop->lock);
+        }
+
+        JCFW_RETURN_IF_FALSE(is_tcp);
+
+        JCFW_TRACELN_WARN(
+            TRACE_TAG,
+            "Lost the connection to " JCFW_NET_ADDRESS_FORMAT "; errno %d",
+            JCFW_NET_ADDRESS_ARGS(&sock->config.remote),
+            (received == 0) ? 0 : error);
+        _jcfw_net_socket_fail(sock);
+        return;
+    }
+}
+
+static void _jcfw_net_socket_fail(jcfw_net_socket_t *sock)
+{
+    jcfw_net_socket_close(sock);
+
+    if (sock->config.state_cb)
+    {
+        sock->config.state_cb(sock, JCFW_NET_SOCKET_STATE_CLOSED, sock->config.cb_arg);
+    }
+}
@@ -0,0 +1,223 @@
+#include "jcfw/net/timesync.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+static uint32_t _jcfw_timesync_get_delay_median(const jcfw_timesync_t *timesync);
+
+// CLIENT ------------------------------------------------------------------------------------------
+
+void jcfw_timesync_init(jcfw_timesync_t *timesync)
+{
+    JCFW_RETURN_IF_FALSE(timesync);
+    memset(timesync, 0x00, sizeof(*timesync));
+}
+
+void jcfw_timesync_make_request(jcfw_timesync_t *timesync, uint64_t now_us, uint8_t *o_datagram)
+{
+    JCFW_RETURN_IF_FALSE(timesync && o_datagram);
+
+    timesync->next_seq++;
+    timesync->has_request = true;
+    timesync->request_us  = now_us;
+    timesync->stats.request_count++;
+
+    o_datagram[0] = JCFW_TIMESYNC_TYPE_REQUEST;
+    o_datagram[1] = 0;
+    JCFW_PUT_LE(&o_datagram[2], timesync->next_seq, sizeof(uint32_t));
+    JCFW_PUT_LE(&o_datagram[6], now_us, sizeof(uint64_t));
+}
+
+jcfw_result_e jcfw_timesync_on_receive(
+    jcfw_timesync_t *timesync, const uint8_t *datagram, size_t length, uint64_t now_us)
+{
+    JCFW_ERROR_IF_FALSE(timesync && datagram, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_FALSE(length == JCFW_TIMESYNC_RESPONSE_SIZE, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(datagram[0] == JCFW_TIMESYNC_TYPE_RESPONSE, JCFW_RESULT_ERROR);
+
+    const uint32_t seq    = JCFW_GET_LE(&datagram[2], sizeof(uint32_t));
+    const uint64_t t1     = JCFW_GET_LE(&datagram[6], sizeof(uint64_t));
+    const uint64_t t2     = JCFW_GET_LE(&datagram[14], sizeof(uint64_t));
+    const uint64_t t3     = JCFW_GET_LE(&datagram[22], sizeof(uint64_t));
+    const uint64_t t4     = now_us;
+    const bool     is_new = timesync->has_request && seq == timesync->next_seq
+                        && t1 == timesync->request_us;
+    if (!is_new)
+    {
+        timesync->stats.stale_count++;
+        return JCFW_RESULT_ERROR;
+    }
+
+    timesync->has_request = false;
+    timesync->stats.response_count++;
+
+    // NOTE(Caleb): The clocks may be any distance apart, but each difference is taken on one clock
+    // before they are combined, so nothing here overflows.
+    const int64_t outbound_us = (int64_t)(t2 - t1);
+    const int64_t inbound_us  = (int64_t)(t3 - t4);
+    const int64_t trip_us     = (int64_t)(t4 - t1) - (int64_t)(t3 - t2);
+
+    const jcfw_timesync_sample_t sample = {
+        .local_us  = t1 + (t4 - t1) / 2,
+        .offset_us = (outbound_us + inbound_us) / 2,
+        .delay_us  = (uint32_t)JCFW_CLAMP(trip_us, 0, (int64_t)UINT32_MAX),
+    };
+
+    // NOTE(Caleb): A probe can be off by half its delay, so a disagreement well beyond that means
+    // that the server's clock jumped.
+    jcfw_timesync_model_t model;
+    if (jcfw_timesync_get_model(timesync, &model))
+    {
+        const int64_t error_us =
+            (int64_t)(jcfw_timesync_model_apply(&model, sample.local_us) - sample.local_us)
+            - sample.offset_us;
+        if (JCFW_MAX(error_us, -error_us) > JCFW_TIMESYNC_STEP_US + sample.delay_us / 2)
+        {
+            timesync->sample_count = 0;
+            timesync->next_sample  = 0;
+            timesync->stats.step_count++;
+        }
+    }
+
+    timesync->samples[timesync->next_sample] = sample;
+
+    timesync->next_sample = (timesync->next_sample + 1) % JCFW_TIMESYNC_SAMPLE_COUNT;
+    if (timesync->sample_count < JCFW_TIMESYNC_SAMPLE_COUNT)
+    {
+        timesync->sample_count++;
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+bool jcfw_timesync_get_estimate(const jcfw_timesync_t *timesync, jcfw_timesync_sample_t *o_sample)
+{
+    JCFW_RETURN_IF_FALSE(timesync && o_sample, false);
+    JCFW_RETURN_IF_FALSE(timesync->sample_count > 0, false);
+
+    *o_sample = timesync->samples[0];
+    for (uint32_t i = 1; i < timesync->sample_count; i++)
+    {
+        if (timesync->samples[i].delay_us < o_sample->delay_us)
+        {
+            *o_sample = timesync->samples[i];
+        }
+    }
+
+    return true;
+}
+
+bool jcfw_timesync_get_model(const jcfw_timesync_t *timesync, jcfw_timesync_model_t *o_model)
+{
+    JCFW_RETURN_IF_FALSE(o_model, false);
+
+    jcfw_timesync_sample_t best;
+    JCFW_RETURN_IF_FALSE(jcfw_timesync_get_estimate(timesync, &best), false);
+
+    o_model->local_us  = best.local_us;
+    o_model->offset_us = best.offset_us;
+    o_model->drift_ppb = 0;
+    o_model->error_us  = best.delay_us / 2;
+
+    // NOTE(Caleb): Fit the drift to the probes which were quicker than the median, since the slow
+    // ones are the lopsided ones. Relative to the best probe, the sums stay well within a double's
+    // precision. This runs once per probe, so a double costs nothing worth avoiding.
+    const uint32_t delay_median_us = _jcfw_timesync_get_delay_median(timesync);
+
+    double   sum_x  = 0;
+    double   sum_y  = 0;
+    double   sum_xx = 0;
+    double   sum_xy = 0;
+    double   sum_yy = 0;
+    uint32_t count  = 0;
+    for (uint32_t i = 0; i < timesync->sample_count; i++)
+    {
+        const jcfw_timesync_sample_t *sample = &timesync->samples[i];
+        if (sample->delay_us > delay_median_us)
+        {
+            continue;
+        }
+
+        const double x = (double)(int64_t)(sample->local_us - best.local_us);
+        const double y = (double)(sample->offset_us - best.offset_us);
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+        sum_yy += y * y;
+        count++;
+    }
+
+    const double spread = count * sum_xx - sum_x * sum_x;
+    JCFW_RETURN_IF_FALSE(count >= 3 && spread > 0, true);
+
+    const double slope = (count * sum_xy - sum_x * sum_y) / spread;
+
+    // NOTE(Caleb): Over a short span, jitter alone makes for a steep slope, and extrapolating it
+    // would do more harm than ignoring the drift. Only trust a slope that is at least twice its
+    // standard error.
+    const double residual = (count * sum_yy - sum_y * sum_y) / count
+                          - slope * (count * sum_xy - sum_x * sum_y) / count;
+    const double slope_variance = residual / (count - 2) / (spread / count);
+    JCFW_RETURN_IF_TRUE(slope * slope < 4 * slope_variance, true);
+
+    o_model->drift_ppb = (int32_t)JCFW_CLAMP(
+        slope * 1e9, -JCFW_TIMESYNC_DRIFT_MAX_PPB, (double)JCFW_TIMESYNC_DRIFT_MAX_PPB);
+
+    return true;
+}
+
+void jcfw_timesync_get_stats(const jcfw_timesync_t *timesync, jcfw_timesync_stats_t *o_stats)
+{
+    *o_stats = timesync->stats;
+}
+
+// SERVER ------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_timesync_respond(
+    const uint8_t *request,
+    size_t         length,
+    uint64_t       receive_us,
+    uint64_t       transmit_us,
+    uint8_t       *o_response)
+{
+    JCFW_ERROR_IF_FALSE(request && o_response, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_FALSE(length == JCFW_TIMESYNC_REQUEST_SIZE, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(request[0] == JCFW_TIMESYNC_TYPE_REQUEST, JCFW_RESULT_ERROR);
+
+    o_response[0] = JCFW_TIMESYNC_TYPE_RESPONSE;
+    o_response[1] = 0;
+    memcpy(&o_response[2], &request[2], sizeof(uint32_t) + sizeof(uint64_t));
+    JCFW_PUT_LE(&o_response[14], receive_us, sizeof(uint64_t));
+    JCFW_PUT_LE(&o_response[22], transmit_us, sizeof(uint64_t));
+
+    return JCFW_RESULT_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static uint32_t _jcfw_timesync_get_delay_median(const jcfw_timesync_t *timesync)
+{
+    uint32_t delays[JCFW_TIMESYNC_SAMPLE_COUNT];
+    uint32_t count = 0;
+
+    // NOTE(Caleb): An insertion sort; There are only a handful of samples.
+    for (uint32_t i = 0; i < timesync->sample_count; i++)
+    {
+        const uint32_t delay_us = timesync->samples[i].delay_us;
+
+        uint32_t j = count++;
+        while (j > 0 && delays[j - 1] > delay_us)
+        {
+            delays[j] = delays[j - 1];
+            j--;
+        }
+
+        delays[j] = delay_us;
+    }
+
+    return delays[(count - 1) / 2];
+}
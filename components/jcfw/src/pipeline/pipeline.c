@@ -0,0 +1,303 @@
+#include "jcfw/pipeline/pipeline.h"
+
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG                   "JCFW-PIPE"
+
+#define _JCFW_PIPELINE_EVENT_WAKE   (1u << 0)
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_pipeline_stage_run(void *arg);
+static bool _jcfw_pipeline_stage_drain(jcfw_pipeline_stage_t *stage);
+static void _jcfw_pipeline_stats_begin(jcfw_pipeline_stage_t *stage);
+static void _jcfw_pipeline_stats_end(jcfw_pipeline_stage_t *stage);
+
+// POOL --------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_pipeline_pool_init(
+    jcfw_pipeline_pool_t *pool, jcfw_pipeline_block_t *blocks, uint32_t block_count)
+{
+    JCFW_ERROR_IF_FALSE(pool && blocks, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        block_count > 0 && block_count <= JCFW_PIPELINE_POOL_BLOCK_COUNT_MAX,
+        JCFW_RESULT_INVALID_ARGS,
+        "Invalid block count %lu",
+        (unsigned long)block_count);
+
+    pool->blocks      = blocks;
+    pool->block_count = block_count;
+
+    for (uint32_t i = 0; i < block_count; i++)
+    {
+        blocks[i].pool = pool;
+    }
+
+    const uint32_t free_mask =
+        (block_count == 32) ? UINT32_MAX : ((uint32_t)1 << block_count) - 1;
+    atomic_init(&pool->free_mask, free_mask);
+    atomic_init(&pool->exhausted_count, 0);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_pipeline_block_t *jcfw_pipeline_block_acquire(
+    jcfw_pipeline_pool_t *pool, uint16_t stream, uint16_t sample_size, uint64_t timestamp_us)
+{
+    JCFW_RETURN_IF_FALSE(pool && sample_size > 0 && sample_size <= JCFW_PIPELINE_BLOCK_SIZE, NULL);
+
+    // NOTE(Caleb): Claim the lowest free bit. A failed exchange reloads `free_mask`, so this only
+    // loops while other tasks are taking or releasing blocks of the same pool.
+    uint32_t free_mask = atomic_load_explicit(&pool->free_mask, memory_order_relaxed);
+    while (free_mask)
+    {
+        const uint32_t bit = free_mask & (~free_mask + 1);
+        if (!atomic_compare_exchange_weak_explicit(
+                &pool->free_mask,
+                &free_mask,
+                free_mask & ~bit,
+                memory_order_acquire,
+                memory_order_relaxed))
+        {
+            continue;
+        }
+
+        jcfw_pipeline_block_t *block = &pool->blocks[__builtin_ctz(bit)];
+        block->timestamp_us          = timestamp_us;
+        block->emit_us               = 0;
+        block->stream                = stream;
+        block->sample_size           = sample_size;
+        block->sample_count          = 0;
+        return block;
+    }
+
+    atomic_fetch_add_explicit(&pool->exhausted_count, 1, memory_order_relaxed);
+    return NULL;
+}
+
+void jcfw_pipeline_block_release(jcfw_pipeline_block_t *block)
+{
+    JCFW_RETURN_IF_FALSE(block);
+
+    jcfw_pipeline_pool_t *pool  = block->pool;
+    const uint32_t        index = block - pool->blocks;
+    JCFW_ERROR_IF_FALSE(index < pool->block_count, , "Block does not belong to its pool");
+
+    atomic_fetch_or_explicit(&pool->free_mask, (uint32_t)1 << index, memory_order_release);
+}
+
+// STAGE -------------------------------------------------------------------------------------------
+
+jcfw_result_e
+jcfw_pipeline_stage_init(jcfw_pipeline_stage_t *stage, const jcfw_pipeline_stage_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(stage && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    memset(stage, 0x00, sizeof(*stage));
+    stage->config = *config;
+    atomic_init(&stage->stats_seq, 0);
+
+    jcfw_result_e err = jcfw_event_create(&stage->event);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "Unable to create the event of a stage");
+
+    jcfw_pipeline_stage_t *next = config->next;
+    JCFW_RETURN_IF_FALSE(next, JCFW_RESULT_OK);
+
+    JCFW_ERROR_IF_FALSE(
+        next->config.process_cb,
+        JCFW_RESULT_INVALID_ARGS,
+        "Stage %s can't take blocks",
+        jcfw_pipeline_stage_get_name(next));
+    JCFW_ERROR_IF_FALSE(
+        next->input_count < JCFW_PIPELINE_INPUT_COUNT_MAX,
+        JCFW_RESULT_FULL,
+        "Stage %s has no free inputs",
+        jcfw_pipeline_stage_get_name(next));
+
+    const uint32_t index = next->input_count;
+    err                  = jcfw_spsc_init(
+        &next->inputs[index],
+        next->input_buffers[index],
+        sizeof(next->input_buffers[index][0]),
+        JCFW_ARRAYSIZE(next->input_buffers[index]));
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "Unable to set up a stage input");
+
+    next->input_count++;
+    stage->next_input = &next->inputs[index];
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_pipeline_stage_start(jcfw_pipeline_stage_t *stage)
+{
+    JCFW_ERROR_IF_FALSE(stage && stage->event, JCFW_RESULT_NOT_INITIALIZED, "Stage not set up");
+
+    // NOTE(Caleb): Latched until the task first waits, so that it polls straight away.
+    jcfw_event_signal(stage->event, _JCFW_PIPELINE_EVENT_WAKE);
+
+    return jcfw_task_create(&stage->config.task, _jcfw_pipeline_stage_run, stage);
+}
+
+jcfw_result_e jcfw_pipeline_emit(jcfw_pipeline_stage_t *stage, jcfw_pipeline_block_t *block)
+{
+    JCFW_ERROR_IF_FALSE(stage && block, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    if (!stage->next_input)
+    {
+        jcfw_pipeline_block_release(block);
+        return JCFW_RESULT_OK;
+    }
+
+    // NOTE(Caleb): The next stage may take the block as soon as it has been pushed, so it mustn't
+    // be touched after that.
+    block->emit_us    = jcfw_platform_get_time_us();
+    jcfw_result_e err = jcfw_spsc_push(stage->next_input, &block);
+
+    _jcfw_pipeline_stats_begin(stage);
+    if (err == JCFW_RESULT_OK)
+    {
+        stage->stats.emit_count++;
+    }
+    else
+    {
+        stage->stats.emit_drop_count++;
+    }
+    _jcfw_pipeline_stats_end(stage);
+
+    if (err != JCFW_RESULT_OK)
+    {
+        jcfw_pipeline_block_release(block);
+        return err;
+    }
+
+    jcfw_event_signal(stage->config.next->event, _JCFW_PIPELINE_EVENT_WAKE);
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_pipeline_stage_notify(jcfw_pipeline_stage_t *stage)
+{
+    JCFW_RETURN_IF_FALSE(stage && stage->event);
+    jcfw_event_signal(stage->event, _JCFW_PIPELINE_EVENT_WAKE);
+}
+
+void jcfw_pipeline_stage_notify_from_isr(jcfw_pipeline_stage_t *stage)
+{
+    JCFW_RETURN_IF_FALSE(stage && stage->event);
+    jcfw_event_signal_from_isr(stage->event, _JCFW_PIPELINE_EVENT_WAKE);
+}
+
+void jcfw_pipeline_stage_get_stats(
+    jcfw_pipeline_stage_t *stage, jcfw_pipeline_stage_stats_t *o_stats)
+{
+    JCFW_RETURN_IF_FALSE(stage && o_stats);
+
+    // NOTE(Caleb): Only the stage task writes the statistics, so retry the copy until it wasn't
+    // torn by an update rather than making the stage take a lock.
+    uint32_t seq;
+    do
+    {
+        seq = atomic_load_explicit(&stage->stats_seq, memory_order_acquire);
+        memcpy(o_stats, &stage->stats, sizeof(*o_stats));
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&stage->stats_seq, memory_order_relaxed));
+
+    o_stats->drop_count       = 0;
+    o_stats->queue_depth      = 0;
+    o_stats->queue_high_water = 0;
+    for (uint32_t i = 0; i < stage->input_count; i++)
+    {
+        o_stats->drop_count += jcfw_spsc_get_overflow_count(&stage->inputs[i]);
+        o_stats->queue_depth += jcfw_spsc_count(&stage->inputs[i]);
+        o_stats->queue_high_water =
+            JCFW_MAX(o_stats->queue_high_water, jcfw_spsc_get_high_water(&stage->inputs[i]));
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_pipeline_stage_run(void *arg)
+{
+    jcfw_pipeline_stage_t *stage = arg;
+
+    uint32_t timeout_ms = JCFW_EVENT_WAIT_FOREVER;
+    while (1)
+    {
+        jcfw_event_wait(stage->event, timeout_ms);
+        const uint64_t wake_us = jcfw_platform_get_time_us();
+
+        // NOTE(Caleb): If blocks are still waiting, a busy input would starve the poll callback;
+        // Poll anyway, and come straight back for the rest.
+        if (_jcfw_pipeline_stage_drain(stage))
+        {
+            jcfw_event_signal(stage->event, _JCFW_PIPELINE_EVENT_WAKE);
+        }
+
+        if (stage->config.poll_cb)
+        {
+            timeout_ms = stage->config.poll_cb(
+                stage, jcfw_platform_get_time_us(), stage->config.cb_arg);
+        }
+
+        const uint64_t sleep_us = jcfw_platform_get_time_us();
+
+        _jcfw_pipeline_stats_begin(stage);
+        stage->stats.wake_count++;
+        stage->stats.busy_us += sleep_us - wake_us;
+        _jcfw_pipeline_stats_end(stage);
+    }
+}
+
+/// @brief Process the blocks waiting at the inputs of a stage, taking turns between inputs.
+/// @return True if blocks are still waiting after JCFW_PIPELINE_QUEUE_CAPACITY turns.
+static bool _jcfw_pipeline_stage_drain(jcfw_pipeline_stage_t *stage)
+{
+    for (uint32_t turn = 0; turn < JCFW_PIPELINE_QUEUE_CAPACITY; turn++)
+    {
+        bool is_any = false;
+        for (uint32_t i = 0; i < stage->input_count; i++)
+        {
+            jcfw_pipeline_block_t *block;
+            if (jcfw_spsc_pop(&stage->inputs[i], &block) != JCFW_RESULT_OK)
+            {
+                continue;
+            }
+
+            is_any = true;
+
+            const uint32_t latency_us = jcfw_platform_get_time_us() - block->emit_us;
+
+            _jcfw_pipeline_stats_begin(stage);
+            stage->stats.block_count++;
+            stage->stats.sample_count += block->sample_count;
+            stage->stats.queue_latency_max_us =
+                JCFW_MAX(stage->stats.queue_latency_max_us, latency_us);
+            stage->stats.queue_latency_total_us += latency_us;
+            _jcfw_pipeline_stats_end(stage);
+
+            stage->config.process_cb(stage, block, stage->config.cb_arg);
+        }
+
+        JCFW_RETURN_IF_FALSE(is_any, false);
+    }
+
+    for (uint32_t i = 0; i < stage->input_count; i++)
+    {
+        JCFW_RETURN_IF_TRUE(jcfw_spsc_count(&stage->inputs[i]) > 0, true);
+    }
+
+    return false;
+}
+
+static void _jcfw_pipeline_stats_begin(jcfw_pipeline_stage_t *stage)
+{
+    atomic_fetch_add_explicit(&stage->stats_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void _jcfw_pipeline_stats_end(jcfw_pipeline_stage_t *stage)
+{
+    atomic_fetch_add_explicit(&stage->stats_seq, 1, memory_order_release);
+}
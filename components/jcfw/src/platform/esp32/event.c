@@ -0,0 +1,96 @@
+#include "jcfw/platform/event.h"
+
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+// TODO(Caleb): JCFW OS
+struct jcfw_event_s
+{
+    _Atomic uint32_t     bits;
+    _Atomic TaskHandle_t waiter;
+};
+
+static jcfw_event_t s_events[JCFW_EVENT_COUNT_MAX];
+static size_t       s_event_count = 0;
+static portMUX_TYPE s_events_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_event_create(jcfw_event_t **o_event)
+{
+    JCFW_ERROR_IF_FALSE(o_event, JCFW_RESULT_INVALID_ARGS, "No event provided");
+
+    taskENTER_CRITICAL(&s_events_lock);
+    jcfw_event_t *event = (s_event_count < JCFW_ARRAYSIZE(s_events)) ? &s_events[s_event_count++]
+                                                                     : NULL;
+    taskEXIT_CRITICAL(&s_events_lock);
+    JCFW_ERROR_IF_FALSE(event, JCFW_RESULT_FULL, "No free event slots");
+
+    atomic_init(&event->bits, 0);
+    atomic_init(&event->waiter, NULL);
+
+    *o_event = event;
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_event_signal(jcfw_event_t *event, uint32_t bits)
+{
+    atomic_fetch_or(&event->bits, bits);
+
+    // NOTE(Caleb): Before the first wait there is nobody to wake; The bits wait for the waiter.
+    TaskHandle_t waiter = atomic_load(&event->waiter);
+    if (waiter)
+    {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+void jcfw_event_signal_from_isr(jcfw_event_t *event, uint32_t bits)
+{
+    atomic_fetch_or(&event->bits, bits);
+
+    TaskHandle_t waiter = atomic_load(&event->waiter);
+    if (waiter)
+    {
+        BaseType_t should_yield = pdFALSE;
+        vTaskNotifyGiveFromISR(waiter, &should_yield);
+        portYIELD_FROM_ISR(should_yield);
+    }
+}
+
+uint32_t jcfw_event_wait(jcfw_event_t *event, uint32_t timeout_ms)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TaskHandle_t none = NULL;
+    if (!atomic_compare_exchange_strong(&event->waiter, &none, self))
+    {
+        JCFW_ASSERT(none == self, "Only one task may wait on an event");
+    }
+
+    TickType_t ticks_left =
+        (timeout_ms == JCFW_EVENT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    // NOTE(Caleb): A notification may be left over from bits which an earlier wait already took,
+    // so only the bits themselves say whether anything happened.
+    while (1)
+    {
+        const uint32_t bits = atomic_exchange(&event->bits, 0);
+        JCFW_RETURN_IF_TRUE(bits, bits);
+
+        if (ulTaskNotifyTake(pdTRUE, ticks_left) == 0
+            || xTaskCheckForTimeOut(&timeout, &ticks_left) == pdTRUE)
+        {
+            return atomic_exchange(&event->bits, 0);
+        }
+    }
+}
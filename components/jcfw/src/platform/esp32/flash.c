@@ -0,0 +1,75 @@
+#include "jcfw/platform/flash.h"
+
+#include "esp_partition.h"
+
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+
+#define TRACE_TAG "JCFW-FLASH"
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_flash_open(jcfw_flash_region_t *region, const char *name)
+{
+    JCFW_ERROR_IF_FALSE(region && name, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    const esp_partition_t *partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, name);
+    JCFW_ERROR_IF_FALSE(partition, JCFW_RESULT_ERROR, "No data partition labelled %s", name);
+
+    region->size        = partition->size;
+    region->sector_size = partition->erase_size;
+    region->handle      = (void *)partition;
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_flash_close(jcfw_flash_region_t *region)
+{
+    JCFW_RETURN_IF_FALSE(region);
+
+    // NOTE(Caleb): Partitions are owned by the IDF; There is nothing to release.
+    region->handle = NULL;
+}
+
+jcfw_result_e
+jcfw_flash_read(const jcfw_flash_region_t *region, size_t offset, void *o_data, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(region && o_data, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(offset + size > region->size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    esp_err_t err = esp_partition_read(region->handle, offset, o_data, size);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK, JCFW_RESULT_ERROR, "Unable to read flash; %s", esp_err_to_name(err));
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e
+jcfw_flash_write(const jcfw_flash_region_t *region, size_t offset, const void *data, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(region && data, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(offset + size > region->size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    esp_err_t err = esp_partition_write(region->handle, offset, data, size);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK, JCFW_RESULT_ERROR, "Unable to write flash; %s", esp_err_to_name(err));
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_flash_erase(const jcfw_flash_region_t *region, size_t offset, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(region, JCFW_RESULT_INVALID_ARGS, "No region provided");
+    JCFW_ERROR_IF_FALSE(
+        offset % region->sector_size == 0 && size % region->sector_size == 0,
+        JCFW_RESULT_INVALID_ARGS,
+        "Erases must be sector aligned");
+    JCFW_RETURN_IF_TRUE(offset + size > region->size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    esp_err_t err = esp_partition_erase_range(region->handle, offset, size);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK, JCFW_RESULT_ERROR, "Unable to erase flash; %s", esp_err_to_name(err));
+
+    return JCFW_RESULT_OK;
+}
@@ -0,0 +1,272 @@
+#include "jcfw/platform/i2c.h"
+
+#include "driver/i2c_master.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "jcfw/detail/i2c.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG "JCFW-I2C"
+
+// -------------------------------------------------------------------------------------------------
+
+// TODO(Caleb): JCFW OS
+typedef struct
+{
+    portMUX_TYPE lock;
+    TaskHandle_t worker_task;
+} _jcfw_esp32_i2c_port_t;
+
+static _jcfw_esp32_i2c_port_t s_ports[JCFW_I2C_BUS_COUNT_MAX];
+static size_t                 s_port_count = 0;
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_i2c_transfer_blocking(jcfw_i2c_xfer_t *xfer);
+static void          _jcfw_i2c_on_blocking_done(
+    jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg);
+static void          _jcfw_i2c_worker(void *arg);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_platform_i2c_mstr_mem_read(
+    void          *arg,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    uint8_t       *o_data,
+    size_t         data_size,
+    uint32_t       timeout_ms)
+{
+    jcfw_i2c_xfer_t xfer = {
+        .device        = arg,
+        .type          = JCFW_I2C_XFER_TYPE_READ,
+        .mem_addr      = mem_addr,
+        .mem_addr_size = mem_addr_size,
+        .o_data        = o_data,
+        .data_size     = data_size,
+        .timeout_ms    = timeout_ms,
+    };
+
+    return _jcfw_i2c_transfer_blocking(&xfer);
+}
+
+jcfw_result_e jcfw_platform_i2c_mstr_mem_write(
+    void          *arg,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size,
+    uint32_t       timeout_ms)
+{
+    jcfw_i2c_xfer_t xfer = {
+        .device        = arg,
+        .type          = JCFW_I2C_XFER_TYPE_WRITE,
+        .mem_addr      = mem_addr,
+        .mem_addr_size = mem_addr_size,
+        .data          = data,
+        .data_size     = data_size,
+        .timeout_ms    = timeout_ms,
+    };
+
+    return _jcfw_i2c_transfer_blocking(&xfer);
+}
+
+jcfw_result_e jcfw_platform_i2c_mstr_mem_writev(
+    void                     *arg,
+    const uint8_t            *mem_addr,
+    size_t                    mem_addr_size,
+    const jcfw_i2c_segment_t *segments,
+    size_t                    segment_count,
+    uint32_t                  timeout_ms)
+{
+    jcfw_i2c_xfer_t xfer = {
+        .device        = arg,
+        .type          = JCFW_I2C_XFER_TYPE_WRITE,
+        .mem_addr      = mem_addr,
+        .mem_addr_size = mem_addr_size,
+        .segments      = segments,
+        .segment_count = segment_count,
+        .data_size     = _jcfw_i2c_segments_size(segments, segment_count),
+        .timeout_ms    = timeout_ms,
+    };
+
+    return _jcfw_i2c_transfer_blocking(&xfer);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e _jcfw_i2c_port_start(jcfw_i2c_bus_t *bus)
+{
+    JCFW_ERROR_IF_FALSE(
+        s_port_count < JCFW_ARRAYSIZE(s_ports), JCFW_RESULT_FULL, "No free I2C port slots");
+
+    _jcfw_esp32_i2c_port_t *port = &s_ports[s_port_count];
+    portMUX_INITIALIZE(&port->lock);
+    port->worker_task = NULL;
+
+    // NOTE(Caleb): The worker only touches the port once something has been queued, which can't
+    // happen before the bus is marked as used, so it is safe to publish the port first.
+    bus->port = port;
+
+    // TODO(Caleb): JCFW OS
+    BaseType_t rc = xTaskCreate(
+        _jcfw_i2c_worker,
+        "JCFW-I2C",
+        JCFW_I2C_TASK_STACK_SIZE,
+        bus,
+        JCFW_I2C_TASK_PRIORITY,
+        &port->worker_task);
+    JCFW_ERROR_IF_FALSE(rc == pdPASS, JCFW_RESULT_ERROR, "Unable to create the I2C worker task");
+
+    s_port_count++;
+    return JCFW_RESULT_OK;
+}
+
+void _jcfw_i2c_port_lock(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_esp32_i2c_port_t *port = bus->port;
+    taskENTER_CRITICAL(&port->lock);
+}
+
+void _jcfw_i2c_port_unlock(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_esp32_i2c_port_t *port = bus->port;
+    taskEXIT_CRITICAL(&port->lock);
+}
+
+void _jcfw_i2c_port_notify(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_esp32_i2c_port_t *port = bus->port;
+
+    // TODO(Caleb): JCFW OS
+    xTaskNotifyGive(port->worker_task);
+}
+
+jcfw_result_e _jcfw_i2c_port_read(const jcfw_i2c_xfer_t *xfer)
+{
+    i2c_master_dev_handle_t handle = xfer->device->handle;
+
+    esp_err_t err = i2c_master_transmit_receive(
+        handle,
+        xfer->mem_addr,
+        xfer->mem_addr_size,
+        xfer->o_data,
+        xfer->data_size,
+        xfer->timeout_ms);
+
+    return (err == ESP_OK) ? JCFW_RESULT_OK : JCFW_RESULT_ERROR;
+}
+
+jcfw_result_e _jcfw_i2c_port_write(
+    const jcfw_i2c_xfer_t *xfer, const jcfw_i2c_segment_t *segments, size_t segment_count)
+{
+    i2c_master_dev_handle_t handle = xfer->device->handle;
+
+    // NOTE(Caleb): The pinned IDF (5.2) can't transmit from several buffers, so everything is
+    // copied into one bounded buffer.
+    uint8_t buffer[JCFW_I2C_WRITE_COPY_SIZE_MAX];
+    JCFW_ERROR_IF_FALSE(
+        xfer->mem_addr_size <= sizeof(buffer),
+        JCFW_RESULT_OUT_OF_BOUNDS,
+        "I2C \"memory address\" does not fit the copy buffer");
+
+    memcpy(buffer, xfer->mem_addr, xfer->mem_addr_size);
+
+    jcfw_result_e gather_err = _jcfw_i2c_segments_gather(
+        segments,
+        segment_count,
+        &buffer[xfer->mem_addr_size],
+        sizeof(buffer) - xfer->mem_addr_size);
+    JCFW_RETURN_IF_FALSE(gather_err == JCFW_RESULT_OK, gather_err);
+
+    esp_err_t err = i2c_master_transmit(
+        handle, buffer, xfer->mem_addr_size + xfer->data_size, xfer->timeout_ms);
+
+    return (err == ESP_OK) ? JCFW_RESULT_OK : JCFW_RESULT_ERROR;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_i2c_transfer_blocking(jcfw_i2c_xfer_t *xfer)
+{
+    JCFW_ERROR_IF_FALSE(
+        xfer->device && xfer->device->bus, JCFW_RESULT_INVALID_ARGS, "No device provided");
+
+    // NOTE(Caleb): The worker task would deadlock waiting on itself (e.g. a blocking call made from
+    // a completion callback), so it runs the transaction directly.
+    _jcfw_esp32_i2c_port_t *port = xfer->device->bus->port;
+    if (port && xTaskGetCurrentTaskHandle() == port->worker_task)
+    {
+        return _jcfw_i2c_execute(xfer);
+    }
+
+    // TODO(Caleb): JCFW OS
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&done_buffer);
+
+    xfer->callback     = _jcfw_i2c_on_blocking_done;
+    xfer->callback_arg = done;
+
+    // NOTE(Caleb): Blocking callers are already bounded by the number of tasks, so they are allowed
+    // past the queue depth limit rather than failing with JCFW_RESULT_FULL.
+    jcfw_result_e err = _jcfw_i2c_enqueue(xfer, true);
+    if (err == JCFW_RESULT_OK)
+    {
+        // NOTE(Caleb): In 64 bits, since the sum (and pdMS_TO_TICKS()) would wrap for long
+        // timeouts, and JCFW_I2C_WAIT_FOREVER would become a few ticks.
+        const uint64_t wait_ms = (uint64_t)xfer->timeout_ms + JCFW_I2C_QUEUE_TIMEOUT_MS;
+        const uint64_t ticks   = wait_ms * configTICK_RATE_HZ / 1000;
+
+        // TODO(Caleb): JCFW OS
+        TickType_t wait_ticks = portMAX_DELAY;
+        if (xfer->timeout_ms != JCFW_I2C_WAIT_FOREVER && ticks < portMAX_DELAY)
+        {
+            wait_ticks = (TickType_t)ticks;
+        }
+        if (xSemaphoreTake(done, wait_ticks) == pdTRUE)
+        {
+            err = xfer->result;
+        }
+        else if (jcfw_platform_i2c_cancel(xfer) == JCFW_RESULT_OK)
+        {
+            err = JCFW_RESULT_TIMEOUT;
+        }
+        else
+        {
+            // NOTE(Caleb): The transaction reached the bus in the meantime. The descriptor lives on
+            // this stack, so it has to finish before returning, but the bus operation itself is
+            // bounded by its own timeout.
+            xSemaphoreTake(done, portMAX_DELAY);
+            err = xfer->result;
+        }
+    }
+
+    vSemaphoreDelete(done);
+
+    return err;
+}
+
+static void _jcfw_i2c_on_blocking_done(
+    jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg)
+{
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+static void _jcfw_i2c_worker(void *arg)
+{
+    jcfw_i2c_bus_t *bus = arg;
+
+    while (1)
+    {
+        // TODO(Caleb): JCFW OS
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        _jcfw_i2c_service(bus);
+    }
+}
@@ -0,0 +1,49 @@
+#include "jcfw/platform/mutex.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+// TODO(Caleb): JCFW OS
+struct jcfw_mutex_s
+{
+    StaticSemaphore_t storage;
+    SemaphoreHandle_t handle;
+};
+
+static jcfw_mutex_t s_mutexes[JCFW_MUTEX_COUNT_MAX];
+static size_t       s_mutex_count  = 0;
+static portMUX_TYPE s_mutexes_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_mutex_create(jcfw_mutex_t **o_mutex)
+{
+    JCFW_ERROR_IF_FALSE(o_mutex, JCFW_RESULT_INVALID_ARGS, "No mutex provided");
+
+    taskENTER_CRITICAL(&s_mutexes_lock);
+    jcfw_mutex_t *mutex = (s_mutex_count < JCFW_ARRAYSIZE(s_mutexes))
+                            ? &s_mutexes[s_mutex_count++]
+                            : NULL;
+    taskEXIT_CRITICAL(&s_mutexes_lock);
+    JCFW_ERROR_IF_FALSE(mutex, JCFW_RESULT_FULL, "No free mutex slots");
+
+    mutex->handle = xSemaphoreCreateMutexStatic(&mutex->storage);
+
+    *o_mutex = mutex;
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_mutex_lock(jcfw_mutex_t *mutex)
+{
+    xSemaphoreTake(mutex->handle, portMAX_DELAY);
+}
+
+void jcfw_mutex_unlock(jcfw_mutex_t *mutex)
+{
+    xSemaphoreGive(mutex->handle);
+}
@@ -0,0 +1,31 @@
+#include "jcfw/platform/task.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+
+#define TRACE_TAG "JCFW-TASK"
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_task_create(const jcfw_task_config_t *config, jcfw_task_f task, void *arg)
+{
+    JCFW_ERROR_IF_FALSE(config && task, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        config->core == JCFW_TASK_CORE_ANY
+            || (config->core >= 0 && config->core < portNUM_PROCESSORS),
+        JCFW_RESULT_INVALID_ARGS,
+        "No core %ld",
+        (long)config->core);
+
+    const BaseType_t core = (config->core == JCFW_TASK_CORE_ANY) ? tskNO_AFFINITY : config->core;
+
+    BaseType_t rc = xTaskCreatePinnedToCore(
+        task, config->name, config->stack_size, arg, config->priority, NULL, core);
+    JCFW_ERROR_IF_FALSE(
+        rc == pdPASS, JCFW_RESULT_ALLOCATION_FAILURE, "Unable to create task %s", config->name);
+
+    return JCFW_RESULT_OK;
+}
@@ -1,17 +1,31 @@
 #include "jcfw/platform/wifi.h"
 
 #include "esp_event.h"
+#include "esp_random.h"
 #include "esp_wifi.h"
+#include "nvs.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
 
+#include "jcfw/platform/event.h"
+#include "jcfw/platform/mutex.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/platform/task.h"
 #include "jcfw/trace.h"
 #include "jcfw/util/assert.h"
 #include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
 
-#define STA_TRACE_TAG "JCFW-WIFI-STA"
-#define AP_TRACE_TAG  "JCFW-WIFI-AP"
+#define STA_TRACE_TAG                 "JCFW-WIFI-STA"
+#define AP_TRACE_TAG                  "JCFW-WIFI-AP"
+
+#define _JCFW_WIFI_NVS_NAMESPACE      "jcfw_wifi"
+#define _JCFW_WIFI_NVS_KEY_LAST_AP    "last_ap"
+#define _JCFW_WIFI_LAST_AP_VERSION    1
+
+/// @brief How long an aborted connection attempt may take to wind down, in ms.
+#define _JCFW_WIFI_ABORT_TIMEOUT_MS   1000
 
 // -------------------------------------------------------------------------------------------------
 
@@ -95,12 +109,104 @@ static const char *S_REASON_STRINGS[] = {
     [212] = "WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD",
 };
 
+/// @brief What is kept in NVS about the last successful connection.
+typedef struct
+{
+    uint8_t          version;
+    uint8_t          ssid[JCFW_WIFI_SSID_LEN_MAX + 1];
+    uint8_t          bssid[JCFW_WIFI_BSSID_LEN];
+    uint8_t          channel;
+    wifi_auth_mode_t authmode;
+    uint32_t         ip;
+} _jcfw_wifi_last_ap_t;
+
+typedef struct
+{
+    jcfw_wifi_sta_state_f cb;
+    void                 *arg;
+} _jcfw_wifi_subscriber_t;
+
+/// @brief What the manager does once an aborted attempt (or connection) has wound down.
+typedef enum
+{
+    _JCFW_WIFI_AFTER_ABORT_RETRY,
+    _JCFW_WIFI_AFTER_ABORT_RESTART,
+    _JCFW_WIFI_AFTER_ABORT_STOP,
+    _JCFW_WIFI_AFTER_ABORT_ROAM,
+} _jcfw_wifi_after_abort_e;
+
+/// @brief The state of the connection manager; Only touched by its task.
+typedef struct
+{
+    wifi_config_t            wifi_cfg;
+    _jcfw_wifi_last_ap_t     last_ap;
+    bool                     has_last_ap;
+    bool                     is_fast;
+    bool                     is_aborting;
+    _jcfw_wifi_after_abort_e after_abort;
+    bool                     has_deadline;
+    uint64_t                 deadline_us;
+    uint64_t                 started_us;
+    uint32_t                 retry_count;
+    uint32_t                 auth_failure_count;
+
+    /// @brief The access point being roamed to, and what the roam is based on.
+    _jcfw_wifi_last_ap_t     roam_ap;
+    bool                     is_roaming;
+    bool                     is_roam_scanning;
+    bool                     has_roam_scanned;
+    uint64_t                 roam_scan_us;
+    int8_t                   rssi_dBm;
+    uint32_t                 low_rssi_count;
+
+    /// @brief Called once the last request completes (see: _jcfw_wifi_manager_complete()).
+    jcfw_wifi_done_f         done_cb;
+    void                    *done_cb_arg;
+    bool                     is_done_on_connect;
+} _jcfw_wifi_manager_t;
+
 // TODO(Caleb): JCFW OS
 static EventGroupHandle_t           s_event_group        = NULL;
 static esp_netif_t                 *s_sta_netif          = NULL;
 static esp_event_handler_instance_t s_wifi_event_handler = NULL;
 static esp_event_handler_instance_t s_ip_event_handler   = NULL;
-static wifi_ap_record_t             s_scan_results[JCFW_WIFI_STA_SCAN_SIZE_MAX];
+
+// NOTE(Caleb): Set before the driver is started, and taken by the event handler once it has.
+static jcfw_wifi_done_f             s_init_cb            = NULL;
+static void                        *s_init_cb_arg        = NULL;
+
+// NOTE(Caleb): The scan cache is written by the WIFI event task and read by anyone, so the lock
+// guards it along with the result of the last scan and the pending scan callback. It also guards
+// what is handed to the manager task, and the static address and statistics, which any task may
+// set or read. The lock (and the task) outlive deinitialization, since neither can be destroyed.
+static jcfw_mutex_t               *s_lock             = NULL;
+static jcfw_wifi_sta_scan_result_t s_scan_cache[JCFW_WIFI_STA_SCAN_SIZE_MAX];
+static size_t                      s_scan_cache_count = 0;
+static jcfw_result_e               s_scan_result      = JCFW_RESULT_OK;
+static jcfw_wifi_sta_scan_f        s_scan_cb          = NULL;
+static void                       *s_scan_cb_arg      = NULL;
+
+// NOTE(Caleb): Filled in by the event handler before it signals the manager task.
+static _jcfw_wifi_last_ap_t        s_sta_ap;
+static uint8_t                     s_sta_reason    = 0;
+
+static bool                        s_has_static_ip = false;
+static jcfw_wifi_ip_config_t       s_static_ip;
+static jcfw_wifi_sta_stats_t       s_sta_stats;
+
+// NOTE(Caleb): The manager task owns the connection; Others only hand it what they want (under the
+// lock) and signal it.
+static jcfw_event_t               *s_manager_event            = NULL;
+static bool                        s_is_manager_started       = false;
+static bool                        s_is_wanted                = false;
+static wifi_config_t               s_wanted_cfg;
+static jcfw_wifi_done_f            s_request_cb               = NULL;
+static void                       *s_request_cb_arg           = NULL;
+static bool                        s_is_request_cb_on_connect = false;
+static jcfw_wifi_sta_state_e       s_sta_state                = JCFW_WIFI_STA_STATE_IDLE;
+static _jcfw_wifi_subscriber_t     s_subscribers[JCFW_WIFI_SUBSCRIBER_COUNT_MAX];
+static size_t                      s_subscriber_count         = 0;
+static _jcfw_wifi_manager_t        s_manager;
 
 // -------------------------------------------------------------------------------------------------
 
@@ -108,14 +214,46 @@ typedef enum
 {
     _JCFW_WIFI_STATUS_INITIALIZED   = JCFW_BIT(0),
     _JCFW_WIFI_STATUS_CONNECTED     = JCFW_BIT(1),
-    _JCFW_WIFI_STATUS_DISCONNECTING = JCFW_BIT(2),
     _JCFW_WIFI_STATUS_DISCONNECTED  = JCFW_BIT(3),
     _JCFW_WIFI_STATUS_SCAN_IN_PROG  = JCFW_BIT(4),
+    _JCFW_WIFI_STATUS_SCAN_DONE     = JCFW_BIT(5),
     _JCFW_WIFI_STATUS_FAILURE       = JCFW_BIT(23),
 } _jcfw_wifi_status_e;
 
+typedef enum
+{
+    _JCFW_WIFI_SIGNAL_REQUEST      = JCFW_BIT(0),
+    _JCFW_WIFI_SIGNAL_GOT_IP       = JCFW_BIT(1),
+    _JCFW_WIFI_SIGNAL_DISCONNECTED = JCFW_BIT(2),
+    _JCFW_WIFI_SIGNAL_SCAN_DONE    = JCFW_BIT(3),
+} _jcfw_wifi_signal_e;
+
+typedef enum
+{
+    _JCFW_WIFI_REASON_CLASS_RETRYABLE,
+    _JCFW_WIFI_REASON_CLASS_AUTH,
+    _JCFW_WIFI_REASON_CLASS_FATAL,
+} _jcfw_wifi_reason_class_e;
+
+/// @brief The last step of initialization to complete, in order (see: _jcfw_wifi_init_undo()).
+typedef enum
+{
+    _JCFW_WIFI_INIT_STAGE_NONE,
+    _JCFW_WIFI_INIT_STAGE_EVENT_GROUP,
+    _JCFW_WIFI_INIT_STAGE_EVENT_LOOP,
+    _JCFW_WIFI_INIT_STAGE_NETIF,
+    _JCFW_WIFI_INIT_STAGE_DRIVER,
+    _JCFW_WIFI_INIT_STAGE_WIFI_HANDLER,
+    _JCFW_WIFI_INIT_STAGE_IP_HANDLER,
+} _jcfw_wifi_init_stage_e;
+
 // -------------------------------------------------------------------------------------------------
 
+static jcfw_result_e
+_jcfw_wifi_init_start(jcfw_wifi_done_f cb, void *arg, _jcfw_wifi_init_stage_e *o_stage);
+
+static void _jcfw_wifi_init_undo(_jcfw_wifi_init_stage_e stage);
+
 static void _jcfw_wifi_sta_event_handler(
     void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 
@@ -126,90 +264,114 @@ static const char *_jcfw_wifi_get_reason_string(wifi_err_reason_t reason);
 static void
 _jcfw_wifi_convert_scan_result(jcfw_wifi_sta_scan_result_t *dest, wifi_ap_record_t *src);
 
-// -------------------------------------------------------------------------------------------------
+static jcfw_result_e _jcfw_wifi_scan_start(
+    const wifi_scan_config_t *scan_cfg, jcfw_wifi_sta_scan_f cb, void *arg);
 
-jcfw_result_e jcfw_wifi_init(void)
-{
-    JCFW_RETURN_IF_TRUE(jcfw_wifi_is_initialized(), JCFW_RESULT_OK);
+static void _jcfw_wifi_on_scan_done(bool is_complete);
 
-    // NOTE(Caleb): The order of the following function calls is important and must be preserved.
+static void _jcfw_wifi_merge_scan_results(uint64_t now_us);
 
-    esp_err_t err;
+static void _jcfw_wifi_manager_run(void *arg);
 
-    // TODO(Caleb): JCFW OS
-    s_event_group = xEventGroupCreate();
-    JCFW_ERROR_IF_FALSE(s_event_group, JCFW_RESULT_ERROR, "Unable to create an event group");
+static void _jcfw_wifi_manager_on_request(uint64_t now_us);
 
-    err = esp_netif_init();
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to initialize the ESP32 TCP/IP stack (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_on_got_ip(uint64_t now_us);
 
-    err = esp_event_loop_create_default();
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to initialize the ESP32 event loop (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_on_disconnected(uint64_t now_us, uint8_t reason);
 
-    // NOTE(Caleb): May abort the program if a failure occurs.
-    s_sta_netif = esp_netif_create_default_wifi_sta();
+static void _jcfw_wifi_manager_on_deadline(uint64_t now_us);
 
-    wifi_init_config_t wifi_cfg = WIFI_INIT_CONFIG_DEFAULT();
-    err                         = esp_wifi_init(&wifi_cfg);
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to initialize the ESP32 WIFI driver (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_on_aborted(uint64_t now_us);
 
-    err = esp_wifi_set_storage(WIFI_STORAGE_RAM);
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to set the WIFI storage location (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_on_failure(uint64_t now_us, uint8_t reason);
 
-    err = esp_event_handler_instance_register(
-        WIFI_EVENT, ESP_EVENT_ANY_ID, _jcfw_wifi_sta_event_handler, NULL, &s_wifi_event_handler);
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to register the WIFI event handler (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_on_sample(uint64_t now_us);
 
-    err = esp_event_handler_instance_register(
-        IP_EVENT, IP_EVENT_STA_GOT_IP, _jcfw_wifi_sta_event_handler, NULL, &s_ip_event_handler);
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to register the IP event handler (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_on_scan_done(uint64_t now_us);
 
-    err = esp_wifi_set_mode(WIFI_MODE_APSTA);
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to set the WIFI mode (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_begin(uint64_t now_us);
 
-    err = esp_wifi_start();
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to start the ESP32 WIFI driver (esp error %s)",
-        esp_err_to_name(err));
+static void _jcfw_wifi_manager_attempt(uint64_t now_us, const _jcfw_wifi_last_ap_t *ap);
+
+static void _jcfw_wifi_manager_abort(uint64_t now_us, _jcfw_wifi_after_abort_e after_abort);
+
+static void _jcfw_wifi_manager_set_state(jcfw_wifi_sta_state_e state);
+
+static void _jcfw_wifi_manager_complete(jcfw_result_e result);
+
+static jcfw_result_e _jcfw_wifi_sta_request(
+    bool is_wanted, const wifi_config_t *wifi_cfg, jcfw_wifi_done_f cb, void *arg);
+
+static TickType_t _jcfw_wifi_get_ticks(uint32_t timeout_ms);
+
+static _jcfw_wifi_reason_class_e _jcfw_wifi_classify_reason(uint8_t reason);
+
+static uint32_t _jcfw_wifi_get_backoff_ms(uint32_t retry_count);
+
+static jcfw_result_e _jcfw_wifi_sta_apply_ip_config(void);
+
+static bool _jcfw_wifi_load_last_ap(_jcfw_wifi_last_ap_t *o_last_ap);
+
+static void _jcfw_wifi_save_last_ap(const _jcfw_wifi_last_ap_t *last_ap);
+
+static inline bool _jcfw_wifi_is_scan_result_fresh(
+    const jcfw_wifi_sta_scan_result_t *result, uint64_t now_us)
+{
+    return now_us - result->seen_us < (uint64_t)JCFW_WIFI_SCAN_AGE_MAX_MS * 1000;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_wifi_init_start(jcfw_wifi_done_f cb, void *arg)
+{
+    JCFW_RETURN_IF_TRUE(jcfw_wifi_is_initialized(), JCFW_RESULT_OK);
+
+    // NOTE(Caleb): Already initializing; Only its one callback slot can be taken. The event
+    // handler completes it under the lock, so it can't be missed.
+    if (s_event_group)
+    {
+        jcfw_mutex_lock(s_lock);
+        const bool is_initialized = jcfw_wifi_is_initialized();
+        const bool is_full        = !is_initialized && s_init_cb && cb;
+        if (cb && !is_initialized && !is_full)
+        {
+            s_init_cb     = cb;
+            s_init_cb_arg = arg;
+        }
+        jcfw_mutex_unlock(s_lock);
+
+        JCFW_RETURN_IF_TRUE(is_initialized, JCFW_RESULT_OK);
+        return (is_full) ? JCFW_RESULT_FULL : JCFW_RESULT_IN_PROGRESS;
+    }
+
+    // NOTE(Caleb): A failure undoes whatever was done before it, so that initialization can be
+    // tried again.
+    _jcfw_wifi_init_stage_e stage    = _JCFW_WIFI_INIT_STAGE_NONE;
+    jcfw_result_e           jcfw_err = _jcfw_wifi_init_start(cb, arg, &stage);
+    if (jcfw_err != JCFW_RESULT_IN_PROGRESS)
+    {
+        _jcfw_wifi_init_undo(stage);
+    }
+
+    return jcfw_err;
+}
+
+jcfw_result_e jcfw_wifi_init(uint32_t timeout_ms)
+{
+    jcfw_result_e jcfw_err = jcfw_wifi_init_start(NULL, NULL);
+    JCFW_RETURN_IF_FALSE(jcfw_err == JCFW_RESULT_IN_PROGRESS, jcfw_err);
 
-    // TODO(Caleb): Wait for initialized bit to be set here.
     // TODO(Caleb): JCFW OS
     EventBits_t bits = xEventGroupWaitBits(
-        s_event_group, _JCFW_WIFI_STATUS_INITIALIZED, pdFALSE, pdFALSE, portMAX_DELAY);
+        s_event_group,
+        _JCFW_WIFI_STATUS_INITIALIZED,
+        pdFALSE,
+        pdFALSE,
+        _jcfw_wifi_get_ticks(timeout_ms));
 
     JCFW_ERROR_IF_FALSE(
         bits & _JCFW_WIFI_STATUS_INITIALIZED,
-        JCFW_RESULT_ERROR,
+        JCFW_RESULT_TIMEOUT,
         "Unable to complete WIFI initialization (timeout)");
 
     return JCFW_RESULT_OK;
@@ -222,9 +384,9 @@ jcfw_result_e jcfw_wifi_deinit(void)
     jcfw_result_e jcfw_err;
     esp_err_t     esp_err;
 
-    if (jcfw_wifi_sta_is_connected())
+    if (jcfw_wifi_sta_get_state() != JCFW_WIFI_STA_STATE_IDLE)
     {
-        jcfw_err = jcfw_wifi_sta_disconnect();
+        jcfw_err = jcfw_wifi_sta_disconnect(2 * _JCFW_WIFI_ABORT_TIMEOUT_MS);
 
         // NOTE(Caleb): jcfw_wifi_sta_disconnect() already outputs an appropriate error message
         JCFW_RETURN_IF_FALSE(jcfw_err == JCFW_RESULT_OK, JCFW_RESULT_ERROR);
@@ -290,134 +452,217 @@ jcfw_result_e jcfw_wifi_deinit(void)
     return JCFW_RESULT_OK;
 }
 
-jcfw_result_e jcfw_wifi_sta_connect(const char *ssid, const char *password)
+jcfw_result_e jcfw_wifi_sta_connect_start(
+    const char *ssid, const char *password, jcfw_wifi_done_f cb, void *arg)
 {
     JCFW_ERROR_IF_FALSE(
         jcfw_wifi_is_initialized(), JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
     JCFW_ERROR_IF_FALSE(ssid, JCFW_RESULT_INVALID_ARGS, "No SSID provided");
 
-    // TODO(Caleb): Disconnect if already connected
-    if (jcfw_wifi_sta_is_connected())
-    {
-        jcfw_result_e jcfw_err = jcfw_wifi_sta_disconnect();
-
-        // NOTE(Caleb): jcfw_wifi_sta_disconnect() already outputs an appropriate error message
-        JCFW_RETURN_IF_FALSE(jcfw_err == JCFW_RESULT_OK, JCFW_RESULT_ERROR);
-    }
-
-    esp_err_t         err;
-    wifi_sta_config_t sta_cfg = {0};
-
-    memcpy(sta_cfg.ssid, ssid, strnlen(ssid, sizeof(sta_cfg.ssid)));
+    wifi_config_t wifi_cfg = {0};
+    memcpy(wifi_cfg.sta.ssid, ssid, strnlen(ssid, sizeof(wifi_cfg.sta.ssid)));
 
     if (password)
     {
-        memcpy(sta_cfg.password, password, strnlen(password, sizeof(sta_cfg.password)));
+        memcpy(
+            wifi_cfg.sta.password, password, strnlen(password, sizeof(wifi_cfg.sta.password)));
     }
 
-    sta_cfg.threshold.authmode = (password) ? WIFI_AUTH_WPA_PSK : WIFI_AUTH_OPEN;
+    wifi_cfg.sta.threshold.authmode = (password) ? WIFI_AUTH_WPA_PSK : WIFI_AUTH_OPEN;
+
+    return _jcfw_wifi_sta_request(true, &wifi_cfg, cb, arg);
+}
 
-    wifi_config_t wifi_cfg = {.sta = sta_cfg};
-    err                    = esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg);
+jcfw_result_e jcfw_wifi_sta_disconnect_start(jcfw_wifi_done_f cb, void *arg)
+{
     JCFW_ERROR_IF_FALSE(
-        err == ESP_OK, JCFW_RESULT_ERROR, "Unable to configure the STA with new settings");
+        jcfw_wifi_is_initialized(), JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
+
+    return _jcfw_wifi_sta_request(false, NULL, cb, arg);
+}
 
-    err = esp_wifi_connect();
+jcfw_result_e jcfw_wifi_sta_connect(const char *ssid, const char *password, uint32_t timeout_ms)
+{
     JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to start the WIFI connect procedure (esp error %s)",
-        esp_err_to_name(err));
+        jcfw_wifi_is_initialized(), JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
+
+    // NOTE(Caleb): The manager goes through a new attempt even if it is already connected, which
+    // sets one of these again.
+    // TODO(Caleb): JCFW OS
+    xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_CONNECTED | _JCFW_WIFI_STATUS_FAILURE);
 
+    jcfw_result_e jcfw_err = jcfw_wifi_sta_connect_start(ssid, password, NULL, NULL);
+    JCFW_RETURN_IF_FALSE(jcfw_err == JCFW_RESULT_IN_PROGRESS, jcfw_err);
+
+    // NOTE(Caleb): Failed attempts which can be retried are, within the timeout; Only giving up
+    // sets the failure bit.
     // TODO(Caleb): JCFW OS
     EventBits_t bits = xEventGroupWaitBits(
         s_event_group,
         _JCFW_WIFI_STATUS_CONNECTED | _JCFW_WIFI_STATUS_FAILURE,
         pdFALSE,
         pdFALSE,
-        portMAX_DELAY);
+        _jcfw_wifi_get_ticks(timeout_ms));
 
     JCFW_ERROR_IF_TRUE(
         bits & _JCFW_WIFI_STATUS_FAILURE,
         JCFW_RESULT_ERROR,
-        "Unable to complete the WIFI connect procedure (max retries)");
-
+        "Unable to complete the WIFI connect procedure (failure)");
     JCFW_ERROR_IF_FALSE(
         bits & _JCFW_WIFI_STATUS_CONNECTED,
-        JCFW_RESULT_ERROR,
+        JCFW_RESULT_TIMEOUT,
         "Unable to complete the WIFI connect procedure (timeout)");
 
     return JCFW_RESULT_OK;
 }
 
-jcfw_result_e jcfw_wifi_sta_disconnect(void)
+jcfw_result_e jcfw_wifi_sta_disconnect(uint32_t timeout_ms)
 {
     JCFW_ERROR_IF_FALSE(
         jcfw_wifi_is_initialized(), JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
 
-    xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_DISCONNECTING);
+    // TODO(Caleb): JCFW OS
+    xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_DISCONNECTED);
 
-    esp_err_t err = esp_wifi_disconnect();
-    JCFW_ERROR_IF_FALSE(
-        err == ESP_OK,
-        JCFW_RESULT_ERROR,
-        "Unable to start the WIFI disconnect procedure (esp error %s)",
-        esp_err_to_name(err));
+    jcfw_result_e jcfw_err = jcfw_wifi_sta_disconnect_start(NULL, NULL);
+    JCFW_RETURN_IF_FALSE(jcfw_err == JCFW_RESULT_IN_PROGRESS, jcfw_err);
 
     // TODO(Caleb): JCFW OS
     EventBits_t bits = xEventGroupWaitBits(
-        s_event_group, _JCFW_WIFI_STATUS_DISCONNECTED, pdFALSE, pdFALSE, portMAX_DELAY);
+        s_event_group,
+        _JCFW_WIFI_STATUS_DISCONNECTED,
+        pdFALSE,
+        pdFALSE,
+        _jcfw_wifi_get_ticks(timeout_ms));
 
     JCFW_ERROR_IF_FALSE(
         bits & _JCFW_WIFI_STATUS_DISCONNECTED,
-        JCFW_RESULT_ERROR,
+        JCFW_RESULT_TIMEOUT,
         "Unable to complete the WIFI disconnect procedure (timeout)");
 
     return JCFW_RESULT_OK;
 }
 
+jcfw_wifi_sta_state_e jcfw_wifi_sta_get_state(void)
+{
+    JCFW_RETURN_IF_FALSE(s_lock, JCFW_WIFI_STA_STATE_IDLE);
+
+    jcfw_mutex_lock(s_lock);
+    const jcfw_wifi_sta_state_e state = s_sta_state;
+    jcfw_mutex_unlock(s_lock);
+
+    return state;
+}
+
+jcfw_result_e jcfw_wifi_sta_subscribe(jcfw_wifi_sta_state_f cb, void *arg)
+{
+    JCFW_ERROR_IF_FALSE(cb, JCFW_RESULT_INVALID_ARGS, "No callback provided");
+    JCFW_ERROR_IF_FALSE(s_lock, JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
+
+    jcfw_mutex_lock(s_lock);
+    const bool is_full = (s_subscriber_count >= JCFW_ARRAYSIZE(s_subscribers));
+    if (!is_full)
+    {
+        s_subscribers[s_subscriber_count].cb  = cb;
+        s_subscribers[s_subscriber_count].arg = arg;
+        s_subscriber_count++;
+    }
+    jcfw_mutex_unlock(s_lock);
+
+    JCFW_ERROR_IF_TRUE(is_full, JCFW_RESULT_FULL, "No free WIFI subscriber slots");
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_wifi_sta_set_static_ip(const jcfw_wifi_ip_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(s_lock, JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
+
+    jcfw_mutex_lock(s_lock);
+    s_has_static_ip = (config != NULL);
+    if (config)
+    {
+        s_static_ip = *config;
+    }
+    jcfw_mutex_unlock(s_lock);
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_wifi_sta_get_stats(jcfw_wifi_sta_stats_t *o_stats)
+{
+    memset(o_stats, 0, sizeof(*o_stats));
+    JCFW_RETURN_IF_FALSE(s_lock);
+
+    jcfw_mutex_lock(s_lock);
+    *o_stats = s_sta_stats;
+    jcfw_mutex_unlock(s_lock);
+}
+
+jcfw_result_e jcfw_wifi_sta_scan_start(jcfw_wifi_sta_scan_f cb, void *arg)
+{
+    JCFW_ERROR_IF_FALSE(
+        jcfw_wifi_is_initialized(), JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
+
+    return _jcfw_wifi_scan_start(NULL, cb, arg);
+}
+
 jcfw_result_e jcfw_wifi_sta_scan(jcfw_wifi_sta_scan_result_t *o_aps, size_t *io_num_aps)
 {
     JCFW_ERROR_IF_FALSE(
         jcfw_wifi_is_initialized(), JCFW_RESULT_NOT_INITIALIZED, "WIFI is not initialized");
     JCFW_ERROR_IF_FALSE(
-        o_aps || io_num_aps || *io_num_aps > 0,
+        o_aps && io_num_aps && *io_num_aps > 0,
         JCFW_RESULT_INVALID_ARGS,
         "No memory provided for scan results");
-    JCFW_ERROR_IF_FALSE(
-        *io_num_aps <= JCFW_WIFI_STA_SCAN_SIZE_MAX,
-        JCFW_RESULT_INVALID_ARGS,
-        "Invalid scan result request size (requested %zu results, max request size %zu results)",
-        *io_num_aps,
-        JCFW_WIFI_STA_SCAN_SIZE_MAX);
-    JCFW_ERROR_IF_TRUE(
-        jcfw_wifi_sta_is_scanning(), JCFW_RESULT_IN_PROGRESS, "A scan is already in progress");
 
-    xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_IN_PROG);
+    jcfw_result_e jcfw_err = jcfw_wifi_sta_scan_start(NULL, NULL);
+    JCFW_RETURN_IF_FALSE(jcfw_err == JCFW_RESULT_IN_PROGRESS, jcfw_err);
 
-    esp_err_t err;
+    // TODO(Caleb): JCFW OS
+    EventBits_t bits = xEventGroupWaitBits(
+        s_event_group,
+        _JCFW_WIFI_STATUS_SCAN_DONE,
+        pdFALSE,
+        pdFALSE,
+        pdMS_TO_TICKS(JCFW_WIFI_SCAN_TIMEOUT_MS));
+
+    JCFW_ERROR_IF_FALSE(
+        bits & _JCFW_WIFI_STATUS_SCAN_DONE,
+        JCFW_RESULT_TIMEOUT,
+        "Unable to complete the WIFI scan procedure (timeout)");
 
-    uint16_t num_aps = *io_num_aps;
-    memset(s_scan_results, 0, sizeof(s_scan_results));
+    jcfw_mutex_lock(s_lock);
+    const jcfw_result_e scan_result = s_scan_result;
+    jcfw_mutex_unlock(s_lock);
 
-    err = esp_wifi_scan_start(NULL, true);
     JCFW_ERROR_IF_FALSE(
-        err == ESP_OK, JCFW_RESULT_ERROR, "Unable to start the WIFI scan procedure");
+        scan_result == JCFW_RESULT_OK,
+        scan_result,
+        "Unable to complete the WIFI scan procedure (scan failed)");
+
+    return jcfw_wifi_sta_get_scan_cache(o_aps, io_num_aps);
+}
 
-    // NOTE(Caleb): The following will be refactored into a helper function when nonblocking
-    // scanning is implemented
+jcfw_result_e jcfw_wifi_sta_get_scan_cache(jcfw_wifi_sta_scan_result_t *o_aps, size_t *io_num_aps)
+{
+    JCFW_ERROR_IF_FALSE(
+        o_aps && io_num_aps, JCFW_RESULT_INVALID_ARGS, "No memory provided for scan results");
+    JCFW_RETURN_IF_FALSE(s_lock, JCFW_RESULT_NOT_INITIALIZED);
 
-    err = esp_wifi_scan_get_ap_records(&num_aps, s_scan_results);
-    JCFW_ERROR_IF_FALSE(err == ESP_OK, JCFW_RESULT_ERROR, "Unable to retrieve scan results");
+    const uint64_t now_us = jcfw_platform_get_time_us();
+    size_t         count  = 0;
 
-    for (uint16_t i = 0; i < num_aps; i++)
+    jcfw_mutex_lock(s_lock);
+    for (size_t i = 0; i < s_scan_cache_count && count < *io_num_aps; i++)
     {
-        _jcfw_wifi_convert_scan_result(&o_aps[i], &s_scan_results[i]);
+        if (_jcfw_wifi_is_scan_result_fresh(&s_scan_cache[i], now_us))
+        {
+            o_aps[count++] = s_scan_cache[i];
+        }
     }
+    jcfw_mutex_unlock(s_lock);
 
-    *io_num_aps = num_aps;
-
-    xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_IN_PROG);
+    *io_num_aps = count;
 
     return JCFW_RESULT_OK;
 }
@@ -449,83 +694,296 @@ jcfw_result_e jcfw_wifi_sta_is_scanning(void)
     return bits & _JCFW_WIFI_STATUS_SCAN_IN_PROG;
 }
 
-static void _jcfw_wifi_sta_event_handler(
-    void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+static jcfw_result_e
+_jcfw_wifi_init_start(jcfw_wifi_done_f cb, void *arg, _jcfw_wifi_init_stage_e *o_stage)
 {
-    JCFW_ERROR_IF_FALSE(
-        event_base == WIFI_EVENT || event_base == IP_EVENT,
-        /* ... */,
-        "jcfw_wifi_sta event handler received unexpexted event base: %s",
-        event_base);
+    // NOTE(Caleb): The order of the following function calls is important and must be preserved.
 
-    EventBits_t bits = xEventGroupGetBits(s_event_group);
+    jcfw_result_e jcfw_err;
+    esp_err_t     err;
 
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
-    {
-        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "WIFI STA driver has been initialized");
+    // TODO(Caleb): JCFW OS
+    s_event_group = xEventGroupCreate();
+    JCFW_ERROR_IF_FALSE(s_event_group, JCFW_RESULT_ERROR, "Unable to create an event group");
+    *o_stage = _JCFW_WIFI_INIT_STAGE_EVENT_GROUP;
 
-        // TODO(Caleb): JCFW OS
-        xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_INITIALIZED);
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    if (!s_lock)
     {
-        wifi_event_sta_connected_t *sta_conn_evt = event_data;
-
-        JCFW_TRACELN_INFO(
-            STA_TRACE_TAG,
-            "STA connected to AP with SSID \"%.*s\". Waiting for IP address from DHCP...",
-            sta_conn_evt->ssid_len,
-            sta_conn_evt->ssid);
+        jcfw_err = jcfw_mutex_create(&s_lock);
+        JCFW_ERROR_IF_FALSE(
+            jcfw_err == JCFW_RESULT_OK, jcfw_err, "Unable to create the scan cache lock");
+
+        jcfw_sketch_init(
+            &s_sta_stats.fast_connect_ms,
+            JCFW_WIFI_CONNECT_TIME_MIN_MS,
+            JCFW_WIFI_CONNECT_TIME_MAX_MS);
+        jcfw_sketch_init(
+            &s_sta_stats.full_connect_ms,
+            JCFW_WIFI_CONNECT_TIME_MIN_MS,
+            JCFW_WIFI_CONNECT_TIME_MAX_MS);
+        jcfw_sketch_init(
+            &s_sta_stats.roam_ms, JCFW_WIFI_CONNECT_TIME_MIN_MS, JCFW_WIFI_CONNECT_TIME_MAX_MS);
+    }
 
-        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "Connection Info:");
-        JCFW_TRACELN_DEBUG(
-            STA_TRACE_TAG, "  SSID: %.*s", sta_conn_evt->ssid_len, sta_conn_evt->ssid);
-        JCFW_TRACELN_DEBUG(
-            STA_TRACE_TAG,
-            "  MAC Address (BSSID): %02X:%02X:%02X:%02X:%02X:%02X",
-            sta_conn_evt->bssid[0],
-            sta_conn_evt->bssid[1],
-            sta_conn_evt->bssid[2],
-            sta_conn_evt->bssid[3],
-            sta_conn_evt->bssid[4],
-            sta_conn_evt->bssid[5]);
-        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "  Channel: %u", sta_conn_evt->channel);
-        JCFW_TRACELN_DEBUG(
-            STA_TRACE_TAG,
-            "  Auth. Mode: %u (%s)",
-            sta_conn_evt->authmode,
-            _jcfw_wifi_get_authmode_string(sta_conn_evt->authmode));
-        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "  Assoc. ID: %hu", sta_conn_evt->aid);
+    if (!s_manager_event)
+    {
+        jcfw_err = jcfw_event_create(&s_manager_event);
+        JCFW_ERROR_IF_FALSE(
+            jcfw_err == JCFW_RESULT_OK, jcfw_err, "Unable to create the WIFI manager event");
     }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+
+    if (!s_is_manager_started)
     {
-        wifi_event_sta_disconnected_t *sta_disconn_evt = event_data;
+        jcfw_task_config_t task_config = {
+            .name       = "JCFW-WIFI",
+            .stack_size = JCFW_WIFI_TASK_STACK_SIZE,
+            .priority   = JCFW_WIFI_TASK_PRIORITY,
+            .core       = JCFW_TASK_CORE_ANY,
+        };
+        jcfw_err = jcfw_task_create(&task_config, _jcfw_wifi_manager_run, NULL);
+        JCFW_ERROR_IF_FALSE(
+            jcfw_err == JCFW_RESULT_OK, jcfw_err, "Unable to create the WIFI manager task");
+        s_is_manager_started = true;
+    }
 
-        JCFW_TRACELN_INFO(
-            STA_TRACE_TAG,
-            "STA disconnected from AP with SSID \"%.*s\" (reason %u - %s)",
-            sta_disconn_evt->ssid_len,
-            sta_disconn_evt->ssid,
-            sta_disconn_evt->reason,
-            _jcfw_wifi_get_reason_string(sta_disconn_evt->reason));
+    // NOTE(Caleb): Can't be undone, but is fine to repeat.
+    err = esp_netif_init();
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to initialize the ESP32 TCP/IP stack (esp error %s)",
+        esp_err_to_name(err));
+
+    err = esp_event_loop_create_default();
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to initialize the ESP32 event loop (esp error %s)",
+        esp_err_to_name(err));
+    *o_stage = _JCFW_WIFI_INIT_STAGE_EVENT_LOOP;
+
+    // NOTE(Caleb): May abort the program if a failure occurs.
+    s_sta_netif = esp_netif_create_default_wifi_sta();
+    *o_stage    = _JCFW_WIFI_INIT_STAGE_NETIF;
+
+    wifi_init_config_t wifi_cfg = WIFI_INIT_CONFIG_DEFAULT();
+    err                         = esp_wifi_init(&wifi_cfg);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to initialize the ESP32 WIFI driver (esp error %s)",
+        esp_err_to_name(err));
+    *o_stage = _JCFW_WIFI_INIT_STAGE_DRIVER;
+
+    err = esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to set the WIFI storage location (esp error %s)",
+        esp_err_to_name(err));
+
+    err = esp_event_handler_instance_register(
+        WIFI_EVENT, ESP_EVENT_ANY_ID, _jcfw_wifi_sta_event_handler, NULL, &s_wifi_event_handler);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to register the WIFI event handler (esp error %s)",
+        esp_err_to_name(err));
+    *o_stage = _JCFW_WIFI_INIT_STAGE_WIFI_HANDLER;
+
+    err = esp_event_handler_instance_register(
+        IP_EVENT, IP_EVENT_STA_GOT_IP, _jcfw_wifi_sta_event_handler, NULL, &s_ip_event_handler);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to register the IP event handler (esp error %s)",
+        esp_err_to_name(err));
+    *o_stage = _JCFW_WIFI_INIT_STAGE_IP_HANDLER;
+
+    err = esp_wifi_set_mode(WIFI_MODE_APSTA);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to set the WIFI mode (esp error %s)",
+        esp_err_to_name(err));
+
+    // NOTE(Caleb): The driver signals that it has started from its own task, maybe before this
+    // returns, so the callback has to be in place first.
+    jcfw_mutex_lock(s_lock);
+    s_init_cb     = cb;
+    s_init_cb_arg = arg;
+    jcfw_mutex_unlock(s_lock);
+
+    err = esp_wifi_start();
+    if (err != ESP_OK)
+    {
+        jcfw_mutex_lock(s_lock);
+        s_init_cb = NULL;
+        jcfw_mutex_unlock(s_lock);
+
+        JCFW_TRACELN_ERROR(
+            STA_TRACE_TAG,
+            "Unable to start the ESP32 WIFI driver (esp error %s)",
+            esp_err_to_name(err));
+        return JCFW_RESULT_ERROR;
+    }
+
+    return JCFW_RESULT_IN_PROGRESS;
+}
+
+static void _jcfw_wifi_init_undo(_jcfw_wifi_init_stage_e stage)
+{
+    // NOTE(Caleb): Each stage falls through to undo the ones before it. A failure here can only be
+    // reported, since it is already being handled.
+    esp_err_t err;
+
+    switch (stage)
+    {
+        case _JCFW_WIFI_INIT_STAGE_IP_HANDLER:
+            err = esp_event_handler_instance_unregister(
+                IP_EVENT, IP_EVENT_STA_GOT_IP, s_ip_event_handler);
+            if (err != ESP_OK)
+            {
+                JCFW_TRACELN_ERROR(
+                    STA_TRACE_TAG,
+                    "Unable to unregister the IP event handler (esp error %s)",
+                    esp_err_to_name(err));
+            }
+            __attribute__((fallthrough));
+        case _JCFW_WIFI_INIT_STAGE_WIFI_HANDLER:
+            err = esp_event_handler_instance_unregister(
+                WIFI_EVENT, ESP_EVENT_ANY_ID, s_wifi_event_handler);
+            if (err != ESP_OK)
+            {
+                JCFW_TRACELN_ERROR(
+                    STA_TRACE_TAG,
+                    "Unable to unregister the WIFI event handler (esp error %s)",
+                    esp_err_to_name(err));
+            }
+            __attribute__((fallthrough));
+        case _JCFW_WIFI_INIT_STAGE_DRIVER:
+            err = esp_wifi_deinit();
+            if (err != ESP_OK)
+            {
+                JCFW_TRACELN_ERROR(
+                    STA_TRACE_TAG,
+                    "Unable to deinitialize the ESP32 WIFI driver (esp error %s)",
+                    esp_err_to_name(err));
+            }
+            __attribute__((fallthrough));
+        case _JCFW_WIFI_INIT_STAGE_NETIF:
+            esp_netif_destroy_default_wifi(s_sta_netif);
+            s_sta_netif = NULL;
+            __attribute__((fallthrough));
+        case _JCFW_WIFI_INIT_STAGE_EVENT_LOOP:
+            err = esp_event_loop_delete_default();
+            if (err != ESP_OK)
+            {
+                JCFW_TRACELN_ERROR(
+                    STA_TRACE_TAG,
+                    "Unable to delete the ESP32 event loop (esp error %s)",
+                    esp_err_to_name(err));
+            }
+            __attribute__((fallthrough));
+        case _JCFW_WIFI_INIT_STAGE_EVENT_GROUP:
+            // TODO(Caleb): JCFW OS
+            vEventGroupDelete(s_event_group);
+            s_event_group = NULL;
+            __attribute__((fallthrough));
+        case _JCFW_WIFI_INIT_STAGE_NONE:
+            break;
+    }
+}
+
+static void _jcfw_wifi_sta_event_handler(
+    void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    JCFW_ERROR_IF_FALSE(
+        event_base == WIFI_EVENT || event_base == IP_EVENT,
+        /* ... */,
+        "jcfw_wifi_sta event handler received unexpexted event base: %s",
+        event_base);
+
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
+    {
+        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "WIFI STA driver has been initialized");
+
+        jcfw_mutex_lock(s_lock);
+        jcfw_wifi_done_f cb     = s_init_cb;
+        void            *cb_arg = s_init_cb_arg;
+        s_init_cb               = NULL;
 
-        // TODO(Caleb): Check to see if the disconnect is intentional
         // TODO(Caleb): JCFW OS
-        if (bits & _JCFW_WIFI_STATUS_CONNECTED)
-        {
-            xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_CONNECTED);
-        }
+        xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_INITIALIZED);
+        jcfw_mutex_unlock(s_lock);
 
-        if (bits & _JCFW_WIFI_STATUS_DISCONNECTING)
-        {
-            xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_DISCONNECTING);
-            xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_DISCONNECTED);
-        }
-        else
+        if (cb)
         {
-            xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_FAILURE);
+            cb(JCFW_RESULT_OK, cb_arg);
         }
     }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        wifi_event_sta_connected_t *sta_conn_evt = event_data;
+
+        JCFW_TRACELN_INFO(
+            STA_TRACE_TAG,
+            "STA connected to AP with SSID \"%.*s\". Waiting for IP address from DHCP...",
+            sta_conn_evt->ssid_len,
+            sta_conn_evt->ssid);
+
+        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "Connection Info:");
+        JCFW_TRACELN_DEBUG(
+            STA_TRACE_TAG, "  SSID: %.*s", sta_conn_evt->ssid_len, sta_conn_evt->ssid);
+        JCFW_TRACELN_DEBUG(
+            STA_TRACE_TAG,
+            "  MAC Address (BSSID): %02X:%02X:%02X:%02X:%02X:%02X",
+            sta_conn_evt->bssid[0],
+            sta_conn_evt->bssid[1],
+            sta_conn_evt->bssid[2],
+            sta_conn_evt->bssid[3],
+            sta_conn_evt->bssid[4],
+            sta_conn_evt->bssid[5]);
+        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "  Channel: %u", sta_conn_evt->channel);
+        JCFW_TRACELN_DEBUG(
+            STA_TRACE_TAG,
+            "  Auth. Mode: %u (%s)",
+            sta_conn_evt->authmode,
+            _jcfw_wifi_get_authmode_string(sta_conn_evt->authmode));
+        JCFW_TRACELN_DEBUG(STA_TRACE_TAG, "  Assoc. ID: %hu", sta_conn_evt->aid);
+
+        memcpy(s_sta_ap.bssid, sta_conn_evt->bssid, sizeof(s_sta_ap.bssid));
+        s_sta_ap.channel  = sta_conn_evt->channel;
+        s_sta_ap.authmode = sta_conn_evt->authmode;
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    {
+        wifi_event_sta_disconnected_t *sta_disconn_evt = event_data;
+
+        JCFW_TRACELN_INFO(
+            STA_TRACE_TAG,
+            "STA disconnected from AP with SSID \"%.*s\" (reason %u - %s)",
+            sta_disconn_evt->ssid_len,
+            sta_disconn_evt->ssid,
+            sta_disconn_evt->reason,
+            _jcfw_wifi_get_reason_string(sta_disconn_evt->reason));
+
+        // NOTE(Caleb): The manager tells intentional disconnects apart from lost connections.
+        s_sta_reason = sta_disconn_evt->reason;
+        jcfw_event_signal(s_manager_event, _JCFW_WIFI_SIGNAL_DISCONNECTED);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
+    {
+        wifi_event_sta_scan_done_t *scan_done_evt = event_data;
+
+        JCFW_TRACELN_DEBUG(
+            STA_TRACE_TAG,
+            "Scan %s with %u access points",
+            (scan_done_evt->status == 0) ? "completed" : "failed",
+            scan_done_evt->number);
+
+        _jcfw_wifi_on_scan_done(scan_done_evt->status == 0);
+    }
     else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
     {
         ip_event_got_ip_t *got_ip_evt = event_data;
@@ -548,13 +1006,8 @@ static void _jcfw_wifi_sta_event_handler(
         JCFW_TRACELN_DEBUG(
             STA_TRACE_TAG, "  Gateway Address: " IPSTR, IP2STR(&got_ip_evt->ip_info.gw));
 
-        // TODO(Caleb): JCFW OS
-        if (bits & _JCFW_WIFI_STATUS_DISCONNECTED)
-        {
-            xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_DISCONNECTED);
-        }
-
-        xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_CONNECTED);
+        s_sta_ap.ip = got_ip_evt->ip_info.ip.addr;
+        jcfw_event_signal(s_manager_event, _JCFW_WIFI_SIGNAL_GOT_IP);
     }
     else
     {
@@ -588,3 +1041,887 @@ static void _jcfw_wifi_convert_scan_result(jcfw_wifi_sta_scan_result_t *dest, wi
     dest->rssi_dBm = src->rssi;
     dest->channel  = src->primary;
 }
+
+static jcfw_result_e _jcfw_wifi_scan_start(
+    const wifi_scan_config_t *scan_cfg, jcfw_wifi_sta_scan_f cb, void *arg)
+{
+    jcfw_mutex_lock(s_lock);
+
+    // NOTE(Caleb): A scan which is already running gives results just as fresh, so ride along with
+    // it rather than failing; Only its one callback slot can be taken.
+    const bool is_scanning = jcfw_wifi_sta_is_scanning();
+    if (is_scanning && s_scan_cb && cb)
+    {
+        jcfw_mutex_unlock(s_lock);
+        return JCFW_RESULT_FULL;
+    }
+
+    if (cb)
+    {
+        s_scan_cb     = cb;
+        s_scan_cb_arg = arg;
+    }
+
+    if (!is_scanning)
+    {
+        // TODO(Caleb): JCFW OS
+        xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_DONE);
+        xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_IN_PROG);
+
+        esp_err_t err = esp_wifi_scan_start(scan_cfg, false);
+        if (err != ESP_OK)
+        {
+            xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_IN_PROG);
+            s_scan_cb = NULL;
+            jcfw_mutex_unlock(s_lock);
+
+            JCFW_TRACELN_ERROR(
+                STA_TRACE_TAG,
+                "Unable to start the WIFI scan procedure (esp error %s)",
+                esp_err_to_name(err));
+            return JCFW_RESULT_ERROR;
+        }
+    }
+
+    jcfw_mutex_unlock(s_lock);
+    return JCFW_RESULT_IN_PROGRESS;
+}
+
+static void _jcfw_wifi_on_scan_done(bool is_complete)
+{
+    jcfw_mutex_lock(s_lock);
+
+    if (is_complete)
+    {
+        _jcfw_wifi_merge_scan_results(jcfw_platform_get_time_us());
+    }
+
+    // NOTE(Caleb): Frees whatever the driver still holds (e.g. after a failed scan).
+    esp_wifi_clear_ap_list();
+
+    const jcfw_result_e  result   = is_complete ? JCFW_RESULT_OK : JCFW_RESULT_ERROR;
+    const size_t         ap_count = s_scan_cache_count;
+    jcfw_wifi_sta_scan_f cb       = s_scan_cb;
+    void                *cb_arg   = s_scan_cb_arg;
+    s_scan_cb                     = NULL;
+    s_scan_result                 = result;
+
+    // TODO(Caleb): JCFW OS
+    xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_IN_PROG);
+    xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_SCAN_DONE);
+
+    jcfw_mutex_unlock(s_lock);
+
+    if (cb)
+    {
+        cb(result, ap_count, cb_arg);
+    }
+
+    // NOTE(Caleb): The manager may be waiting on the scan to roam.
+    jcfw_event_signal(s_manager_event, _JCFW_WIFI_SIGNAL_SCAN_DONE);
+}
+
+static void _jcfw_wifi_merge_scan_results(uint64_t now_us)
+{
+    size_t kept_count = 0;
+    for (size_t i = 0; i < s_scan_cache_count; i++)
+    {
+        if (_jcfw_wifi_is_scan_result_fresh(&s_scan_cache[i], now_us))
+        {
+            s_scan_cache[kept_count++] = s_scan_cache[i];
+        }
+    }
+    s_scan_cache_count = kept_count;
+
+    // NOTE(Caleb): Take the records from the driver one at a time, straight into the cache. An
+    // access point which is already cached is updated in place; When the cache is full, a new one
+    // replaces the weakest if it is stronger.
+    wifi_ap_record_t record;
+    while (esp_wifi_scan_get_ap_record(&record) == ESP_OK)
+    {
+        jcfw_wifi_sta_scan_result_t *entry   = NULL;
+        jcfw_wifi_sta_scan_result_t *weakest = NULL;
+        for (size_t i = 0; i < s_scan_cache_count; i++)
+        {
+            if (memcmp(s_scan_cache[i].bssid, record.bssid, JCFW_WIFI_BSSID_LEN) == 0)
+            {
+                entry = &s_scan_cache[i];
+                break;
+            }
+
+            if (!weakest || s_scan_cache[i].rssi_dBm < weakest->rssi_dBm)
+            {
+                weakest = &s_scan_cache[i];
+            }
+        }
+
+        if (!entry && s_scan_cache_count < JCFW_WIFI_STA_SCAN_SIZE_MAX)
+        {
+            entry = &s_scan_cache[s_scan_cache_count++];
+        }
+        else if (!entry && weakest->rssi_dBm < record.rssi)
+        {
+            entry = weakest;
+        }
+
+        if (entry)
+        {
+            _jcfw_wifi_convert_scan_result(entry, &record);
+            entry->seen_us = now_us;
+        }
+    }
+
+    // NOTE(Caleb): Insertion sort, strongest first; The cache is small, and mostly sorted already.
+    for (size_t i = 1; i < s_scan_cache_count; i++)
+    {
+        const jcfw_wifi_sta_scan_result_t result = s_scan_cache[i];
+
+        size_t j = i;
+        while (j > 0 && s_scan_cache[j - 1].rssi_dBm < result.rssi_dBm)
+        {
+            s_scan_cache[j] = s_scan_cache[j - 1];
+            j--;
+        }
+        s_scan_cache[j] = result;
+    }
+}
+
+static void _jcfw_wifi_manager_run(void *arg)
+{
+    while (1)
+    {
+        uint32_t timeout_ms = JCFW_EVENT_WAIT_FOREVER;
+        if (s_manager.has_deadline)
+        {
+            const uint64_t now_us = jcfw_platform_get_time_us();
+            timeout_ms            = (s_manager.deadline_us > now_us)
+                                        ? (uint32_t)((s_manager.deadline_us - now_us + 999) / 1000)
+                                        : 0;
+        }
+
+        const uint32_t signals = jcfw_event_wait(s_manager_event, timeout_ms);
+        const uint64_t now_us  = jcfw_platform_get_time_us();
+
+        // NOTE(Caleb): What happened to the current attempt goes first, so that a request which
+        // came in along with it is applied on top.
+        if (signals & _JCFW_WIFI_SIGNAL_DISCONNECTED)
+        {
+            _jcfw_wifi_manager_on_disconnected(now_us, s_sta_reason);
+        }
+
+        if (signals & _JCFW_WIFI_SIGNAL_GOT_IP)
+        {
+            _jcfw_wifi_manager_on_got_ip(now_us);
+        }
+
+        if (signals & _JCFW_WIFI_SIGNAL_SCAN_DONE)
+        {
+            _jcfw_wifi_manager_on_scan_done(now_us);
+        }
+
+        if (s_manager.has_deadline && now_us >= s_manager.deadline_us)
+        {
+            _jcfw_wifi_manager_on_deadline(now_us);
+        }
+
+        if (signals & _JCFW_WIFI_SIGNAL_REQUEST)
+        {
+            _jcfw_wifi_manager_on_request(now_us);
+        }
+    }
+}
+
+static void _jcfw_wifi_manager_on_request(uint64_t now_us)
+{
+    jcfw_mutex_lock(s_lock);
+    const bool          is_wanted        = s_is_wanted;
+    const wifi_config_t wifi_cfg         = s_wanted_cfg;
+    const bool          is_cb_on_connect = s_is_request_cb_on_connect;
+    jcfw_wifi_done_f    cb               = s_request_cb;
+    void               *cb_arg           = s_request_cb_arg;
+    s_request_cb                         = NULL;
+    jcfw_mutex_unlock(s_lock);
+
+    // NOTE(Caleb): A request with a callback may have been merged into one of the other kind
+    // (e.g. connect, then disconnect) before it got here; It can't complete.
+    if (cb && is_cb_on_connect != is_wanted)
+    {
+        cb(JCFW_RESULT_ERROR, cb_arg);
+        cb = NULL;
+    }
+
+    // NOTE(Caleb): A request which is still waiting to complete is overtaken by one with a
+    // callback of its own, or by one of the other kind.
+    if (cb || is_wanted != s_manager.is_done_on_connect)
+    {
+        _jcfw_wifi_manager_complete(JCFW_RESULT_ERROR);
+        s_manager.done_cb            = cb;
+        s_manager.done_cb_arg        = cb_arg;
+        s_manager.is_done_on_connect = is_wanted;
+    }
+
+    // NOTE(Caleb): The radio has to be quiet before the next attempt (or before stopping), so a
+    // running attempt or connection is wound down first.
+    const bool is_busy = s_sta_state == JCFW_WIFI_STA_STATE_CONNECTING
+                      || s_sta_state == JCFW_WIFI_STA_STATE_CONNECTED;
+    const _jcfw_wifi_after_abort_e after_abort =
+        (is_wanted) ? _JCFW_WIFI_AFTER_ABORT_RESTART : _JCFW_WIFI_AFTER_ABORT_STOP;
+
+    s_manager.is_roaming       = false;
+    s_manager.is_roam_scanning = false;
+
+    if (is_wanted)
+    {
+        s_manager.wifi_cfg           = wifi_cfg;
+        s_manager.retry_count        = 0;
+        s_manager.auth_failure_count = 0;
+        s_manager.has_last_ap =
+            _jcfw_wifi_load_last_ap(&s_manager.last_ap)
+            && strncmp(
+                   (const char *)s_manager.last_ap.ssid,
+                   (const char *)wifi_cfg.sta.ssid,
+                   sizeof(wifi_cfg.sta.ssid))
+                   == 0;
+    }
+
+    if (s_manager.is_aborting)
+    {
+        s_manager.after_abort = after_abort;
+    }
+    else if (is_busy)
+    {
+        _jcfw_wifi_manager_abort(now_us, after_abort);
+    }
+    else if (is_wanted)
+    {
+        _jcfw_wifi_manager_begin(now_us);
+    }
+    else
+    {
+        s_manager.has_deadline = false;
+        _jcfw_wifi_manager_set_state(JCFW_WIFI_STA_STATE_IDLE);
+    }
+}
+
+static void _jcfw_wifi_manager_on_got_ip(uint64_t now_us)
+{
+    JCFW_RETURN_IF_FALSE(s_sta_state == JCFW_WIFI_STA_STATE_CONNECTING && !s_manager.is_aborting);
+
+    const uint32_t connect_ms = (uint32_t)((now_us - s_manager.started_us) / 1000);
+
+    jcfw_mutex_lock(s_lock);
+    if (s_manager.is_roaming)
+    {
+        s_sta_stats.roam_count++;
+        jcfw_sketch_add(&s_sta_stats.roam_ms, connect_ms);
+    }
+    else if (s_manager.is_fast)
+    {
+        s_sta_stats.connect_count++;
+        s_sta_stats.fast_connect_count++;
+        jcfw_sketch_add(&s_sta_stats.fast_connect_ms, connect_ms);
+    }
+    else
+    {
+        s_sta_stats.connect_count++;
+        jcfw_sketch_add(&s_sta_stats.full_connect_ms, connect_ms);
+    }
+
+    if (s_manager.has_last_ap && s_sta_ap.ip == s_manager.last_ap.ip)
+    {
+        s_sta_stats.lease_reuse_count++;
+    }
+    jcfw_mutex_unlock(s_lock);
+
+    const char *how = (s_manager.is_fast) ? "last access point" : "scan";
+    JCFW_TRACELN_INFO(
+        STA_TRACE_TAG,
+        "STA connected in %lu ms (%s)",
+        (unsigned long)connect_ms,
+        (s_manager.is_roaming) ? "roam" : how);
+
+    // NOTE(Caleb): Only write NVS when something changed, to spare the flash.
+    memset(s_sta_ap.ssid, 0, sizeof(s_sta_ap.ssid));
+    memcpy(s_sta_ap.ssid, s_manager.wifi_cfg.sta.ssid, sizeof(s_manager.wifi_cfg.sta.ssid));
+    s_sta_ap.version = _JCFW_WIFI_LAST_AP_VERSION;
+    if (!s_manager.has_last_ap || memcmp(&s_sta_ap, &s_manager.last_ap, sizeof(s_sta_ap)) != 0)
+    {
+        _jcfw_wifi_save_last_ap(&s_sta_ap);
+    }
+
+    s_manager.last_ap            = s_sta_ap;
+    s_manager.has_last_ap        = true;
+    s_manager.retry_count        = 0;
+    s_manager.auth_failure_count = 0;
+    s_manager.is_roaming         = false;
+    s_manager.is_roam_scanning   = false;
+    s_manager.low_rssi_count     = 0;
+
+    // NOTE(Caleb): From now on, the deadline is that of the next signal strength sample.
+    s_manager.has_deadline = true;
+    s_manager.deadline_us  = now_us + (uint64_t)JCFW_WIFI_ROAM_SAMPLE_PERIOD_MS * 1000;
+    _jcfw_wifi_manager_set_state(JCFW_WIFI_STA_STATE_CONNECTED);
+}
+
+static void _jcfw_wifi_manager_on_disconnected(uint64_t now_us, uint8_t reason)
+{
+    if (s_manager.is_aborting)
+    {
+        _jcfw_wifi_manager_on_aborted(now_us);
+    }
+    else if (s_sta_state == JCFW_WIFI_STA_STATE_CONNECTING)
+    {
+        _jcfw_wifi_manager_on_failure(now_us, reason);
+    }
+    else if (s_sta_state == JCFW_WIFI_STA_STATE_CONNECTED)
+    {
+        // NOTE(Caleb): No backoff for the first attempt; The access point is most likely still
+        // there (or about to be again), and every moment without it counts.
+        JCFW_TRACELN_WARN(STA_TRACE_TAG, "STA lost its connection; Reconnecting");
+
+        jcfw_mutex_lock(s_lock);
+        s_sta_stats.drop_count++;
+        jcfw_mutex_unlock(s_lock);
+
+        s_manager.retry_count = 0;
+        _jcfw_wifi_manager_begin(now_us);
+    }
+}
+
+static void _jcfw_wifi_manager_on_deadline(uint64_t now_us)
+{
+    if (s_manager.is_aborting)
+    {
+        JCFW_TRACELN_WARN(STA_TRACE_TAG, "Unable to wind down the WIFI connection (timeout)");
+        _jcfw_wifi_manager_on_aborted(now_us);
+    }
+    else if (s_sta_state == JCFW_WIFI_STA_STATE_CONNECTING)
+    {
+        JCFW_TRACELN_WARN(STA_TRACE_TAG, "Unable to complete the WIFI connect procedure (timeout)");
+        _jcfw_wifi_manager_abort(now_us, _JCFW_WIFI_AFTER_ABORT_RETRY);
+    }
+    else if (s_sta_state == JCFW_WIFI_STA_STATE_BACKOFF)
+    {
+        _jcfw_wifi_manager_begin(now_us);
+    }
+    else if (s_sta_state == JCFW_WIFI_STA_STATE_CONNECTED)
+    {
+        _jcfw_wifi_manager_on_sample(now_us);
+    }
+}
+
+static void _jcfw_wifi_manager_on_aborted(uint64_t now_us)
+{
+    s_manager.is_aborting = false;
+
+    switch (s_manager.after_abort)
+    {
+        case _JCFW_WIFI_AFTER_ABORT_RETRY:
+            _jcfw_wifi_manager_on_failure(now_us, WIFI_REASON_TIMEOUT);
+            break;
+
+        case _JCFW_WIFI_AFTER_ABORT_RESTART:
+            _jcfw_wifi_manager_begin(now_us);
+            break;
+
+        case _JCFW_WIFI_AFTER_ABORT_STOP:
+            s_manager.has_deadline = false;
+            _jcfw_wifi_manager_set_state(JCFW_WIFI_STA_STATE_IDLE);
+            break;
+
+        case _JCFW_WIFI_AFTER_ABORT_ROAM:
+            s_manager.is_roaming = true;
+            _jcfw_wifi_manager_attempt(now_us, &s_manager.roam_ap);
+            break;
+    }
+}
+
+static void _jcfw_wifi_manager_on_failure(uint64_t now_us, uint8_t reason)
+{
+    jcfw_mutex_lock(s_lock);
+    s_sta_stats.failure_count++;
+    s_sta_stats.roam_failure_count += (s_manager.is_roaming) ? 1 : 0;
+    s_sta_stats.fallback_count     += (s_manager.is_fast) ? 1 : 0;
+    jcfw_mutex_unlock(s_lock);
+
+    s_manager.is_roaming = false;
+
+    // NOTE(Caleb): The last access point may be gone, or have moved to another channel; Scanning
+    // finds out, so it is tried straight away.
+    if (s_manager.is_fast)
+    {
+        JCFW_TRACELN_WARN(STA_TRACE_TAG, "Unable to reconnect to the last access point; Scanning");
+        _jcfw_wifi_manager_attempt(now_us, NULL);
+        return;
+    }
+
+    const _jcfw_wifi_reason_class_e reason_class = _jcfw_wifi_classify_reason(reason);
+    if (reason_class == _JCFW_WIFI_REASON_CLASS_AUTH)
+    {
+        s_manager.auth_failure_count++;
+    }
+
+    if (reason_class == _JCFW_WIFI_REASON_CLASS_FATAL
+        || s_manager.auth_failure_count >= JCFW_WIFI_AUTH_FAILURE_MAX)
+    {
+        JCFW_TRACELN_ERROR(
+            STA_TRACE_TAG,
+            "Unable to connect (reason %u - %s); Giving up",
+            reason,
+            _jcfw_wifi_get_reason_string(reason));
+
+        s_manager.has_deadline = false;
+        _jcfw_wifi_manager_set_state(JCFW_WIFI_STA_STATE_FAILED);
+        return;
+    }
+
+    const uint32_t backoff_ms = _jcfw_wifi_get_backoff_ms(s_manager.retry_count++);
+    JCFW_TRACELN_WARN(
+        STA_TRACE_TAG,
+        "Unable to connect (reason %u - %s); Retrying in %lu ms",
+        reason,
+        _jcfw_wifi_get_reason_string(reason),
+        (unsigned long)backoff_ms);
+
+    s_manager.has_deadline = true;
+    s_manager.deadline_us  = now_us + (uint64_t)backoff_ms * 1000;
+    _jcfw_wifi_manager_set_state(JCFW_WIFI_STA_STATE_BACKOFF);
+}
+
+static void _jcfw_wifi_manager_on_sample(uint64_t now_us)
+{
+    s_manager.deadline_us = now_us + (uint64_t)JCFW_WIFI_ROAM_SAMPLE_PERIOD_MS * 1000;
+
+    wifi_ap_record_t ap_info;
+    esp_err_t        err = esp_wifi_sta_get_ap_info(&ap_info);
+    JCFW_RETURN_IF_FALSE(err == ESP_OK);
+
+    s_manager.rssi_dBm = ap_info.rssi;
+    s_manager.low_rssi_count =
+        (ap_info.rssi < JCFW_WIFI_ROAM_RSSI_MIN_DBM) ? s_manager.low_rssi_count + 1 : 0;
+
+    JCFW_RETURN_IF_TRUE(
+        s_manager.is_roam_scanning || s_manager.low_rssi_count < JCFW_WIFI_ROAM_LOW_COUNT_MIN);
+    JCFW_RETURN_IF_TRUE(
+        s_manager.has_roam_scanned
+        && now_us - s_manager.roam_scan_us < (uint64_t)JCFW_WIFI_ROAM_SCAN_PERIOD_MS * 1000);
+
+    JCFW_TRACELN_INFO(
+        STA_TRACE_TAG, "Signal is weak (%d dBm); Looking for a better access point", ap_info.rssi);
+
+    // NOTE(Caleb): Only for the SSID, to keep it short. The connection stays up meanwhile; The
+    // driver goes back to its channel between the others.
+    uint8_t ssid[JCFW_WIFI_SSID_LEN_MAX + 1] = {0};
+    memcpy(ssid, s_manager.wifi_cfg.sta.ssid, sizeof(s_manager.wifi_cfg.sta.ssid));
+    wifi_scan_config_t scan_cfg = {.ssid = ssid};
+
+    s_manager.has_roam_scanned = true;
+    s_manager.roam_scan_us     = now_us;
+    s_manager.is_roam_scanning =
+        (_jcfw_wifi_scan_start(&scan_cfg, NULL, NULL) == JCFW_RESULT_IN_PROGRESS);
+    if (s_manager.is_roam_scanning)
+    {
+        jcfw_mutex_lock(s_lock);
+        s_sta_stats.roam_scan_count++;
+        jcfw_mutex_unlock(s_lock);
+    }
+}
+
+static void _jcfw_wifi_manager_on_scan_done(uint64_t now_us)
+{
+    JCFW_RETURN_IF_FALSE(s_manager.is_roam_scanning);
+    s_manager.is_roam_scanning = false;
+
+    JCFW_RETURN_IF_FALSE(s_sta_state == JCFW_WIFI_STA_STATE_CONNECTED && !s_manager.is_aborting);
+
+    int8_t                      current_dBm   = s_manager.rssi_dBm;
+    bool                        has_candidate = false;
+    jcfw_wifi_sta_scan_result_t candidate     = {0};
+
+    // NOTE(Caleb): Only what this scan saw counts; The cache may remember access points which have
+    // since moved (or gone). It is sorted, so the first other access point is the strongest.
+    jcfw_mutex_lock(s_lock);
+    for (size_t i = 0; i < s_scan_cache_count; i++)
+    {
+        const jcfw_wifi_sta_scan_result_t *result = &s_scan_cache[i];
+        if (result->seen_us < s_manager.roam_scan_us
+            || strncmp(
+                   (const char *)result->ssid,
+                   (const char *)s_manager.wifi_cfg.sta.ssid,
+                   sizeof(s_manager.wifi_cfg.sta.ssid))
+                   != 0)
+        {
+            continue;
+        }
+
+        if (memcmp(result->bssid, s_manager.last_ap.bssid, JCFW_WIFI_BSSID_LEN) == 0)
+        {
+            // NOTE(Caleb): Measured along with the others, so the fairest to compare them with.
+            current_dBm = result->rssi_dBm;
+        }
+        else if (!has_candidate)
+        {
+            candidate     = *result;
+            has_candidate = true;
+        }
+    }
+    jcfw_mutex_unlock(s_lock);
+
+    if (!has_candidate || candidate.rssi_dBm < current_dBm + JCFW_WIFI_ROAM_HYSTERESIS_DB)
+    {
+        JCFW_TRACELN_DEBUG(
+            STA_TRACE_TAG,
+            "No access point is enough stronger than this one (%d dBm)",
+            current_dBm);
+        return;
+    }
+
+    JCFW_TRACELN_INFO(
+        STA_TRACE_TAG,
+        "Roaming to %02X:%02X:%02X:%02X:%02X:%02X on channel %u (%d dBm, from %d dBm)",
+        candidate.bssid[0],
+        candidate.bssid[1],
+        candidate.bssid[2],
+        candidate.bssid[3],
+        candidate.bssid[4],
+        candidate.bssid[5],
+        candidate.channel,
+        candidate.rssi_dBm,
+        current_dBm);
+
+    // NOTE(Caleb): The same network, so the same auth mode is expected of it.
+    s_manager.roam_ap         = s_manager.last_ap;
+    s_manager.roam_ap.channel = candidate.channel;
+    memcpy(s_manager.roam_ap.bssid, candidate.bssid, sizeof(s_manager.roam_ap.bssid));
+
+    s_manager.started_us = now_us;
+    _jcfw_wifi_manager_abort(now_us, _JCFW_WIFI_AFTER_ABORT_ROAM);
+}
+
+static void _jcfw_wifi_manager_begin(uint64_t now_us)
+{
+    s_manager.started_us = now_us;
+
+    // NOTE(Caleb): Without the address configuration, connecting would be for nothing.
+    if (_jcfw_wifi_sta_apply_ip_config() != JCFW_RESULT_OK)
+    {
+        s_manager.is_fast = false;
+        _jcfw_wifi_manager_on_failure(now_us, WIFI_REASON_UNSPECIFIED);
+        return;
+    }
+
+    _jcfw_wifi_manager_attempt(now_us, (s_manager.has_last_ap) ? &s_manager.last_ap : NULL);
+}
+
+static void _jcfw_wifi_manager_attempt(uint64_t now_us, const _jcfw_wifi_last_ap_t *ap)
+{
+    const bool    is_fast  = (ap != NULL);
+    wifi_config_t wifi_cfg = s_manager.wifi_cfg;
+    if (is_fast)
+    {
+        // NOTE(Caleb): Go straight to the access point (the last one, or one to roam to), on its
+        // one channel, rather than scanning every channel for it. Its auth mode is the floor, so
+        // that it can't be downgraded.
+        wifi_cfg.sta.scan_method        = WIFI_FAST_SCAN;
+        wifi_cfg.sta.bssid_set          = true;
+        wifi_cfg.sta.channel            = ap->channel;
+        wifi_cfg.sta.threshold.authmode = ap->authmode;
+        memcpy(wifi_cfg.sta.bssid, ap->bssid, sizeof(wifi_cfg.sta.bssid));
+    }
+    else
+    {
+        // NOTE(Caleb): Scan every channel, and pick the strongest access point of the SSID.
+        wifi_cfg.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_cfg.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+
+    // NOTE(Caleb): A disconnect which came in late from an earlier attempt would fail this one;
+    // Drop it, and hand anything else back.
+    const uint32_t stale = jcfw_event_wait(s_manager_event, 0) & ~_JCFW_WIFI_SIGNAL_DISCONNECTED;
+    if (stale)
+    {
+        jcfw_event_signal(s_manager_event, stale);
+    }
+
+    const uint32_t timeout_ms =
+        (is_fast) ? JCFW_WIFI_FAST_CONNECT_TIMEOUT_MS : JCFW_WIFI_CONNECT_TIMEOUT_MS;
+    s_manager.is_fast      = is_fast;
+    s_manager.has_deadline = true;
+    s_manager.deadline_us  = now_us + (uint64_t)timeout_ms * 1000;
+    _jcfw_wifi_manager_set_state(JCFW_WIFI_STA_STATE_CONNECTING);
+
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_cfg);
+    if (err == ESP_OK)
+    {
+        err = esp_wifi_connect();
+    }
+
+    if (err != ESP_OK)
+    {
+        JCFW_TRACELN_ERROR(
+            STA_TRACE_TAG,
+            "Unable to start the WIFI connect procedure (esp error %s)",
+            esp_err_to_name(err));
+        _jcfw_wifi_manager_on_failure(now_us, WIFI_REASON_UNSPECIFIED);
+    }
+}
+
+static void _jcfw_wifi_manager_abort(uint64_t now_us, _jcfw_wifi_after_abort_e after_abort)
+{
+    s_manager.is_aborting  = true;
+    s_manager.after_abort  = after_abort;
+    s_manager.has_deadline = true;
+    s_manager.deadline_us  = now_us + (uint64_t)_JCFW_WIFI_ABORT_TIMEOUT_MS * 1000;
+
+    // NOTE(Caleb): Its disconnect event completes the abort.
+    esp_err_t err = esp_wifi_disconnect();
+    if (err != ESP_OK)
+    {
+        JCFW_TRACELN_WARN(
+            STA_TRACE_TAG,
+            "Unable to start the WIFI disconnect procedure (esp error %s)",
+            esp_err_to_name(err));
+        _jcfw_wifi_manager_on_aborted(now_us);
+    }
+}
+
+static void _jcfw_wifi_manager_set_state(jcfw_wifi_sta_state_e state)
+{
+    _jcfw_wifi_subscriber_t subscribers[JCFW_WIFI_SUBSCRIBER_COUNT_MAX];
+
+    jcfw_mutex_lock(s_lock);
+    const jcfw_wifi_sta_state_e from  = s_sta_state;
+    const size_t                count = s_subscriber_count;
+    s_sta_state                       = state;
+    memcpy(subscribers, s_subscribers, count * sizeof(subscribers[0]));
+    jcfw_mutex_unlock(s_lock);
+
+    // NOTE(Caleb): The bits are what the blocking calls wait on, so they are updated even when the
+    // state stays the same (e.g. stopping while already idle).
+    // TODO(Caleb): JCFW OS
+    if (s_event_group)
+    {
+        switch (state)
+        {
+            case JCFW_WIFI_STA_STATE_IDLE:
+                xEventGroupClearBits(s_event_group, _JCFW_WIFI_STATUS_CONNECTED);
+                xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_DISCONNECTED);
+                break;
+
+            case JCFW_WIFI_STA_STATE_CONNECTING:
+                xEventGroupClearBits(
+                    s_event_group, _JCFW_WIFI_STATUS_CONNECTED | _JCFW_WIFI_STATUS_DISCONNECTED);
+                break;
+
+            case JCFW_WIFI_STA_STATE_CONNECTED:
+                xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_CONNECTED);
+                break;
+
+            case JCFW_WIFI_STA_STATE_BACKOFF:
+                break;
+
+            case JCFW_WIFI_STA_STATE_FAILED:
+                xEventGroupSetBits(s_event_group, _JCFW_WIFI_STATUS_FAILURE);
+                break;
+        }
+    }
+
+    if (s_manager.is_done_on_connect && state == JCFW_WIFI_STA_STATE_CONNECTED)
+    {
+        _jcfw_wifi_manager_complete(JCFW_RESULT_OK);
+    }
+    else if (s_manager.is_done_on_connect && state == JCFW_WIFI_STA_STATE_FAILED)
+    {
+        _jcfw_wifi_manager_complete(JCFW_RESULT_ERROR);
+    }
+    else if (!s_manager.is_done_on_connect && state == JCFW_WIFI_STA_STATE_IDLE)
+    {
+        _jcfw_wifi_manager_complete(JCFW_RESULT_OK);
+    }
+
+    JCFW_RETURN_IF_TRUE(from == state);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        subscribers[i].cb(from, state, subscribers[i].arg);
+    }
+}
+
+static void _jcfw_wifi_manager_complete(jcfw_result_e result)
+{
+    jcfw_wifi_done_f cb = s_manager.done_cb;
+    JCFW_RETURN_IF_FALSE(cb);
+
+    s_manager.done_cb = NULL;
+    cb(result, s_manager.done_cb_arg);
+}
+
+static jcfw_result_e _jcfw_wifi_sta_request(
+    bool is_wanted, const wifi_config_t *wifi_cfg, jcfw_wifi_done_f cb, void *arg)
+{
+    jcfw_mutex_lock(s_lock);
+
+    // NOTE(Caleb): Requests which the manager hasn't gotten to yet are merged into the last one;
+    // Only its one callback slot can be taken.
+    if (s_request_cb && cb)
+    {
+        jcfw_mutex_unlock(s_lock);
+        return JCFW_RESULT_FULL;
+    }
+
+    if (wifi_cfg)
+    {
+        s_wanted_cfg = *wifi_cfg;
+    }
+
+    s_is_wanted = is_wanted;
+    if (cb)
+    {
+        s_request_cb               = cb;
+        s_request_cb_arg           = arg;
+        s_is_request_cb_on_connect = is_wanted;
+    }
+
+    jcfw_mutex_unlock(s_lock);
+
+    jcfw_event_signal(s_manager_event, _JCFW_WIFI_SIGNAL_REQUEST);
+    return JCFW_RESULT_IN_PROGRESS;
+}
+
+static TickType_t _jcfw_wifi_get_ticks(uint32_t timeout_ms)
+{
+    return (timeout_ms == JCFW_WIFI_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+static _jcfw_wifi_reason_class_e _jcfw_wifi_classify_reason(uint8_t reason)
+{
+    switch (reason)
+    {
+        // NOTE(Caleb): The access point and the STA don't share a security configuration; That
+        // won't change by trying again.
+        case WIFI_REASON_GROUP_CIPHER_INVALID:
+        case WIFI_REASON_PAIRWISE_CIPHER_INVALID:
+        case WIFI_REASON_AKMP_INVALID:
+        case WIFI_REASON_UNSUPP_RSN_IE_VERSION:
+        case WIFI_REASON_INVALID_RSN_IE_CAP:
+        case WIFI_REASON_CIPHER_SUITE_REJECTED:
+        case WIFI_REASON_BAD_CIPHER_OR_AKM:
+        case WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY:
+        case WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD:
+            return _JCFW_WIFI_REASON_CLASS_FATAL;
+
+        // NOTE(Caleb): Most likely a wrong password, but a weak signal can look the same; Only a
+        // few in a row are taken to mean the former.
+        case WIFI_REASON_MIC_FAILURE:
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_802_1X_AUTH_FAILED:
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+            return _JCFW_WIFI_REASON_CLASS_AUTH;
+
+        default:
+            return _JCFW_WIFI_REASON_CLASS_RETRYABLE;
+    }
+}
+
+static uint32_t _jcfw_wifi_get_backoff_ms(uint32_t retry_count)
+{
+    // NOTE(Caleb): Doubles with each retry, up to the maximum; Then anywhere in its upper half, so
+    // that devices which lost the same access point don't all retry at once.
+    const uint64_t backoff_ms = JCFW_MIN(
+        (uint64_t)JCFW_WIFI_BACKOFF_MIN_MS << JCFW_MIN(retry_count, 16),
+        (uint64_t)JCFW_WIFI_BACKOFF_MAX_MS);
+    const uint32_t half_ms = (uint32_t)(backoff_ms / 2);
+
+    return half_ms + esp_random() % (half_ms + 1);
+}
+
+static jcfw_result_e _jcfw_wifi_sta_apply_ip_config(void)
+{
+    esp_err_t err;
+
+    jcfw_mutex_lock(s_lock);
+    const bool                  has_static_ip = s_has_static_ip;
+    const jcfw_wifi_ip_config_t static_ip     = s_static_ip;
+    jcfw_mutex_unlock(s_lock);
+
+    if (!has_static_ip)
+    {
+        err = esp_netif_dhcpc_start(s_sta_netif);
+        JCFW_ERROR_IF_FALSE(
+            err == ESP_OK || err == ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED,
+            JCFW_RESULT_ERROR,
+            "Unable to start the DHCP client (esp error %s)",
+            esp_err_to_name(err));
+
+        return JCFW_RESULT_OK;
+    }
+
+    err = esp_netif_dhcpc_stop(s_sta_netif);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK || err == ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED,
+        JCFW_RESULT_ERROR,
+        "Unable to stop the DHCP client (esp error %s)",
+        esp_err_to_name(err));
+
+    // NOTE(Caleb): Both are in network order, like the bytes of the address.
+    esp_netif_ip_info_t ip_info = {0};
+    memcpy(&ip_info.ip.addr, static_ip.ip, sizeof(ip_info.ip.addr));
+    memcpy(&ip_info.netmask.addr, static_ip.netmask, sizeof(ip_info.netmask.addr));
+    memcpy(&ip_info.gw.addr, static_ip.gateway, sizeof(ip_info.gw.addr));
+
+    err = esp_netif_set_ip_info(s_sta_netif, &ip_info);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to set the static address (esp error %s)",
+        esp_err_to_name(err));
+
+    esp_netif_dns_info_t dns_info = {0};
+    memcpy(&dns_info.ip.u_addr.ip4.addr, static_ip.dns, sizeof(dns_info.ip.u_addr.ip4.addr));
+    dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+
+    err = esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns_info);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to set the static DNS server (esp error %s)",
+        esp_err_to_name(err));
+
+    return JCFW_RESULT_OK;
+}
+
+static bool _jcfw_wifi_load_last_ap(_jcfw_wifi_last_ap_t *o_last_ap)
+{
+    nvs_handle_t handle;
+    esp_err_t    err = nvs_open(_JCFW_WIFI_NVS_NAMESPACE, NVS_READONLY, &handle);
+    JCFW_RETURN_IF_FALSE(err == ESP_OK, false);
+
+    size_t size = sizeof(*o_last_ap);
+    err         = nvs_get_blob(handle, _JCFW_WIFI_NVS_KEY_LAST_AP, o_last_ap, &size);
+    nvs_close(handle);
+
+    return err == ESP_OK && size == sizeof(*o_last_ap)
+           && o_last_ap->version == _JCFW_WIFI_LAST_AP_VERSION;
+}
+
+static void _jcfw_wifi_save_last_ap(const _jcfw_wifi_last_ap_t *last_ap)
+{
+    nvs_handle_t handle;
+    esp_err_t    err = nvs_open(_JCFW_WIFI_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK, , "Unable to open NVS (esp error %s)", esp_err_to_name(err));
+
+    err = nvs_set_blob(handle, _JCFW_WIFI_NVS_KEY_LAST_AP, last_ap, sizeof(*last_ap));
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    JCFW_ERROR_IF_FALSE(
+        err == ESP_OK,
+        ,
+        "Unable to save the last access point (esp error %s)",
+        esp_err_to_name(err));
+}
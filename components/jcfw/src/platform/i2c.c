@@ -0,0 +1,496 @@
+#include "jcfw/detail/i2c.h"
+
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG "JCFW-I2C"
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_i2c_bus_t s_buses[JCFW_I2C_BUS_COUNT_MAX] = {0};
+
+// -------------------------------------------------------------------------------------------------
+
+static bool _jcfw_i2c_is_device_head(const jcfw_i2c_bus_t *bus, const jcfw_i2c_xfer_t *xfer);
+static bool _jcfw_i2c_is_before(const jcfw_i2c_xfer_t *a, const jcfw_i2c_xfer_t *b);
+static size_t _jcfw_i2c_segment_count(const jcfw_i2c_xfer_t *xfer);
+static bool   _jcfw_i2c_can_merge(
+    const jcfw_i2c_xfer_t *first,
+    size_t                 merged_size,
+    size_t                 merged_segment_count,
+    const jcfw_i2c_xfer_t *next);
+static void _jcfw_i2c_unlink(jcfw_i2c_bus_t *bus, jcfw_i2c_xfer_t *prev, jcfw_i2c_xfer_t *xfer);
+static jcfw_i2c_xfer_t *_jcfw_i2c_dequeue(jcfw_i2c_bus_t *bus);
+static jcfw_result_e    _jcfw_i2c_execute_merged(jcfw_i2c_bus_t *bus, jcfw_i2c_xfer_t *chain);
+static void             _jcfw_i2c_complete(jcfw_i2c_xfer_t *xfer, jcfw_result_e result);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_platform_i2c_bus_create(void *handle, jcfw_i2c_bus_t **o_bus)
+{
+    JCFW_ERROR_IF_FALSE(o_bus, JCFW_RESULT_INVALID_ARGS, "No bus output provided");
+
+    // NOTE(Caleb): Buses are expected to be created once during platform initialization, so the bus
+    // table itself is not locked.
+    jcfw_i2c_bus_t *bus = NULL;
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(s_buses); i++)
+    {
+        if (!s_buses[i].is_used)
+        {
+            bus = &s_buses[i];
+            break;
+        }
+    }
+
+    JCFW_ERROR_IF_FALSE(bus, JCFW_RESULT_FULL, "No free I2C bus slots");
+
+    memset(bus, 0, sizeof(*bus));
+    bus->handle = handle;
+
+    jcfw_result_e err = _jcfw_i2c_port_start(bus);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, err, "Unable to start the I2C bus (rc %u)", err);
+
+    bus->is_used = true;
+    *o_bus       = bus;
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_platform_i2c_device_init(
+    jcfw_i2c_device_t *dev, jcfw_i2c_bus_t *bus, void *handle, uint8_t priority)
+{
+    JCFW_ERROR_IF_FALSE(dev, JCFW_RESULT_INVALID_ARGS, "No device provided");
+    JCFW_ERROR_IF_FALSE(
+        bus && bus->is_used, JCFW_RESULT_NOT_INITIALIZED, "The I2C bus is not initialized");
+
+    memset(dev, 0, sizeof(*dev));
+    dev->handle   = handle;
+    dev->bus      = bus;
+    dev->priority = priority;
+
+    _jcfw_i2c_port_lock(bus);
+    dev->_next   = bus->devices;
+    bus->devices = dev;
+    _jcfw_i2c_port_unlock(bus);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e
+jcfw_platform_i2c_device_get_stats(jcfw_i2c_device_t *dev, jcfw_i2c_device_stats_t *o_stats)
+{
+    JCFW_ERROR_IF_FALSE(dev && dev->bus, JCFW_RESULT_INVALID_ARGS, "No device provided");
+    JCFW_ERROR_IF_FALSE(o_stats, JCFW_RESULT_INVALID_ARGS, "No stats output provided");
+
+    _jcfw_i2c_port_lock(dev->bus);
+    *o_stats = dev->_stats;
+    _jcfw_i2c_port_unlock(dev->bus);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_platform_i2c_device_reset_stats(jcfw_i2c_device_t *dev)
+{
+    JCFW_ERROR_IF_FALSE(dev && dev->bus, JCFW_RESULT_INVALID_ARGS, "No device provided");
+
+    _jcfw_i2c_port_lock(dev->bus);
+    memset(&dev->_stats, 0, sizeof(dev->_stats));
+    _jcfw_i2c_port_unlock(dev->bus);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_platform_i2c_submit(jcfw_i2c_xfer_t *xfer)
+{
+    return _jcfw_i2c_enqueue(xfer, false);
+}
+
+jcfw_result_e jcfw_platform_i2c_cancel(jcfw_i2c_xfer_t *xfer)
+{
+    JCFW_ERROR_IF_FALSE(xfer, JCFW_RESULT_INVALID_ARGS, "No transaction provided");
+    JCFW_ERROR_IF_FALSE(
+        xfer->device && xfer->device->bus, JCFW_RESULT_INVALID_ARGS, "No device provided");
+
+    jcfw_i2c_bus_t *bus    = xfer->device->bus;
+    jcfw_result_e   result = JCFW_RESULT_INVALID_ARGS;
+
+    _jcfw_i2c_port_lock(bus);
+
+    if (xfer->state == JCFW_I2C_XFER_STATE_ACTIVE)
+    {
+        result = JCFW_RESULT_IN_PROGRESS;
+    }
+    else if (xfer->state == JCFW_I2C_XFER_STATE_QUEUED)
+    {
+        jcfw_i2c_xfer_t *prev = NULL;
+        for (jcfw_i2c_xfer_t *it = bus->queue_head; it; prev = it, it = it->_next)
+        {
+            if (it == xfer)
+            {
+                _jcfw_i2c_unlink(bus, prev, xfer);
+
+                xfer->state  = JCFW_I2C_XFER_STATE_IDLE;
+                xfer->result = JCFW_RESULT_ERROR;
+                result       = JCFW_RESULT_OK;
+                break;
+            }
+        }
+    }
+
+    _jcfw_i2c_port_unlock(bus);
+
+    return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e _jcfw_i2c_enqueue(jcfw_i2c_xfer_t *xfer, bool ignore_depth)
+{
+    JCFW_ERROR_IF_FALSE(xfer, JCFW_RESULT_INVALID_ARGS, "No transaction provided");
+    JCFW_ERROR_IF_FALSE(xfer->device, JCFW_RESULT_INVALID_ARGS, "No device provided");
+    JCFW_ERROR_IF_FALSE(
+        xfer->device->bus && xfer->device->bus->is_used,
+        JCFW_RESULT_NOT_INITIALIZED,
+        "The I2C bus is not initialized");
+    JCFW_ERROR_IF_FALSE(
+        xfer->state != JCFW_I2C_XFER_STATE_QUEUED && xfer->state != JCFW_I2C_XFER_STATE_ACTIVE,
+        JCFW_RESULT_INVALID_ARGS,
+        "Transaction is already pending");
+
+    if (xfer->type == JCFW_I2C_XFER_TYPE_WRITE && xfer->segments)
+    {
+        JCFW_ERROR_IF_FALSE(
+            xfer->segment_count && xfer->segment_count <= JCFW_I2C_SEGMENT_COUNT_MAX,
+            JCFW_RESULT_INVALID_ARGS,
+            "Invalid segment count %u",
+            (unsigned)xfer->segment_count);
+
+        xfer->data_size = _jcfw_i2c_segments_size(xfer->segments, xfer->segment_count);
+    }
+
+    jcfw_i2c_bus_t *bus = xfer->device->bus;
+
+    _jcfw_i2c_port_lock(bus);
+
+    if (!ignore_depth && bus->queue_count >= JCFW_I2C_QUEUE_DEPTH)
+    {
+        _jcfw_i2c_port_unlock(bus);
+        return JCFW_RESULT_FULL;
+    }
+
+    xfer->_next  = NULL;
+    xfer->result = JCFW_RESULT_IN_PROGRESS;
+    xfer->state  = JCFW_I2C_XFER_STATE_QUEUED;
+
+    if (bus->queue_tail)
+    {
+        bus->queue_tail->_next = xfer;
+    }
+    else
+    {
+        bus->queue_head = xfer;
+    }
+
+    bus->queue_tail = xfer;
+    bus->queue_count++;
+
+    _jcfw_i2c_port_unlock(bus);
+
+    _jcfw_i2c_port_notify(bus);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e _jcfw_i2c_execute(jcfw_i2c_xfer_t *xfer)
+{
+    jcfw_i2c_device_t *dev = xfer->device;
+
+    uint64_t      start_us = jcfw_platform_get_time_us();
+    jcfw_result_e result;
+
+    if (xfer->type == JCFW_I2C_XFER_TYPE_READ)
+    {
+        result = _jcfw_i2c_port_read(xfer);
+    }
+    else if (xfer->segments)
+    {
+        result = _jcfw_i2c_port_write(xfer, xfer->segments, xfer->segment_count);
+    }
+    else
+    {
+        jcfw_i2c_segment_t segment = {.data = xfer->data, .size = xfer->data_size};
+        result                     = _jcfw_i2c_port_write(xfer, &segment, 1);
+    }
+
+    uint64_t busy_us = jcfw_platform_get_time_us() - start_us;
+
+    _jcfw_i2c_port_lock(dev->bus);
+    dev->_stats.transaction_count++;
+    dev->_stats.byte_count += xfer->mem_addr_size + xfer->data_size;
+    dev->_stats.busy_us    += busy_us;
+    if (result != JCFW_RESULT_OK)
+    {
+        dev->_stats.failure_count++;
+    }
+    _jcfw_i2c_port_unlock(dev->bus);
+
+    return result;
+}
+
+size_t _jcfw_i2c_segments_size(const jcfw_i2c_segment_t *segments, size_t segment_count)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        size += segments[i].size;
+    }
+
+    return size;
+}
+
+jcfw_result_e _jcfw_i2c_segments_gather(
+    const jcfw_i2c_segment_t *segments,
+    size_t                    segment_count,
+    uint8_t                  *o_buffer,
+    size_t                    buffer_size)
+{
+    size_t size = _jcfw_i2c_segments_size(segments, segment_count);
+    JCFW_ERROR_IF_FALSE(
+        size <= buffer_size,
+        JCFW_RESULT_OUT_OF_BOUNDS,
+        "I2C write of %u bytes does not fit the %u byte copy buffer",
+        (unsigned)size,
+        (unsigned)buffer_size);
+
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        memcpy(o_buffer, segments[i].data, segments[i].size);
+        o_buffer += segments[i].size;
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+void _jcfw_i2c_service(jcfw_i2c_bus_t *bus)
+{
+    jcfw_i2c_xfer_t *xfer;
+    while ((xfer = _jcfw_i2c_dequeue(bus)) != NULL)
+    {
+        jcfw_result_e result =
+            (xfer->_next) ? _jcfw_i2c_execute_merged(bus, xfer) : _jcfw_i2c_execute(xfer);
+        JCFW_CHECK(result == JCFW_RESULT_OK, "I2C transaction failed");
+
+        // NOTE(Caleb): Merged transactions all share the result of the single bus transaction.
+        while (xfer)
+        {
+            jcfw_i2c_xfer_t *next = xfer->_next;
+            xfer->_next           = NULL;
+
+            _jcfw_i2c_complete(xfer, result);
+            xfer = next;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool _jcfw_i2c_is_device_head(const jcfw_i2c_bus_t *bus, const jcfw_i2c_xfer_t *xfer)
+{
+    for (const jcfw_i2c_xfer_t *it = bus->queue_head; it != xfer; it = it->_next)
+    {
+        if (it->device == xfer->device)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool _jcfw_i2c_is_before(const jcfw_i2c_xfer_t *a, const jcfw_i2c_xfer_t *b)
+{
+    if (a->device->priority != b->device->priority)
+    {
+        return a->device->priority > b->device->priority;
+    }
+
+    uint64_t a_deadline_us = (a->deadline_us) ? a->deadline_us : UINT64_MAX;
+    uint64_t b_deadline_us = (b->deadline_us) ? b->deadline_us : UINT64_MAX;
+
+    return a_deadline_us < b_deadline_us;
+}
+
+static size_t _jcfw_i2c_segment_count(const jcfw_i2c_xfer_t *xfer)
+{
+    return (xfer->segments) ? xfer->segment_count : 1;
+}
+
+static bool _jcfw_i2c_can_merge(
+    const jcfw_i2c_xfer_t *first,
+    size_t                 merged_size,
+    size_t                 merged_segment_count,
+    const jcfw_i2c_xfer_t *next)
+{
+    JCFW_RETURN_IF_FALSE(next->type == JCFW_I2C_XFER_TYPE_WRITE, false);
+    JCFW_RETURN_IF_FALSE(next->mem_addr_size == 1, false);
+    JCFW_RETURN_IF_FALSE(merged_size + next->data_size <= JCFW_I2C_MERGE_SIZE_MAX, false);
+    JCFW_RETURN_IF_FALSE(
+        merged_segment_count + _jcfw_i2c_segment_count(next) <= JCFW_I2C_SEGMENT_COUNT_MAX, false);
+
+    // NOTE(Caleb): Register addresses do not wrap around, so neither does merging.
+    size_t next_reg = (size_t)first->mem_addr[0] + merged_size;
+    return next_reg <= UINT8_MAX && next->mem_addr[0] == next_reg;
+}
+
+static void _jcfw_i2c_unlink(jcfw_i2c_bus_t *bus, jcfw_i2c_xfer_t *prev, jcfw_i2c_xfer_t *xfer)
+{
+    if (prev)
+    {
+        prev->_next = xfer->_next;
+    }
+    else
+    {
+        bus->queue_head = xfer->_next;
+    }
+
+    if (bus->queue_tail == xfer)
+    {
+        bus->queue_tail = prev;
+    }
+
+    bus->queue_count--;
+    xfer->_next = NULL;
+}
+
+static jcfw_i2c_xfer_t *_jcfw_i2c_dequeue(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_i2c_port_lock(bus);
+
+    // NOTE(Caleb): Only the oldest transaction of each device is eligible, which keeps the
+    // transactions of a device in order no matter how the devices are scheduled against each other.
+    jcfw_i2c_xfer_t *best      = NULL;
+    jcfw_i2c_xfer_t *best_prev = NULL;
+
+    jcfw_i2c_xfer_t *prev = NULL;
+    for (jcfw_i2c_xfer_t *it = bus->queue_head; it; prev = it, it = it->_next)
+    {
+        if (_jcfw_i2c_is_device_head(bus, it) && (!best || _jcfw_i2c_is_before(it, best)))
+        {
+            best      = it;
+            best_prev = prev;
+        }
+    }
+
+    if (!best)
+    {
+        _jcfw_i2c_port_unlock(bus);
+        return NULL;
+    }
+
+    _jcfw_i2c_unlink(bus, best_prev, best);
+    best->state = JCFW_I2C_XFER_STATE_ACTIVE;
+
+    // NOTE(Caleb): The merged transactions are chained onto the first one through `_next`. Since
+    // `best` was the oldest transaction of its device, the next one for the same device after its
+    // old position is the next one in submission order.
+    if (best->type == JCFW_I2C_XFER_TYPE_WRITE && best->mem_addr_size == 1
+        && best->device->is_write_merge_enabled)
+    {
+        jcfw_i2c_xfer_t *tail                 = best;
+        size_t           merged_size          = best->data_size;
+        size_t           merged_segment_count = _jcfw_i2c_segment_count(best);
+
+        jcfw_i2c_xfer_t *it = (best_prev) ? best_prev->_next : bus->queue_head;
+        prev                = best_prev;
+        while (1)
+        {
+            while (it && it->device != best->device)
+            {
+                prev = it;
+                it   = it->_next;
+            }
+
+            if (!it || !_jcfw_i2c_can_merge(best, merged_size, merged_segment_count, it))
+            {
+                break;
+            }
+
+            jcfw_i2c_xfer_t *next = it->_next;
+            _jcfw_i2c_unlink(bus, prev, it);
+            it->state = JCFW_I2C_XFER_STATE_ACTIVE;
+
+            tail->_next           = it;
+            tail                  = it;
+            merged_size          += it->data_size;
+            merged_segment_count += _jcfw_i2c_segment_count(it);
+
+            it = next;
+        }
+    }
+
+    _jcfw_i2c_port_unlock(bus);
+
+    return best;
+}
+
+static jcfw_result_e _jcfw_i2c_execute_merged(jcfw_i2c_bus_t *bus, jcfw_i2c_xfer_t *chain)
+{
+    // NOTE(Caleb): The merged write gathers the data of each transaction in place rather than
+    // copying it into one buffer.
+    jcfw_i2c_xfer_t merged = *chain;
+    merged.segments        = bus->merge_segments;
+    merged.segment_count   = 0;
+    merged.data_size       = 0;
+    merged.timeout_ms      = 0;
+    merged._next           = NULL;
+
+    uint32_t merged_count = 0;
+    for (jcfw_i2c_xfer_t *it = chain; it; it = it->_next)
+    {
+        if (it->segments)
+        {
+            memcpy(
+                &bus->merge_segments[merged.segment_count],
+                it->segments,
+                it->segment_count * sizeof(*it->segments));
+            merged.segment_count += it->segment_count;
+        }
+        else
+        {
+            bus->merge_segments[merged.segment_count++] = (jcfw_i2c_segment_t) {
+                .data = it->data,
+                .size = it->data_size,
+            };
+        }
+
+        merged.data_size  += it->data_size;
+        merged.timeout_ms  = JCFW_MAX(merged.timeout_ms, it->timeout_ms);
+        merged_count++;
+    }
+
+    jcfw_result_e result = _jcfw_i2c_execute(&merged);
+
+    _jcfw_i2c_port_lock(bus);
+    chain->device->_stats.merged_count += merged_count - 1;
+    _jcfw_i2c_port_unlock(bus);
+
+    return result;
+}
+
+static void _jcfw_i2c_complete(jcfw_i2c_xfer_t *xfer, jcfw_result_e result)
+{
+    // NOTE(Caleb): Once the state is DONE, the owner is free to reuse the descriptor, so anything
+    // needed from it (including the result, for the callback) is read beforehand.
+    jcfw_i2c_xfer_cb_f callback     = xfer->callback;
+    void              *callback_arg = xfer->callback_arg;
+
+    xfer->result = result;
+    xfer->state  = JCFW_I2C_XFER_STATE_DONE;
+
+    if (callback)
+    {
+        callback(xfer, result, callback_arg);
+    }
+}
@@ -0,0 +1,91 @@
+#include "jcfw/platform/event.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+struct jcfw_event_s
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        bits;
+};
+
+static jcfw_event_t    s_events[JCFW_EVENT_COUNT_MAX];
+static size_t          s_event_count = 0;
+static pthread_mutex_t s_events_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_event_create(jcfw_event_t **o_event)
+{
+    JCFW_ERROR_IF_FALSE(o_event, JCFW_RESULT_INVALID_ARGS, "No event provided");
+
+    pthread_mutex_lock(&s_events_lock);
+    jcfw_event_t *event = (s_event_count < JCFW_ARRAYSIZE(s_events)) ? &s_events[s_event_count++]
+                                                                     : NULL;
+    pthread_mutex_unlock(&s_events_lock);
+    JCFW_ERROR_IF_FALSE(event, JCFW_RESULT_FULL, "No free event slots");
+
+    // NOTE(Caleb): Timeouts are measured on the monotonic clock, like jcfw_platform_get_time_us().
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    pthread_mutex_init(&event->lock, NULL);
+    pthread_cond_init(&event->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    event->bits = 0;
+
+    *o_event = event;
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_event_signal(jcfw_event_t *event, uint32_t bits)
+{
+    pthread_mutex_lock(&event->lock);
+    event->bits |= bits;
+    pthread_cond_signal(&event->cond);
+    pthread_mutex_unlock(&event->lock);
+}
+
+void jcfw_event_signal_from_isr(jcfw_event_t *event, uint32_t bits)
+{
+    jcfw_event_signal(event, bits);
+}
+
+uint32_t jcfw_event_wait(jcfw_event_t *event, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&event->lock);
+    while (event->bits == 0)
+    {
+        if (timeout_ms == JCFW_EVENT_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&event->cond, &event->lock);
+        }
+        else if (pthread_cond_timedwait(&event->cond, &event->lock, &deadline) != 0)
+        {
+            break;
+        }
+    }
+
+    const uint32_t bits = event->bits;
+    event->bits         = 0;
+    pthread_mutex_unlock(&event->lock);
+
+    return bits;
+}
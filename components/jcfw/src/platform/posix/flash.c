@@ -0,0 +1,182 @@
+#include "jcfw/platform/flash.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jcfw/platform/posix/flash.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG "JCFW-FLASH"
+
+// -------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    int    fd;
+    size_t power_budget;
+} _jcfw_posix_flash_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static size_t _jcfw_posix_flash_spend_power(_jcfw_posix_flash_t *flash, size_t size);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_flash_open(jcfw_flash_region_t *region, const char *name)
+{
+    JCFW_ERROR_IF_FALSE(region && name, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    int fd = open(name, O_RDWR | O_CREAT, 0644);
+    JCFW_ERROR_IF_FALSE(fd >= 0, JCFW_RESULT_ERROR, "Unable to open %s; errno %d", name, errno);
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to stat %s; errno %d", name, errno);
+        close(fd);
+        return JCFW_RESULT_ERROR;
+    }
+
+    // NOTE(Caleb): A new file starts out erased, like a fresh partition.
+    if (st.st_size == 0)
+    {
+        uint8_t sector[JCFW_FLASH_POSIX_SECTOR_SIZE];
+        memset(sector, 0xFF, sizeof(sector));
+
+        for (size_t offset = 0; offset < JCFW_FLASH_POSIX_REGION_SIZE; offset += sizeof(sector))
+        {
+            if (pwrite(fd, sector, sizeof(sector), offset) != sizeof(sector))
+            {
+                JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to create %s; errno %d", name, errno);
+                close(fd);
+                return JCFW_RESULT_ERROR;
+            }
+        }
+
+        st.st_size = JCFW_FLASH_POSIX_REGION_SIZE;
+    }
+
+    _jcfw_posix_flash_t *flash = malloc(sizeof(*flash));
+    if (!flash)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to allocate a region");
+        close(fd);
+        return JCFW_RESULT_ALLOCATION_FAILURE;
+    }
+
+    flash->fd           = fd;
+    flash->power_budget = SIZE_MAX;
+
+    region->size        = st.st_size - (st.st_size % JCFW_FLASH_POSIX_SECTOR_SIZE);
+    region->sector_size = JCFW_FLASH_POSIX_SECTOR_SIZE;
+    region->handle      = flash;
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_flash_close(jcfw_flash_region_t *region)
+{
+    JCFW_RETURN_IF_FALSE(region && region->handle);
+
+    _jcfw_posix_flash_t *flash = region->handle;
+    close(flash->fd);
+    free(flash);
+
+    region->handle = NULL;
+}
+
+jcfw_result_e
+jcfw_flash_read(const jcfw_flash_region_t *region, size_t offset, void *o_data, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(region && o_data, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(offset + size > region->size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    _jcfw_posix_flash_t *flash = region->handle;
+    JCFW_RETURN_IF_FALSE(
+        pread(flash->fd, o_data, size, offset) == (ssize_t)size, JCFW_RESULT_ERROR);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e
+jcfw_flash_write(const jcfw_flash_region_t *region, size_t offset, const void *data, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(region && data, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(offset + size > region->size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    _jcfw_posix_flash_t *flash = region->handle;
+    const uint8_t       *src   = data;
+
+    // NOTE(Caleb): NOR flash can only clear bits, so AND the new data into what is there.
+    uint8_t      chunk[64];
+    const size_t powered_size = _jcfw_posix_flash_spend_power(flash, size);
+    for (size_t done = 0; done < powered_size; done += sizeof(chunk))
+    {
+        const size_t chunk_size = JCFW_MIN(sizeof(chunk), powered_size - done);
+        JCFW_RETURN_IF_FALSE(
+            pread(flash->fd, chunk, chunk_size, offset + done) == (ssize_t)chunk_size,
+            JCFW_RESULT_ERROR);
+
+        for (size_t i = 0; i < chunk_size; i++)
+        {
+            chunk[i] &= src[done + i];
+        }
+
+        JCFW_RETURN_IF_FALSE(
+            pwrite(flash->fd, chunk, chunk_size, offset + done) == (ssize_t)chunk_size,
+            JCFW_RESULT_ERROR);
+    }
+
+    return (powered_size == size) ? JCFW_RESULT_OK : JCFW_RESULT_ERROR;
+}
+
+jcfw_result_e jcfw_flash_erase(const jcfw_flash_region_t *region, size_t offset, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(region, JCFW_RESULT_INVALID_ARGS, "No region provided");
+    JCFW_ERROR_IF_FALSE(
+        offset % region->sector_size == 0 && size % region->sector_size == 0,
+        JCFW_RESULT_INVALID_ARGS,
+        "Erases must be sector aligned");
+    JCFW_RETURN_IF_TRUE(offset + size > region->size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    _jcfw_posix_flash_t *flash = region->handle;
+
+    uint8_t erased[64];
+    memset(erased, 0xFF, sizeof(erased));
+
+    const size_t powered_size = _jcfw_posix_flash_spend_power(flash, size);
+    for (size_t done = 0; done < powered_size; done += sizeof(erased))
+    {
+        const size_t chunk_size = JCFW_MIN(sizeof(erased), powered_size - done);
+        JCFW_RETURN_IF_FALSE(
+            pwrite(flash->fd, erased, chunk_size, offset + done) == (ssize_t)chunk_size,
+            JCFW_RESULT_ERROR);
+    }
+
+    return (powered_size == size) ? JCFW_RESULT_OK : JCFW_RESULT_ERROR;
+}
+
+void jcfw_posix_flash_set_power_budget(jcfw_flash_region_t *region, size_t byte_count)
+{
+    _jcfw_posix_flash_t *flash = region->handle;
+    flash->power_budget        = byte_count;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Take `size` bytes out of the power budget of a region.
+/// @return The number of bytes which may be written or erased before the power goes out.
+static size_t _jcfw_posix_flash_spend_power(_jcfw_posix_flash_t *flash, size_t size)
+{
+    JCFW_RETURN_IF_TRUE(flash->power_budget == SIZE_MAX, size);
+
+    const size_t powered_size = JCFW_MIN(size, flash->power_budget);
+    flash->power_budget -= powered_size;
+
+    return powered_size;
+}
@@ -0,0 +1,330 @@
+#include "jcfw/platform/i2c.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "jcfw/detail/i2c.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/platform/posix/i2c.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG "JCFW-I2C"
+
+// NOTE(Caleb): Start + stop conditions, plus the start and address byte of the repeated start
+#define _JCFW_POSIX_I2C_OVERHEAD_BITS  2
+#define _JCFW_POSIX_I2C_BITS_PER_BYTE  9
+#define _JCFW_POSIX_I2C_DEFAULT_SCL_HZ 100000
+
+// -------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    pthread_t       worker;
+} _jcfw_posix_i2c_port_t;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    bool            is_done;
+} _jcfw_posix_i2c_waiter_t;
+
+static _jcfw_posix_i2c_port_t s_ports[JCFW_I2C_BUS_COUNT_MAX];
+static size_t                 s_port_count = 0;
+static uint32_t               s_time_scale = 100;
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_posix_i2c_simulate_bus_time(
+    const jcfw_posix_i2c_device_t *dev, bool is_read, size_t mem_addr_size, size_t data_size);
+static jcfw_result_e _jcfw_i2c_transfer_blocking(jcfw_i2c_xfer_t *xfer);
+static void          _jcfw_i2c_on_blocking_done(
+    jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg);
+static void         *_jcfw_i2c_worker(void *arg);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_platform_i2c_mstr_mem_read(
+    void          *arg,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    uint8_t       *o_data,
+    size_t         data_size,
+    uint32_t       timeout_ms)
+{
+    jcfw_i2c_xfer_t xfer = {
+        .device        = arg,
+        .type          = JCFW_I2C_XFER_TYPE_READ,
+        .mem_addr      = mem_addr,
+        .mem_addr_size = mem_addr_size,
+        .o_data        = o_data,
+        .data_size     = data_size,
+        .timeout_ms    = timeout_ms,
+    };
+
+    return _jcfw_i2c_transfer_blocking(&xfer);
+}
+
+jcfw_result_e jcfw_platform_i2c_mstr_mem_write(
+    void          *arg,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size,
+    uint32_t       timeout_ms)
+{
+    jcfw_i2c_xfer_t xfer = {
+        .device        = arg,
+        .type          = JCFW_I2C_XFER_TYPE_WRITE,
+        .mem_addr      = mem_addr,
+        .mem_addr_size = mem_addr_size,
+        .data          = data,
+        .data_size     = data_size,
+        .timeout_ms    = timeout_ms,
+    };
+
+    return _jcfw_i2c_transfer_blocking(&xfer);
+}
+
+jcfw_result_e jcfw_platform_i2c_mstr_mem_writev(
+    void                     *arg,
+    const uint8_t            *mem_addr,
+    size_t                    mem_addr_size,
+    const jcfw_i2c_segment_t *segments,
+    size_t                    segment_count,
+    uint32_t                  timeout_ms)
+{
+    jcfw_i2c_xfer_t xfer = {
+        .device        = arg,
+        .type          = JCFW_I2C_XFER_TYPE_WRITE,
+        .mem_addr      = mem_addr,
+        .mem_addr_size = mem_addr_size,
+        .segments      = segments,
+        .segment_count = segment_count,
+        .data_size     = _jcfw_i2c_segments_size(segments, segment_count),
+        .timeout_ms    = timeout_ms,
+    };
+
+    return _jcfw_i2c_transfer_blocking(&xfer);
+}
+
+void jcfw_posix_i2c_set_time_scale(uint32_t percent)
+{
+    s_time_scale = percent;
+}
+
+uint32_t jcfw_posix_i2c_bus_time_us(
+    const jcfw_posix_i2c_device_t *dev, bool is_read, size_t mem_addr_size, size_t data_size)
+{
+    uint32_t scl_speed_hz =
+        (dev && dev->scl_speed_hz) ? dev->scl_speed_hz : _JCFW_POSIX_I2C_DEFAULT_SCL_HZ;
+
+    // Address byte + "memory address" + data, plus a second address byte for the repeated start
+    uint64_t bytes = 1 + mem_addr_size + data_size + ((is_read) ? 1 : 0);
+    uint64_t bits  = bytes * _JCFW_POSIX_I2C_BITS_PER_BYTE + _JCFW_POSIX_I2C_OVERHEAD_BITS;
+
+    return (uint32_t)((bits * 1000000 + scl_speed_hz - 1) / scl_speed_hz);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e _jcfw_i2c_port_start(jcfw_i2c_bus_t *bus)
+{
+    JCFW_ERROR_IF_FALSE(
+        s_port_count < JCFW_ARRAYSIZE(s_ports), JCFW_RESULT_FULL, "No free I2C port slots");
+
+    _jcfw_posix_i2c_port_t *port = &s_ports[s_port_count];
+    pthread_mutex_init(&port->lock, NULL);
+    pthread_cond_init(&port->cond, NULL);
+
+    bus->port = port;
+
+    int rc = pthread_create(&port->worker, NULL, _jcfw_i2c_worker, bus);
+    JCFW_ERROR_IF_FALSE(rc == 0, JCFW_RESULT_ERROR, "Unable to create the I2C worker thread");
+
+    s_port_count++;
+    return JCFW_RESULT_OK;
+}
+
+void _jcfw_i2c_port_lock(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_posix_i2c_port_t *port = bus->port;
+    pthread_mutex_lock(&port->lock);
+}
+
+void _jcfw_i2c_port_unlock(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_posix_i2c_port_t *port = bus->port;
+    pthread_mutex_unlock(&port->lock);
+}
+
+void _jcfw_i2c_port_notify(jcfw_i2c_bus_t *bus)
+{
+    _jcfw_posix_i2c_port_t *port = bus->port;
+    pthread_cond_signal(&port->cond);
+}
+
+jcfw_result_e _jcfw_i2c_port_read(const jcfw_i2c_xfer_t *xfer)
+{
+    const jcfw_posix_i2c_device_t *dev = xfer->device->handle;
+    JCFW_ERROR_IF_FALSE(
+        dev && dev->read && dev->write, JCFW_RESULT_ERROR, "No simulated device at the address");
+
+    _jcfw_posix_i2c_simulate_bus_time(dev, true, xfer->mem_addr_size, xfer->data_size);
+
+    return dev->read(dev->ctx, xfer->mem_addr, xfer->mem_addr_size, xfer->o_data, xfer->data_size);
+}
+
+jcfw_result_e _jcfw_i2c_port_write(
+    const jcfw_i2c_xfer_t *xfer, const jcfw_i2c_segment_t *segments, size_t segment_count)
+{
+    const jcfw_posix_i2c_device_t *dev = xfer->device->handle;
+    JCFW_ERROR_IF_FALSE(
+        dev && dev->read && dev->write, JCFW_RESULT_ERROR, "No simulated device at the address");
+
+    // NOTE(Caleb): Mirrors the copy that a platform without scatter-gather support has to make, so
+    // the same size limit applies.
+    uint8_t buffer[JCFW_I2C_WRITE_COPY_SIZE_MAX];
+    JCFW_ERROR_IF_FALSE(
+        xfer->mem_addr_size <= sizeof(buffer),
+        JCFW_RESULT_OUT_OF_BOUNDS,
+        "I2C \"memory address\" does not fit the copy buffer");
+
+    jcfw_result_e err = _jcfw_i2c_segments_gather(
+        segments, segment_count, buffer, sizeof(buffer) - xfer->mem_addr_size);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    _jcfw_posix_i2c_simulate_bus_time(dev, false, xfer->mem_addr_size, xfer->data_size);
+
+    return dev->write(dev->ctx, xfer->mem_addr, xfer->mem_addr_size, buffer, xfer->data_size);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_posix_i2c_simulate_bus_time(
+    const jcfw_posix_i2c_device_t *dev, bool is_read, size_t mem_addr_size, size_t data_size)
+{
+    uint64_t bus_us = jcfw_posix_i2c_bus_time_us(dev, is_read, mem_addr_size, data_size);
+    bus_us          = bus_us * s_time_scale / 100;
+
+    if (bus_us)
+    {
+        struct timespec ts = {
+            .tv_sec  = bus_us / 1000000,
+            .tv_nsec = (bus_us % 1000000) * 1000,
+        };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static jcfw_result_e _jcfw_i2c_transfer_blocking(jcfw_i2c_xfer_t *xfer)
+{
+    JCFW_ERROR_IF_FALSE(
+        xfer->device && xfer->device->bus, JCFW_RESULT_INVALID_ARGS, "No device provided");
+
+    // NOTE(Caleb): The worker thread would deadlock waiting on itself (e.g. a blocking call made
+    // from a completion callback), so it runs the transaction directly.
+    _jcfw_posix_i2c_port_t *port = xfer->device->bus->port;
+    if (port && pthread_equal(pthread_self(), port->worker))
+    {
+        return _jcfw_i2c_execute(xfer);
+    }
+
+    _jcfw_posix_i2c_waiter_t waiter = {
+        .lock    = PTHREAD_MUTEX_INITIALIZER,
+        .cond    = PTHREAD_COND_INITIALIZER,
+        .is_done = false,
+    };
+
+    xfer->callback     = _jcfw_i2c_on_blocking_done;
+    xfer->callback_arg = &waiter;
+
+    // NOTE(Caleb): Blocking callers are already bounded by the number of threads, so they are
+    // allowed past the queue depth limit rather than failing with JCFW_RESULT_FULL.
+    jcfw_result_e err = _jcfw_i2c_enqueue(xfer, true);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    uint64_t        wait_ms = (uint64_t)xfer->timeout_ms + JCFW_I2C_QUEUE_TIMEOUT_MS;
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec  += wait_ms / 1000;
+    until.tv_nsec += (wait_ms % 1000) * 1000000;
+    if (until.tv_nsec >= 1000000000)
+    {
+        until.tv_sec  += 1;
+        until.tv_nsec -= 1000000000;
+    }
+
+    const bool is_forever = xfer->timeout_ms == JCFW_I2C_WAIT_FOREVER;
+
+    pthread_mutex_lock(&waiter.lock);
+    while (!waiter.is_done)
+    {
+        if (is_forever)
+        {
+            pthread_cond_wait(&waiter.cond, &waiter.lock);
+        }
+        else if (pthread_cond_timedwait(&waiter.cond, &waiter.lock, &until) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+
+    bool is_done = waiter.is_done;
+    pthread_mutex_unlock(&waiter.lock);
+
+    if (!is_done)
+    {
+        if (jcfw_platform_i2c_cancel(xfer) == JCFW_RESULT_OK)
+        {
+            return JCFW_RESULT_TIMEOUT;
+        }
+
+        // NOTE(Caleb): The transaction reached the bus in the meantime. The descriptor lives on
+        // this stack, so it has to finish before returning.
+        pthread_mutex_lock(&waiter.lock);
+        while (!waiter.is_done)
+        {
+            pthread_cond_wait(&waiter.cond, &waiter.lock);
+        }
+        pthread_mutex_unlock(&waiter.lock);
+    }
+
+    return xfer->result;
+}
+
+static void _jcfw_i2c_on_blocking_done(
+    jcfw_i2c_xfer_t *xfer, jcfw_result_e result, void *arg)
+{
+    _jcfw_posix_i2c_waiter_t *waiter = arg;
+
+    pthread_mutex_lock(&waiter->lock);
+    waiter->is_done = true;
+    pthread_cond_signal(&waiter->cond);
+    pthread_mutex_unlock(&waiter->lock);
+}
+
+static void *_jcfw_i2c_worker(void *arg)
+{
+    jcfw_i2c_bus_t         *bus  = arg;
+    _jcfw_posix_i2c_port_t *port = bus->port;
+
+    while (1)
+    {
+        pthread_mutex_lock(&port->lock);
+        while (!bus->queue_head)
+        {
+            pthread_cond_wait(&port->cond, &port->lock);
+        }
+        pthread_mutex_unlock(&port->lock);
+
+        _jcfw_i2c_service(bus);
+    }
+
+    return NULL;
+}
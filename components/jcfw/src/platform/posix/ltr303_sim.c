@@ -0,0 +1,495 @@
+#include "jcfw/platform/posix/ltr303_sim.h"
+
+#include <stdio.h>
+
+#include "jcfw/platform/platform.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
+
+// NOTE(Caleb): Register addresses, reset values, and timings from the datasheet (pages 14 - 25)
+#define _JCFW_LTR303_SIM_BASE            0x80
+#define _JCFW_LTR303_SIM_IDX(_reg)       ((_reg) - _JCFW_LTR303_SIM_BASE)
+
+#define _JCFW_LTR303_SIM_REG_CONTR       0x80
+#define _JCFW_LTR303_SIM_REG_MEAS_RATE   0x85
+#define _JCFW_LTR303_SIM_REG_DATA_CH1_0  0x88
+#define _JCFW_LTR303_SIM_REG_DATA_CH0_1  0x8B
+#define _JCFW_LTR303_SIM_REG_STATUS      0x8C
+#define _JCFW_LTR303_SIM_REG_INTERRUPT   0x8F
+#define _JCFW_LTR303_SIM_REG_THRES_UP_0  0x97
+#define _JCFW_LTR303_SIM_REG_THRES_LOW_0 0x99
+#define _JCFW_LTR303_SIM_REG_PERSIST     0x9E
+
+#define _JCFW_LTR303_SIM_CONTR_MODE      0x01
+#define _JCFW_LTR303_SIM_CONTR_RESET     0x02
+#define _JCFW_LTR303_SIM_STATUS_NEW      0x04
+#define _JCFW_LTR303_SIM_STATUS_INT      0x08
+#define _JCFW_LTR303_SIM_STATUS_INVALID  0x80
+#define _JCFW_LTR303_SIM_INTR_MODE       0x02
+#define _JCFW_LTR303_SIM_INTR_POL        0x04
+
+#define _JCFW_LTR303_SIM_WAKEUP_US       10000
+#define _JCFW_LTR303_SIM_COUNT_MAX       0xFFFF
+
+static const uint8_t S_RESET_REGS[0x20] = {
+    [_JCFW_LTR303_SIM_IDX(0x85)] = 0x03,
+    [_JCFW_LTR303_SIM_IDX(0x86)] = 0xA0,
+    [_JCFW_LTR303_SIM_IDX(0x87)] = 0x05,
+    [_JCFW_LTR303_SIM_IDX(0x8F)] = 0x08,
+    [_JCFW_LTR303_SIM_IDX(0x97)] = 0xFF,
+    [_JCFW_LTR303_SIM_IDX(0x98)] = 0xFF,
+};
+
+// NOTE(Caleb): The bits of each register which can be written. Everything else is read-only or
+// reserved.
+static const uint8_t S_WRITE_MASKS[0x20] = {
+    [_JCFW_LTR303_SIM_IDX(0x80)] = 0x1F,
+    [_JCFW_LTR303_SIM_IDX(0x85)] = 0x3F,
+    [_JCFW_LTR303_SIM_IDX(0x8F)] = 0x06,
+    [_JCFW_LTR303_SIM_IDX(0x97)] = 0xFF,
+    [_JCFW_LTR303_SIM_IDX(0x98)] = 0xFF,
+    [_JCFW_LTR303_SIM_IDX(0x99)] = 0xFF,
+    [_JCFW_LTR303_SIM_IDX(0x9A)] = 0xFF,
+    [_JCFW_LTR303_SIM_IDX(0x9E)] = 0x0F,
+};
+
+// NOTE(Caleb): Gains 4 and 5 are invalid, and behave as 1x
+static const uint8_t S_GAIN_FACTORS[8] = {1, 2, 4, 8, 1, 1, 48, 96};
+
+static const uint32_t S_INTEGRATION_TIMES_MS[8] = {100, 50, 200, 400, 150, 250, 300, 350};
+
+static const uint32_t S_MEASUREMENT_RATES_MS[8] = {50, 100, 200, 500, 1000, 2000, 2000, 2000};
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_ltr303_sim_read(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size);
+
+static jcfw_result_e _jcfw_ltr303_sim_write(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size);
+
+static uint64_t _jcfw_ltr303_sim_now(jcfw_posix_ltr303_sim_t *sim);
+static void     _jcfw_ltr303_sim_advance(jcfw_posix_ltr303_sim_t *sim, uint64_t now_us);
+static void     _jcfw_ltr303_sim_convert(jcfw_posix_ltr303_sim_t *sim, uint64_t end_us);
+static void     _jcfw_ltr303_sim_reset(jcfw_posix_ltr303_sim_t *sim);
+static uint64_t _jcfw_ltr303_sim_period_us(const jcfw_posix_ltr303_sim_t *sim);
+static uint64_t _jcfw_ltr303_sim_integration_us(const jcfw_posix_ltr303_sim_t *sim);
+static uint16_t _jcfw_ltr303_sim_get_u16(const jcfw_posix_ltr303_sim_t *sim, uint8_t reg);
+
+static void _jcfw_ltr303_sim_sample(
+    const jcfw_posix_ltr303_sim_t *sim, uint64_t time_us, float *o_lux, float *o_ir_ratio);
+
+static void _jcfw_ltr303_sim_write_reg(jcfw_posix_ltr303_sim_t *sim, uint8_t reg, uint8_t value);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e
+jcfw_posix_ltr303_sim_init(jcfw_posix_ltr303_sim_t *sim, const jcfw_posix_ltr303_sim_config_t *cfg)
+{
+    JCFW_ERROR_IF_FALSE(sim, JCFW_RESULT_INVALID_ARGS, "No simulated device provided");
+    JCFW_ERROR_IF_FALSE(cfg, JCFW_RESULT_INVALID_ARGS, "No configuration provided");
+    JCFW_ERROR_IF_FALSE(
+        cfg->trace && cfg->trace_len > 0,
+        JCFW_RESULT_INVALID_ARGS,
+        "No light level trace provided");
+
+    memset(sim, 0x00, sizeof(*sim));
+    sim->cfg = *cfg;
+
+    sim->device = (jcfw_posix_i2c_device_t) {
+        .read         = _jcfw_ltr303_sim_read,
+        .write        = _jcfw_ltr303_sim_write,
+        .ctx          = sim,
+        .scl_speed_hz = cfg->scl_speed_hz,
+    };
+
+    JCFW_ERROR_IF_FALSE(
+        pthread_mutex_init(&sim->lock, NULL) == 0,
+        JCFW_RESULT_ERROR,
+        "Unable to create the simulated device lock");
+
+    sim->start_us = _jcfw_ltr303_sim_now(sim);
+    sim->now_us   = sim->start_us;
+    _jcfw_ltr303_sim_reset(sim);
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_posix_ltr303_sim_deinit(jcfw_posix_ltr303_sim_t *sim)
+{
+    pthread_mutex_destroy(&sim->lock);
+}
+
+jcfw_posix_i2c_device_t *jcfw_posix_ltr303_sim_get_device(jcfw_posix_ltr303_sim_t *sim)
+{
+    return &sim->device;
+}
+
+void jcfw_posix_ltr303_sim_update(jcfw_posix_ltr303_sim_t *sim)
+{
+    pthread_mutex_lock(&sim->lock);
+    _jcfw_ltr303_sim_advance(sim, _jcfw_ltr303_sim_now(sim));
+    pthread_mutex_unlock(&sim->lock);
+}
+
+bool jcfw_posix_ltr303_sim_get_int_level(jcfw_posix_ltr303_sim_t *sim)
+{
+    pthread_mutex_lock(&sim->lock);
+    _jcfw_ltr303_sim_advance(sim, _jcfw_ltr303_sim_now(sim));
+
+    const uint8_t intr      = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_INTERRUPT)];
+    const uint8_t status    = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_STATUS)];
+    const bool is_asserted =
+        (intr & _JCFW_LTR303_SIM_INTR_MODE) && (status & _JCFW_LTR303_SIM_STATUS_INT);
+    const bool is_active_high = intr & _JCFW_LTR303_SIM_INTR_POL;
+
+    pthread_mutex_unlock(&sim->lock);
+
+    return (is_active_high) ? is_asserted : !is_asserted;
+}
+
+uint64_t jcfw_posix_ltr303_sim_get_next_conversion_us(jcfw_posix_ltr303_sim_t *sim)
+{
+    pthread_mutex_lock(&sim->lock);
+    _jcfw_ltr303_sim_advance(sim, _jcfw_ltr303_sim_now(sim));
+    const uint64_t next_us = (sim->is_active) ? sim->next_conversion_us : UINT64_MAX;
+    pthread_mutex_unlock(&sim->lock);
+
+    return next_us;
+}
+
+void jcfw_posix_ltr303_sim_get_stats(
+    jcfw_posix_ltr303_sim_t *sim, jcfw_posix_ltr303_sim_stats_t *o_stats)
+{
+    pthread_mutex_lock(&sim->lock);
+    *o_stats = sim->stats;
+    pthread_mutex_unlock(&sim->lock);
+}
+
+jcfw_result_e jcfw_posix_ltr303_sim_load_trace(
+    const char                     *path,
+    jcfw_posix_ltr303_sim_sample_t *o_trace,
+    size_t                          capacity,
+    size_t                         *o_trace_len)
+{
+    JCFW_ERROR_IF_FALSE(path, JCFW_RESULT_INVALID_ARGS, "No path provided");
+    JCFW_ERROR_IF_FALSE(
+        o_trace && o_trace_len,
+        JCFW_RESULT_INVALID_ARGS,
+        "No memory provided for required return values");
+
+    FILE *file = fopen(path, "r");
+    JCFW_ERROR_IF_FALSE(file, JCFW_RESULT_ERROR, "Unable to open trace %s", path);
+
+    jcfw_result_e err = JCFW_RESULT_OK;
+    char          line[128];
+    size_t        count = 0;
+
+    while (fgets(line, sizeof(line), file))
+    {
+        double time_ms  = 0.0;
+        float  lux      = 0.0f;
+        float  ir_ratio = 0.0f;
+
+        if (line[0] == '#' || sscanf(line, "%lf,%f,%f", &time_ms, &lux, &ir_ratio) < 2)
+        {
+            continue;
+        }
+
+        if (count == capacity)
+        {
+            err = JCFW_RESULT_OUT_OF_BOUNDS;
+            break;
+        }
+
+        o_trace[count++] = (jcfw_posix_ltr303_sim_sample_t) {
+            .time_us  = (uint64_t)(time_ms * 1000.0),
+            .lux      = lux,
+            .ir_ratio = ir_ratio,
+        };
+    }
+
+    fclose(file);
+
+    *o_trace_len = count;
+    return err;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e _jcfw_ltr303_sim_read(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size)
+{
+    jcfw_posix_ltr303_sim_t *sim = ctx;
+    JCFW_RETURN_IF_FALSE(mem_addr_size == 1, JCFW_RESULT_ERROR);
+
+    pthread_mutex_lock(&sim->lock);
+    _jcfw_ltr303_sim_advance(sim, _jcfw_ltr303_sim_now(sim));
+    sim->stats.read_count++;
+
+    bool is_data_read   = false;
+    bool is_status_read = false;
+
+    for (size_t i = 0; i < data_size; i++)
+    {
+        const uint8_t reg = mem_addr[0] + i;
+        if (reg < _JCFW_LTR303_SIM_BASE || _JCFW_LTR303_SIM_IDX(reg) >= sizeof(sim->regs))
+        {
+            o_data[i] = 0x00;
+            continue;
+        }
+
+        o_data[i] = sim->regs[_JCFW_LTR303_SIM_IDX(reg)];
+
+        is_data_read |= reg >= _JCFW_LTR303_SIM_REG_DATA_CH1_0
+                     && reg <= _JCFW_LTR303_SIM_REG_DATA_CH0_1;
+        is_status_read |= reg == _JCFW_LTR303_SIM_REG_STATUS;
+    }
+
+    // NOTE(Caleb): The flags are cleared after the whole burst, so that one burst read always sees
+    // a consistent snapshot of the data and its status.
+    uint8_t *status = &sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_STATUS)];
+    if (is_data_read && !sim->is_data_read)
+    {
+        const uint32_t latency_us = sim->now_us - sim->last_conversion_us;
+
+        sim->stats.latency_total_us += latency_us;
+        sim->stats.latency_max_us = JCFW_MAX(sim->stats.latency_max_us, latency_us);
+        sim->stats.latency_count++;
+
+        sim->is_data_read = true;
+        JCFW_BITCLEAR(*status, _JCFW_LTR303_SIM_STATUS_NEW);
+    }
+
+    if (is_status_read)
+    {
+        JCFW_BITCLEAR(*status, _JCFW_LTR303_SIM_STATUS_INT);
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+    return JCFW_RESULT_OK;
+}
+
+static jcfw_result_e _jcfw_ltr303_sim_write(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size)
+{
+    jcfw_posix_ltr303_sim_t *sim = ctx;
+    JCFW_RETURN_IF_FALSE(mem_addr_size == 1, JCFW_RESULT_ERROR);
+
+    pthread_mutex_lock(&sim->lock);
+    _jcfw_ltr303_sim_advance(sim, _jcfw_ltr303_sim_now(sim));
+    sim->stats.write_count++;
+
+    for (size_t i = 0; i < data_size; i++)
+    {
+        _jcfw_ltr303_sim_write_reg(sim, mem_addr[0] + i, data[i]);
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+    return JCFW_RESULT_OK;
+}
+
+static uint64_t _jcfw_ltr303_sim_now(jcfw_posix_ltr303_sim_t *sim)
+{
+    if (sim->cfg.get_time_us)
+    {
+        return sim->cfg.get_time_us(sim->cfg.clock_ctx);
+    }
+
+    return jcfw_platform_get_time_us();
+}
+
+static void _jcfw_ltr303_sim_advance(jcfw_posix_ltr303_sim_t *sim, uint64_t now_us)
+{
+    while (sim->is_active && sim->next_conversion_us <= now_us)
+    {
+        _jcfw_ltr303_sim_convert(sim, sim->next_conversion_us);
+        sim->next_conversion_us += _jcfw_ltr303_sim_period_us(sim);
+    }
+
+    sim->now_us = JCFW_MAX(sim->now_us, now_us);
+}
+
+static void _jcfw_ltr303_sim_convert(jcfw_posix_ltr303_sim_t *sim, uint64_t end_us)
+{
+    const uint8_t  contr          = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_CONTR)];
+    const uint8_t  gain           = (contr >> 2) & 0x07;
+    const uint64_t integration_us = _jcfw_ltr303_sim_integration_us(sim);
+
+    // NOTE(Caleb): The light level at the middle of the integration window stands in for the
+    // average over the window.
+    float lux;
+    float ir_ratio;
+    _jcfw_ltr303_sim_sample(sim, end_us - integration_us / 2, &lux, &ir_ratio);
+
+    const float counts_per_lux = (float)S_GAIN_FACTORS[gain] * (float)integration_us / 100000.0f;
+    const float channel0       = JCFW_MAX(lux, 0.0f) * counts_per_lux;
+    const float channel1       = channel0 * JCFW_CLAMP(ir_ratio, 0.0f, 1.0f);
+
+    const bool     is_saturated = channel0 > _JCFW_LTR303_SIM_COUNT_MAX;
+    const uint16_t ch0 = (uint16_t)JCFW_MIN(channel0, _JCFW_LTR303_SIM_COUNT_MAX);
+    const uint16_t ch1 = (uint16_t)JCFW_MIN(channel1, _JCFW_LTR303_SIM_COUNT_MAX);
+
+    if (!sim->is_data_read)
+    {
+        sim->stats.missed_count++;
+    }
+
+    sim->stats.conversion_count++;
+    sim->stats.saturated_count += (is_saturated) ? 1 : 0;
+    sim->last_conversion_us = end_us;
+    sim->is_data_read       = false;
+
+    uint8_t *data = &sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_DATA_CH1_0)];
+    data[0]       = ch1 & 0xFF;
+    data[1]       = ch1 >> 8;
+    data[2]       = ch0 & 0xFF;
+    data[3]       = ch0 >> 8;
+
+    uint8_t *status = &sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_STATUS)];
+    *status = (*status & _JCFW_LTR303_SIM_STATUS_INT) | (gain << 4) | _JCFW_LTR303_SIM_STATUS_NEW;
+    if (is_saturated)
+    {
+        JCFW_BITSET(*status, _JCFW_LTR303_SIM_STATUS_INVALID);
+    }
+
+    // NOTE(Caleb): Channel 0 is compared against the thresholds. The interrupt fires once
+    // `persist + 1` consecutive conversions fall outside of them, and stays asserted until
+    // ALS_STATUS is read.
+    const uint16_t upper   = _jcfw_ltr303_sim_get_u16(sim, _JCFW_LTR303_SIM_REG_THRES_UP_0);
+    const uint16_t lower   = _jcfw_ltr303_sim_get_u16(sim, _JCFW_LTR303_SIM_REG_THRES_LOW_0);
+    const uint8_t  persist = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_PERSIST)];
+    const uint8_t  intr    = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_INTERRUPT)];
+
+    if (ch0 <= upper && ch0 >= lower)
+    {
+        sim->persist_count = 0;
+        return;
+    }
+
+    sim->persist_count = JCFW_MIN(sim->persist_count + 1, 0x10);
+    if (sim->persist_count > persist && (intr & _JCFW_LTR303_SIM_INTR_MODE)
+        && !(*status & _JCFW_LTR303_SIM_STATUS_INT))
+    {
+        JCFW_BITSET(*status, _JCFW_LTR303_SIM_STATUS_INT);
+        sim->stats.interrupt_count++;
+    }
+}
+
+static void _jcfw_ltr303_sim_sample(
+    const jcfw_posix_ltr303_sim_t *sim, uint64_t time_us, float *o_lux, float *o_ir_ratio)
+{
+    const jcfw_posix_ltr303_sim_sample_t *trace = sim->cfg.trace;
+    const size_t                          len   = sim->cfg.trace_len;
+
+    uint64_t t        = (time_us > sim->start_us) ? time_us - sim->start_us : 0;
+    uint64_t duration = trace[len - 1].time_us;
+    if (sim->cfg.is_trace_looped && duration > 0)
+    {
+        t %= duration;
+    }
+
+    if (t <= trace[0].time_us || len == 1)
+    {
+        *o_lux      = trace[0].lux;
+        *o_ir_ratio = trace[0].ir_ratio;
+        return;
+    }
+
+    if (t >= duration)
+    {
+        *o_lux      = trace[len - 1].lux;
+        *o_ir_ratio = trace[len - 1].ir_ratio;
+        return;
+    }
+
+    // Find the first sample after `t`
+    size_t low  = 1;
+    size_t high = len - 1;
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        if (trace[mid].time_us <= t)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    const jcfw_posix_ltr303_sim_sample_t *a = &trace[low - 1];
+    const jcfw_posix_ltr303_sim_sample_t *b = &trace[low];
+    const float frac = (float)(t - a->time_us) / (float)(b->time_us - a->time_us);
+
+    *o_lux      = a->lux + (b->lux - a->lux) * frac;
+    *o_ir_ratio = a->ir_ratio + (b->ir_ratio - a->ir_ratio) * frac;
+}
+
+static void _jcfw_ltr303_sim_write_reg(jcfw_posix_ltr303_sim_t *sim, uint8_t reg, uint8_t value)
+{
+    JCFW_RETURN_IF_TRUE(
+        reg < _JCFW_LTR303_SIM_BASE || _JCFW_LTR303_SIM_IDX(reg) >= sizeof(sim->regs));
+
+    const uint8_t mask = S_WRITE_MASKS[_JCFW_LTR303_SIM_IDX(reg)];
+    uint8_t      *dest = &sim->regs[_JCFW_LTR303_SIM_IDX(reg)];
+    *dest              = (*dest & ~mask) | (value & mask);
+
+    if (reg != _JCFW_LTR303_SIM_REG_CONTR)
+    {
+        return;
+    }
+
+    if (value & _JCFW_LTR303_SIM_CONTR_RESET)
+    {
+        _jcfw_ltr303_sim_reset(sim);
+        return;
+    }
+
+    const bool is_active = value & _JCFW_LTR303_SIM_CONTR_MODE;
+    if (is_active && !sim->is_active)
+    {
+        sim->next_conversion_us =
+            sim->now_us + _JCFW_LTR303_SIM_WAKEUP_US + _jcfw_ltr303_sim_integration_us(sim);
+    }
+
+    sim->is_active = is_active;
+}
+
+static void _jcfw_ltr303_sim_reset(jcfw_posix_ltr303_sim_t *sim)
+{
+    memcpy(sim->regs, S_RESET_REGS, sizeof(sim->regs));
+    sim->persist_count = 0;
+    sim->is_active     = false;
+    sim->is_data_read  = true;
+}
+
+static uint64_t _jcfw_ltr303_sim_period_us(const jcfw_posix_ltr303_sim_t *sim)
+{
+    const uint8_t  meas = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_MEAS_RATE)];
+    const uint64_t rate_us = (uint64_t)S_MEASUREMENT_RATES_MS[meas & 0x07] * 1000;
+
+    return JCFW_MAX(_jcfw_ltr303_sim_integration_us(sim), rate_us);
+}
+
+static uint64_t _jcfw_ltr303_sim_integration_us(const jcfw_posix_ltr303_sim_t *sim)
+{
+    const uint8_t meas = sim->regs[_JCFW_LTR303_SIM_IDX(_JCFW_LTR303_SIM_REG_MEAS_RATE)];
+    return (uint64_t)S_INTEGRATION_TIMES_MS[(meas >> 3) & 0x07] * 1000;
+}
+
+static uint16_t _jcfw_ltr303_sim_get_u16(const jcfw_posix_ltr303_sim_t *sim, uint8_t reg)
+{
+    const uint8_t *bytes = &sim->regs[_JCFW_LTR303_SIM_IDX(reg)];
+    return (uint16_t)bytes[0] | ((uint16_t)bytes[1] << 8);
+}
@@ -0,0 +1,46 @@
+#include "jcfw/platform/mutex.h"
+
+#include <pthread.h>
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+struct jcfw_mutex_s
+{
+    pthread_mutex_t lock;
+};
+
+static jcfw_mutex_t    s_mutexes[JCFW_MUTEX_COUNT_MAX];
+static size_t          s_mutex_count  = 0;
+static pthread_mutex_t s_mutexes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_mutex_create(jcfw_mutex_t **o_mutex)
+{
+    JCFW_ERROR_IF_FALSE(o_mutex, JCFW_RESULT_INVALID_ARGS, "No mutex provided");
+
+    pthread_mutex_lock(&s_mutexes_lock);
+    jcfw_mutex_t *mutex = (s_mutex_count < JCFW_ARRAYSIZE(s_mutexes))
+                            ? &s_mutexes[s_mutex_count++]
+                            : NULL;
+    pthread_mutex_unlock(&s_mutexes_lock);
+    JCFW_ERROR_IF_FALSE(mutex, JCFW_RESULT_FULL, "No free mutex slots");
+
+    pthread_mutex_init(&mutex->lock, NULL);
+
+    *o_mutex = mutex;
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_mutex_lock(jcfw_mutex_t *mutex)
+{
+    pthread_mutex_lock(&mutex->lock);
+}
+
+void jcfw_mutex_unlock(jcfw_mutex_t *mutex)
+{
+    pthread_mutex_unlock(&mutex->lock);
+}
@@ -0,0 +1,57 @@
+#include "jcfw/platform/task.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+
+#define TRACE_TAG "JCFW-TASK"
+
+// -------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    jcfw_task_f task;
+    void       *arg;
+} _jcfw_posix_task_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static void *_jcfw_posix_task_run(void *arg);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_task_create(const jcfw_task_config_t *config, jcfw_task_f task, void *arg)
+{
+    JCFW_ERROR_IF_FALSE(config && task, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    // NOTE(Caleb): Tasks never return, so neither is this ever freed.
+    _jcfw_posix_task_t *posix_task = malloc(sizeof(*posix_task));
+    JCFW_ERROR_IF_FALSE(
+        posix_task, JCFW_RESULT_ALLOCATION_FAILURE, "Unable to allocate task %s", config->name);
+
+    posix_task->task = task;
+    posix_task->arg  = arg;
+
+    pthread_t thread;
+    int       rc = pthread_create(&thread, NULL, _jcfw_posix_task_run, posix_task);
+    if (rc != 0)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to create task %s; rc %d", config->name, rc);
+        free(posix_task);
+        return JCFW_RESULT_ERROR;
+    }
+
+    pthread_detach(thread);
+    return JCFW_RESULT_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void *_jcfw_posix_task_run(void *arg)
+{
+    _jcfw_posix_task_t *posix_task = arg;
+    posix_task->task(posix_task->arg);
+    return NULL;
+}
@@ -0,0 +1,156 @@
+#include "jcfw/telemetry/aggregate.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_aggregate_advance(jcfw_aggregate_t *agg, uint64_t time_us);
+static void _jcfw_aggregate_report(jcfw_aggregate_t *agg, uint64_t end_us);
+static void _jcfw_aggregate_clear_pane(jcfw_aggregate_pane_t *pane);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_aggregate_init(jcfw_aggregate_t *agg, const jcfw_aggregate_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(agg && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(config->report_cb, JCFW_RESULT_INVALID_ARGS, "No report callback provided");
+    JCFW_ERROR_IF_FALSE(
+        config->hop_ms > 0 && config->window_ms >= config->hop_ms
+            && config->window_ms % config->hop_ms == 0,
+        JCFW_RESULT_INVALID_ARGS,
+        "Windows must be a non-zero multiple of the hop");
+    JCFW_ERROR_IF_FALSE(
+        config->window_ms / config->hop_ms <= JCFW_AGGREGATE_PANE_COUNT_MAX,
+        JCFW_RESULT_INVALID_ARGS,
+        "Windows may be at most %u hops long",
+        (unsigned)JCFW_AGGREGATE_PANE_COUNT_MAX);
+
+    memset(agg, 0x00, sizeof(*agg));
+    agg->config     = *config;
+    agg->pane_count = config->window_ms / config->hop_ms;
+
+    jcfw_result_e err = jcfw_sketch_init(&agg->merged, config->value_min, config->value_max);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    for (size_t i = 0; i < agg->pane_count; i++)
+    {
+        agg->panes[i].sketch = agg->merged;
+        _jcfw_aggregate_clear_pane(&agg->panes[i]);
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_aggregate_add(jcfw_aggregate_t *agg, uint64_t time_us, float value)
+{
+    const uint64_t hop_us = (uint64_t)agg->config.hop_ms * 1000;
+
+    if (!agg->is_started)
+    {
+        agg->pane_start_us = time_us - (time_us % hop_us);
+        agg->is_started    = true;
+    }
+
+    JCFW_RETURN_IF_TRUE(time_us < agg->pane_start_us);
+    _jcfw_aggregate_advance(agg, time_us);
+
+    jcfw_aggregate_pane_t *pane = &agg->panes[agg->current_pane];
+    pane->min                   = pane->count ? JCFW_MIN(pane->min, value) : value;
+    pane->max                   = pane->count ? JCFW_MAX(pane->max, value) : value;
+    pane->sum += value;
+    pane->last = value;
+    pane->count++;
+
+    jcfw_sketch_add(&pane->sketch, value);
+}
+
+void jcfw_aggregate_poll(jcfw_aggregate_t *agg, uint64_t now_us)
+{
+    JCFW_RETURN_IF_FALSE(agg->is_started);
+
+    _jcfw_aggregate_advance(agg, now_us);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void _jcfw_aggregate_advance(jcfw_aggregate_t *agg, uint64_t time_us)
+{
+    const uint64_t hop_us = (uint64_t)agg->config.hop_ms * 1000;
+
+    size_t step_count = 0;
+    while (time_us >= agg->pane_start_us + hop_us)
+    {
+        // NOTE(Caleb): Once every pane has been closed, every window left to report is empty, so
+        // skip straight to the pane which `time_us` belongs in.
+        if (step_count++ >= agg->pane_count)
+        {
+            for (size_t i = 0; i < agg->pane_count; i++)
+            {
+                _jcfw_aggregate_clear_pane(&agg->panes[i]);
+            }
+
+            agg->pane_start_us = time_us - (time_us % hop_us);
+            break;
+        }
+
+        _jcfw_aggregate_report(agg, agg->pane_start_us + hop_us);
+
+        agg->current_pane = (agg->current_pane + 1) % agg->pane_count;
+        _jcfw_aggregate_clear_pane(&agg->panes[agg->current_pane]);
+        agg->pane_start_us += hop_us;
+    }
+}
+
+static void _jcfw_aggregate_report(jcfw_aggregate_t *agg, uint64_t end_us)
+{
+    const uint64_t window_us = (uint64_t)agg->config.window_ms * 1000;
+
+    jcfw_aggregate_report_t report = {
+        .start_us = end_us > window_us ? end_us - window_us : 0,
+        .end_us   = end_us,
+    };
+
+    float sum = 0.0f;
+    jcfw_sketch_clear(&agg->merged);
+
+    // NOTE(Caleb): Oldest pane first, so that `last` ends up as the newest value.
+    for (size_t i = 1; i <= agg->pane_count; i++)
+    {
+        const jcfw_aggregate_pane_t *pane = &agg->panes[(agg->current_pane + i) % agg->pane_count];
+        if (pane->count == 0)
+        {
+            continue;
+        }
+
+        report.min  = report.count ? JCFW_MIN(report.min, pane->min) : pane->min;
+        report.max  = report.count ? JCFW_MAX(report.max, pane->max) : pane->max;
+        report.last = pane->last;
+        report.count += pane->count;
+        sum += pane->sum;
+
+        jcfw_sketch_merge(&agg->merged, &pane->sketch);
+    }
+
+    JCFW_RETURN_IF_TRUE(report.count == 0);
+
+    // NOTE(Caleb): The sketch only knows which bucket a value fell in, so keep its estimates within
+    // the values which were actually seen.
+    report.mean = sum / report.count;
+    report.p50  = JCFW_CLAMP(jcfw_sketch_quantile(&agg->merged, 0.50f), report.min, report.max);
+    report.p90  = JCFW_CLAMP(jcfw_sketch_quantile(&agg->merged, 0.90f), report.min, report.max);
+    report.p99  = JCFW_CLAMP(jcfw_sketch_quantile(&agg->merged, 0.99f), report.min, report.max);
+
+    agg->config.report_cb(&report, agg->config.report_cb_arg);
+}
+
+static void _jcfw_aggregate_clear_pane(jcfw_aggregate_pane_t *pane)
+{
+    pane->count = 0;
+    pane->min   = 0.0f;
+    pane->max   = 0.0f;
+    pane->sum   = 0.0f;
+    pane->last  = 0.0f;
+
+    jcfw_sketch_clear(&pane->sketch);
+}
@@ -0,0 +1,123 @@
+#include "jcfw/telemetry/batcher.h"
+
+#include "jcfw/util/assert.h"
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e
+_jcfw_telemetry_batcher_flush(jcfw_telemetry_batcher_t *batcher, jcfw_telemetry_flush_reason_e why);
+static jcfw_result_e _jcfw_telemetry_batcher_begin(jcfw_telemetry_batcher_t *batcher);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_telemetry_batcher_init(
+    jcfw_telemetry_batcher_t *batcher, const jcfw_telemetry_batcher_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(batcher && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(config->flush_cb, JCFW_RESULT_INVALID_ARGS, "No flush callback provided");
+    JCFW_ERROR_IF_FALSE(
+        config->frame_size_max <= JCFW_TELEMETRY_FRAME_SIZE_MAX,
+        JCFW_RESULT_INVALID_ARGS,
+        "Frames may be at most %u bytes",
+        (unsigned)JCFW_TELEMETRY_FRAME_SIZE_MAX);
+
+    memset(batcher, 0x00, sizeof(*batcher));
+    batcher->config = *config;
+
+    return _jcfw_telemetry_batcher_begin(batcher);
+}
+
+jcfw_result_e
+jcfw_telemetry_batcher_add(jcfw_telemetry_batcher_t *batcher, uint64_t time_us, const void *record)
+{
+    JCFW_ERROR_IF_FALSE(batcher && record, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    jcfw_result_e err = jcfw_telemetry_frame_append(&batcher->writer, time_us, record);
+    if (err == JCFW_RESULT_FULL)
+    {
+        err = _jcfw_telemetry_batcher_flush(batcher, JCFW_TELEMETRY_FLUSH_SIZE);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+        err = jcfw_telemetry_frame_append(&batcher->writer, time_us, record);
+    }
+
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+    batcher->stats.record_count++;
+
+    // NOTE(Caleb): Send a frame as soon as it's full rather than when the next record arrives,
+    // since that may be a while.
+    const size_t record_size_max = jcfw_telemetry_frame_get_record_size_max(&batcher->writer);
+    if (jcfw_telemetry_frame_get_free_space(&batcher->writer) < record_size_max)
+    {
+        return _jcfw_telemetry_batcher_flush(batcher, JCFW_TELEMETRY_FLUSH_SIZE);
+    }
+
+    if (batcher->config.record_count_max
+        && batcher->writer.header.record_count >= batcher->config.record_count_max)
+    {
+        return _jcfw_telemetry_batcher_flush(batcher, JCFW_TELEMETRY_FLUSH_COUNT);
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_batcher_poll(jcfw_telemetry_batcher_t *batcher, uint64_t now_us)
+{
+    JCFW_ERROR_IF_FALSE(batcher, JCFW_RESULT_INVALID_ARGS, "No batcher provided");
+    JCFW_RETURN_IF_TRUE(batcher->writer.header.record_count == 0, JCFW_RESULT_OK);
+    JCFW_RETURN_IF_TRUE(batcher->config.age_max_us == 0, JCFW_RESULT_OK);
+
+    const uint64_t base_time_us = batcher->writer.header.base_time_us;
+    JCFW_RETURN_IF_TRUE(now_us < base_time_us, JCFW_RESULT_OK);
+    JCFW_RETURN_IF_TRUE(now_us - base_time_us < batcher->config.age_max_us, JCFW_RESULT_OK);
+
+    return _jcfw_telemetry_batcher_flush(batcher, JCFW_TELEMETRY_FLUSH_AGE);
+}
+
+jcfw_result_e jcfw_telemetry_batcher_flush(jcfw_telemetry_batcher_t *batcher)
+{
+    JCFW_ERROR_IF_FALSE(batcher, JCFW_RESULT_INVALID_ARGS, "No batcher provided");
+    JCFW_RETURN_IF_TRUE(batcher->writer.header.record_count == 0, JCFW_RESULT_OK);
+
+    return _jcfw_telemetry_batcher_flush(batcher, JCFW_TELEMETRY_FLUSH_MANUAL);
+}
+
+void jcfw_telemetry_batcher_get_stats(
+    const jcfw_telemetry_batcher_t *batcher, jcfw_telemetry_batcher_stats_t *o_stats)
+{
+    JCFW_RETURN_IF_FALSE(batcher && o_stats);
+
+    *o_stats = batcher->stats;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e
+_jcfw_telemetry_batcher_flush(jcfw_telemetry_batcher_t *batcher, jcfw_telemetry_flush_reason_e why)
+{
+    size_t        length = 0;
+    jcfw_result_e err    = jcfw_telemetry_frame_finish(&batcher->writer, &length);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    batcher->config.flush_cb(batcher->buffer, length, batcher->config.flush_cb_arg);
+
+    batcher->stats.frame_count++;
+    batcher->stats.byte_count += length;
+    batcher->stats.flush_counts[why]++;
+
+    batcher->sequence++;
+    return _jcfw_telemetry_batcher_begin(batcher);
+}
+
+static jcfw_result_e _jcfw_telemetry_batcher_begin(jcfw_telemetry_batcher_t *batcher)
+{
+    return jcfw_telemetry_frame_begin(
+        &batcher->writer,
+        batcher->buffer,
+        batcher->config.frame_size_max,
+        batcher->config.device_id,
+        batcher->sequence,
+        batcher->config.stream,
+        batcher->config.record_size,
+        batcher->config.layout);
+}
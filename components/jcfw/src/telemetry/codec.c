@@ -0,0 +1,217 @@
+#include "jcfw/telemetry/codec.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+
+// -------------------------------------------------------------------------------------------------
+
+static size_t _jcfw_codec_put_varint(uint8_t *dest, uint64_t value);
+static bool
+_jcfw_codec_get_varint(const uint8_t *src, size_t length, size_t *io_offset, uint64_t *o_value);
+
+static inline uint64_t _jcfw_codec_zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t _jcfw_codec_unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/// @brief Sign extend the low `size` bytes of a value.
+static inline int32_t _jcfw_codec_sign_extend(uint32_t value, size_t size)
+{
+    const uint32_t shift = 32 - (size * 8);
+    return (int32_t)(value << shift) >> shift;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_telemetry_codec_init(
+    jcfw_telemetry_codec_t *codec, const jcfw_telemetry_codec_layout_t *layout)
+{
+    JCFW_ERROR_IF_FALSE(codec && layout, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    const size_t record_size = jcfw_telemetry_codec_get_record_size(layout);
+    JCFW_ERROR_IF_FALSE(record_size > 0, JCFW_RESULT_INVALID_ARGS, "Invalid record layout");
+
+    codec->layout      = *layout;
+    codec->record_size = record_size;
+
+    jcfw_telemetry_codec_reset(codec, 0);
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_telemetry_codec_reset(jcfw_telemetry_codec_t *codec, uint64_t base_time_us)
+{
+    codec->prev_time_us  = base_time_us;
+    codec->prev_delta_us = 0;
+    memset(codec->prev_fields, 0x00, sizeof(codec->prev_fields));
+}
+
+size_t jcfw_telemetry_codec_get_record_size(const jcfw_telemetry_codec_layout_t *layout)
+{
+    JCFW_RETURN_IF_FALSE(layout, 0);
+    JCFW_RETURN_IF_TRUE(layout->field_count == 0, 0);
+    JCFW_RETURN_IF_TRUE(layout->field_count > JCFW_TELEMETRY_FIELD_COUNT_MAX, 0);
+
+    size_t record_size = 0;
+    for (size_t i = 0; i < layout->field_count; i++)
+    {
+        const uint8_t size = layout->field_sizes[i];
+        JCFW_RETURN_IF_FALSE(size == 1 || size == 2 || size == 4, 0);
+
+        record_size += size;
+    }
+
+    return record_size;
+}
+
+size_t jcfw_telemetry_codec_get_encoded_size_max(const jcfw_telemetry_codec_layout_t *layout)
+{
+    // NOTE(Caleb): A 64-bit timestamp takes up to 10 varint bytes, and a zigzagged n-byte field
+    // takes up to n + 1.
+    size_t size = 10;
+    for (size_t i = 0; i < layout->field_count; i++)
+    {
+        size += layout->field_sizes[i] + 1;
+    }
+
+    return size;
+}
+
+jcfw_result_e jcfw_telemetry_codec_encode(
+    jcfw_telemetry_codec_t *codec,
+    uint64_t                time_us,
+    const void             *record,
+    uint8_t                *o_buffer,
+    size_t                  capacity,
+    size_t                 *o_length)
+{
+    JCFW_ERROR_IF_FALSE(
+        codec && record && o_buffer && o_length, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        time_us >= codec->prev_time_us,
+        JCFW_RESULT_INVALID_ARGS,
+        "Record timestamps must not go backwards");
+
+    // NOTE(Caleb): Encode into scratch space first, so that a record which doesn't fit leaves the
+    // codec untouched.
+    uint8_t encoded[JCFW_TELEMETRY_CODEC_RECORD_SIZE_MAX];
+    size_t  length = 0;
+
+    const int64_t delta_us = (int64_t)(time_us - codec->prev_time_us);
+    const int64_t dod_us   = delta_us - codec->prev_delta_us;
+    length += _jcfw_codec_put_varint(&encoded[length], _jcfw_codec_zigzag(dod_us));
+
+    uint32_t       fields[JCFW_TELEMETRY_FIELD_COUNT_MAX];
+    const uint8_t *src = record;
+    for (size_t i = 0; i < codec->layout.field_count; i++)
+    {
+        const size_t size = codec->layout.field_sizes[i];
+        fields[i]         = (uint32_t)JCFW_GET_LE(src, size);
+        src += size;
+
+        const int32_t diff = _jcfw_codec_sign_extend(fields[i] - codec->prev_fields[i], size);
+        length += _jcfw_codec_put_varint(&encoded[length], _jcfw_codec_zigzag(diff));
+    }
+
+    JCFW_RETURN_IF_TRUE(length > capacity, JCFW_RESULT_FULL);
+    memcpy(o_buffer, encoded, length);
+    *o_length = length;
+
+    codec->prev_time_us  = time_us;
+    codec->prev_delta_us = delta_us;
+    memcpy(codec->prev_fields, fields, codec->layout.field_count * sizeof(fields[0]));
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_codec_decode(
+    jcfw_telemetry_codec_t *codec,
+    const uint8_t          *buffer,
+    size_t                  length,
+    uint64_t               *o_time_us,
+    void                   *o_record,
+    size_t                 *o_consumed)
+{
+    JCFW_ERROR_IF_FALSE(
+        codec && buffer && o_time_us && o_record && o_consumed,
+        JCFW_RESULT_INVALID_ARGS,
+        "Invalid arguments");
+
+    size_t   offset = 0;
+    uint64_t value  = 0;
+    JCFW_RETURN_IF_FALSE(
+        _jcfw_codec_get_varint(buffer, length, &offset, &value), JCFW_RESULT_OUT_OF_BOUNDS);
+
+    const int64_t  delta_us = codec->prev_delta_us + _jcfw_codec_unzigzag(value);
+    const uint64_t time_us  = codec->prev_time_us + delta_us;
+    JCFW_RETURN_IF_TRUE(delta_us < 0, JCFW_RESULT_ERROR);
+
+    uint32_t fields[JCFW_TELEMETRY_FIELD_COUNT_MAX];
+    for (size_t i = 0; i < codec->layout.field_count; i++)
+    {
+        JCFW_RETURN_IF_FALSE(
+            _jcfw_codec_get_varint(buffer, length, &offset, &value), JCFW_RESULT_OUT_OF_BOUNDS);
+
+        fields[i] = codec->prev_fields[i] + (uint32_t)_jcfw_codec_unzigzag(value);
+    }
+
+    uint8_t *dest = o_record;
+    for (size_t i = 0; i < codec->layout.field_count; i++)
+    {
+        const size_t size = codec->layout.field_sizes[i];
+        JCFW_PUT_LE(dest, fields[i], size);
+        dest += size;
+    }
+
+    codec->prev_time_us  = time_us;
+    codec->prev_delta_us = delta_us;
+    memcpy(codec->prev_fields, fields, codec->layout.field_count * sizeof(fields[0]));
+
+    *o_time_us  = time_us;
+    *o_consumed = offset;
+    return JCFW_RESULT_OK;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static size_t _jcfw_codec_put_varint(uint8_t *dest, uint64_t value)
+{
+    size_t length = 0;
+    do
+    {
+        dest[length] = value & 0x7F;
+        value >>= 7;
+        if (value)
+        {
+            dest[length] |= 0x80;
+        }
+
+        length++;
+    } while (value);
+
+    return length;
+}
+
+static bool
+_jcfw_codec_get_varint(const uint8_t *src, size_t length, size_t *io_offset, uint64_t *o_value)
+{
+    uint64_t value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7)
+    {
+        JCFW_RETURN_IF_TRUE(*io_offset >= length, false);
+
+        const uint8_t byte = src[(*io_offset)++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *o_value = value;
+            return true;
+        }
+    }
+
+    return false;
+}
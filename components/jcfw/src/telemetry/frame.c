@@ -0,0 +1,276 @@
+#include "jcfw/telemetry/frame.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_telemetry_frame_begin(
+    jcfw_telemetry_frame_writer_t       *writer,
+    uint8_t                             *buffer,
+    size_t                               capacity,
+    uint32_t                             device_id,
+    uint32_t                             sequence,
+    uint8_t                              stream,
+    uint8_t                              record_size,
+    const jcfw_telemetry_codec_layout_t *layout)
+{
+    JCFW_ERROR_IF_FALSE(writer, JCFW_RESULT_INVALID_ARGS, "No frame writer provided");
+    JCFW_ERROR_IF_FALSE(buffer, JCFW_RESULT_INVALID_ARGS, "No frame buffer provided");
+
+    memset(writer, 0x00, sizeof(*writer));
+    writer->header.version     = JCFW_TELEMETRY_FRAME_VERSION;
+    writer->header.encoding    = JCFW_TELEMETRY_ENCODING_RAW;
+    writer->header.record_size = record_size;
+    writer->header.stream      = stream;
+    writer->header.device_id   = device_id;
+    writer->header.sequence    = sequence;
+
+    writer->buffer   = buffer;
+    writer->capacity = capacity;
+    writer->length   = JCFW_TELEMETRY_FRAME_HEADER_SIZE;
+
+    if (layout)
+    {
+        jcfw_result_e err = jcfw_telemetry_codec_init(&writer->codec, layout);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+        JCFW_ERROR_IF_FALSE(
+            writer->codec.record_size == record_size,
+            JCFW_RESULT_INVALID_ARGS,
+            "Record layout doesn't match the record size");
+
+        writer->header.encoding = JCFW_TELEMETRY_ENCODING_DELTA;
+        writer->length += 1 + layout->field_count;
+    }
+
+    JCFW_ERROR_IF_FALSE(
+        capacity >= writer->length + jcfw_telemetry_frame_get_record_size_max(writer),
+        JCFW_RESULT_INVALID_ARGS,
+        "Frame buffer can't hold a single record");
+
+    if (layout)
+    {
+        uint8_t *dest = &buffer[JCFW_TELEMETRY_FRAME_HEADER_SIZE];
+        dest[0]       = layout->field_count;
+        memcpy(&dest[1], layout->field_sizes, layout->field_count);
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_frame_append(
+    jcfw_telemetry_frame_writer_t *writer, uint64_t time_us, const void *record)
+{
+    JCFW_ERROR_IF_FALSE(writer && record, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(writer->header.record_count == UINT16_MAX, JCFW_RESULT_FULL);
+
+    if (writer->header.record_count == 0)
+    {
+        writer->header.base_time_us = time_us;
+        writer->last_time_us        = time_us;
+    }
+
+    JCFW_ERROR_IF_FALSE(
+        time_us >= writer->last_time_us,
+        JCFW_RESULT_INVALID_ARGS,
+        "Record timestamps must not go backwards");
+
+    if (writer->header.encoding == JCFW_TELEMETRY_ENCODING_DELTA)
+    {
+        if (writer->header.record_count == 0)
+        {
+            jcfw_telemetry_codec_reset(&writer->codec, time_us);
+        }
+
+        size_t        size = 0;
+        jcfw_result_e err  = jcfw_telemetry_codec_encode(
+            &writer->codec,
+            time_us,
+            record,
+            &writer->buffer[writer->length],
+            jcfw_telemetry_frame_get_free_space(writer),
+            &size);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+        writer->length += size;
+        writer->header.record_count++;
+        writer->last_time_us = time_us;
+
+        return JCFW_RESULT_OK;
+    }
+
+    // NOTE(Caleb): A delta which doesn't fit 32 bits means that the stream stalled for over an
+    // hour; that record belongs in a new frame anyway.
+    const uint64_t delta_us = time_us - writer->last_time_us;
+    JCFW_RETURN_IF_TRUE(delta_us > UINT32_MAX, JCFW_RESULT_FULL);
+
+    uint8_t  delta[JCFW_TELEMETRY_FRAME_DELTA_SIZE_MAX];
+    size_t   delta_size = 0;
+    uint32_t remaining  = (uint32_t)delta_us;
+    do
+    {
+        delta[delta_size] = remaining & 0x7F;
+        remaining >>= 7;
+        if (remaining)
+        {
+            JCFW_BITSET(delta[delta_size], 0x80);
+        }
+
+        delta_size++;
+    } while (remaining);
+
+    const size_t size = delta_size + writer->header.record_size;
+    JCFW_RETURN_IF_TRUE(size > jcfw_telemetry_frame_get_free_space(writer), JCFW_RESULT_FULL);
+
+    memcpy(&writer->buffer[writer->length], delta, delta_size);
+    memcpy(&writer->buffer[writer->length + delta_size], record, writer->header.record_size);
+    writer->length += size;
+
+    writer->header.record_count++;
+    writer->last_time_us = time_us;
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_frame_finish(jcfw_telemetry_frame_writer_t *writer, size_t *o_length)
+{
+    JCFW_ERROR_IF_FALSE(writer && o_length, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    uint8_t *header = writer->buffer;
+    header[0]       = JCFW_TELEMETRY_FRAME_MAGIC_0;
+    header[1]       = JCFW_TELEMETRY_FRAME_MAGIC_1;
+    header[2]       = writer->header.version;
+    header[3]       = writer->header.encoding;
+    header[4]       = writer->header.record_size;
+    header[5]       = writer->header.stream;
+    JCFW_PUT_LE(&header[6], writer->header.record_count, sizeof(uint16_t));
+    JCFW_PUT_LE(&header[8], writer->header.device_id, sizeof(uint32_t));
+    JCFW_PUT_LE(&header[12], writer->header.sequence, sizeof(uint32_t));
+    JCFW_PUT_LE(&header[16], writer->header.base_time_us, sizeof(uint64_t));
+
+    *o_length = writer->length;
+    return JCFW_RESULT_OK;
+}
+
+size_t jcfw_telemetry_frame_get_record_size_max(const jcfw_telemetry_frame_writer_t *writer)
+{
+    if (writer->header.encoding == JCFW_TELEMETRY_ENCODING_DELTA)
+    {
+        return jcfw_telemetry_codec_get_encoded_size_max(&writer->codec.layout);
+    }
+
+    return JCFW_TELEMETRY_FRAME_DELTA_SIZE_MAX + writer->header.record_size;
+}
+
+jcfw_result_e
+jcfw_telemetry_frame_open(jcfw_telemetry_frame_reader_t *reader, const void *buffer, size_t length)
+{
+    JCFW_ERROR_IF_FALSE(reader && buffer, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(length < JCFW_TELEMETRY_FRAME_HEADER_SIZE, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    const uint8_t *header = buffer;
+    JCFW_RETURN_IF_FALSE(
+        header[0] == JCFW_TELEMETRY_FRAME_MAGIC_0 && header[1] == JCFW_TELEMETRY_FRAME_MAGIC_1,
+        JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(header[2] == JCFW_TELEMETRY_FRAME_VERSION, JCFW_RESULT_ERROR);
+    JCFW_RETURN_IF_FALSE(
+        header[3] == JCFW_TELEMETRY_ENCODING_RAW || header[3] == JCFW_TELEMETRY_ENCODING_DELTA,
+        JCFW_RESULT_ERROR);
+
+    memset(reader, 0x00, sizeof(*reader));
+    reader->header.version      = header[2];
+    reader->header.encoding     = header[3];
+    reader->header.record_size  = header[4];
+    reader->header.stream       = header[5];
+    reader->header.record_count = JCFW_GET_LE(&header[6], sizeof(uint16_t));
+    reader->header.device_id    = JCFW_GET_LE(&header[8], sizeof(uint32_t));
+    reader->header.sequence     = JCFW_GET_LE(&header[12], sizeof(uint32_t));
+    reader->header.base_time_us = JCFW_GET_LE(&header[16], sizeof(uint64_t));
+
+    reader->buffer  = buffer;
+    reader->length  = length;
+    reader->offset  = JCFW_TELEMETRY_FRAME_HEADER_SIZE;
+    reader->time_us = reader->header.base_time_us;
+
+    if (reader->header.encoding == JCFW_TELEMETRY_ENCODING_DELTA)
+    {
+        const uint8_t *layout_bytes = &reader->buffer[JCFW_TELEMETRY_FRAME_HEADER_SIZE];
+        JCFW_RETURN_IF_TRUE(length < reader->offset + 1, JCFW_RESULT_OUT_OF_BOUNDS);
+        JCFW_RETURN_IF_TRUE(
+            layout_bytes[0] > JCFW_TELEMETRY_FIELD_COUNT_MAX, JCFW_RESULT_ERROR);
+        JCFW_RETURN_IF_TRUE(
+            length < reader->offset + 1 + layout_bytes[0], JCFW_RESULT_OUT_OF_BOUNDS);
+
+        jcfw_telemetry_codec_layout_t layout = {.field_count = layout_bytes[0]};
+        memcpy(layout.field_sizes, &layout_bytes[1], layout.field_count);
+
+        // NOTE(Caleb): The codec rejects any layout which would decode past the end of `record`.
+        jcfw_result_e err = jcfw_telemetry_codec_init(&reader->codec, &layout);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, JCFW_RESULT_ERROR);
+        JCFW_RETURN_IF_FALSE(
+            reader->codec.record_size == reader->header.record_size, JCFW_RESULT_ERROR);
+
+        jcfw_telemetry_codec_reset(&reader->codec, reader->header.base_time_us);
+        reader->offset += 1 + layout.field_count;
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_frame_next(
+    jcfw_telemetry_frame_reader_t *reader, uint64_t *o_time_us, const uint8_t **o_record)
+{
+    JCFW_ERROR_IF_FALSE(
+        reader && o_time_us && o_record, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(
+        reader->record_index == reader->header.record_count, JCFW_RESULT_EMPTY);
+
+    if (reader->header.encoding == JCFW_TELEMETRY_ENCODING_DELTA)
+    {
+        size_t        consumed = 0;
+        jcfw_result_e err      = jcfw_telemetry_codec_decode(
+            &reader->codec,
+            &reader->buffer[reader->offset],
+            reader->length - reader->offset,
+            &reader->time_us,
+            reader->record,
+            &consumed);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+        *o_time_us = reader->time_us;
+        *o_record  = reader->record;
+
+        reader->offset += consumed;
+        reader->record_index++;
+
+        return JCFW_RESULT_OK;
+    }
+
+    size_t   offset   = reader->offset;
+    uint32_t delta_us = 0;
+    for (size_t i = 0; i < JCFW_TELEMETRY_FRAME_DELTA_SIZE_MAX; i++)
+    {
+        JCFW_RETURN_IF_TRUE(offset >= reader->length, JCFW_RESULT_OUT_OF_BOUNDS);
+
+        const uint8_t byte = reader->buffer[offset++];
+        delta_us |= (uint32_t)(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+
+        JCFW_RETURN_IF_TRUE(i == JCFW_TELEMETRY_FRAME_DELTA_SIZE_MAX - 1, JCFW_RESULT_ERROR);
+    }
+
+    JCFW_RETURN_IF_TRUE(
+        reader->length - offset < reader->header.record_size, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    reader->time_us += delta_us;
+    *o_time_us = reader->time_us;
+    *o_record  = &reader->buffer[offset];
+
+    reader->offset = offset + reader->header.record_size;
+    reader->record_index++;
+
+    return JCFW_RESULT_OK;
+}
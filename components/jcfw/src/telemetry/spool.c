@@ -0,0 +1,474 @@
+#include "jcfw/telemetry/spool.h"
+
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/crc.h"
+#include "jcfw/util/math.h"
+
+#define TRACE_TAG                          "JCFW-SPOOL"
+
+#define _JCFW_SPOOL_SEGMENT_MAGIC          0x4C50534A // "JSPL"
+#define _JCFW_SPOOL_RECORD_LENGTH_FREE     0xFFFF
+#define _JCFW_SPOOL_RECORD_STATE_PENDING   0xFF
+#define _JCFW_SPOOL_RECORD_STATE_CONSUMED  0x00
+#define _JCFW_SPOOL_RECORD_STATE_OFFSET    2
+
+/// @brief The size of the chunks which records are checksummed in, in bytes.
+#define _JCFW_SPOOL_CHECK_CHUNK_SIZE       64
+
+typedef enum
+{
+    _JCFW_SPOOL_RECORD_VALID = 0,
+    _JCFW_SPOOL_RECORD_FREE,
+    _JCFW_SPOOL_RECORD_CORRUPT,
+} _jcfw_spool_record_e;
+
+// -------------------------------------------------------------------------------------------------
+
+static bool _jcfw_spool_read_segment_header(
+    jcfw_telemetry_spool_t *spool, uint32_t segment, uint32_t *o_seq, uint32_t *o_erase_count);
+static _jcfw_spool_record_e _jcfw_spool_read_record(
+    jcfw_telemetry_spool_t *spool,
+    uint32_t                segment,
+    size_t                  offset,
+    bool                    is_checked,
+    uint16_t               *o_length,
+    uint8_t                *o_state);
+static jcfw_result_e _jcfw_spool_start_segment(jcfw_telemetry_spool_t *spool);
+static void          _jcfw_spool_seek(jcfw_telemetry_spool_t *spool);
+
+static inline size_t _jcfw_spool_get_address(
+    const jcfw_telemetry_spool_t *spool, uint32_t segment, size_t offset)
+{
+    return (segment * spool->segment_size) + offset;
+}
+
+/// @brief Get the space taken up by a record of the given length, in bytes.
+static inline size_t _jcfw_spool_get_record_span(size_t length)
+{
+    return JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE + ((length + 3) & ~(size_t)3);
+}
+
+static inline uint32_t _jcfw_spool_get_next_segment(
+    const jcfw_telemetry_spool_t *spool, uint32_t segment)
+{
+    return (segment + 1) % spool->segment_count;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_telemetry_spool_open(jcfw_telemetry_spool_t *spool, const char *region_name)
+{
+    JCFW_ERROR_IF_FALSE(spool && region_name, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    memset(spool, 0x00, sizeof(*spool));
+
+    jcfw_result_e err = jcfw_flash_open(&spool->region, region_name);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    spool->segment_size  = spool->region.sector_size;
+    spool->segment_count = spool->region.size / spool->segment_size;
+    if (spool->segment_count < 2
+        || spool->segment_size
+               < JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE
+                     + _jcfw_spool_get_record_span(JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX))
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "%s is too small for a spool", region_name);
+        jcfw_flash_close(&spool->region);
+        return JCFW_RESULT_INVALID_ARGS;
+    }
+
+    // NOTE(Caleb): The live segments are a run which ends at the newest one and starts at the
+    // oldest one (wrapping around the region).
+    uint32_t oldest_seq = UINT32_MAX;
+    for (uint32_t segment = 0; segment < spool->segment_count; segment++)
+    {
+        uint32_t seq, erase_count;
+        if (!_jcfw_spool_read_segment_header(spool, segment, &seq, &erase_count))
+        {
+            continue;
+        }
+
+        spool->stats.wear_max = JCFW_MAX(spool->stats.wear_max, erase_count);
+        if (!spool->has_segment || seq > spool->write_seq)
+        {
+            spool->has_segment   = true;
+            spool->write_segment = segment;
+            spool->write_seq     = seq;
+        }
+
+        if (seq < oldest_seq)
+        {
+            oldest_seq          = seq;
+            spool->read_segment = segment;
+        }
+    }
+
+    JCFW_RETURN_IF_FALSE(spool->has_segment, JCFW_RESULT_OK);
+
+    // NOTE(Caleb): Count what is left to send, and find the end of the newest segment.
+    uint32_t segment = spool->read_segment;
+    while (1)
+    {
+        uint32_t seq, erase_count;
+        size_t   offset = JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE;
+
+        _jcfw_spool_record_e record = _JCFW_SPOOL_RECORD_FREE;
+        if (_jcfw_spool_read_segment_header(spool, segment, &seq, &erase_count))
+        {
+            while (1)
+            {
+                uint16_t length;
+                uint8_t  state;
+                record = _jcfw_spool_read_record(spool, segment, offset, true, &length, &state);
+                if (record != _JCFW_SPOOL_RECORD_VALID)
+                {
+                    break;
+                }
+
+                spool->pending_count += (state == _JCFW_SPOOL_RECORD_STATE_PENDING);
+                offset += _jcfw_spool_get_record_span(length);
+            }
+        }
+
+        if (record == _JCFW_SPOOL_RECORD_CORRUPT)
+        {
+            spool->stats.corrupt_count++;
+        }
+
+        if (segment == spool->write_segment)
+        {
+            // NOTE(Caleb): Never write after a torn record; Its length can't be trusted.
+            spool->write_offset =
+                (record == _JCFW_SPOOL_RECORD_CORRUPT) ? spool->segment_size : offset;
+            break;
+        }
+
+        segment = _jcfw_spool_get_next_segment(spool, segment);
+    }
+
+    spool->read_offset = JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE;
+    _jcfw_spool_seek(spool);
+
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "Recovered %lu records (%lu torn)",
+        (unsigned long)spool->pending_count,
+        (unsigned long)spool->stats.corrupt_count);
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_telemetry_spool_close(jcfw_telemetry_spool_t *spool)
+{
+    JCFW_RETURN_IF_FALSE(spool);
+
+    jcfw_flash_close(&spool->region);
+}
+
+jcfw_result_e
+jcfw_telemetry_spool_append(jcfw_telemetry_spool_t *spool, const void *data, size_t size)
+{
+    JCFW_ERROR_IF_FALSE(spool && data, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        size > 0 && size <= JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX,
+        JCFW_RESULT_INVALID_ARGS,
+        "Invalid record size");
+
+    jcfw_result_e err;
+
+    const size_t span = _jcfw_spool_get_record_span(size);
+    if (!spool->has_segment || spool->write_offset + span > spool->segment_size)
+    {
+        err = _jcfw_spool_start_segment(spool);
+        JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+    }
+
+    uint8_t header[JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE];
+    JCFW_PUT_LE(&header[0], (uint16_t)size, sizeof(uint16_t));
+    header[2] = _JCFW_SPOOL_RECORD_STATE_PENDING;
+    header[3] = 0xFF;
+    const uint32_t crc = jcfw_crc32(jcfw_crc32(JCFW_CRC32_INIT, &header[0], 2), data, size);
+    JCFW_PUT_LE(&header[4], crc, sizeof(uint32_t));
+
+    // NOTE(Caleb): The header goes first, so that a record torn by a reset fails its CRC rather
+    // than leaving dirty "free" space behind.
+    const size_t address =
+        _jcfw_spool_get_address(spool, spool->write_segment, spool->write_offset);
+
+    err = jcfw_flash_write(&spool->region, address, header, sizeof(header));
+    if (err == JCFW_RESULT_OK)
+    {
+        err = jcfw_flash_write(&spool->region, address + sizeof(header), data, size);
+    }
+
+    if (err != JCFW_RESULT_OK)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to write a record (rc %u)", err);
+        spool->write_offset = spool->segment_size;
+        return err;
+    }
+
+    // NOTE(Caleb): If everything had been consumed, the read position was the write position, so
+    // it is now at this record.
+    spool->write_offset += span;
+    spool->pending_count++;
+    spool->stats.append_count++;
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_spool_peek(
+    jcfw_telemetry_spool_t *spool, void *o_data, size_t capacity, size_t *o_size)
+{
+    JCFW_ERROR_IF_FALSE(spool && o_data && o_size, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_RETURN_IF_TRUE(spool->pending_count == 0, JCFW_RESULT_EMPTY);
+
+    uint8_t      header[JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE];
+    const size_t address = _jcfw_spool_get_address(spool, spool->read_segment, spool->read_offset);
+
+    jcfw_result_e err = jcfw_flash_read(&spool->region, address, header, sizeof(header));
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    const uint16_t length = JCFW_GET_LE(&header[0], sizeof(uint16_t));
+    JCFW_RETURN_IF_TRUE(length > capacity, JCFW_RESULT_OUT_OF_BOUNDS);
+
+    err = jcfw_flash_read(&spool->region, address + sizeof(header), o_data, length);
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    *o_size = length;
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_telemetry_spool_consume(jcfw_telemetry_spool_t *spool)
+{
+    JCFW_ERROR_IF_FALSE(spool, JCFW_RESULT_INVALID_ARGS, "No spool provided");
+    JCFW_RETURN_IF_TRUE(spool->pending_count == 0, JCFW_RESULT_EMPTY);
+
+    uint16_t length;
+    uint8_t  state;
+    _jcfw_spool_record_e record = _jcfw_spool_read_record(
+        spool, spool->read_segment, spool->read_offset, false, &length, &state);
+    JCFW_RETURN_IF_FALSE(record == _JCFW_SPOOL_RECORD_VALID, JCFW_RESULT_ERROR);
+
+    const uint8_t consumed = _JCFW_SPOOL_RECORD_STATE_CONSUMED;
+    const size_t  address =
+        _jcfw_spool_get_address(spool, spool->read_segment, spool->read_offset);
+
+    jcfw_result_e err = jcfw_flash_write(
+        &spool->region, address + _JCFW_SPOOL_RECORD_STATE_OFFSET, &consumed, sizeof(consumed));
+    JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK, err);
+
+    spool->pending_count--;
+    spool->stats.consume_count++;
+
+    spool->read_offset += _jcfw_spool_get_record_span(length);
+    _jcfw_spool_seek(spool);
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_telemetry_spool_get_stats(
+    const jcfw_telemetry_spool_t *spool, jcfw_telemetry_spool_stats_t *o_stats)
+{
+    *o_stats = spool->stats;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool _jcfw_spool_read_segment_header(
+    jcfw_telemetry_spool_t *spool, uint32_t segment, uint32_t *o_seq, uint32_t *o_erase_count)
+{
+    uint8_t      header[JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE];
+    const size_t address = _jcfw_spool_get_address(spool, segment, 0);
+    JCFW_RETURN_IF_FALSE(
+        jcfw_flash_read(&spool->region, address, header, sizeof(header)) == JCFW_RESULT_OK, false);
+
+    const uint32_t magic = JCFW_GET_LE(&header[0], sizeof(uint32_t));
+    const uint32_t crc   = JCFW_GET_LE(&header[12], sizeof(uint32_t));
+    JCFW_RETURN_IF_FALSE(magic == _JCFW_SPOOL_SEGMENT_MAGIC, false);
+    JCFW_RETURN_IF_FALSE(crc == jcfw_crc32(JCFW_CRC32_INIT, header, 12), false);
+
+    *o_seq         = JCFW_GET_LE(&header[4], sizeof(uint32_t));
+    *o_erase_count = JCFW_GET_LE(&header[8], sizeof(uint32_t));
+    return true;
+}
+
+/// @brief Read the header of the record at an offset of a segment, and check its CRC if asked to.
+static _jcfw_spool_record_e _jcfw_spool_read_record(
+    jcfw_telemetry_spool_t *spool,
+    uint32_t                segment,
+    size_t                  offset,
+    bool                    is_checked,
+    uint16_t               *o_length,
+    uint8_t                *o_state)
+{
+    JCFW_RETURN_IF_TRUE(
+        offset + JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE > spool->segment_size,
+        _JCFW_SPOOL_RECORD_FREE);
+
+    uint8_t header[JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE];
+    size_t  address = _jcfw_spool_get_address(spool, segment, offset);
+    JCFW_RETURN_IF_FALSE(
+        jcfw_flash_read(&spool->region, address, header, sizeof(header)) == JCFW_RESULT_OK,
+        _JCFW_SPOOL_RECORD_CORRUPT);
+
+    const uint16_t length = JCFW_GET_LE(&header[0], sizeof(uint16_t));
+    JCFW_RETURN_IF_TRUE(length == _JCFW_SPOOL_RECORD_LENGTH_FREE, _JCFW_SPOOL_RECORD_FREE);
+    JCFW_RETURN_IF_TRUE(
+        length == 0 || length > JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX, _JCFW_SPOOL_RECORD_CORRUPT);
+    JCFW_RETURN_IF_TRUE(
+        offset + _jcfw_spool_get_record_span(length) > spool->segment_size,
+        _JCFW_SPOOL_RECORD_CORRUPT);
+
+    *o_length = length;
+    *o_state  = header[_JCFW_SPOOL_RECORD_STATE_OFFSET];
+    JCFW_RETURN_IF_FALSE(is_checked, _JCFW_SPOOL_RECORD_VALID);
+
+    uint32_t crc = jcfw_crc32(JCFW_CRC32_INIT, &header[0], 2);
+    address += sizeof(header);
+    for (size_t done = 0; done < length; done += _JCFW_SPOOL_CHECK_CHUNK_SIZE)
+    {
+        uint8_t      chunk[_JCFW_SPOOL_CHECK_CHUNK_SIZE];
+        const size_t chunk_size = JCFW_MIN(sizeof(chunk), length - done);
+        JCFW_RETURN_IF_FALSE(
+            jcfw_flash_read(&spool->region, address + done, chunk, chunk_size) == JCFW_RESULT_OK,
+            _JCFW_SPOOL_RECORD_CORRUPT);
+
+        crc = jcfw_crc32(crc, chunk, chunk_size);
+    }
+
+    const bool is_valid = crc == JCFW_GET_LE(&header[4], sizeof(uint32_t));
+    return is_valid ? _JCFW_SPOOL_RECORD_VALID : _JCFW_SPOOL_RECORD_CORRUPT;
+}
+
+/// @brief Erase the segment after the newest one and start writing to it, dropping whatever it
+/// held which hadn't been consumed.
+static jcfw_result_e _jcfw_spool_start_segment(jcfw_telemetry_spool_t *spool)
+{
+    const uint32_t segment =
+        spool->has_segment ? _jcfw_spool_get_next_segment(spool, spool->write_segment) : 0;
+    const uint32_t seq = spool->has_segment ? spool->write_seq + 1 : 0;
+
+    // NOTE(Caleb): The read position is always at the oldest record which is still wanted, so if
+    // it is in this segment, everything from there to the end of the segment is lost.
+    bool is_dropping = spool->pending_count > 0 && spool->read_segment == segment;
+    if (is_dropping)
+    {
+        size_t offset = spool->read_offset;
+        while (1)
+        {
+            uint16_t length;
+            uint8_t  state;
+            if (_jcfw_spool_read_record(spool, segment, offset, false, &length, &state)
+                != _JCFW_SPOOL_RECORD_VALID)
+            {
+                break;
+            }
+
+            if (state == _JCFW_SPOOL_RECORD_STATE_PENDING)
+            {
+                spool->pending_count--;
+                spool->stats.drop_count++;
+            }
+
+            offset += _jcfw_spool_get_record_span(length);
+        }
+    }
+
+    uint32_t old_seq, erase_count = 0;
+    if (!_jcfw_spool_read_segment_header(spool, segment, &old_seq, &erase_count))
+    {
+        erase_count = 0;
+    }
+
+    erase_count++;
+    spool->stats.erase_count++;
+    spool->stats.wear_max = JCFW_MAX(spool->stats.wear_max, erase_count);
+
+    const size_t  address = _jcfw_spool_get_address(spool, segment, 0);
+    jcfw_result_e err     = jcfw_flash_erase(&spool->region, address, spool->segment_size);
+    JCFW_ERROR_IF_FALSE(
+        err == JCFW_RESULT_OK, err, "Unable to erase segment %lu", (unsigned long)segment);
+
+    uint8_t header[JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE];
+    JCFW_PUT_LE(&header[0], _JCFW_SPOOL_SEGMENT_MAGIC, sizeof(uint32_t));
+    JCFW_PUT_LE(&header[4], seq, sizeof(uint32_t));
+    JCFW_PUT_LE(&header[8], erase_count, sizeof(uint32_t));
+    JCFW_PUT_LE(&header[12], jcfw_crc32(JCFW_CRC32_INIT, header, 12), sizeof(uint32_t));
+
+    err = jcfw_flash_write(&spool->region, address, header, sizeof(header));
+    JCFW_ERROR_IF_FALSE(
+        err == JCFW_RESULT_OK, err, "Unable to start segment %lu", (unsigned long)segment);
+
+    spool->has_segment   = true;
+    spool->write_segment = segment;
+    spool->write_seq     = seq;
+    spool->write_offset  = JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE;
+
+    if (spool->pending_count == 0)
+    {
+        spool->read_segment = segment;
+        spool->read_offset  = JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE;
+    }
+    else if (is_dropping)
+    {
+        spool->read_segment = _jcfw_spool_get_next_segment(spool, segment);
+        spool->read_offset  = JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE;
+        _jcfw_spool_seek(spool);
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+/// @brief Move the read position forward to the oldest record which hasn't been consumed, or to
+/// the write position.
+static void _jcfw_spool_seek(jcfw_telemetry_spool_t *spool)
+{
+    JCFW_RETURN_IF_FALSE(spool->has_segment);
+
+    while (1)
+    {
+        const bool is_write_segment = spool->read_segment == spool->write_segment;
+        if (is_write_segment && spool->read_offset >= spool->write_offset)
+        {
+            spool->read_offset   = spool->write_offset;
+            spool->pending_count = 0;
+            return;
+        }
+
+        uint32_t seq, erase_count;
+        uint16_t length;
+        uint8_t  state;
+
+        _jcfw_spool_record_e record = _JCFW_SPOOL_RECORD_FREE;
+        if (_jcfw_spool_read_segment_header(spool, spool->read_segment, &seq, &erase_count))
+        {
+            // NOTE(Caleb): Pending records are checked, since they are about to be sent.
+            record = _jcfw_spool_read_record(
+                spool, spool->read_segment, spool->read_offset, false, &length, &state);
+            if (record == _JCFW_SPOOL_RECORD_VALID && state == _JCFW_SPOOL_RECORD_STATE_PENDING)
+            {
+                record = _jcfw_spool_read_record(
+                    spool, spool->read_segment, spool->read_offset, true, &length, &state);
+                JCFW_RETURN_IF_TRUE(record == _JCFW_SPOOL_RECORD_VALID);
+            }
+        }
+
+        if (record == _JCFW_SPOOL_RECORD_VALID)
+        {
+            spool->read_offset += _jcfw_spool_get_record_span(length);
+        }
+        else if (is_write_segment)
+        {
+            spool->read_offset   = spool->write_offset;
+            spool->pending_count = 0;
+            return;
+        }
+        else
+        {
+            spool->read_segment = _jcfw_spool_get_next_segment(spool, spool->read_segment);
+            spool->read_offset  = JCFW_TELEMETRY_SPOOL_SEGMENT_HEADER_SIZE;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include "jcfw/time.h"
+
+#include <stdatomic.h>
+
+#include "jcfw/platform/platform.h"
+#include "jcfw/util/assert.h"
+
+// -------------------------------------------------------------------------------------------------
+
+/// @brief Odd while the model is being replaced.
+static _Atomic uint32_t      s_jcfw_time_seq       = 0;
+static bool                  s_jcfw_time_has_model = false;
+static jcfw_timesync_model_t s_jcfw_time_model;
+
+// -------------------------------------------------------------------------------------------------
+
+void jcfw_time_set_model(const jcfw_timesync_model_t *model)
+{
+    JCFW_RETURN_IF_FALSE(model);
+
+    atomic_fetch_add_explicit(&s_jcfw_time_seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    s_jcfw_time_model     = *model;
+    s_jcfw_time_has_model = true;
+
+    atomic_fetch_add_explicit(&s_jcfw_time_seq, 1, memory_order_release);
+}
+
+bool jcfw_time_get_model(jcfw_timesync_model_t *o_model)
+{
+    JCFW_RETURN_IF_FALSE(o_model, false);
+
+    // NOTE(Caleb): The model changes every few seconds at most, so retry a torn copy rather than
+    // making every reader take a lock.
+    uint32_t seq;
+    bool     has_model;
+    do
+    {
+        seq       = atomic_load_explicit(&s_jcfw_time_seq, memory_order_acquire);
+        has_model = s_jcfw_time_has_model;
+        *o_model  = s_jcfw_time_model;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&s_jcfw_time_seq, memory_order_relaxed));
+
+    return has_model;
+}
+
+uint64_t jcfw_time_from_local_us(uint64_t local_us)
+{
+    jcfw_timesync_model_t model;
+    JCFW_RETURN_IF_FALSE(jcfw_time_get_model(&model), local_us);
+
+    return jcfw_timesync_model_apply(&model, local_us);
+}
+
+uint64_t jcfw_time_now_us(void)
+{
+    return jcfw_time_from_local_us(jcfw_platform_get_time_us());
+}
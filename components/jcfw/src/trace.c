@@ -55,10 +55,15 @@ void _jcfw_trace_generic(
     }
 
     va_list args;
+    va_list size_args;
     va_start(args, format);
 
-    size_t size = (size_t)vsnprintf(NULL, 0, format, args) + 1;
-    char   buffer[size];
+    // NOTE(Caleb): A va_list can't be walked twice, so the size is measured with a copy.
+    va_copy(size_args, args);
+    size_t size = (size_t)vsnprintf(NULL, 0, format, size_args) + 1;
+    va_end(size_args);
+
+    char buffer[size];
     vsnprintf(buffer, size, format, args);
 
     va_end(args);
@@ -144,10 +149,14 @@ static void _jcfw_trace_printf(const char *format, ...)
     JCFW_RETURN_IF_FALSE(format);
   
     va_list args;
+    va_list size_args;
     va_start(args, format);
 
-    size_t size = (size_t)vsnprintf(NULL, 0, format, args) + 1;
-    char   buffer[size];
+    va_copy(size_args, args);
+    size_t size = (size_t)vsnprintf(NULL, 0, format, size_args) + 1;
+    va_end(size_args);
+
+    char buffer[size];
     vsnprintf(buffer, size, format, args);
 
     va_end(args);
@@ -0,0 +1,25 @@
+#include "jcfw/util/crc.h"
+
+// NOTE(Caleb): A nibble at a time; 64 bytes of table instead of 1 KiB, and still fast enough for
+// the small records which get checksummed.
+static const uint32_t S_CRC32_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+// -------------------------------------------------------------------------------------------------
+
+uint32_t jcfw_crc32(uint32_t crc, const void *data, size_t size)
+{
+    const uint8_t *src = data;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= src[i];
+        crc = (crc >> 4) ^ S_CRC32_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ S_CRC32_TABLE[crc & 0x0F];
+    }
+
+    return ~crc;
+}
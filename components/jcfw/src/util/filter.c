@@ -0,0 +1,295 @@
+#include "jcfw/util/filter.h"
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+static inline int32_t _jcfw_filter_round_q16(int64_t value_q16);
+static inline int32_t _jcfw_filter_div_round(int64_t num, int64_t den);
+
+static inline int32_t _jcfw_filter_ema_step(jcfw_filter_t *filter, int32_t sample);
+static inline int32_t _jcfw_filter_moving_average_step(jcfw_filter_t *filter, int32_t sample);
+static inline int32_t _jcfw_filter_median_step(jcfw_filter_t *filter, int32_t sample);
+static inline int32_t _jcfw_filter_hysteresis_step(jcfw_filter_t *filter, int32_t sample);
+static inline int32_t _jcfw_filter_kalman_step(jcfw_filter_t *filter, int32_t sample);
+
+static uint32_t _jcfw_filter_sorted_find(const int32_t *sorted, uint32_t count, int32_t sample);
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_filter_init(jcfw_filter_t *filter, const jcfw_filter_config_t *config)
+{
+    JCFW_ERROR_IF_FALSE(filter && config, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+
+    switch (config->type)
+    {
+        case JCFW_FILTER_TYPE_NONE:
+        case JCFW_FILTER_TYPE_HYSTERESIS:
+            break;
+
+        case JCFW_FILTER_TYPE_EMA:
+            JCFW_ERROR_IF_FALSE(
+                config->ema.alpha_q16 > 0 && config->ema.alpha_q16 <= (1 << 16),
+                JCFW_RESULT_INVALID_ARGS,
+                "EMA weight out of range");
+            break;
+
+        case JCFW_FILTER_TYPE_MOVING_AVERAGE:
+            JCFW_ERROR_IF_FALSE(
+                config->moving_average.length > 0
+                    && config->moving_average.length <= JCFW_FILTER_LENGTH_MAX,
+                JCFW_RESULT_INVALID_ARGS,
+                "Moving average length out of range");
+            break;
+
+        case JCFW_FILTER_TYPE_MEDIAN:
+            JCFW_ERROR_IF_FALSE(
+                config->median.length > 0 && config->median.length <= JCFW_FILTER_LENGTH_MAX
+                    && (config->median.length % 2) == 1,
+                JCFW_RESULT_INVALID_ARGS,
+                "Median length must be odd and at most %d",
+                JCFW_FILTER_LENGTH_MAX);
+            break;
+
+        case JCFW_FILTER_TYPE_KALMAN:
+            JCFW_ERROR_IF_FALSE(
+                config->kalman.measurement_variance_q8 > 0,
+                JCFW_RESULT_INVALID_ARGS,
+                "Kalman measurement variance must not be 0");
+            break;
+
+        default:
+            JCFW_ERROR_IF_TRUE(true, JCFW_RESULT_INVALID_ARGS, "Unknown filter type");
+    }
+
+    memset(filter, 0x00, sizeof(*filter));
+    filter->config = *config;
+
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_filter_reset(jcfw_filter_t *filter)
+{
+    JCFW_RETURN_IF_FALSE(filter);
+
+    const jcfw_filter_config_t config = filter->config;
+    memset(filter, 0x00, sizeof(*filter));
+    filter->config = config;
+}
+
+int32_t jcfw_filter_apply(jcfw_filter_t *filter, int32_t sample)
+{
+    switch (filter->config.type)
+    {
+        case JCFW_FILTER_TYPE_EMA:
+            return _jcfw_filter_ema_step(filter, sample);
+        case JCFW_FILTER_TYPE_MOVING_AVERAGE:
+            return _jcfw_filter_moving_average_step(filter, sample);
+        case JCFW_FILTER_TYPE_MEDIAN:
+            return _jcfw_filter_median_step(filter, sample);
+        case JCFW_FILTER_TYPE_HYSTERESIS:
+            return _jcfw_filter_hysteresis_step(filter, sample);
+        case JCFW_FILTER_TYPE_KALMAN:
+            return _jcfw_filter_kalman_step(filter, sample);
+        default:
+            return sample;
+    }
+}
+
+void jcfw_filter_apply_block(
+    jcfw_filter_t *filter, const int32_t *samples, int32_t *o_samples, size_t count)
+{
+    // NOTE(Caleb): One loop per filter, so that the step is inlined and the type is only checked
+    // once per block.
+    switch (filter->config.type)
+    {
+        case JCFW_FILTER_TYPE_EMA:
+            for (size_t i = 0; i < count; i++)
+            {
+                o_samples[i] = _jcfw_filter_ema_step(filter, samples[i]);
+            }
+            break;
+
+        case JCFW_FILTER_TYPE_MOVING_AVERAGE:
+            for (size_t i = 0; i < count; i++)
+            {
+                o_samples[i] = _jcfw_filter_moving_average_step(filter, samples[i]);
+            }
+            break;
+
+        case JCFW_FILTER_TYPE_MEDIAN:
+            for (size_t i = 0; i < count; i++)
+            {
+                o_samples[i] = _jcfw_filter_median_step(filter, samples[i]);
+            }
+            break;
+
+        case JCFW_FILTER_TYPE_HYSTERESIS:
+            for (size_t i = 0; i < count; i++)
+            {
+                o_samples[i] = _jcfw_filter_hysteresis_step(filter, samples[i]);
+            }
+            break;
+
+        case JCFW_FILTER_TYPE_KALMAN:
+            for (size_t i = 0; i < count; i++)
+            {
+                o_samples[i] = _jcfw_filter_kalman_step(filter, samples[i]);
+            }
+            break;
+
+        default:
+            if (o_samples != samples)
+            {
+                memmove(o_samples, samples, count * sizeof(samples[0]));
+            }
+            break;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static inline int32_t _jcfw_filter_round_q16(int64_t value_q16)
+{
+    return (int32_t)((value_q16 + (1 << 15)) >> 16);
+}
+
+/// @brief Divide, rounding halves away from 0.
+static inline int32_t _jcfw_filter_div_round(int64_t num, int64_t den)
+{
+    return (int32_t)((num >= 0) ? (num + den / 2) / den : -((-num + den / 2) / den));
+}
+
+static inline int32_t _jcfw_filter_ema_step(jcfw_filter_t *filter, int32_t sample)
+{
+    const int64_t sample_q16 = (int64_t)sample << 16;
+    if (!filter->has_sample)
+    {
+        filter->ema.value_q16 = sample_q16;
+        filter->has_sample    = true;
+        return sample;
+    }
+
+    // NOTE(Caleb): The difference is below 2^47 and alpha at most 2^16, so the product fits.
+    filter->ema.value_q16 +=
+        ((sample_q16 - filter->ema.value_q16) * (int64_t)filter->config.ema.alpha_q16) >> 16;
+    return _jcfw_filter_round_q16(filter->ema.value_q16);
+}
+
+static inline int32_t _jcfw_filter_moving_average_step(jcfw_filter_t *filter, int32_t sample)
+{
+    const uint32_t length = filter->config.moving_average.length;
+
+    if (filter->window.count == length)
+    {
+        filter->window.sum -= filter->window.window[filter->window.next];
+    }
+    else
+    {
+        filter->window.count++;
+    }
+
+    filter->window.window[filter->window.next] = sample;
+    filter->window.sum += sample;
+    filter->window.next = (filter->window.next + 1 == length) ? 0 : filter->window.next + 1;
+    filter->has_sample  = true;
+
+    return _jcfw_filter_div_round(filter->window.sum, filter->window.count);
+}
+
+static inline int32_t _jcfw_filter_median_step(jcfw_filter_t *filter, int32_t sample)
+{
+    const uint32_t length = filter->config.median.length;
+    int32_t       *sorted = filter->window.sorted;
+    uint32_t       count  = filter->window.count;
+
+    // NOTE(Caleb): Keep a sorted copy of the window, so each sample costs one removal and one
+    // insertion (at most `length` moves each) rather than a sort.
+    if (count == length)
+    {
+        const int32_t  oldest = filter->window.window[filter->window.next];
+        const uint32_t index  = _jcfw_filter_sorted_find(sorted, count, oldest);
+        memmove(&sorted[index], &sorted[index + 1], (count - index - 1) * sizeof(sorted[0]));
+        count--;
+    }
+
+    const uint32_t index = _jcfw_filter_sorted_find(sorted, count, sample);
+    memmove(&sorted[index + 1], &sorted[index], (count - index) * sizeof(sorted[0]));
+    sorted[index] = sample;
+    count++;
+
+    filter->window.window[filter->window.next] = sample;
+    filter->window.next  = (filter->window.next + 1 == length) ? 0 : filter->window.next + 1;
+    filter->window.count = count;
+    filter->has_sample   = true;
+
+    // NOTE(Caleb): Until the window fills up, it can hold an even number of samples.
+    if (count % 2 == 0)
+    {
+        return _jcfw_filter_div_round((int64_t)sorted[count / 2 - 1] + sorted[count / 2], 2);
+    }
+
+    return sorted[count / 2];
+}
+
+static inline int32_t _jcfw_filter_hysteresis_step(jcfw_filter_t *filter, int32_t sample)
+{
+    const int64_t difference = (int64_t)sample - filter->hysteresis.value;
+    if (!filter->has_sample
+        || JCFW_MAX(difference, -difference) > (int64_t)filter->config.hysteresis.threshold)
+    {
+        filter->hysteresis.value = sample;
+        filter->has_sample       = true;
+    }
+
+    return filter->hysteresis.value;
+}
+
+static inline int32_t _jcfw_filter_kalman_step(jcfw_filter_t *filter, int32_t sample)
+{
+    const int64_t  sample_q16 = (int64_t)sample << 16;
+    const uint64_t noise_q16  = (uint64_t)filter->config.kalman.measurement_variance_q8 << 8;
+
+    if (!filter->has_sample)
+    {
+        filter->kalman.value_q16    = sample_q16;
+        filter->kalman.variance_q16 = noise_q16;
+        filter->has_sample          = true;
+        return sample;
+    }
+
+    // NOTE(Caleb): Predict (the value may have drifted), then correct towards the sample by the
+    // gain, which weighs the uncertainty of the estimate against the noise of the sample. The
+    // variance never grows past the noise plus the drift, so it stays below 2^41 and every product
+    // here fits.
+    const uint64_t variance_q16 =
+        filter->kalman.variance_q16 + ((uint64_t)filter->config.kalman.process_variance_q8 << 8);
+    const uint64_t gain_q16 = (variance_q16 << 16) / (variance_q16 + noise_q16);
+
+    filter->kalman.value_q16 += ((sample_q16 - filter->kalman.value_q16) * (int64_t)gain_q16) >> 16;
+    filter->kalman.variance_q16 = variance_q16 - ((variance_q16 * gain_q16) >> 16);
+
+    return _jcfw_filter_round_q16(filter->kalman.value_q16);
+}
+
+/// @brief Find the first element of a sorted array which isn't below `sample`.
+static uint32_t _jcfw_filter_sorted_find(const int32_t *sorted, uint32_t count, int32_t sample)
+{
+    uint32_t low  = 0;
+    uint32_t high = count;
+    while (low < high)
+    {
+        const uint32_t mid = low + (high - low) / 2;
+        if (sorted[mid] < sample)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
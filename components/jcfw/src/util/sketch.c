@@ -0,0 +1,90 @@
+#include "jcfw/util/sketch.h"
+
+#include <math.h>
+
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_sketch_init(jcfw_sketch_t *sketch, float min, float max)
+{
+    JCFW_ERROR_IF_FALSE(sketch, JCFW_RESULT_INVALID_ARGS, "No sketch provided");
+    JCFW_ERROR_IF_FALSE(min > 0 && max > min, JCFW_RESULT_INVALID_ARGS, "Invalid sketch range");
+
+    // NOTE(Caleb): Bucket 0 holds everything at or below `min` and the last bucket everything above
+    // `max`, so the buckets in between have to span `min` to `max` on their own.
+    sketch->min       = min;
+    sketch->log_gamma = logf(max / min) / (JCFW_SKETCH_BUCKET_COUNT - 2);
+    sketch->gamma     = expf(sketch->log_gamma);
+
+    jcfw_sketch_clear(sketch);
+    return JCFW_RESULT_OK;
+}
+
+void jcfw_sketch_clear(jcfw_sketch_t *sketch)
+{
+    sketch->count = 0;
+    memset(sketch->buckets, 0x00, sizeof(sketch->buckets));
+}
+
+void jcfw_sketch_add(jcfw_sketch_t *sketch, float value)
+{
+    size_t bucket = 0;
+    if (value > sketch->min)
+    {
+        const float index = ceilf(logf(value / sketch->min) / sketch->log_gamma);
+        bucket            = JCFW_MIN((size_t)JCFW_MAX(index, 1), JCFW_SKETCH_BUCKET_COUNT - 1);
+    }
+
+    if (sketch->buckets[bucket] < UINT16_MAX)
+    {
+        sketch->buckets[bucket]++;
+        sketch->count++;
+    }
+}
+
+jcfw_result_e jcfw_sketch_merge(jcfw_sketch_t *sketch, const jcfw_sketch_t *other)
+{
+    JCFW_ERROR_IF_FALSE(sketch && other, JCFW_RESULT_INVALID_ARGS, "Invalid arguments");
+    JCFW_ERROR_IF_FALSE(
+        sketch->min == other->min && sketch->log_gamma == other->log_gamma,
+        JCFW_RESULT_INVALID_ARGS,
+        "Sketches with different ranges can't be merged");
+
+    sketch->count = 0;
+    for (size_t i = 0; i < JCFW_SKETCH_BUCKET_COUNT; i++)
+    {
+        const uint32_t sum = (uint32_t)sketch->buckets[i] + other->buckets[i];
+        sketch->buckets[i] = JCFW_MIN(sum, UINT16_MAX);
+        sketch->count += sketch->buckets[i];
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+float jcfw_sketch_quantile(const jcfw_sketch_t *sketch, float q)
+{
+    JCFW_RETURN_IF_TRUE(sketch->count == 0, 0.0f);
+
+    const float    clamped_q = JCFW_CLAMP(q, 0.0f, 1.0f);
+    const uint32_t rank      = (uint32_t)(clamped_q * (sketch->count - 1));
+
+    uint32_t seen   = 0;
+    size_t   bucket = 0;
+    for (; bucket < JCFW_SKETCH_BUCKET_COUNT - 1; bucket++)
+    {
+        seen += sketch->buckets[bucket];
+        if (seen > rank)
+        {
+            break;
+        }
+    }
+
+    JCFW_RETURN_IF_TRUE(bucket == 0, sketch->min);
+
+    // NOTE(Caleb): Bucket i holds (min * gamma^(i - 1), min * gamma^i]; this point is the same
+    // relative distance from both ends.
+    const float upper = sketch->min * expf(sketch->log_gamma * bucket);
+    return 2.0f * upper / (sketch->gamma + 1.0f);
+}
@@ -0,0 +1,66 @@
+#include "jcfw/util/spsc.h"
+
+#include "jcfw/util/assert.h"
+
+// -------------------------------------------------------------------------------------------------
+
+jcfw_result_e jcfw_spsc_init(jcfw_spsc_t *ring, void *buffer, size_t elem_size, uint32_t capacity)
+{
+    JCFW_ERROR_IF_FALSE(ring, JCFW_RESULT_INVALID_ARGS, "No ring provided");
+    JCFW_ERROR_IF_FALSE(buffer, JCFW_RESULT_INVALID_ARGS, "No ring storage provided");
+    JCFW_ERROR_IF_FALSE(elem_size > 0, JCFW_RESULT_INVALID_ARGS, "Invalid record size");
+    JCFW_ERROR_IF_FALSE(
+        capacity > 0 && (capacity & (capacity - 1)) == 0,
+        JCFW_RESULT_INVALID_ARGS,
+        "Ring capacity %lu is not a power of two",
+        (unsigned long)capacity);
+
+    ring->buffer    = buffer;
+    ring->elem_size = elem_size;
+    ring->mask      = capacity - 1;
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overflow_count, 0);
+    atomic_init(&ring->high_water, 0);
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_spsc_push(jcfw_spsc_t *ring, const void *elem)
+{
+    // NOTE(Caleb): The indices count records forever and wrap at 2^32, so `head - tail` is the
+    // number of records in the ring even after they wrap.
+    const uint32_t head  = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    const uint32_t tail  = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    const uint32_t count = head - tail;
+
+    if (count > ring->mask)
+    {
+        atomic_fetch_add_explicit(&ring->overflow_count, 1, memory_order_relaxed);
+        return JCFW_RESULT_FULL;
+    }
+
+    memcpy(&ring->buffer[(head & ring->mask) * ring->elem_size], elem, ring->elem_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    if (count + 1 > atomic_load_explicit(&ring->high_water, memory_order_relaxed))
+    {
+        atomic_store_explicit(&ring->high_water, count + 1, memory_order_relaxed);
+    }
+
+    return JCFW_RESULT_OK;
+}
+
+jcfw_result_e jcfw_spsc_pop(jcfw_spsc_t *ring, void *o_elem)
+{
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    JCFW_RETURN_IF_TRUE(head == tail, JCFW_RESULT_EMPTY);
+
+    memcpy(o_elem, &ring->buffer[(tail & ring->mask) * ring->elem_size], ring->elem_size);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return JCFW_RESULT_OK;
+}
@@ -0,0 +1,266 @@
+#include "acquisition.h"
+
+// TODO(Caleb): JCFW OS
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "jcfw/driver/als/ltr303.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+#include "platform.h"
+
+#define TRACE_TAG                   "ACQ"
+
+// NOTE(Caleb): Just below the I2C worker, which has to run for the sensor read to complete, and
+// well above the network stage.
+#define ACQUISITION_TASK_PRIORITY   (JCFW_I2C_TASK_PRIORITY - 1)
+#define ACQUISITION_TASK_STACK_SIZE 3072
+
+/// @brief The number of samples which can be on their way to the network stage at once.
+#define ACQUISITION_BLOCK_COUNT     16
+
+/// @brief The default filter of the ALS channels; A median of 3 removes single-sample spikes
+/// (flicker, a passing shadow) for one sample of delay.
+#define ACQUISITION_FILTER_LENGTH   3
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_pipeline_stage_t s_stage;
+static bool                  s_is_started = false;
+static jcfw_pipeline_block_t s_blocks[ACQUISITION_BLOCK_COUNT];
+static jcfw_pipeline_pool_t  s_pool;
+static uint32_t              s_sequence = 0;
+
+// TODO(Caleb): JCFW OS
+static portMUX_TYPE s_edge_lock            = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t     s_edge_us              = 0;
+static bool         s_is_edge_pending      = false;
+static uint32_t     s_coalesced_edge_count = 0;
+
+static portMUX_TYPE        s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static acquisition_stats_t s_stats      = {0};
+
+// NOTE(Caleb): The filters belong to the stage task; Other tasks hand it a new configuration,
+// which it picks up before its next sample.
+static portMUX_TYPE         s_filter_lock        = portMUX_INITIALIZER_UNLOCKED;
+static jcfw_filter_config_t s_filter_config      = {0};
+static bool                 s_is_filter_changed  = false;
+static jcfw_filter_t        s_channel0_filter;
+static jcfw_filter_t        s_channel1_filter;
+static uint8_t              s_filter_gain_factor = 0;
+
+// -------------------------------------------------------------------------------------------------
+
+static uint32_t acquisition_poll(jcfw_pipeline_stage_t *stage, uint64_t now_us, void *arg);
+static void     acquisition_count_overflow(void);
+static void     acquisition_filter(acquisition_sample_t *sample);
+
+// -------------------------------------------------------------------------------------------------
+
+bool acquisition_init(jcfw_pipeline_stage_t *next)
+{
+    jcfw_result_e err = jcfw_pipeline_pool_init(&s_pool, s_blocks, JCFW_ARRAYSIZE(s_blocks));
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, false, "Unable to set up the sample blocks");
+
+    const jcfw_filter_config_t filter_config = {
+        .type   = JCFW_FILTER_TYPE_MEDIAN,
+        .median = {.length = ACQUISITION_FILTER_LENGTH},
+    };
+    JCFW_ERROR_IF_FALSE(
+        acquisition_set_filter(&filter_config), false, "Unable to set up the ALS filter");
+
+    jcfw_pipeline_stage_config_t config = {
+        .task =
+            {
+                .name       = "APP-ACQ",
+                .stack_size = ACQUISITION_TASK_STACK_SIZE,
+                .priority   = ACQUISITION_TASK_PRIORITY,
+                .core       = JCFW_TASK_CORE_ANY,
+            },
+        .process_cb = NULL,
+        .poll_cb    = acquisition_poll,
+        .cb_arg     = NULL,
+        .next       = next,
+    };
+    err = jcfw_pipeline_stage_init(&s_stage, &config);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, false, "Unable to set up the acquisition stage");
+
+    // NOTE(Caleb): The LTR303 holds INT until its status is read, so an edge which arrived before
+    // the stage existed would never repeat. Start with a read to clear it; The stage polls as soon
+    // as it starts.
+    taskENTER_CRITICAL(&s_edge_lock);
+    s_edge_us         = jcfw_platform_get_time_us();
+    s_is_edge_pending = true;
+    taskEXIT_CRITICAL(&s_edge_lock);
+
+    err = jcfw_pipeline_stage_start(&s_stage);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, false, "Unable to start the acquisition stage");
+
+    s_is_started = true;
+    return true;
+}
+
+jcfw_pipeline_stage_t *acquisition_get_stage(void)
+{
+    return &s_stage;
+}
+
+void acquisition_on_edge_from_isr(uint64_t edge_us)
+{
+    JCFW_RETURN_IF_FALSE(s_is_started);
+
+    taskENTER_CRITICAL_ISR(&s_edge_lock);
+    if (s_is_edge_pending)
+    {
+        s_coalesced_edge_count++;
+    }
+
+    s_edge_us         = edge_us;
+    s_is_edge_pending = true;
+    taskEXIT_CRITICAL_ISR(&s_edge_lock);
+
+    jcfw_pipeline_stage_notify_from_isr(&s_stage);
+}
+
+bool acquisition_set_filter(const jcfw_filter_config_t *config)
+{
+    JCFW_RETURN_IF_FALSE(config, false);
+
+    // NOTE(Caleb): Check the configuration here, where the caller can hear about it.
+    jcfw_filter_t filter;
+    JCFW_RETURN_IF_FALSE(jcfw_filter_init(&filter, config) == JCFW_RESULT_OK, false);
+
+    taskENTER_CRITICAL(&s_filter_lock);
+    s_filter_config     = *config;
+    s_is_filter_changed = true;
+    taskEXIT_CRITICAL(&s_filter_lock);
+
+    return true;
+}
+
+void acquisition_get_filter(jcfw_filter_config_t *o_config)
+{
+    taskENTER_CRITICAL(&s_filter_lock);
+    *o_config = s_filter_config;
+    taskEXIT_CRITICAL(&s_filter_lock);
+}
+
+void acquisition_get_stats(acquisition_stats_t *o_stats)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    *o_stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    taskENTER_CRITICAL(&s_edge_lock);
+    o_stats->coalesced_edge_count = s_coalesced_edge_count;
+    taskEXIT_CRITICAL(&s_edge_lock);
+}
+
+void acquisition_reset_stats(void)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0x00, sizeof(s_stats));
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    taskENTER_CRITICAL(&s_edge_lock);
+    s_coalesced_edge_count = 0;
+    taskEXIT_CRITICAL(&s_edge_lock);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static uint32_t acquisition_poll(jcfw_pipeline_stage_t *stage, uint64_t now_us, void *arg)
+{
+    taskENTER_CRITICAL(&s_edge_lock);
+    const bool     is_edge_pending = s_is_edge_pending;
+    const uint64_t edge_us         = s_edge_us;
+    s_is_edge_pending              = false;
+    taskEXIT_CRITICAL(&s_edge_lock);
+
+    JCFW_RETURN_IF_FALSE(is_edge_pending, JCFW_EVENT_WAIT_FOREVER);
+
+    acquisition_sample_t sample = {
+        .edge_us  = edge_us,
+        .sequence = s_sequence,
+    };
+
+    jcfw_result_e err =
+        jcfw_ltr303_read(&g_ltr303, &sample.channel0, &sample.channel1, &sample.gain_factor);
+    sample.read_us = jcfw_platform_get_time_us();
+
+    if (err != JCFW_RESULT_OK)
+    {
+        taskENTER_CRITICAL(&s_stats_lock);
+        s_stats.read_error_count++;
+        taskEXIT_CRITICAL(&s_stats_lock);
+
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to read ALS data (rc %u)", err);
+        return JCFW_EVENT_WAIT_FOREVER;
+    }
+
+    s_sequence++;
+    acquisition_filter(&sample);
+
+    // NOTE(Caleb): If the network stage has fallen behind, there is either no free block or no
+    // room in its queue. Either way the sample is counted as dropped and acquisition carries on.
+    jcfw_pipeline_block_t *block =
+        jcfw_pipeline_block_acquire(&s_pool, ACQUISITION_STREAM_ALS, sizeof(sample), edge_us);
+    if (block)
+    {
+        jcfw_pipeline_block_append(block, &sample);
+        err = jcfw_pipeline_emit(stage, block);
+    }
+
+    if (!block || err != JCFW_RESULT_OK)
+    {
+        acquisition_count_overflow();
+    }
+
+    const uint32_t latency_us = sample.read_us - sample.edge_us;
+
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.sample_count++;
+    s_stats.read_latency_max_us = JCFW_MAX(s_stats.read_latency_max_us, latency_us);
+    s_stats.read_latency_total_us += latency_us;
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    return JCFW_EVENT_WAIT_FOREVER;
+}
+
+static void acquisition_count_overflow(void)
+{
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.overflow_count++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void acquisition_filter(acquisition_sample_t *sample)
+{
+    taskENTER_CRITICAL(&s_filter_lock);
+    const bool                 is_filter_changed = s_is_filter_changed;
+    const jcfw_filter_config_t config            = s_filter_config;
+    s_is_filter_changed                          = false;
+    taskEXIT_CRITICAL(&s_filter_lock);
+
+    if (is_filter_changed)
+    {
+        jcfw_filter_init(&s_channel0_filter, &config);
+        jcfw_filter_init(&s_channel1_filter, &config);
+    }
+
+    // NOTE(Caleb): Readings at different gains aren't comparable, so start over on a gain change.
+    if (sample->gain_factor != s_filter_gain_factor)
+    {
+        jcfw_filter_reset(&s_channel0_filter);
+        jcfw_filter_reset(&s_channel1_filter);
+        s_filter_gain_factor = sample->gain_factor;
+    }
+
+    sample->channel0 =
+        JCFW_CLAMP(jcfw_filter_apply(&s_channel0_filter, sample->channel0), 0, UINT16_MAX);
+    sample->channel1 =
+        JCFW_CLAMP(jcfw_filter_apply(&s_channel1_filter, sample->channel1), 0, UINT16_MAX);
+}
@@ -0,0 +1,83 @@
+#ifndef __ACQUISITION_H__
+#define __ACQUISITION_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "jcfw/pipeline/pipeline.h"
+#include "jcfw/util/filter.h"
+
+/// @brief The stream of the pipeline blocks which acquisition emits. Each block holds one
+/// acquisition_sample_t.
+#define ACQUISITION_STREAM_ALS 0
+
+/// @brief One ALS sample, as handed from the acquisition stage to the network stage.
+typedef struct
+{
+    /// @brief The time of the INT edge which announced the sample (see: jcfw_platform_get_time_us).
+    uint64_t edge_us;
+
+    /// @brief The time at which the sample was read from the sensor.
+    uint64_t read_us;
+
+    /// @brief Incremented for every sample read, so that dropped samples can be detected.
+    uint32_t sequence;
+
+    /// @brief The channel readings, after the filter (see: acquisition_set_filter()).
+    uint16_t channel0;
+    uint16_t channel1;
+    uint8_t  gain_factor;
+} acquisition_sample_t;
+
+/// @brief Acquisition statistics.
+typedef struct
+{
+    /// @brief The number of samples read from the sensor.
+    uint32_t sample_count;
+
+    /// @brief The number of failed sensor reads.
+    uint32_t read_error_count;
+
+    /// @brief The number of INT edges which arrived before the previous one was handled.
+    uint32_t coalesced_edge_count;
+
+    /// @brief The number of samples dropped because the network stage fell behind. (see: the
+    /// pipeline statistics of the network stage)
+    uint32_t overflow_count;
+
+    /// @brief The time from the INT edge to the end of the sensor read.
+    uint32_t read_latency_max_us;
+    uint64_t read_latency_total_us;
+} acquisition_stats_t;
+
+/// @brief Start the acquisition stage, a pipeline source which reads the ALS on each INT edge.
+/// @param next The stage to emit samples to. It must already be set up.
+/// @return True if the stage was started, and false otherwise.
+bool acquisition_init(jcfw_pipeline_stage_t *next);
+
+/// @brief Get the pipeline stage of acquisition.
+/// @return The stage.
+jcfw_pipeline_stage_t *acquisition_get_stage(void);
+
+/// @brief Announce an INT edge from the ALS. Only call this from the GPIO ISR.
+/// @param edge_us The time of the edge.
+void acquisition_on_edge_from_isr(uint64_t edge_us);
+
+/// @brief Change the filter which both ALS channels go through before they are emitted. The
+/// filters start over with the next sample.
+/// @param config Required; The configuration of the filter (JCFW_FILTER_TYPE_NONE for none).
+/// @return True if the filter will be used, and false if the configuration is invalid.
+bool acquisition_set_filter(const jcfw_filter_config_t *config);
+
+/// @brief Get the configuration of the filter which both ALS channels go through.
+/// @param o_config Required; The configuration of the filter.
+void acquisition_get_filter(jcfw_filter_config_t *o_config);
+
+/// @brief Get a snapshot of the acquisition statistics.
+/// @param o_stats Required; The statistics.
+void acquisition_get_stats(acquisition_stats_t *o_stats);
+
+/// @brief Reset the acquisition statistics.
+void acquisition_reset_stats(void);
+
+#endif // __ACQUISITION_H__
@@ -0,0 +1,154 @@
+#include "aggregation.h"
+
+// TODO(Caleb): JCFW OS
+#include "freertos/FreeRTOS.h"
+
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+
+#define TRACE_TAG           "AGG"
+
+/// @brief The range over which percentiles are told apart, in lux.
+#define AGGREGATION_LUX_MIN 0.1f
+#define AGGREGATION_LUX_MAX 64000.0f
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_aggregate_t     s_agg;
+static aggregation_report_f s_report_cb     = NULL;
+static void                *s_report_cb_arg = NULL;
+
+// TODO(Caleb): JCFW OS
+static portMUX_TYPE            s_lock              = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t                s_window_ms         = AGGREGATION_WINDOW_MS_DEFAULT;
+static uint32_t                s_hop_ms            = AGGREGATION_HOP_MS_DEFAULT;
+static bool                    s_is_window_changed = false;
+static bool                    s_is_raw_enabled    = false;
+static jcfw_aggregate_report_t s_last_report       = {0};
+static bool                    s_has_last_report   = false;
+
+// -------------------------------------------------------------------------------------------------
+
+static bool aggregation_apply_window(void);
+static void aggregation_on_report(const jcfw_aggregate_report_t *report, void *arg);
+
+// -------------------------------------------------------------------------------------------------
+
+bool aggregation_init(aggregation_report_f report_cb, void *report_cb_arg)
+{
+    JCFW_ERROR_IF_FALSE(report_cb, false, "No report callback provided");
+
+    s_report_cb     = report_cb;
+    s_report_cb_arg = report_cb_arg;
+
+    taskENTER_CRITICAL(&s_lock);
+    s_is_window_changed = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    return aggregation_apply_window();
+}
+
+void aggregation_add(uint64_t time_us, float lux)
+{
+    aggregation_apply_window();
+
+    jcfw_aggregate_add(&s_agg, time_us, lux);
+}
+
+void aggregation_poll(uint64_t now_us)
+{
+    aggregation_apply_window();
+
+    jcfw_aggregate_poll(&s_agg, now_us);
+}
+
+bool aggregation_set_window(uint32_t window_ms, uint32_t hop_ms)
+{
+    JCFW_RETURN_IF_FALSE(hop_ms > 0 && window_ms >= hop_ms && window_ms % hop_ms == 0, false);
+    JCFW_RETURN_IF_FALSE(window_ms / hop_ms <= JCFW_AGGREGATE_PANE_COUNT_MAX, false);
+
+    taskENTER_CRITICAL(&s_lock);
+    s_window_ms         = window_ms;
+    s_hop_ms            = hop_ms;
+    s_is_window_changed = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    return true;
+}
+
+void aggregation_get_window(uint32_t *o_window_ms, uint32_t *o_hop_ms)
+{
+    taskENTER_CRITICAL(&s_lock);
+    *o_window_ms = s_window_ms;
+    *o_hop_ms    = s_hop_ms;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+bool aggregation_get_last_report(jcfw_aggregate_report_t *o_report)
+{
+    taskENTER_CRITICAL(&s_lock);
+    const bool has_last_report = s_has_last_report;
+    *o_report                  = s_last_report;
+    taskEXIT_CRITICAL(&s_lock);
+
+    return has_last_report;
+}
+
+void aggregation_set_raw_enabled(bool is_enabled)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_is_raw_enabled = is_enabled;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+bool aggregation_is_raw_enabled(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    const bool is_raw_enabled = s_is_raw_enabled;
+    taskEXIT_CRITICAL(&s_lock);
+
+    return is_raw_enabled;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool aggregation_apply_window(void)
+{
+    // NOTE(Caleb): The CLI only records the new window; the aggregator itself is only ever touched
+    // by the network stage, so it needs no lock of its own.
+    taskENTER_CRITICAL(&s_lock);
+    const bool is_due = s_is_window_changed;
+
+    jcfw_aggregate_config_t config = {
+        .window_ms     = s_window_ms,
+        .hop_ms        = s_hop_ms,
+        .value_min     = AGGREGATION_LUX_MIN,
+        .value_max     = AGGREGATION_LUX_MAX,
+        .report_cb     = aggregation_on_report,
+        .report_cb_arg = NULL,
+    };
+    s_is_window_changed = false;
+    taskEXIT_CRITICAL(&s_lock);
+
+    JCFW_RETURN_IF_FALSE(is_due, true);
+
+    jcfw_result_e err = jcfw_aggregate_init(&s_agg, &config);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, false, "Unable to set up the aggregator");
+
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "Aggregating over %lu ms, reporting every %lu ms",
+        (unsigned long)config.window_ms,
+        (unsigned long)config.hop_ms);
+    return true;
+}
+
+static void aggregation_on_report(const jcfw_aggregate_report_t *report, void *arg)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_last_report     = *report;
+    s_has_last_report = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    s_report_cb(report, s_report_cb_arg);
+}
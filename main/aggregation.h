@@ -0,0 +1,57 @@
+#ifndef __AGGREGATION_H__
+#define __AGGREGATION_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "jcfw/telemetry/aggregate.h"
+
+/// @brief The default window, which reports per-minute statistics.
+#define AGGREGATION_WINDOW_MS_DEFAULT (60 * 1000)
+#define AGGREGATION_HOP_MS_DEFAULT    (60 * 1000)
+
+/// @brief Called with the summary of each window. Runs on the network stage.
+typedef void (*aggregation_report_f)(const jcfw_aggregate_report_t *report, void *arg);
+
+/// @brief Set up the aggregation stage with the default window.
+/// @param report_cb Called with the summary of each window.
+/// @param report_cb_arg Passed to `report_cb`.
+/// @return True if the stage was set up, and false otherwise.
+bool aggregation_init(aggregation_report_f report_cb, void *report_cb_arg);
+
+/// @brief Add an ALS reading. Network stage only.
+/// @param time_us The time of the reading.
+/// @param lux The reading.
+void aggregation_add(uint64_t time_us, float lux);
+
+/// @brief Report any windows which have closed. Network stage only.
+/// @param now_us The current time.
+void aggregation_poll(uint64_t now_us);
+
+/// @brief Change the window. May be called from any task; The windows in progress are dropped when
+/// the network stage picks up the change.
+/// @param window_ms The length of each window, in milliseconds.
+/// @param hop_ms The time between reports, in milliseconds. Equal to `window_ms` for tumbling
+/// windows.
+/// @return True if the window is valid, and false otherwise.
+bool aggregation_set_window(uint32_t window_ms, uint32_t hop_ms);
+
+/// @brief Get the current window.
+/// @param o_window_ms Required; The length of each window, in milliseconds.
+/// @param o_hop_ms Required; The time between reports, in milliseconds.
+void aggregation_get_window(uint32_t *o_window_ms, uint32_t *o_hop_ms);
+
+/// @brief Get the summary of the most recent window.
+/// @param o_report Required; The summary.
+/// @return True if a window has been reported, and false otherwise.
+bool aggregation_get_last_report(jcfw_aggregate_report_t *o_report);
+
+/// @brief Choose whether raw readings are sent alongside the summaries.
+/// @param is_enabled True to send raw readings, and false otherwise.
+void aggregation_set_raw_enabled(bool is_enabled);
+
+/// @brief Check whether raw readings are sent alongside the summaries.
+/// @return True if raw readings are sent, and false otherwise.
+bool aggregation_is_raw_enabled(void);
+
+#endif // __AGGREGATION_H__
@@ -1,33 +1,109 @@
 #include "cli.h"
 
+#include <stdlib.h>
+
 // TODO(Caleb): JCFW OS
 #include "freertos/FreeRTOS.h"
 
 #include "jcfw/cli.h"
+#include "jcfw/platform/platform.h"
 #include "jcfw/platform/wifi.h"
+#include "jcfw/time.h"
 #include "jcfw/util/assert.h"
 #include "jcfw/util/math.h"
 
+#include "acquisition.h"
+#include "aggregation.h"
 #include "platform.h"
 #include "util.h"
 
+/// @brief How long the `wifi` commands wait for, in ms; The CLI is blocked in the meantime.
+#define CLI_WIFI_INIT_TIMEOUT_MS       5000
+#define CLI_WIFI_CONNECT_TIMEOUT_MS    30000
+#define CLI_WIFI_DISCONNECT_TIMEOUT_MS 5000
+
 // -------------------------------------------------------------------------------------------------
 
 static jcfw_cli_t s_cli = {0};
 
+typedef struct
+{
+    jcfw_pipeline_stage_t *stage;
+
+    /// @brief The sample count and time of the last `pipeline` command, for the throughput.
+    uint32_t last_sample_count;
+    uint64_t last_us;
+} cli_stage_t;
+
+static cli_stage_t s_stages[CLI_STAGE_COUNT_MAX];
+static size_t      s_stage_count = 0;
+
 // -------------------------------------------------------------------------------------------------
 
+static int acq(jcfw_cli_t *cli, int argc, char **argv);
+static int acq_filter(jcfw_cli_t *cli, int argc, char **argv);
+
+static int agg(jcfw_cli_t *cli, int argc, char **argv);
+static int agg_status(jcfw_cli_t *cli, int argc, char **argv);
+static int agg_window(jcfw_cli_t *cli, int argc, char **argv);
+static int agg_raw(jcfw_cli_t *cli, int argc, char **argv);
+
 static int als(jcfw_cli_t *cli, int argc, char **argv);
 
+static int i2c(jcfw_cli_t *cli, int argc, char **argv);
+
+static int pipeline(jcfw_cli_t *cli, int argc, char **argv);
+
+static int time_status(jcfw_cli_t *cli, int argc, char **argv);
+
 static int wifi(jcfw_cli_t *cli, int argc, char **argv);
 static int wifi_status(jcfw_cli_t *cli, int argc, char **argv);
 static int wifi_connect(jcfw_cli_t *cli, int argc, char **argv);
 static int wifi_disconnect(jcfw_cli_t *cli, int argc, char **argv);
 static int wifi_scan(jcfw_cli_t *cli, int argc, char **argv);
+static int wifi_aps(jcfw_cli_t *cli, int argc, char **argv);
+static void wifi_print_aps(jcfw_cli_t *cli, const jcfw_wifi_sta_scan_result_t *aps, size_t num_aps);
 
 // -------------------------------------------------------------------------------------------------
 
 const jcfw_cli_cmd_spec_t s_cmds[] = {
+    {
+        .name        = "acq",
+        .usage       = "usage: acq <stats|reset|filter>",
+        .handler     = acq,
+        .num_subcmds = 0,
+        .subcmds     = NULL,
+    },
+    {
+        .name        = "agg",
+        .usage       = "usage: agg <status|window|raw>",
+        .handler     = agg,
+        .num_subcmds = 3,
+        .subcmds =
+            (jcfw_cli_cmd_spec_t[]) {
+                {
+                    .name        = "status",
+                    .usage       = "agg status",
+                    .handler     = agg_status,
+                    .num_subcmds = 0,
+                    .subcmds     = NULL,
+                },
+                {
+                    .name        = "window",
+                    .usage       = "agg window <window_ms> [hop_ms]",
+                    .handler     = agg_window,
+                    .num_subcmds = 0,
+                    .subcmds     = NULL,
+                },
+                {
+                    .name        = "raw",
+                    .usage       = "agg raw <on|off>",
+                    .handler     = agg_raw,
+                    .num_subcmds = 0,
+                    .subcmds     = NULL,
+                },
+            },
+    },
     {
         .name        = "als",
         .usage       = "usage: als <on|off>",
@@ -35,11 +111,32 @@ const jcfw_cli_cmd_spec_t s_cmds[] = {
         .num_subcmds = 0,
         .subcmds     = NULL,
     },
+    {
+        .name        = "i2c",
+        .usage       = "usage: i2c <stats|reset>",
+        .handler     = i2c,
+        .num_subcmds = 0,
+        .subcmds     = NULL,
+    },
+    {
+        .name        = "pipeline",
+        .usage       = "usage: pipeline",
+        .handler     = pipeline,
+        .num_subcmds = 0,
+        .subcmds     = NULL,
+    },
+    {
+        .name        = "time",
+        .usage       = "usage: time",
+        .handler     = time_status,
+        .num_subcmds = 0,
+        .subcmds     = NULL,
+    },
     {
         .name        = "wifi",
         .usage       = "usage: wifi <on|off>",
         .handler     = wifi,
-        .num_subcmds = 4,
+        .num_subcmds = 5,
         .subcmds =
             (jcfw_cli_cmd_spec_t[]) {
                 {
@@ -70,12 +167,247 @@ const jcfw_cli_cmd_spec_t s_cmds[] = {
                     .num_subcmds = 0,
                     .subcmds     = NULL,
                 },
+                {
+                    .name        = "aps",
+                    .usage       = "wifi aps",
+                    .handler     = wifi_aps,
+                    .num_subcmds = 0,
+                    .subcmds     = NULL,
+                },
             },
     },
 };
 
 // -------------------------------------------------------------------------------------------------
 
+static int acq(jcfw_cli_t *cli, int argc, char **argv)
+{
+    const char *USAGE_MESSAGE = "usage: acq <stats|reset|filter>\n";
+
+    if (argc >= 2 && strncmp(argv[1], "filter", 6) == 0)
+    {
+        return acq_filter(cli, argc - 1, &argv[1]);
+    }
+
+    if (argc != 2)
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    if (strncmp(argv[1], "stats", 5) == 0)
+    {
+        acquisition_stats_t stats;
+        acquisition_get_stats(&stats);
+
+        const uint32_t read_latency_avg_us =
+            stats.sample_count ? stats.read_latency_total_us / stats.sample_count : 0;
+
+        jcfw_cli_printf(cli, "samples:           %lu\n", (unsigned long)stats.sample_count);
+        jcfw_cli_printf(cli, "read errors:       %lu\n", (unsigned long)stats.read_error_count);
+        jcfw_cli_printf(cli, "coalesced edges:   %lu\n", (unsigned long)stats.coalesced_edge_count);
+        jcfw_cli_printf(cli, "overflows:         %lu\n", (unsigned long)stats.overflow_count);
+        jcfw_cli_printf(
+            cli,
+            "read latency:      %lu us avg, %lu us max\n",
+            (unsigned long)read_latency_avg_us,
+            (unsigned long)stats.read_latency_max_us);
+    }
+    else if (strncmp(argv[1], "reset", 5) == 0)
+    {
+        acquisition_reset_stats();
+    }
+    else
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int acq_filter(jcfw_cli_t *cli, int argc, char **argv)
+{
+    const char *USAGE_MESSAGE =
+        "usage: acq filter [off|ema <alpha/65536>|avg <length>|median <length>|hyst <threshold>|"
+        "kalman <drift variance> <noise variance>]\n";
+
+    jcfw_filter_config_t config = {0};
+
+    if (argc == 1)
+    {
+        acquisition_get_filter(&config);
+        switch (config.type)
+        {
+            case JCFW_FILTER_TYPE_EMA:
+                jcfw_cli_printf(cli, "ema %lu\n", (unsigned long)config.ema.alpha_q16);
+                break;
+            case JCFW_FILTER_TYPE_MOVING_AVERAGE:
+                jcfw_cli_printf(cli, "avg %lu\n", (unsigned long)config.moving_average.length);
+                break;
+            case JCFW_FILTER_TYPE_MEDIAN:
+                jcfw_cli_printf(cli, "median %lu\n", (unsigned long)config.median.length);
+                break;
+            case JCFW_FILTER_TYPE_HYSTERESIS:
+                jcfw_cli_printf(cli, "hyst %lu\n", (unsigned long)config.hysteresis.threshold);
+                break;
+            case JCFW_FILTER_TYPE_KALMAN:
+                jcfw_cli_printf(
+                    cli,
+                    "kalman %lu %lu\n",
+                    (unsigned long)(config.kalman.process_variance_q8 >> 8),
+                    (unsigned long)(config.kalman.measurement_variance_q8 >> 8));
+                break;
+            default:
+                jcfw_cli_printf(cli, "off\n");
+                break;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc == 2 && strncmp(argv[1], "off", 3) == 0)
+    {
+        config.type = JCFW_FILTER_TYPE_NONE;
+    }
+    else if (argc == 3 && strncmp(argv[1], "ema", 3) == 0)
+    {
+        config.type          = JCFW_FILTER_TYPE_EMA;
+        config.ema.alpha_q16 = strtoul(argv[2], NULL, 10);
+    }
+    else if (argc == 3 && strncmp(argv[1], "avg", 3) == 0)
+    {
+        config.type                  = JCFW_FILTER_TYPE_MOVING_AVERAGE;
+        config.moving_average.length = strtoul(argv[2], NULL, 10);
+    }
+    else if (argc == 3 && strncmp(argv[1], "median", 6) == 0)
+    {
+        config.type          = JCFW_FILTER_TYPE_MEDIAN;
+        config.median.length = strtoul(argv[2], NULL, 10);
+    }
+    else if (argc == 3 && strncmp(argv[1], "hyst", 4) == 0)
+    {
+        config.type                 = JCFW_FILTER_TYPE_HYSTERESIS;
+        config.hysteresis.threshold = strtoul(argv[2], NULL, 10);
+    }
+    else if (argc == 4 && strncmp(argv[1], "kalman", 6) == 0)
+    {
+        config.type                           = JCFW_FILTER_TYPE_KALMAN;
+        config.kalman.process_variance_q8     = strtoul(argv[2], NULL, 10) << 8;
+        config.kalman.measurement_variance_q8 = strtoul(argv[3], NULL, 10) << 8;
+    }
+    else
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    if (!acquisition_set_filter(&config))
+    {
+        jcfw_cli_printf(cli, "error: Invalid filter settings\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int agg(jcfw_cli_t *cli, int argc, char **argv)
+{
+    jcfw_cli_printf(cli, "usage: agg <status|window|raw>\n");
+    return EXIT_FAILURE;
+}
+
+static int agg_status(jcfw_cli_t *cli, int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        jcfw_cli_printf(cli, "usage: agg status\n");
+        return EXIT_FAILURE;
+    }
+
+    uint32_t window_ms = 0;
+    uint32_t hop_ms    = 0;
+    aggregation_get_window(&window_ms, &hop_ms);
+
+    jcfw_cli_printf(
+        cli,
+        "window %lu ms, hop %lu ms (%s), raw readings %s\n",
+        (unsigned long)window_ms,
+        (unsigned long)hop_ms,
+        (window_ms == hop_ms) ? "tumbling" : "sliding",
+        aggregation_is_raw_enabled() ? "on" : "off");
+
+    jcfw_aggregate_report_t report;
+    if (!aggregation_get_last_report(&report))
+    {
+        jcfw_cli_printf(cli, "no window has closed yet\n");
+        return EXIT_SUCCESS;
+    }
+
+    jcfw_cli_printf(
+        cli,
+        "last window: %lu readings, min %f, max %f, mean %f, last %f\n",
+        (unsigned long)report.count,
+        report.min,
+        report.max,
+        report.mean,
+        report.last);
+    jcfw_cli_printf(
+        cli, "             p50 %f, p90 %f, p99 %f\n", report.p50, report.p90, report.p99);
+
+    return EXIT_SUCCESS;
+}
+
+static int agg_window(jcfw_cli_t *cli, int argc, char **argv)
+{
+    if (argc != 2 && argc != 3)
+    {
+        jcfw_cli_printf(cli, "usage: agg window <window_ms> [hop_ms]\n");
+        return EXIT_FAILURE;
+    }
+
+    const uint32_t window_ms = strtoul(argv[1], NULL, 10);
+    const uint32_t hop_ms    = (argc == 3) ? strtoul(argv[2], NULL, 10) : window_ms;
+
+    if (!aggregation_set_window(window_ms, hop_ms))
+    {
+        jcfw_cli_printf(
+            cli,
+            "error: The window must be a non-zero multiple of the hop, and at most %u hops long\n",
+            (unsigned)JCFW_AGGREGATE_PANE_COUNT_MAX);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int agg_raw(jcfw_cli_t *cli, int argc, char **argv)
+{
+    const char *USAGE_MESSAGE = "usage: agg raw <on|off>\n";
+
+    if (argc != 2)
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    if (strncmp(argv[1], "on", 2) == 0)
+    {
+        aggregation_set_raw_enabled(true);
+    }
+    else if (strncmp(argv[1], "off", 3) == 0)
+    {
+        aggregation_set_raw_enabled(false);
+    }
+    else
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
 static int als(jcfw_cli_t *cli, int argc, char **argv)
 {
     const char *USAGE_MESSAGE        = "usage: als <on|off>\n";
@@ -116,6 +448,154 @@ static int als(jcfw_cli_t *cli, int argc, char **argv)
     return EXIT_SUCCESS;
 }
 
+static int i2c(jcfw_cli_t *cli, int argc, char **argv)
+{
+    const char *USAGE_MESSAGE = "usage: i2c <stats|reset>\n";
+
+    if (argc != 2)
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    if (strncmp(argv[1], "stats", 5) == 0)
+    {
+        jcfw_i2c_device_stats_t stats;
+        jcfw_result_e           err = jcfw_platform_i2c_device_get_stats(&g_als_i2c_device, &stats);
+        if (err != JCFW_RESULT_OK)
+        {
+            jcfw_cli_printf(cli, "error: Unable to get the I2C statistics\n");
+            return EXIT_FAILURE;
+        }
+
+        jcfw_cli_printf(
+            cli,
+            "%-6s %12s %8s %8s %12s %12s\n",
+            "DEVICE",
+            "TRANSACTIONS",
+            "MERGED",
+            "FAILURES",
+            "BYTES",
+            "BUSY (us)");
+        jcfw_cli_printf(
+            cli,
+            "%-6s %12lu %8lu %8lu %12llu %12llu\n",
+            "als",
+            (unsigned long)stats.transaction_count,
+            (unsigned long)stats.merged_count,
+            (unsigned long)stats.failure_count,
+            (unsigned long long)stats.byte_count,
+            (unsigned long long)stats.busy_us);
+    }
+    else if (strncmp(argv[1], "reset", 5) == 0)
+    {
+        jcfw_result_e err = jcfw_platform_i2c_device_reset_stats(&g_als_i2c_device);
+        if (err != JCFW_RESULT_OK)
+        {
+            jcfw_cli_printf(cli, "error: Unable to reset the I2C statistics\n");
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        jcfw_cli_printf(cli, USAGE_MESSAGE);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int pipeline(jcfw_cli_t *cli, int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        jcfw_cli_printf(cli, "usage: pipeline\n");
+        return EXIT_FAILURE;
+    }
+
+    jcfw_cli_printf(
+        cli,
+        "%-8s %10s %8s %6s %6s %6s %10s %10s %12s\n",
+        "STAGE",
+        "SAMPLES",
+        "RATE/s",
+        "DROPS",
+        "DEPTH",
+        "HIGH",
+        "WAIT (us)",
+        "MAX (us)",
+        "BUSY (us)");
+
+    const uint64_t now_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < s_stage_count; i++)
+    {
+        cli_stage_t *entry = &s_stages[i];
+
+        jcfw_pipeline_stage_stats_t stats;
+        jcfw_pipeline_stage_get_stats(entry->stage, &stats);
+
+        // NOTE(Caleb): Sources take no blocks, so count what they emit instead.
+        const uint32_t sample_count = stats.block_count ? stats.sample_count : stats.emit_count;
+        const uint64_t elapsed_us   = now_us - entry->last_us;
+        const uint32_t rate =
+            elapsed_us ? (uint64_t)(sample_count - entry->last_sample_count) * 1000000 / elapsed_us
+                       : 0;
+        const uint32_t wait_avg_us =
+            stats.block_count ? stats.queue_latency_total_us / stats.block_count : 0;
+
+        jcfw_cli_printf(
+            cli,
+            "%-8s %10lu %8lu %6lu %6lu %6lu %10lu %10lu %12llu\n",
+            jcfw_pipeline_stage_get_name(entry->stage),
+            (unsigned long)sample_count,
+            (unsigned long)rate,
+            (unsigned long)(stats.drop_count + stats.emit_drop_count),
+            (unsigned long)stats.queue_depth,
+            (unsigned long)stats.queue_high_water,
+            (unsigned long)wait_avg_us,
+            (unsigned long)stats.queue_latency_max_us,
+            (unsigned long long)stats.busy_us);
+
+        entry->last_sample_count = sample_count;
+        entry->last_us           = now_us;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int time_status(jcfw_cli_t *cli, int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        jcfw_cli_printf(cli, "usage: time\n");
+        return EXIT_FAILURE;
+    }
+
+    const uint64_t local_us = jcfw_platform_get_time_us();
+    jcfw_cli_printf(cli, "Local time:  %llu us\n", (unsigned long long)local_us);
+
+    jcfw_timesync_model_t model;
+    if (!jcfw_time_get_model(&model))
+    {
+        jcfw_cli_printf(cli, "Not synchronized; Samples are stamped with the local time\n");
+        return EXIT_SUCCESS;
+    }
+
+    jcfw_cli_printf(
+        cli,
+        "Server time: %llu us\n",
+        (unsigned long long)jcfw_timesync_model_apply(&model, local_us));
+    jcfw_cli_printf(
+        cli,
+        "Offset:      %lld us (+/- %lu us, %llu ms ago)\n",
+        (long long)model.offset_us,
+        (unsigned long)model.error_us,
+        (unsigned long long)((local_us - model.local_us) / 1000));
+    jcfw_cli_printf(cli, "Drift:       %ld ppb\n", (long)model.drift_ppb);
+
+    return EXIT_SUCCESS;
+}
+
 static int wifi(jcfw_cli_t *cli, int argc, char **argv)
 {
     const char *USAGE_MESSAGE        = "usage: wifi <on|off>\n";
@@ -138,7 +618,7 @@ static int wifi(jcfw_cli_t *cli, int argc, char **argv)
             return EXIT_SUCCESS;
         }
 
-        err = jcfw_wifi_init();
+        err = jcfw_wifi_init(CLI_WIFI_INIT_TIMEOUT_MS);
         if (err != JCFW_RESULT_OK)
         {
             jcfw_cli_printf(cli, ERROR_MESSAGE_FORMAT, "enable");
@@ -177,11 +657,56 @@ static int wifi_status(jcfw_cli_t *cli, int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    static const char *S_STATE_STRINGS[] = {
+        [JCFW_WIFI_STA_STATE_IDLE]       = "STA IDLE",
+        [JCFW_WIFI_STA_STATE_CONNECTING] = "STA CONNECTING",
+        [JCFW_WIFI_STA_STATE_CONNECTED]  = "STA CONNECTED",
+        [JCFW_WIFI_STA_STATE_BACKOFF]    = "STA WAITING TO RETRY",
+        [JCFW_WIFI_STA_STATE_FAILED]     = "STA FAILED",
+    };
+
     const char *init_status = (jcfw_wifi_is_initialized()) ? "INITIALIZED" : "NOT INITIALIZED";
-    const char *sta_conn_status =
-        (jcfw_wifi_sta_is_connected()) ? "STA CONNECTED" : "STA NOT CONNECTED";
+    const char *sta_status  = S_STATE_STRINGS[jcfw_wifi_sta_get_state()];
+
+    jcfw_cli_printf(cli, "%s, %s\n", init_status, sta_status);
+
+    jcfw_wifi_sta_stats_t stats;
+    jcfw_wifi_sta_get_stats(&stats);
+
+    jcfw_cli_printf(
+        cli,
+        "Connects: %lu (%lu to the last AP, %lu fallbacks, %lu lease reuses)\n",
+        (unsigned long)stats.connect_count,
+        (unsigned long)stats.fast_connect_count,
+        (unsigned long)stats.fallback_count,
+        (unsigned long)stats.lease_reuse_count);
+    jcfw_cli_printf(
+        cli,
+        "Failed attempts: %lu, lost connections: %lu\n",
+        (unsigned long)stats.failure_count,
+        (unsigned long)stats.drop_count);
+    jcfw_cli_printf(
+        cli,
+        "Connect time to the last AP: p50 %.0f ms, p90 %.0f ms\n",
+        jcfw_sketch_quantile(&stats.fast_connect_ms, 0.50f),
+        jcfw_sketch_quantile(&stats.fast_connect_ms, 0.90f));
+    jcfw_cli_printf(
+        cli,
+        "Connect time with a scan:    p50 %.0f ms, p90 %.0f ms\n",
+        jcfw_sketch_quantile(&stats.full_connect_ms, 0.50f),
+        jcfw_sketch_quantile(&stats.full_connect_ms, 0.90f));
+    jcfw_cli_printf(
+        cli,
+        "Roams: %lu (and %lu failed, %lu scans)\n",
+        (unsigned long)stats.roam_count,
+        (unsigned long)stats.roam_failure_count,
+        (unsigned long)stats.roam_scan_count);
+    jcfw_cli_printf(
+        cli,
+        "Roam time:                   p50 %.0f ms, p90 %.0f ms\n",
+        jcfw_sketch_quantile(&stats.roam_ms, 0.50f),
+        jcfw_sketch_quantile(&stats.roam_ms, 0.90f));
 
-    jcfw_cli_printf(cli, "%s, %s\n", init_status, sta_conn_status);
     return EXIT_SUCCESS;
 }
 
@@ -210,7 +735,13 @@ static int wifi_connect(jcfw_cli_t *cli, int argc, char **argv)
         jcfw_cli_printf(cli, "and no password\n");
     }
 
-    jcfw_result_e err = jcfw_wifi_sta_connect(argv[1], (argc == 3) ? argv[2] : NULL);
+    jcfw_result_e err = jcfw_wifi_sta_connect(
+        argv[1], (argc == 3) ? argv[2] : NULL, CLI_WIFI_CONNECT_TIMEOUT_MS);
+    if (err == JCFW_RESULT_TIMEOUT)
+    {
+        jcfw_cli_printf(cli, "Not connected yet; Still trying in the background\n");
+    }
+
     return (err == JCFW_RESULT_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -228,7 +759,7 @@ static int wifi_disconnect(jcfw_cli_t *cli, int argc, char **argv)
         return EXIT_FAILURE;
     }
 
-    jcfw_result_e err = jcfw_wifi_sta_disconnect();
+    jcfw_result_e err = jcfw_wifi_sta_disconnect(CLI_WIFI_DISCONNECT_TIMEOUT_MS);
     return (err == JCFW_RESULT_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -259,9 +790,38 @@ static int wifi_scan(jcfw_cli_t *cli, int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    wifi_print_aps(cli, aps, num_aps);
+    return EXIT_SUCCESS;
+}
+
+static int wifi_aps(jcfw_cli_t *cli, int argc, char **argv)
+{
+    if (argc != 1)
+    {
+        jcfw_cli_printf(cli, "usage: wifi aps\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t                      num_aps = JCFW_WIFI_STA_SCAN_SIZE_MAX;
+    jcfw_wifi_sta_scan_result_t aps[num_aps];
+
+    // NOTE(Caleb): Shows what earlier scans found, without waiting for a new one.
+    jcfw_result_e err = jcfw_wifi_sta_get_scan_cache(aps, &num_aps);
+    if (err != JCFW_RESULT_OK)
+    {
+        jcfw_cli_printf(cli, "error: Unable to read the scan cache, %d\n", err);
+        return EXIT_FAILURE;
+    }
+
+    wifi_print_aps(cli, aps, num_aps);
+    return EXIT_SUCCESS;
+}
+
+static void wifi_print_aps(jcfw_cli_t *cli, const jcfw_wifi_sta_scan_result_t *aps, size_t num_aps)
+{
     // TODO(Caleb): JCFW tabluated print function
 
-    size_t max_ssid_len = 0;
+    size_t max_ssid_len = strlen("SSID");
     for (size_t i = 0; i < num_aps; i++)
     {
         max_ssid_len = JCFW_MAX(max_ssid_len, strlen((char *)aps[i].ssid));
@@ -269,19 +829,32 @@ static int wifi_scan(jcfw_cli_t *cli, int argc, char **argv)
 
     jcfw_cli_printf(
         cli,
-        "%-*s %-4s %-15s\n",
+        "%-*s %-17s %-4s %-7s %s\n",
         max_ssid_len,
         "SSID",
+        "BSSID",
         "RSSI (dBm)",
-        "CHANNEL");
+        "CHANNEL",
+        "AGE (s)");
 
+    const uint64_t now_us = jcfw_platform_get_time_us();
     for (size_t i = 0; i < num_aps; i++)
     {
         jcfw_cli_printf(
-            cli, "%-*.33s %10d %7d\n", max_ssid_len, aps[i].ssid, aps[i].rssi_dBm, aps[i].channel);
+            cli,
+            "%-*.33s %02X:%02X:%02X:%02X:%02X:%02X %10d %7d %7lu\n",
+            max_ssid_len,
+            aps[i].ssid,
+            aps[i].bssid[0],
+            aps[i].bssid[1],
+            aps[i].bssid[2],
+            aps[i].bssid[3],
+            aps[i].bssid[4],
+            aps[i].bssid[5],
+            aps[i].rssi_dBm,
+            aps[i].channel,
+            (unsigned long)((now_us - aps[i].seen_us) / (1000 * 1000)));
     }
-
-    return EXIT_SUCCESS;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -294,6 +867,19 @@ bool cli_init(void)
     return true;
 }
 
+bool cli_add_stage(jcfw_pipeline_stage_t *stage)
+{
+    JCFW_RETURN_IF_FALSE(stage && s_stage_count < JCFW_ARRAYSIZE(s_stages), false);
+
+    s_stages[s_stage_count++] = (cli_stage_t) {
+        .stage             = stage,
+        .last_sample_count = 0,
+        .last_us           = jcfw_platform_get_time_us(),
+    };
+
+    return true;
+}
+
 void cli_run(void *arg)
 {
     jcfw_cli_print_prompt(&s_cli);
@@ -341,30 +927,6 @@ void cli_run(void *arg)
             jcfw_cli_print_prompt(&s_cli);
         }
 
-        // if (g_is_als_data_ready)
-        // {
-        //     uint16_t      ch0         = 0x0000;
-        //     uint16_t      ch1         = 0x0000;
-        //     uint8_t       gain_factor = 0;
-        //     jcfw_result_e err         = jcfw_ltr303_read(&g_ltr303, &ch0, &ch1, &gain_factor);
-        //     if (err != JCFW_RESULT_OK)
-        //     {
-        //         jcfw_cli_printf(&s_cli, "error: Unable to read ALS data\n");
-        //     }
-        //     else if (gain_factor == 0)
-        //     {
-        //         jcfw_cli_printf(&s_cli, "error: Invalid gain read\n");
-        //     }
-        //     else
-        //     {
-        //         float visible_light = JCFW_CLAMP((float)(ch0 - ch1), 0, 64000) / gain_factor;
-
-        //         jcfw_cli_printf(&s_cli, "ALS DATA: %f lux\n", visible_light);
-        //     }
-
-        //     g_is_als_data_ready = false;
-        // }
-
         vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
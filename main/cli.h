@@ -3,7 +3,17 @@
 
 #include <stdbool.h>
 
+#include "jcfw/pipeline/pipeline.h"
+
+/// @brief The maximum number of pipeline stages which the `pipeline` command reports on.
+#define CLI_STAGE_COUNT_MAX 4
+
 bool cli_init(void);
 void cli_run(void *arg);
 
+/// @brief Add a pipeline stage to the report of the `pipeline` command.
+/// @param stage The stage to add.
+/// @return True if the stage was added, and false if there is no room for it.
+bool cli_add_stage(jcfw_pipeline_stage_t *stage);
+
 #endif // __CLI_H__
@@ -1,29 +1,188 @@
-#include "driver/uart.h"
-
-// TODO(Caleb): Move these to net lib
-#include "lwip/netdb.h"
-#include "lwip/sockets.h"
-#include "lwip/sys.h"
+#include <stdatomic.h>
 
+#include "driver/uart.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+
+#include "jcfw/net/endpoint.h"
+#include "jcfw/net/rdp.h"
+#include "jcfw/net/resolver.h"
+#include "jcfw/net/socket.h"
+#include "jcfw/net/timesync.h"
+#include "jcfw/pipeline/pipeline.h"
+#include "jcfw/platform/platform.h"
 #include "jcfw/platform/wifi.h"
+#include "jcfw/telemetry/batcher.h"
+#include "jcfw/telemetry/spool.h"
+#include "jcfw/time.h"
 #include "jcfw/trace.h"
 #include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
 #include "jcfw/util/math.h"
+#include "jcfw/util/spsc.h"
 
+#include "acquisition.h"
+#include "aggregation.h"
 #include "cli.h"
 #include "platform.h"
 #include "util.h"
 
-#define TRACE_TAG "MAIN"
+#define TRACE_TAG                     "MAIN"
+
+/// @brief Holds datagrams which the stack can't take yet (see: jcfw/net/socket.h). The reliable
+/// window keeps every frame until it is acknowledged anyway, so this only has to ride out a burst.
+#define TELEMETRY_SEND_BUFFER_SIZE    (2 * JCFW_RDP_DATAGRAM_SIZE_MAX)
+
+/// @brief Raw ALS readings: channel 0 (u16), channel 1 (u16) and the gain factor (u8). Lux is
+/// computed by the receiver. Consecutive readings are close, so these frames are delta encoded.
+///
+/// Each reading also carries how long after its INT edge it was read (u16, in us, saturating) and
+/// encoded into its frame (u32, in us). Together with the send time of the datagram (see:
+/// jcfw/net/rdp.h), this lets the collector break the latency of every reading down by stage.
+#define TELEMETRY_STREAM_ALS_RAW      0
+#define TELEMETRY_RAW_RECORD_SIZE     11
+
+/// @brief ALS window summaries: the window length in ms (u32), the reading count (u32), then the
+/// min, max, mean, last, p50, p90 and p99 in lux (f32 each). Each summary is timestamped with the
+/// end of its window.
+#define TELEMETRY_STREAM_ALS_SUMMARY  1
+#define TELEMETRY_SUMMARY_RECORD_SIZE 36
+
+#define TELEMETRY_RECORD_COUNT_MAX    64
+#define TELEMETRY_AGE_MAX_US          (1000 * 1000)
+
+#define TELEMETRY_TASK_PRIORITY       (tskIDLE_PRIORITY + 1)
+#define TELEMETRY_TASK_STACK_SIZE     4096
+
+/// @brief How long the network stage sleeps without a sample or an ACK, in ms, while frames are
+/// in flight or spooled. This bounds how late a retransmit or a spool probe can be.
+#define TELEMETRY_TICK_BUSY_MS        50
+
+/// @brief How long the network stage sleeps without a sample or an ACK, in ms, while there is
+/// nothing to resend. This bounds how late a batch or an aggregation window is flushed.
+#define TELEMETRY_TICK_IDLE_MS        1000
+
+/// @brief The number of received datagrams (ACKs and clock probe responses) which can wait for
+/// the network stage. Must be a power of two.
+#define TELEMETRY_RX_QUEUE_CAPACITY   16
+
+/// @brief How often each collector is probed, in ms. The probes are clock probes (see:
+/// jcfw/time.h), and double as health checks (see: jcfw/net/endpoint.h).
+#define TELEMETRY_PROBE_PERIOD_MS     2000
+
+/// @brief How often the collectors are resolved again, in ms, while the STA is connected but none
+/// of them could be set up.
+#define TELEMETRY_RESOLVE_PERIOD_MS   5000
+
+/// @brief The flash partition which holds frames while the collector can't be reached.
+#define TELEMETRY_SPOOL_PARTITION     "spool"
+
+/// @brief The number of slots of the reliable window which draining the spool leaves free, so
+/// that live frames always go out first.
+#define TELEMETRY_LIVE_SLOT_COUNT     2
+
+/// @brief How long after the last ACK the collector is still considered reachable.
+#define TELEMETRY_UPLINK_TIMEOUT_US   (3 * 1000 * 1000)
 
 typedef struct
 {
-    struct sockaddr_storage data;
-    socklen_t               len;
-} ip_address_t;
+    const char *host;
+    uint16_t    port;
 
-int create_socket(
-    const char *addr, const char *port, ip_address_t *o_remote_addr, uint32_t timeout_sec);
+    /// @brief The share of devices which the collector is the primary of (see:
+    /// jcfw/net/endpoint.h).
+    uint32_t weight;
+} telemetry_collector_config_t;
+
+/// @brief The connection to one collector.
+typedef struct
+{
+    jcfw_net_socket_t socket;
+    uint8_t           send_buffer[TELEMETRY_SEND_BUFFER_SIZE];
+
+    /// @brief Each collector keeps its own clock, so each has its own model of it.
+    jcfw_timesync_t timesync;
+} telemetry_collector_t;
+
+typedef struct
+{
+    /// @brief The local time at which the datagram arrived.
+    uint64_t receive_us;
+
+    /// @brief The collector which sent the datagram.
+    uint8_t collector;
+    uint8_t length;
+    uint8_t data[JCFW_TIMESYNC_RESPONSE_SIZE];
+} telemetry_datagram_t;
+
+static void          on_wifi_initialized(jcfw_result_e result, void *arg);
+static void on_sta_state(jcfw_wifi_sta_state_e from, jcfw_wifi_sta_state_e to, void *arg);
+static bool          open_collectors(void);
+static bool          has_collectors(void);
+static void          send_telemetry_frame(const uint8_t *frame, size_t length, void *arg);
+static jcfw_result_e send_datagram(const uint8_t *datagram, size_t length, void *arg);
+static jcfw_result_e send_to_collector(uint32_t index, const uint8_t *data, size_t length);
+static uint64_t      stamp_datagram(uint64_t now_us, void *arg);
+static void          on_datagram_timeout(uint64_t sent_us, void *arg);
+static void telemetry_process(
+    jcfw_pipeline_stage_t *stage, jcfw_pipeline_block_t *block, void *arg);
+static uint32_t      telemetry_poll(jcfw_pipeline_stage_t *stage, uint64_t now_us, void *arg);
+static void          telemetry_add_sample(const acquisition_sample_t *sample);
+static void          telemetry_rx_task(void *arg);
+static void          receive_datagram(
+    jcfw_net_socket_t *sock, const uint8_t *data, size_t length, uint64_t receive_us, void *arg);
+static void          handle_datagrams(void);
+static void          probe_collector(uint32_t index, void *arg);
+static void          change_collector(uint32_t from, uint32_t to, void *arg);
+static void          spool_frame(const uint8_t *frame, size_t length, void *arg);
+static void          drain_spool(uint64_t now_us);
+static void send_als_summary(const jcfw_aggregate_report_t *report, void *arg);
+
+// NOTE(Caleb): All multi-byte telemetry fields are little endian, like the frame header.
+static inline void put_f32(uint8_t *dest, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    JCFW_ITOB32_LE(dest, bits);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static const jcfw_telemetry_codec_layout_t S_RAW_RECORD_LAYOUT = {
+    .field_count = 5,
+    .field_sizes = {2, 2, 1, 2, 4},
+};
+
+// NOTE(Caleb): Every collector can take any device; Each device picks its primary by itself, and
+// fails over to the next one in its ranking.
+static const telemetry_collector_config_t S_COLLECTORS[] = {
+    {.host = "***.***.***.***", .port = 5000, .weight = 1},
+    {.host = "***.***.***.***", .port = 5001, .weight = 1},
+};
+
+_Static_assert(
+    JCFW_ARRAYSIZE(S_COLLECTORS) <= JCFW_ENDPOINT_COUNT_MAX, "Too many telemetry collectors");
+
+static jcfw_telemetry_batcher_t s_raw_batcher;
+static jcfw_telemetry_batcher_t s_summary_batcher;
+static jcfw_rdp_sender_t        s_rdp;
+static jcfw_telemetry_spool_t   s_spool;
+static bool                     s_has_spool   = false;
+static uint64_t                 s_last_ack_us = 0;
+static bool                     s_has_ack     = false;
+static uint8_t                  s_spooled_frame[JCFW_TELEMETRY_FRAME_SIZE_MAX];
+static jcfw_net_loop_t          s_net_loop;
+static telemetry_collector_t    s_collectors[JCFW_ARRAYSIZE(S_COLLECTORS)];
+static jcfw_endpoint_config_t   s_collector_endpoints[JCFW_ARRAYSIZE(S_COLLECTORS)];
+static uint32_t                 s_collector_count = 0;
+static jcfw_endpoint_set_t      s_collector_set;
+static uint32_t                 s_device_id       = 0;
+static atomic_bool              s_has_collectors;
+static uint64_t                 s_active_since_us = 0;
+static jcfw_pipeline_stage_t    s_telemetry_stage;
+static telemetry_datagram_t     s_rx_queue_buffer[TELEMETRY_RX_QUEUE_CAPACITY];
+static jcfw_spsc_t              s_rx_queue;
+static uint64_t                 s_raw_last_time_us = 0;
 
 void app_main(void)
 {
@@ -39,13 +198,16 @@ void app_main(void)
     JCFW_TRACELN_DEBUG("MAIN", "Here's a debug message!");
     JCFW_TRACELN_NOTIFICATION("MAIN", "Here's a notification message!");
 
-    err = jcfw_wifi_init();
-    JCFW_ASSERT(err == JCFW_RESULT_OK, "Unable to initialize WIFI");
-    JCFW_TRACELN_INFO(TRACE_TAG, "WIFI has been initialized");
+    // NOTE(Caleb): The rest of the system comes up while WIFI does (see: on_wifi_initialized()).
+    err = jcfw_wifi_init_start(on_wifi_initialized, NULL);
+    JCFW_ASSERT(err == JCFW_RESULT_IN_PROGRESS, "Unable to start initializing WIFI");
 
-    err = jcfw_wifi_sta_connect("**********", "**********");
-    JCFW_ASSERT(err == JCFW_RESULT_OK, "Unable to connect to the network");
-    JCFW_TRACELN_INFO(TRACE_TAG, "WIFI has been connected");
+    err         = jcfw_telemetry_spool_open(&s_spool, TELEMETRY_SPOOL_PARTITION);
+    s_has_spool = (err == JCFW_RESULT_OK);
+    if (!s_has_spool)
+    {
+        JCFW_TRACELN_WARN(TRACE_TAG, "Unable to open the telemetry spool; Frames may be lost");
+    }
 
     JCFW_ASSERT(cli_init(), "error: Unable to initialize the CLI task");
     JCFW_ASSERT(
@@ -54,103 +216,553 @@ void app_main(void)
 
     // -------------------------------------------------------------------------
 
-    ip_address_t server_addr = {0};
-    const char  *MSG_FORMAT  = "{\"als\": %f}";
+    // NOTE(Caleb): The collectors can't be resolved until the STA has an address, so the receive
+    // task sets them up once it is connected (see: open_collectors()). Until then, frames are
+    // spooled.
+    err = jcfw_net_loop_init(&s_net_loop);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up the network loop");
+
+    atomic_init(&s_has_collectors, false);
+    err = jcfw_wifi_sta_subscribe(on_sta_state, NULL);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to watch the WIFI connection");
+
+    err = jcfw_spsc_init(
+        &s_rx_queue,
+        s_rx_queue_buffer,
+        sizeof(s_rx_queue_buffer[0]),
+        JCFW_ARRAYSIZE(s_rx_queue_buffer));
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up the receive queue");
+
+    // NOTE(Caleb): The NIC-specific half of the MAC is unique enough to tell our nodes apart.
+    uint8_t mac[6] = {0};
+    esp_efuse_mac_get_default(mac);
+    s_device_id = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8)
+                | mac[5];
+
+    // NOTE(Caleb): Frames go out over the reliable datagram protocol, so that the collector
+    // acknowledges them and lost ones are resent. A random session lets the collector tell a
+    // reboot apart from a stream of late duplicates. A retransmit timeout is what fails a quiet
+    // collector over; The retransmit then goes to the next one.
+    jcfw_rdp_sender_config_t rdp_config = {
+        .session        = esp_random(),
+        .send_cb        = send_datagram,
+        .send_cb_arg    = NULL,
+        .drop_cb        = spool_frame,
+        .drop_cb_arg    = NULL,
+        .stamp_cb       = stamp_datagram,
+        .stamp_cb_arg   = NULL,
+        .timeout_cb     = on_datagram_timeout,
+        .timeout_cb_arg = NULL,
+    };
+    err = jcfw_rdp_sender_init(&s_rdp, &rdp_config);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up reliable telemetry");
+
+    // NOTE(Caleb): Batch samples rather than sending one datagram each; a frame goes out when it
+    // is full, holds TELEMETRY_RECORD_COUNT_MAX samples, or its oldest sample is a second old.
+    jcfw_telemetry_batcher_config_t batcher_config = {
+        .device_id        = s_device_id,
+        .stream           = TELEMETRY_STREAM_ALS_RAW,
+        .record_size      = TELEMETRY_RAW_RECORD_SIZE,
+        .layout           = &S_RAW_RECORD_LAYOUT,
+        .frame_size_max   = JCFW_TELEMETRY_FRAME_SIZE_MAX,
+        .record_count_max = TELEMETRY_RECORD_COUNT_MAX,
+        .age_max_us       = TELEMETRY_AGE_MAX_US,
+        .flush_cb         = send_telemetry_frame,
+        .flush_cb_arg     = NULL,
+    };
+    err = jcfw_telemetry_batcher_init(&s_raw_batcher, &batcher_config);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up telemetry batching");
+
+    // NOTE(Caleb): Summaries are already rate limited by the aggregation hop, so each one is sent
+    // as soon as its window closes.
+    batcher_config.stream           = TELEMETRY_STREAM_ALS_SUMMARY;
+    batcher_config.record_size      = TELEMETRY_SUMMARY_RECORD_SIZE;
+    batcher_config.layout           = NULL;
+    batcher_config.record_count_max = 1;
+    err = jcfw_telemetry_batcher_init(&s_summary_batcher, &batcher_config);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up telemetry batching");
 
-    int sock = create_socket("***.***.***.***", "5000", &server_addr, 3);
-    JCFW_ASSERT(sock >= 0, "Unable to create the client socket");
+    JCFW_ASSERT(
+        aggregation_init(send_als_summary, NULL), "error: Unable to set up ALS aggregation");
 
     err = jcfw_ltr303_set_mode(&g_ltr303, JCFW_LTR303_MODE_ACTIVE);
-    JCFW_ASSERT(sock >= 0, "error: Unable to start the LTR303");
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to start the LTR303");
+
+    // NOTE(Caleb): Samples flow from the acquisition stage (a source on its own high priority
+    // task) into the network stage, which owns the batchers, the reliable sender and the spool.
+    // Another sensor or output is another stage feeding this one, keyed by the block stream.
+    jcfw_pipeline_stage_config_t stage_config = {
+        .task =
+            {
+                .name       = "APP-NET",
+                .stack_size = TELEMETRY_TASK_STACK_SIZE,
+                .priority   = TELEMETRY_TASK_PRIORITY,
+                .core       = JCFW_TASK_CORE_ANY,
+            },
+        .process_cb = telemetry_process,
+        .poll_cb    = telemetry_poll,
+        .cb_arg     = NULL,
+        .next       = NULL,
+    };
+    err = jcfw_pipeline_stage_init(&s_telemetry_stage, &stage_config);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up the network stage");
+
+    JCFW_ASSERT(
+        acquisition_init(&s_telemetry_stage), "error: Unable to start the acquisition stage");
+
+    err = jcfw_pipeline_stage_start(&s_telemetry_stage);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to start the network stage");
+
+    JCFW_ASSERT(
+        xTaskCreate(telemetry_rx_task, "APP-RX", 3072, NULL, tskIDLE_PRIORITY + 2, NULL),
+        "error: Unable to start the telemetry receive task");
+
+    cli_add_stage(acquisition_get_stage());
+    cli_add_stage(&s_telemetry_stage);
+}
+
+static void on_wifi_initialized(jcfw_result_e result, void *arg)
+{
+    JCFW_TRACELN_INFO(TRACE_TAG, "WIFI has been initialized");
+
+    // NOTE(Caleb): Telemetry is spooled to flash until the collector can be reached, so there's
+    // no need to wait for the network here; The WIFI manager connects (and reconnects) on its own.
+    jcfw_result_e err = jcfw_wifi_sta_connect_start("**********", "**********", NULL, NULL);
+    if (err != JCFW_RESULT_IN_PROGRESS)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to start connecting to the network");
+    }
+}
+
+static void on_sta_state(jcfw_wifi_sta_state_e from, jcfw_wifi_sta_state_e to, void *arg)
+{
+    if (to == JCFW_WIFI_STA_STATE_CONNECTED && !has_collectors())
+    {
+        jcfw_net_loop_wake(&s_net_loop);
+    }
+}
+
+/// @brief Resolve the collectors, give each one a socket, and rank them. Runs on the receive task,
+/// which owns the sockets, until it succeeds; The network stage only uses the collectors after.
+/// @return Whether any collector could be set up.
+static bool open_collectors(void)
+{
+    jcfw_result_e err;
+
+    // NOTE(Caleb): Each collector gets a socket of its own. The sockets are connected, so the
+    // route to each collector is looked up once rather than for every datagram. A collector which
+    // can't be reached now is left out rather than fatal, as long as another one can be.
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(S_COLLECTORS); i++)
+    {
+        const telemetry_collector_config_t *config    = &S_COLLECTORS[i];
+        telemetry_collector_t              *collector = &s_collectors[s_collector_count];
+        jcfw_endpoint_config_t             *endpoint  = &s_collector_endpoints[s_collector_count];
+
+        err = jcfw_net_resolve(config->host, config->port, &endpoint->address);
+        if (err != JCFW_RESULT_OK)
+        {
+            JCFW_TRACELN_WARN(
+                TRACE_TAG, "Unable to resolve collector %s; Skipping it", config->host);
+            continue;
+        }
+
+        jcfw_net_socket_config_t socket_config = {
+            .type             = JCFW_NET_SOCKET_TYPE_UDP,
+            .remote           = endpoint->address,
+            .send_buffer      = collector->send_buffer,
+            .send_buffer_size = sizeof(collector->send_buffer),
+            .receive_cb       = receive_datagram,
+            .state_cb         = NULL,
+            .writable_cb      = NULL,
+            .cb_arg           = (void *)(uintptr_t)s_collector_count,
+        };
+        err = jcfw_net_socket_open(&s_net_loop, &collector->socket, &socket_config);
+        if (err != JCFW_RESULT_OK)
+        {
+            JCFW_TRACELN_WARN(
+                TRACE_TAG, "Unable to create a socket for collector %s; Skipping it", config->host);
+            continue;
+        }
+
+        // NOTE(Caleb): Samples are stamped on the active collector's clock (see: jcfw/time.h), so
+        // that the time it takes them to get there doesn't end up in the data.
+        jcfw_timesync_init(&collector->timesync);
+        endpoint->weight = config->weight;
+        s_collector_count++;
+    }
+    JCFW_ERROR_IF_FALSE(s_collector_count > 0, false, "Unable to set up any telemetry collector");
+
+    // NOTE(Caleb): The device id spreads the devices over the collectors, and keeps each device on
+    // the same primary across reboots.
+    jcfw_endpoint_set_config_t collector_set_config = {
+        .key             = s_device_id,
+        .endpoints       = s_collector_endpoints,
+        .endpoint_count  = s_collector_count,
+        .probe_period_ms = TELEMETRY_PROBE_PERIOD_MS,
+        .probe_cb        = probe_collector,
+        .change_cb       = change_collector,
+        .cb_arg          = NULL,
+    };
+    err = jcfw_endpoint_set_init(&s_collector_set, &collector_set_config);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up the telemetry collectors");
+
+    const uint32_t primary = jcfw_endpoint_set_get_active(&s_collector_set);
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "Sending telemetry to collector " JCFW_NET_ADDRESS_FORMAT,
+        JCFW_NET_ADDRESS_ARGS(&s_collector_endpoints[primary].address));
+
+    return true;
+}
+
+static bool has_collectors(void)
+{
+    return atomic_load_explicit(&s_has_collectors, memory_order_acquire);
+}
+
+static void send_telemetry_frame(const uint8_t *frame, size_t length, void *arg)
+{
+    jcfw_result_e err = jcfw_rdp_sender_send(&s_rdp, frame, length, jcfw_platform_get_time_us());
+    if (err == JCFW_RESULT_FULL)
+    {
+        spool_frame(frame, length, NULL);
+        return;
+    }
+
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, , "Unable to send a telemetry frame (rc %u)", err);
+    JCFW_TRACELN_INFO(TRACE_TAG, "Sent %u byte telemetry frame to server", (unsigned)length);
+}
+
+static jcfw_result_e send_datagram(const uint8_t *datagram, size_t length, void *arg)
+{
+    // NOTE(Caleb): A failed send isn't fatal; The datagram is still in flight, so it is resent
+    // once its retransmit timeout expires (to another collector, if this one has gone down).
+    JCFW_RETURN_IF_FALSE(has_collectors(), JCFW_RESULT_NOT_CONNECTED);
+
+    const uint32_t active = jcfw_endpoint_set_get_active(&s_collector_set);
+    JCFW_RETURN_IF_TRUE(active == JCFW_ENDPOINT_NONE, JCFW_RESULT_NOT_CONNECTED);
+
+    return send_to_collector(active, datagram, length);
+}
+
+static jcfw_result_e send_to_collector(uint32_t index, const uint8_t *data, size_t length)
+{
+    // NOTE(Caleb): A full send buffer is the same as a lost datagram.
+    jcfw_result_e err = jcfw_net_socket_send(&s_collectors[index].socket, data, length);
+    JCFW_ERROR_IF_FALSE(
+        err == JCFW_RESULT_OK || err == JCFW_RESULT_FULL,
+        err,
+        "Unable to send data to collector %lu (rc %u)",
+        (unsigned long)index,
+        err);
+
+    return err;
+}
+
+static uint64_t stamp_datagram(uint64_t now_us, void *arg)
+{
+    return jcfw_time_from_local_us(now_us);
+}
+
+static void on_datagram_timeout(uint64_t sent_us, void *arg)
+{
+    JCFW_RETURN_IF_FALSE(has_collectors());
 
+    // NOTE(Caleb): Datagrams sent before the active collector took over went to another one, so
+    // they say nothing about it.
+    JCFW_RETURN_IF_TRUE(sent_us < s_active_since_us);
+
+    const uint32_t active = jcfw_endpoint_set_get_active(&s_collector_set);
+    JCFW_RETURN_IF_TRUE(active == JCFW_ENDPOINT_NONE);
+
+    jcfw_endpoint_set_on_timeout(&s_collector_set, active, sent_us);
+}
+
+static void telemetry_process(
+    jcfw_pipeline_stage_t *stage, jcfw_pipeline_block_t *block, void *arg)
+{
+    if (block->stream == ACQUISITION_STREAM_ALS)
+    {
+        for (uint16_t i = 0; i < block->sample_count; i++)
+        {
+            telemetry_add_sample(jcfw_pipeline_block_get_sample(block, i));
+        }
+    }
+    else
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Dropping a block of unknown stream %u", block->stream);
+    }
+
+    jcfw_pipeline_block_release(block);
+}
+
+static uint32_t telemetry_poll(jcfw_pipeline_stage_t *stage, uint64_t now_us, void *arg)
+{
+    if (has_collectors())
+    {
+        handle_datagrams();
+        jcfw_endpoint_set_poll(&s_collector_set, jcfw_platform_get_time_us());
+    }
+
+    aggregation_poll(now_us);
+    jcfw_telemetry_batcher_poll(&s_raw_batcher, jcfw_time_now_us());
+
+    jcfw_rdp_sender_poll(&s_rdp, jcfw_platform_get_time_us());
+    drain_spool(jcfw_platform_get_time_us());
+
+    // NOTE(Caleb): Samples and ACKs wake the stage as they arrive; Otherwise it only has to wake
+    // for the timers (a retransmit, a batch age or an aggregation window) which may be due.
+    const bool is_busy =
+        jcfw_rdp_sender_get_in_flight(&s_rdp) > 0
+        || (s_has_spool && jcfw_telemetry_spool_get_pending_count(&s_spool) > 0);
+    return is_busy ? TELEMETRY_TICK_BUSY_MS : TELEMETRY_TICK_IDLE_MS;
+}
+
+static void telemetry_add_sample(const acquisition_sample_t *sample)
+{
+    if (sample->gain_factor == 0)
+    {
+        JCFW_TRACE_ERROR(TRACE_TAG, "error: Invalid gain read\n");
+        return;
+    }
+
+    const float lux =
+        JCFW_CLAMP((float)(sample->channel0 - sample->channel1), 0, 64000) / sample->gain_factor;
+    aggregation_add(sample->edge_us, lux);
+
+    JCFW_RETURN_IF_FALSE(aggregation_is_raw_enabled());
+
+    const uint64_t read_delay_us   = sample->read_us - sample->edge_us;
+    const uint64_t encode_delay_us = jcfw_platform_get_time_us() - sample->edge_us;
+
+    uint8_t record[TELEMETRY_RAW_RECORD_SIZE];
+    JCFW_ITOB16_LE(&record[0], sample->channel0);
+    JCFW_ITOB16_LE(&record[2], sample->channel1);
+    record[4] = sample->gain_factor;
+    JCFW_ITOB16_LE(&record[5], (uint16_t)JCFW_MIN(read_delay_us, UINT16_MAX));
+    JCFW_ITOB32_LE(&record[7], (uint32_t)JCFW_MIN(encode_delay_us, UINT32_MAX));
+
+    // NOTE(Caleb): A new clock model can move the time back a little, but records within a frame
+    // must stay in order.
+    const uint64_t time_us = JCFW_MAX(jcfw_time_from_local_us(sample->edge_us), s_raw_last_time_us);
+    s_raw_last_time_us     = time_us;
+
+    jcfw_result_e err = jcfw_telemetry_batcher_add(&s_raw_batcher, time_us, record);
+    if (err != JCFW_RESULT_OK)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to batch a sample (rc %u)", err);
+    }
+}
+
+static void telemetry_rx_task(void *arg)
+{
     while (1)
     {
-        if (g_is_als_data_ready)
+        // NOTE(Caleb): Until the collectors are set up, wake up to try again (and as soon as the
+        // STA connects, see: on_sta_state()).
+        uint32_t timeout_ms = JCFW_NET_WAIT_FOREVER;
+        if (!has_collectors())
         {
-            uint16_t      ch0         = 0x0000;
-            uint16_t      ch1         = 0x0000;
-            uint8_t       gain_factor = 0;
-            jcfw_result_e err         = jcfw_ltr303_read(&g_ltr303, &ch0, &ch1, &gain_factor);
-            if (err != JCFW_RESULT_OK)
+            if (jcfw_wifi_sta_get_state() == JCFW_WIFI_STA_STATE_CONNECTED && open_collectors())
             {
-                JCFW_TRACE_ERROR(TRACE_TAG, "error: Unable to read ALS data\n");
-            }
-            else if (gain_factor == 0)
-            {
-                JCFW_TRACE_ERROR(TRACE_TAG, "error: Invalid gain read\n");
+                atomic_store_explicit(&s_has_collectors, true, memory_order_release);
+                jcfw_pipeline_stage_notify(&s_telemetry_stage);
             }
             else
             {
-                float visible_light = JCFW_CLAMP((float)(ch0 - ch1), 0, 64000) / gain_factor;
-                JCFW_TRACE_DEBUG(TRACE_TAG, "ALS DATA: %f lux\n", visible_light);
-
-                char data[32] = {0};
-                snprintf(data, 32, MSG_FORMAT, visible_light);
-                uint8_t bytes_sent = sendto(
-                    sock,
-                    data,
-                    strnlen(data, 32),
-                    0,
-                    (struct sockaddr *)&server_addr.data,
-                    server_addr.len);
-                JCFW_ASSERT(bytes_sent > 0, "Unable to send data to the server");
-
-                JCFW_TRACELN_INFO(TRACE_TAG, "Sent packet to server");
+                timeout_ms = TELEMETRY_RESOLVE_PERIOD_MS;
             }
-
-            g_is_als_data_ready = false;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(10));
+        jcfw_result_e err = jcfw_net_loop_poll(&s_net_loop, timeout_ms);
+        if (err != JCFW_RESULT_OK)
+        {
+            JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to poll the network (rc %u)", err);
+            // TODO(Caleb): JCFW OS
+            vTaskDelay(pdMS_TO_TICKS(TELEMETRY_TICK_IDLE_MS));
+        }
     }
 }
 
-int create_socket(
-    const char *addr, const char *port, ip_address_t *o_remote_addr, uint32_t timeout_sec)
+static void receive_datagram(
+    jcfw_net_socket_t *sock, const uint8_t *data, size_t length, uint64_t receive_us, void *arg)
 {
-    JCFW_RETURN_IF_FALSE(addr && port && o_remote_addr, -1);
-
-    int             sock;
-    struct addrinfo hints, *servinfo, *p;
-    int             rv;
+    // NOTE(Caleb): Clock probes from the collector are answered straight from here, so that the
+    // time they wait doesn't depend on how busy the network stage is. They are answered on the
+    // clock which samples are stamped with.
+    if (length > 0 && data[0] == JCFW_TIMESYNC_TYPE_REQUEST)
+    {
+        uint8_t response[JCFW_TIMESYNC_RESPONSE_SIZE];
+        if (jcfw_timesync_respond(
+                data,
+                length,
+                jcfw_time_from_local_us(receive_us),
+                jcfw_time_now_us(),
+                response)
+            == JCFW_RESULT_OK)
+        {
+            jcfw_net_socket_send(sock, response, sizeof(response));
+        }
 
-    memset(&hints, 0, sizeof hints);
-    hints.ai_family   = AF_INET;
-    hints.ai_socktype = SOCK_DGRAM;
+        return;
+    }
 
-    rv = getaddrinfo(addr, port, &hints, &servinfo);
-    JCFW_ERROR_IF_FALSE(rv == 0, -1, "getaddrinfo failed; rv %d", rv);
+    // NOTE(Caleb): The RDP sender and the timesync client belong to the network stage, so ACKs and
+    // probe responses are handed over to it rather than handled here. If the stage falls behind,
+    // the queue counts the dropped datagrams; A later ACK covers the same datagrams, and a lost
+    // probe response is only a missing sample.
+    telemetry_datagram_t datagram;
+    JCFW_RETURN_IF_FALSE(length <= sizeof(datagram.data));
+
+    datagram.receive_us = receive_us;
+    datagram.collector  = (uint8_t)(uintptr_t)arg;
+    datagram.length     = (uint8_t)length;
+    memcpy(datagram.data, data, length);
+    if (jcfw_spsc_push(&s_rx_queue, &datagram) == JCFW_RESULT_OK)
+    {
+        jcfw_pipeline_stage_notify(&s_telemetry_stage);
+    }
+}
 
-    // Loop through all the results and make a socket
-    for (p = servinfo; p != NULL; p = p->ai_next)
+static void handle_datagrams(void)
+{
+    telemetry_datagram_t datagram;
+    while (jcfw_spsc_pop(&s_rx_queue, &datagram) == JCFW_RESULT_OK)
     {
-        if ((sock = socket(p->ai_family, p->ai_socktype, p->ai_protocol)) == -1)
+        telemetry_collector_t *collector = &s_collectors[datagram.collector];
+        const uint64_t         now_us    = jcfw_platform_get_time_us();
+
+        if (datagram.data[0] == JCFW_TIMESYNC_TYPE_RESPONSE)
         {
-            JCFW_TRACELN_ERROR(TRACE_TAG, "socket failed; errno %d\n", errno);
+            jcfw_result_e err = jcfw_timesync_on_receive(
+                &collector->timesync, datagram.data, datagram.length, datagram.receive_us);
+            if (err != JCFW_RESULT_OK)
+            {
+                continue;
+            }
+
+            // NOTE(Caleb): A collector which is down is heard from here first, so this may make
+            // it active again.
+            jcfw_endpoint_set_on_heard(&s_collector_set, datagram.collector, now_us);
+
+            jcfw_timesync_model_t model;
+            if (datagram.collector == jcfw_endpoint_set_get_active(&s_collector_set)
+                && jcfw_timesync_get_model(&collector->timesync, &model))
+            {
+                jcfw_time_set_model(&model);
+            }
+
             continue;
         }
 
-        break;
+        // NOTE(Caleb): A collector which was failed away from may still acknowledge what it got
+        // before it went quiet; Those ACKs retire the same datagrams.
+        if (jcfw_rdp_sender_on_receive(&s_rdp, datagram.data, datagram.length, now_us)
+            == JCFW_RESULT_OK)
+        {
+            s_last_ack_us = now_us;
+            s_has_ack     = true;
+            jcfw_endpoint_set_on_heard(&s_collector_set, datagram.collector, now_us);
+        }
+    }
+}
+
+static void probe_collector(uint32_t index, void *arg)
+{
+    // NOTE(Caleb): Stamp the request as late as possible; Time spent before it is sent would count
+    // towards the outbound leg of the trip.
+    uint8_t request[JCFW_TIMESYNC_REQUEST_SIZE];
+    jcfw_timesync_make_request(&s_collectors[index].timesync, jcfw_platform_get_time_us(), request);
+    send_to_collector(index, request, sizeof(request));
+}
+
+static void change_collector(uint32_t from, uint32_t to, void *arg)
+{
+    s_active_since_us = jcfw_platform_get_time_us();
+
+    if (to == JCFW_ENDPOINT_NONE)
+    {
+        JCFW_TRACELN_WARN(TRACE_TAG, "No collector is reachable; Spooling telemetry");
+        return;
     }
 
-    JCFW_ERROR_IF_FALSE(p != NULL, -1, "error: Failed to create a socket");
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "Sending telemetry to collector " JCFW_NET_ADDRESS_FORMAT " (rank %lu)",
+        JCFW_NET_ADDRESS_ARGS(&s_collector_endpoints[to].address),
+        (unsigned long)jcfw_endpoint_set_get_rank(&s_collector_set, to));
+
+    // NOTE(Caleb): Samples are stamped on the clock of the collector which they go to. Until it
+    // has a model of its own, the last one is the best guess.
+    jcfw_timesync_model_t model;
+    if (jcfw_timesync_get_model(&s_collectors[to].timesync, &model))
+    {
+        jcfw_time_set_model(&model);
+    }
+}
+
+static void send_als_summary(const jcfw_aggregate_report_t *report, void *arg)
+{
+    uint8_t record[TELEMETRY_SUMMARY_RECORD_SIZE];
+    JCFW_ITOB32_LE(&record[0], (uint32_t)((report->end_us - report->start_us) / 1000));
+    JCFW_ITOB32_LE(&record[4], report->count);
+    put_f32(&record[8], report->min);
+    put_f32(&record[12], report->max);
+    put_f32(&record[16], report->mean);
+    put_f32(&record[20], report->last);
+    put_f32(&record[24], report->p50);
+    put_f32(&record[28], report->p90);
+    put_f32(&record[32], report->p99);
+
+    jcfw_result_e err = jcfw_telemetry_batcher_add(
+        &s_summary_batcher, jcfw_time_from_local_us(report->end_us), record);
+    if (err != JCFW_RESULT_OK)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Unable to batch an ALS summary (rc %u)", err);
+    }
+}
 
-    if (timeout_sec)
+static void spool_frame(const uint8_t *frame, size_t length, void *arg)
+{
+    if (!s_has_spool)
     {
-        struct timeval timeout;
-        timeout.tv_sec  = timeout_sec;
-        timeout.tv_usec = 0;
-        JCFW_ERROR_IF_TRUE(
-            setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout) < 0,
-            -1,
-            "error: Unable to set a timeout for the socket; errno %d",
-            errno);
+        JCFW_TRACELN_WARN(TRACE_TAG, "Collector is unreachable; Dropping a telemetry frame");
+        return;
     }
 
-    memcpy(&o_remote_addr->data, p->ai_addr, p->ai_addrlen);
-    o_remote_addr->len = p->ai_addrlen;
+    jcfw_result_e err = jcfw_telemetry_spool_append(&s_spool, frame, length);
+    JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, , "Unable to spool a telemetry frame (rc %u)", err);
+}
 
-    freeaddrinfo(servinfo);
+static void drain_spool(uint64_t now_us)
+{
+    JCFW_RETURN_IF_FALSE(s_has_spool);
+
+    // NOTE(Caleb): Drain as fast as the collector acknowledges, but only into the part of the
+    // window which live frames don't need. While the collector hasn't been heard from, send one
+    // frame at a time as a probe; If it is dropped, it goes back into the spool.
+    const bool     is_uplink_up =
+        s_has_ack && (now_us - s_last_ack_us) < TELEMETRY_UPLINK_TIMEOUT_US;
+    const uint32_t in_flight_max =
+        is_uplink_up ? JCFW_RDP_WINDOW_SIZE - TELEMETRY_LIVE_SLOT_COUNT : 1;
+
+    while (jcfw_telemetry_spool_get_pending_count(&s_spool) > 0
+           && jcfw_rdp_sender_get_in_flight(&s_rdp) < in_flight_max)
+    {
+        size_t        length;
+        jcfw_result_e err =
+            jcfw_telemetry_spool_peek(&s_spool, s_spooled_frame, sizeof(s_spooled_frame), &length);
+        if (err == JCFW_RESULT_OK)
+        {
+            err = jcfw_rdp_sender_send(&s_rdp, s_spooled_frame, length, now_us);
+            JCFW_RETURN_IF_FALSE(err == JCFW_RESULT_OK);
+        }
+        else
+        {
+            JCFW_TRACELN_ERROR(TRACE_TAG, "Skipping an unreadable spooled frame (rc %u)", err);
+        }
 
-    return sock;
+        err = jcfw_telemetry_spool_consume(&s_spool);
+        JCFW_ERROR_IF_FALSE(err == JCFW_RESULT_OK, , "Unable to consume a spooled frame");
+    }
 }
@@ -5,29 +5,40 @@
 #include "driver/gpio.h"
 #include "driver/i2c_master.h"
 #include "driver/uart.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "nvs_flash.h"
 
 #include "jcfw/driver/als/ltr303.h"
+#include "jcfw/platform/i2c.h"
 #include "jcfw/util/assert.h"
 
+#include "acquisition.h"
 #include "platform.h"
 
 // -------------------------------------------------------------------------------------------------
 
-#define ALS_INT_GPIO_NUM GPIO_NUM_23
+#define ALS_INT_GPIO_NUM            GPIO_NUM_23
+#define ALS_I2C_TIMEOUT_MS          50
+#define ALS_I2C_PRIORITY            10
+
+#define ALS_WINDOW_DEADBAND_PERCENT 5
+#define ALS_WINDOW_DEADBAND_ABS     8
+#define ALS_WINDOW_PERSISTANCE      1
 
 // -------------------------------------------------------------------------------------------------
 
-bool                           g_is_als_data_ready = false;
-jcfw_ltr303_t                  g_ltr303            = {0};
-static i2c_master_dev_handle_t s_als_i2c_handle    = NULL;
+jcfw_ltr303_t                  g_ltr303         = {0};
+jcfw_i2c_device_t              g_als_i2c_device = {0};
+static i2c_master_dev_handle_t s_als_i2c_handle = NULL;
 
 QueueHandle_t g_cli_uart_event_queue;
 
 // -------------------------------------------------------------------------------------------------
 
 static void on_als_data_ready(void *arg);
+static bool is_warm_start(void);
 
 // -------------------------------------------------------------------------------------------------
 
@@ -59,6 +70,14 @@ jcfw_result_e jcfw_platform_init(void)
     i2c_master_bus_handle_t i2c_bus_handle = NULL;
     ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_bus_cfg, &i2c_bus_handle));
 
+    jcfw_i2c_bus_t *i2c_bus = NULL;
+    jcfw_err                = jcfw_platform_i2c_bus_create(i2c_bus_handle, &i2c_bus);
+    JCFW_ERROR_IF_FALSE(
+        jcfw_err == JCFW_RESULT_OK,
+        JCFW_RESULT_ERROR,
+        "Unable to create the I2C bus (rc %u)",
+        jcfw_err);
+
     // ALS ---------------------------------------------------------------------
 
     memset(&gpio_cfg, 0, sizeof(gpio_cfg));
@@ -75,25 +94,47 @@ jcfw_result_e jcfw_platform_init(void)
     i2c_dev_cfg.scl_speed_hz    = 400000;
     ESP_ERROR_CHECK(i2c_master_bus_add_device(i2c_bus_handle, &i2c_dev_cfg, &s_als_i2c_handle));
 
-    jcfw_platform_delay_ms(100); // NOTE(Caleb): See LTR303 docs
-    jcfw_err = jcfw_ltr303_init(&g_ltr303, s_als_i2c_handle, -1);
+    jcfw_err = jcfw_platform_i2c_device_init(
+        &g_als_i2c_device, i2c_bus, s_als_i2c_handle, ALS_I2C_PRIORITY);
+    JCFW_ASSERT(jcfw_err == JCFW_RESULT_OK, "Unable to register the ALS on the I2C bus");
 
+    // NOTE(Caleb): The LTR303 auto-increments the register address on multi-byte writes.
+    g_als_i2c_device.is_write_merge_enabled = true;
+
+    // NOTE(Caleb): If only the ESP32 was reset, the LTR303 has kept power and its configuration,
+    // so the power-up delay and the soft reset can be skipped.
+    bool warm_start = is_warm_start();
+    if (!warm_start)
+    {
+        jcfw_platform_delay_ms(100); // NOTE(Caleb): See LTR303 docs
+    }
+
+    jcfw_err = jcfw_ltr303_probe(&g_ltr303, &g_als_i2c_device, ALS_I2C_TIMEOUT_MS);
     JCFW_ERROR_IF_FALSE(
         jcfw_err == JCFW_RESULT_OK,
         JCFW_RESULT_ERROR,
         "Unable to initialize the LTR303 (rc %u)",
         jcfw_err);
 
-    uint16_t thresh_low  = 0x0000;
-    uint16_t thresh_high = 0x0000;
-    jcfw_err             = jcfw_ltr303_set_thresholds(&g_ltr303, &thresh_low, &thresh_high);
-    JCFW_ASSERT(jcfw_err == JCFW_RESULT_OK, "Unable to set LTR303 thresholds");
+    jcfw_ltr303_config_t als_cfg = JCFW_LTR303_CONFIG_DEFAULT;
+    als_cfg.gain                 = JCFW_LTR303_GAIN_8X;
+    als_cfg.interrupt_enable     = true;
 
-    jcfw_err = jcfw_ltr303_enable_interrupt(&g_ltr303, true);
-    JCFW_ASSERT(jcfw_err == JCFW_RESULT_OK, "Unable to enable LTR303 interrupts");
+    // NOTE(Caleb): A zero-width window makes the first measurement trigger an interrupt. After
+    // that, the adaptive window only lets the interrupt fire when the light level changes.
+    als_cfg.threshold_low  = 0x0000;
+    als_cfg.threshold_high = 0x0000;
 
-    jcfw_err = jcfw_ltr303_set_gain(&g_ltr303, JCFW_LTR303_GAIN_8X);
-    JCFW_ASSERT(jcfw_err == JCFW_RESULT_OK, "Unable to set LTR303 gain");
+    jcfw_err = jcfw_ltr303_apply_config(&g_ltr303, &als_cfg, warm_start);
+    JCFW_ASSERT(jcfw_err == JCFW_RESULT_OK, "Unable to configure the LTR303");
+
+    jcfw_ltr303_window_config_t als_window_cfg = {
+        .deadband_percent = ALS_WINDOW_DEADBAND_PERCENT,
+        .deadband_abs     = ALS_WINDOW_DEADBAND_ABS,
+        .persistance      = ALS_WINDOW_PERSISTANCE,
+    };
+    jcfw_err = jcfw_ltr303_enable_adaptive_window(&g_ltr303, &als_window_cfg);
+    JCFW_ASSERT(jcfw_err == JCFW_RESULT_OK, "Unable to enable the LTR303 adaptive window");
 
     // CLI UART ----------------------------------------------------------------
 
@@ -149,55 +190,36 @@ bool jcfw_platform_trace_validate(const char *tag)
 
 void jcfw_platform_delay_ms(uint32_t delay_ms)
 {
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    // NOTE(Caleb): vTaskDelay(n) can return anywhere within the n-th tick, so round up and add a
+    // tick to guarantee that at least `delay_ms` has elapsed.
+    vTaskDelay((delay_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1);
 }
 
-jcfw_result_e jcfw_platform_i2c_mstr_mem_read(
-    void          *arg,
-    const uint8_t *mem_addr,
-    size_t         mem_addr_size,
-    uint8_t       *o_data,
-    size_t         data_size,
-    uint32_t       timeout_ms)
+uint64_t jcfw_platform_get_time_us(void)
 {
-    i2c_master_dev_handle_t handle = arg;
+    return (uint64_t)esp_timer_get_time();
+}
 
-    esp_err_t err =
-        i2c_master_transmit_receive(handle, mem_addr, mem_addr_size, o_data, data_size, timeout_ms);
-    if (err != ESP_OK)
-    {
-        return JCFW_RESULT_ERROR;
-    }
+// -------------------------------------------------------------------------------------------------
 
-    return JCFW_RESULT_OK;
+static void on_als_data_ready(void *arg)
+{
+    acquisition_on_edge_from_isr((uint64_t)esp_timer_get_time());
 }
 
-jcfw_result_e jcfw_platform_i2c_mstr_mem_write(
-    void          *arg,
-    const uint8_t *mem_addr,
-    size_t         mem_addr_size,
-    const uint8_t *data,
-    size_t         data_size,
-    uint32_t       timeout_ms)
+static bool is_warm_start(void)
 {
-    i2c_master_dev_handle_t handle = arg;
-
-    uint8_t i2c_data[mem_addr_size + data_size];
-    memcpy(i2c_data, mem_addr, mem_addr_size);
-    memcpy(i2c_data + mem_addr_size, data, data_size);
-
-    esp_err_t err = i2c_master_transmit(handle, i2c_data, mem_addr_size + data_size, timeout_ms);
-    if (err != ESP_OK)
+    switch (esp_reset_reason())
     {
-        return JCFW_RESULT_ERROR;
+        case ESP_RST_SW:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+        case ESP_RST_DEEPSLEEP:
+            return true;
+
+        default:
+            return false;
     }
-
-    return JCFW_RESULT_OK;
-}
-
-// -------------------------------------------------------------------------------------------------
-
-static void on_als_data_ready(void *arg)
-{
-    g_is_als_data_ready = true;
 }
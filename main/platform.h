@@ -3,11 +3,12 @@
 
 #include "driver/i2c_master.h"
 #include "jcfw/driver/als/ltr303.h"
+#include "jcfw/platform/i2c.h"
 
 // #define CLI_UART_NUM UART_NUM_0
 
-extern jcfw_ltr303_t g_ltr303;
-extern bool          g_is_als_data_ready;
+extern jcfw_ltr303_t     g_ltr303;
+extern jcfw_i2c_device_t g_als_i2c_device;
 // extern QueueHandle_t g_cli_uart_event_queue;
 
 #endif // __PLATFORM_H__
@@ -0,0 +1,262 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_harness.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/telemetry/codec.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
+
+/* Notes:
+ * A benchmark of the telemetry codec (see: jcfw/telemetry/codec.h) for the host (the linux
+ * target). Each data set is encoded as one stream (as if it were a single, very long frame), then
+ * decoded again, and every record which comes back is compared with the one which went in. For
+ * each data set it prints:
+ *
+ *     raw         The size of a record as it would be sent without the codec (an 8 byte timestamp
+ *                 and the fields), in bytes
+ *     encoded     The average encoded size of a record, in bytes
+ *     ratio       raw / encoded
+ *     enc, dec    Encode and decode throughput, in millions of records per second
+ *
+ * The data sets run from the best case (a steady rate and constant fields) to the worst (random
+ * timing and fields), with the readings the ALS actually produces in between.
+ *
+ * The number of records per data set is CODEC_BENCH_RECORD_COUNT, or the value of the
+ * CODEC_BENCH_RECORD_COUNT environment variable.
+ *
+ * It exits with a non-zero status if any record does not survive the round trip.
+ */
+
+#define TRACE_TAG                "CODEC"
+
+#define CODEC_BENCH_RECORD_COUNT 200000
+
+/// @brief The period of the generated readings, in us.
+#define CODEC_BENCH_PERIOD_US    (100 * 1000)
+
+// -------------------------------------------------------------------------------------------------
+
+typedef void (*generate_f)(size_t index, uint64_t *io_time_us, uint8_t *o_record);
+
+typedef struct
+{
+    const char                   *name;
+    jcfw_telemetry_codec_layout_t layout;
+    generate_f                    generate;
+} data_set_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static bool     run(const data_set_t *set, size_t record_count);
+static void     generate_steady(size_t index, uint64_t *io_time_us, uint8_t *o_record);
+static void     generate_als(size_t index, uint64_t *io_time_us, uint8_t *o_record);
+static void     generate_counter(size_t index, uint64_t *io_time_us, uint8_t *o_record);
+static void     generate_noise(size_t index, uint64_t *io_time_us, uint8_t *o_record);
+static uint32_t random_u32(void);
+
+// -------------------------------------------------------------------------------------------------
+
+static const data_set_t S_DATA_SETS[] = {
+    {
+        .name     = "steady",
+        .layout   = {.field_count = 3, .field_sizes = {2, 2, 1}},
+        .generate = generate_steady,
+    },
+    {
+        .name     = "als",
+        .layout   = {.field_count = 3, .field_sizes = {2, 2, 1}},
+        .generate = generate_als,
+    },
+    {
+        .name     = "counter",
+        .layout   = {.field_count = 2, .field_sizes = {4, 2}},
+        .generate = generate_counter,
+    },
+    {
+        .name     = "noise",
+        .layout   = {.field_count = 3, .field_sizes = {2, 2, 1}},
+        .generate = generate_noise,
+    },
+};
+
+static uint32_t s_random_state = 0x12345678;
+
+void app_main(void)
+{
+    host_harness_init();
+
+    const long record_count =
+        host_harness_get_env_long("CODEC_BENCH_RECORD_COUNT", CODEC_BENCH_RECORD_COUNT);
+    JCFW_ASSERT(record_count > 0, "error: Invalid record count %ld", record_count);
+
+    printf(
+        "%-8s %8s %8s %8s %10s %10s\n",
+        "data set",
+        "raw",
+        "encoded",
+        "ratio",
+        "enc Mr/s",
+        "dec Mr/s");
+
+    bool is_ok = true;
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(S_DATA_SETS); i++)
+    {
+        is_ok &= run(&S_DATA_SETS[i], (size_t)record_count);
+    }
+
+    exit(is_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool run(const data_set_t *set, size_t record_count)
+{
+    const size_t record_size  = jcfw_telemetry_codec_get_record_size(&set->layout);
+    const size_t encoded_max  = jcfw_telemetry_codec_get_encoded_size_max(&set->layout);
+    const size_t capacity     = record_count * encoded_max;
+    uint64_t    *times_us     = malloc(record_count * sizeof(*times_us));
+    uint8_t     *records      = malloc(record_count * record_size);
+    uint8_t     *encoded      = malloc(capacity);
+    uint8_t      decoded[256] = {0};
+    JCFW_ASSERT(times_us && records && encoded, "error: Out of memory");
+
+    uint64_t time_us = 0;
+    for (size_t i = 0; i < record_count; i++)
+    {
+        set->generate(i, &time_us, &records[i * record_size]);
+        times_us[i] = time_us;
+    }
+
+    // NOTE(Caleb): The encoder and the decoder are separate, just like on either end of the link.
+    jcfw_telemetry_codec_t encoder;
+    jcfw_telemetry_codec_t decoder;
+    jcfw_telemetry_codec_init(&encoder, &set->layout);
+    jcfw_telemetry_codec_init(&decoder, &set->layout);
+
+    bool   is_encoded = true;
+    size_t length     = 0;
+
+    uint64_t start_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < record_count && is_encoded; i++)
+    {
+        size_t        record_length = 0;
+        jcfw_result_e err           = jcfw_telemetry_codec_encode(
+            &encoder,
+            times_us[i],
+            &records[i * record_size],
+            &encoded[length],
+            capacity - length,
+            &record_length);
+
+        is_encoded  = err == JCFW_RESULT_OK && record_length <= encoded_max;
+        length     += record_length;
+    }
+    const uint64_t encode_us = jcfw_platform_get_time_us() - start_us;
+
+    bool   is_ok  = is_encoded;
+    size_t offset = 0;
+    size_t count  = 0;
+
+    start_us = jcfw_platform_get_time_us();
+    while (offset < length && count < record_count && is_ok)
+    {
+        uint64_t      decoded_time_us = 0;
+        size_t        consumed        = 0;
+        jcfw_result_e err             = jcfw_telemetry_codec_decode(
+            &decoder, &encoded[offset], length - offset, &decoded_time_us, decoded, &consumed);
+
+        is_ok = err == JCFW_RESULT_OK && decoded_time_us == times_us[count]
+             && memcmp(decoded, &records[count * record_size], record_size) == 0;
+
+        offset += consumed;
+        count++;
+    }
+    const uint64_t decode_us = jcfw_platform_get_time_us() - start_us;
+
+    free(times_us);
+    free(records);
+    free(encoded);
+
+    JCFW_ERROR_IF_FALSE(is_encoded, false, "%s: Unable to encode every record", set->name);
+    JCFW_ERROR_IF_FALSE(
+        is_ok,
+        false,
+        "%s: Record %lu did not survive the round trip",
+        set->name,
+        (unsigned long)(count - 1));
+    JCFW_ERROR_IF_FALSE(
+        count == record_count && offset == length,
+        false,
+        "%s: Decoded %lu of %lu records",
+        set->name,
+        (unsigned long)count,
+        (unsigned long)record_count);
+
+    const double raw_size     = (double)(sizeof(uint64_t) + record_size);
+    const double encoded_size = (double)length / (double)record_count;
+
+    printf(
+        "%-8s %8.2f %8.2f %8.2f %10.2f %10.2f\n",
+        set->name,
+        raw_size,
+        encoded_size,
+        raw_size / encoded_size,
+        (double)record_count / (double)JCFW_MAX(encode_us, 1),
+        (double)record_count / (double)JCFW_MAX(decode_us, 1));
+
+    return true;
+}
+
+/// @brief A steady rate and constant fields; Every record is one byte per field, plus one.
+static void generate_steady(size_t index, uint64_t *io_time_us, uint8_t *o_record)
+{
+    *io_time_us += CODEC_BENCH_PERIOD_US;
+
+    JCFW_ITOB16_LE(&o_record[0], 1000);
+    JCFW_ITOB16_LE(&o_record[2], 300);
+    o_record[4] = 1;
+}
+
+/// @brief ALS readings (channel 0, channel 1, gain) under slowly changing light, with sensor noise
+/// and jitter in when the readings are taken.
+static void generate_als(size_t index, uint64_t *io_time_us, uint8_t *o_record)
+{
+    *io_time_us += CODEC_BENCH_PERIOD_US + (int64_t)(random_u32() % 101) - 50;
+
+    const double level = 1000.0 + 600.0 * sin((double)index / 600.0);
+    JCFW_ITOB16_LE(&o_record[0], (uint16_t)(level + (int)(random_u32() % 7) - 3));
+    JCFW_ITOB16_LE(&o_record[2], (uint16_t)(level * 0.3 + (int)(random_u32() % 5) - 2));
+    o_record[4] = 1;
+}
+
+/// @brief A 32 bit sequence number which wraps, and a slowly changing reading.
+static void generate_counter(size_t index, uint64_t *io_time_us, uint8_t *o_record)
+{
+    *io_time_us += CODEC_BENCH_PERIOD_US;
+
+    JCFW_ITOB32_LE(&o_record[0], 0xFFFFFF00u + (uint32_t)index);
+    JCFW_ITOB16_LE(&o_record[4], (uint16_t)(500 + (index / 100) % 50));
+}
+
+/// @brief Random timing and fields; The worst case.
+static void generate_noise(size_t index, uint64_t *io_time_us, uint8_t *o_record)
+{
+    *io_time_us += random_u32() % (10 * CODEC_BENCH_PERIOD_US);
+
+    JCFW_ITOB16_LE(&o_record[0], (uint16_t)random_u32());
+    JCFW_ITOB16_LE(&o_record[2], (uint16_t)random_u32());
+    o_record[4] = (uint8_t)random_u32();
+}
+
+static uint32_t random_u32(void)
+{
+    // NOTE(Caleb): xorshift32, so that every run (and every host) sees the same data.
+    s_random_state ^= s_random_state << 13;
+    s_random_state ^= s_random_state >> 17;
+    s_random_state ^= s_random_state << 5;
+    return s_random_state;
+}
@@ -0,0 +1,304 @@
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+
+#include "host_harness.h"
+#include "jcfw/net/rdp.h"
+#include "jcfw/net/timesync.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/telemetry/frame.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/bit.h"
+#include "jcfw/util/math.h"
+#include "jcfw/util/sketch.h"
+
+/* Notes:
+ * A telemetry collector for the host (the linux target) which measures the latency of every raw
+ * ALS reading from its INT edge on the device to its arrival here, broken down by stage:
+ *
+ *     irq->read   The INT edge to the end of the sensor read (device clock)
+ *     read->enc   The end of the read to the reading being encoded into a frame (device clock)
+ *     enc->send   Batching and any backlog (retransmits, the spool) until the frame was last sent
+ *                 (device clock)
+ *     send->rx    The network, from the frame being sent to it arriving here (both clocks)
+ *     total       The INT edge to the frame arriving here (both clocks)
+ *
+ * The device's clock is related to this one with clock probes (see: jcfw/net/timesync.h), which
+ * the device answers on its telemetry socket. Stages which span both clocks are only measured
+ * once a probe has been answered, and are off by at most half of the probe's round trip.
+ *
+ * The collector acknowledges frames like any other, and answers the device's own clock probes
+ * (see: jcfw/time.h) with its clock, so devices can point straight at it. It follows whichever
+ * device sent it a frame last.
+ *
+ * It listens on COLLECTOR_PORT, or on the port in the COLLECTOR_PORT environment variable, so that
+ * several collectors can run on one host to try out failover between them (see:
+ * jcfw/net/endpoint.h). Stop one, and the device moves on to the next within a retransmit timeout.
+ */
+
+#define TRACE_TAG                     "COLL"
+
+#define COLLECTOR_PORT                5000
+
+/// @brief How often the device's clock is probed, and the latencies are reported, in ms.
+#define COLLECTOR_PROBE_PERIOD_MS     1000
+#define COLLECTOR_REPORT_PERIOD_MS    10000
+
+/// @brief The range of latencies which the report tells apart, in us.
+#define COLLECTOR_LATENCY_MIN_US      10
+#define COLLECTOR_LATENCY_MAX_US      (10 * 1000 * 1000)
+
+/// @brief See: TELEMETRY_STREAM_ALS_RAW (main/main.c).
+#define TELEMETRY_STREAM_ALS_RAW      0
+#define TELEMETRY_RAW_RECORD_SIZE     11
+
+typedef enum
+{
+    STAGE_READ = 0,
+    STAGE_ENCODE,
+    STAGE_SEND,
+    STAGE_NETWORK,
+    STAGE_TOTAL,
+    STAGE_COUNT,
+} stage_e;
+
+typedef struct
+{
+    jcfw_sketch_t sketch;
+    uint64_t      max_us;
+} stage_latency_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e send_datagram(const uint8_t *datagram, size_t length, void *arg);
+static void on_frame(const uint8_t *frame, size_t length, uint64_t send_us, void *arg);
+static void add_latency(stage_e stage, int64_t latency_us);
+static void report(void);
+
+// -------------------------------------------------------------------------------------------------
+
+static const char *const S_STAGE_NAMES[STAGE_COUNT] = {
+    "irq->read",
+    "read->enc",
+    "enc->send",
+    "send->rx",
+    "total",
+};
+
+static int                     s_sock = -1;
+static struct sockaddr_storage s_device_addr;
+static socklen_t               s_device_addr_len = 0;
+static jcfw_rdp_receiver_t     s_rdp;
+static jcfw_timesync_t         s_timesync;
+static stage_latency_t         s_latencies[STAGE_COUNT];
+static uint64_t                s_receive_us;
+static uint32_t                s_unsynced_count = 0;
+
+void app_main(void)
+{
+    host_harness_init();
+
+    const int port = (int)host_harness_get_env_long("COLLECTOR_PORT", COLLECTOR_PORT);
+
+    s_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    JCFW_ASSERT(s_sock >= 0, "error: Unable to create a socket; errno %d", errno);
+
+    struct sockaddr_in local = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    JCFW_ASSERT(
+        bind(s_sock, (struct sockaddr *)&local, sizeof(local)) == 0,
+        "error: Unable to bind port %d; errno %d",
+        port,
+        errno);
+
+    // NOTE(Caleb): Wake every 100 ms even while nothing arrives, so that probes and reports go out
+    // on time.
+    struct timeval timeout = {.tv_sec = 0, .tv_usec = 100 * 1000};
+    setsockopt(s_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    const jcfw_rdp_receiver_config_t rdp_config = {
+        .deliver_cb = on_frame,
+        .send_cb    = send_datagram,
+    };
+    jcfw_result_e err = jcfw_rdp_receiver_init(&s_rdp, &rdp_config);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up the reliable receiver");
+
+    jcfw_timesync_init(&s_timesync);
+    for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+        jcfw_sketch_init(
+            &s_latencies[i].sketch, COLLECTOR_LATENCY_MIN_US, COLLECTOR_LATENCY_MAX_US);
+    }
+
+    JCFW_TRACELN_INFO(TRACE_TAG, "Listening on port %d", port);
+
+    uint64_t probe_us  = jcfw_platform_get_time_us();
+    uint64_t report_us = probe_us;
+    while (1)
+    {
+        uint8_t                 datagram[JCFW_RDP_DATAGRAM_SIZE_MAX];
+        struct sockaddr_storage source;
+        socklen_t               source_len = sizeof(source);
+        ssize_t                 length     = recvfrom(
+            s_sock, datagram, sizeof(datagram), 0, (struct sockaddr *)&source, &source_len);
+        s_receive_us = jcfw_platform_get_time_us();
+
+        if (length > 0 && datagram[0] == JCFW_RDP_TYPE_DATA)
+        {
+            if (s_device_addr_len != source_len || memcmp(&s_device_addr, &source, source_len))
+            {
+                JCFW_TRACELN_INFO(TRACE_TAG, "Following a new device");
+                memcpy(&s_device_addr, &source, source_len);
+                s_device_addr_len = source_len;
+                jcfw_timesync_init(&s_timesync);
+            }
+
+            jcfw_rdp_receiver_on_receive(&s_rdp, datagram, length);
+        }
+        else if (length > 0 && datagram[0] == JCFW_TIMESYNC_TYPE_RESPONSE)
+        {
+            jcfw_timesync_on_receive(&s_timesync, datagram, length, s_receive_us);
+        }
+        else if (length > 0 && datagram[0] == JCFW_TIMESYNC_TYPE_REQUEST)
+        {
+            uint8_t response[JCFW_TIMESYNC_RESPONSE_SIZE];
+            if (jcfw_timesync_respond(
+                    datagram, length, s_receive_us, jcfw_platform_get_time_us(), response)
+                == JCFW_RESULT_OK)
+            {
+                sendto(
+                    s_sock, response, sizeof(response), 0, (struct sockaddr *)&source, source_len);
+            }
+        }
+
+        const uint64_t now_us = jcfw_platform_get_time_us();
+        if (s_device_addr_len && now_us - probe_us >= COLLECTOR_PROBE_PERIOD_MS * 1000)
+        {
+            uint8_t request[JCFW_TIMESYNC_REQUEST_SIZE];
+            jcfw_timesync_make_request(&s_timesync, jcfw_platform_get_time_us(), request);
+            send_datagram(request, sizeof(request), NULL);
+            probe_us = now_us;
+        }
+
+        if (now_us - report_us >= COLLECTOR_REPORT_PERIOD_MS * 1000)
+        {
+            report();
+            report_us = now_us;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static jcfw_result_e send_datagram(const uint8_t *datagram, size_t length, void *arg)
+{
+    ssize_t bytes_sent = sendto(
+        s_sock, datagram, length, 0, (struct sockaddr *)&s_device_addr, s_device_addr_len);
+    JCFW_ERROR_IF_FALSE(
+        bytes_sent == (ssize_t)length,
+        JCFW_RESULT_ERROR,
+        "Unable to send to the device; errno %d",
+        errno);
+
+    return JCFW_RESULT_OK;
+}
+
+static void on_frame(const uint8_t *frame, size_t length, uint64_t send_us, void *arg)
+{
+    jcfw_telemetry_frame_reader_t reader;
+    JCFW_RETURN_IF_FALSE(jcfw_telemetry_frame_open(&reader, frame, length) == JCFW_RESULT_OK);
+    JCFW_RETURN_IF_FALSE(
+        reader.header.stream == TELEMETRY_STREAM_ALS_RAW
+        && reader.header.record_size == TELEMETRY_RAW_RECORD_SIZE);
+
+    // NOTE(Caleb): The offset takes device time to collector time; Without it, only the stages
+    // which stay on the device can be measured.
+    jcfw_timesync_sample_t clock;
+    const bool             is_synced = jcfw_timesync_get_estimate(&s_timesync, &clock);
+
+    uint64_t       edge_us;
+    const uint8_t *record;
+    while (jcfw_telemetry_frame_next(&reader, &edge_us, &record) == JCFW_RESULT_OK)
+    {
+        const uint32_t read_delay_us   = JCFW_GET_LE(&record[5], sizeof(uint16_t));
+        const uint32_t encode_delay_us = JCFW_GET_LE(&record[7], sizeof(uint32_t));
+        const uint64_t encode_us       = edge_us + encode_delay_us;
+
+        add_latency(STAGE_READ, read_delay_us);
+        add_latency(STAGE_ENCODE, (int64_t)encode_delay_us - read_delay_us);
+        add_latency(STAGE_SEND, (int64_t)(send_us - encode_us));
+
+        if (!is_synced)
+        {
+            s_unsynced_count++;
+            continue;
+        }
+
+        add_latency(STAGE_NETWORK, (int64_t)(s_receive_us - (send_us - clock.offset_us)));
+        add_latency(STAGE_TOTAL, (int64_t)(s_receive_us - (edge_us - clock.offset_us)));
+    }
+}
+
+static void add_latency(stage_e stage, int64_t latency_us)
+{
+    // NOTE(Caleb): Clock error can push a short cross-clock stage below 0; It counts as 0.
+    latency_us = JCFW_MAX(latency_us, 0);
+
+    jcfw_sketch_add(&s_latencies[stage].sketch, (float)latency_us);
+    s_latencies[stage].max_us = JCFW_MAX(s_latencies[stage].max_us, (uint64_t)latency_us);
+}
+
+static void report(void)
+{
+    jcfw_timesync_sample_t clock;
+    if (jcfw_timesync_get_estimate(&s_timesync, &clock))
+    {
+        JCFW_TRACELN_INFO(
+            TRACE_TAG,
+            "Device clock offset %lld us (+/- %lu us)",
+            (long long)clock.offset_us,
+            (unsigned long)(clock.delay_us / 2));
+    }
+
+    jcfw_rdp_receiver_stats_t rdp_stats;
+    jcfw_rdp_receiver_get_stats(&s_rdp, &rdp_stats);
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "%lu frames (%lu duplicate, %lu lost); %lu readings before the clocks were aligned",
+        (unsigned long)rdp_stats.delivered_count,
+        (unsigned long)rdp_stats.duplicate_count,
+        (unsigned long)rdp_stats.lost_count,
+        (unsigned long)s_unsynced_count);
+
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "%-10s %8s %10s %10s %10s %10s",
+        "stage",
+        "count",
+        "p50 us",
+        "p90 us",
+        "p99 us",
+        "max us");
+    for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+        jcfw_sketch_t *sketch = &s_latencies[i].sketch;
+        JCFW_TRACELN_INFO(
+            TRACE_TAG,
+            "%-10s %8lu %10.0f %10.0f %10.0f %10llu",
+            S_STAGE_NAMES[i],
+            (unsigned long)sketch->count,
+            jcfw_sketch_quantile(sketch, 0.5f),
+            jcfw_sketch_quantile(sketch, 0.9f),
+            jcfw_sketch_quantile(sketch, 0.99f),
+            (unsigned long long)s_latencies[i].max_us);
+
+        jcfw_sketch_clear(sketch);
+        s_latencies[i].max_us = 0;
+    }
+}
@@ -0,0 +1,381 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_harness.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/filter.h"
+#include "jcfw/util/math.h"
+
+/* Notes:
+ * A benchmark of the smoothing filters (see: jcfw/util/filter.h) for the host (the linux target).
+ * Every filter type is run over the same samples as a reference implementation of it in double
+ * precision, and its output must stay within a bound of the reference: The rounding of the output
+ * (half a unit) for the filters which keep integer state, plus the truncation of the 16 fractional
+ * bits of state for EMA and Kalman. jcfw_filter_apply_block(), over batches of odd sizes, must
+ * give exactly the same output as jcfw_filter_apply(). For each filter it prints:
+ *
+ *     max err     The largest difference from the reference
+ *     bound       The largest difference allowed
+ *     apply       The cost of jcfw_filter_apply(), in ns per sample
+ *     block       The cost of jcfw_filter_apply_block(), in ns per sample
+ *
+ * The samples are ALS readings under slowly changing light, with sensor noise, short dips (a
+ * passing shadow) and steps (a light switched on or off).
+ *
+ * The number of samples is FILTER_BENCH_SAMPLE_COUNT, or the value of the
+ * FILTER_BENCH_SAMPLE_COUNT environment variable.
+ *
+ * It exits with a non-zero status if any filter strays beyond its bound.
+ */
+
+#define TRACE_TAG                 "FILTER"
+
+#define FILTER_BENCH_SAMPLE_COUNT 200000
+
+/// @brief The size of the batches which jcfw_filter_apply_block() is checked with; Odd, so that
+/// the windows wrap part way through batches.
+#define FILTER_BENCH_BLOCK_SIZE   37
+
+// -------------------------------------------------------------------------------------------------
+
+typedef void (*reference_f)(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+
+typedef struct
+{
+    const char          *name;
+    jcfw_filter_config_t config;
+    reference_f          reference;
+
+    /// @brief The largest difference from the reference which is allowed.
+    double error_max;
+} filter_case_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static bool     run(const filter_case_t *filter_case, const int32_t *samples, size_t count);
+static void     reference_none(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+static void     reference_ema(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+static void     reference_moving_average(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+static void     reference_median(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+static void     reference_hysteresis(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+static void     reference_kalman(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count);
+static int      compare_doubles(const void *a, const void *b);
+static void     generate(int32_t *o_samples, size_t count);
+static uint32_t random_u32(void);
+
+// -------------------------------------------------------------------------------------------------
+
+static const filter_case_t S_CASES[] = {
+    {
+        .name      = "none",
+        .config    = {.type = JCFW_FILTER_TYPE_NONE},
+        .reference = reference_none,
+        .error_max = 0.0,
+    },
+    {
+        .name      = "ema",
+        .config    = {.type = JCFW_FILTER_TYPE_EMA, .ema = {.alpha_q16 = 3277}},
+        .reference = reference_ema,
+        .error_max = 1.0,
+    },
+    {
+        .name      = "mavg",
+        .config    = {.type = JCFW_FILTER_TYPE_MOVING_AVERAGE, .moving_average = {.length = 9}},
+        .reference = reference_moving_average,
+        .error_max = 0.5,
+    },
+    {
+        .name      = "median",
+        .config    = {.type = JCFW_FILTER_TYPE_MEDIAN, .median = {.length = 7}},
+        .reference = reference_median,
+        .error_max = 0.5,
+    },
+    {
+        .name      = "median15",
+        .config    = {.type = JCFW_FILTER_TYPE_MEDIAN, .median = {.length = 15}},
+        .reference = reference_median,
+        .error_max = 0.5,
+    },
+    {
+        .name      = "hyst",
+        .config    = {.type = JCFW_FILTER_TYPE_HYSTERESIS, .hysteresis = {.threshold = 50}},
+        .reference = reference_hysteresis,
+        .error_max = 0.0,
+    },
+    {
+        .name   = "kalman",
+        .config = {
+            .type   = JCFW_FILTER_TYPE_KALMAN,
+            .kalman = {.process_variance_q8 = 4 * 256, .measurement_variance_q8 = 10000 * 256},
+        },
+        .reference = reference_kalman,
+        .error_max = 1.0,
+    },
+};
+
+static uint32_t s_random_state = 0x12345678;
+
+void app_main(void)
+{
+    host_harness_init();
+
+    const long count =
+        host_harness_get_env_long("FILTER_BENCH_SAMPLE_COUNT", FILTER_BENCH_SAMPLE_COUNT);
+    JCFW_ASSERT(count > 0, "error: Invalid sample count %ld", count);
+
+    int32_t *samples = malloc((size_t)count * sizeof(*samples));
+    JCFW_ASSERT(samples, "error: Out of memory");
+    generate(samples, (size_t)count);
+
+    printf("%-8s %8s %8s %10s %10s\n", "filter", "max err", "bound", "apply ns", "block ns");
+
+    bool is_ok = true;
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(S_CASES); i++)
+    {
+        is_ok &= run(&S_CASES[i], samples, (size_t)count);
+    }
+
+    free(samples);
+    exit(is_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool run(const filter_case_t *filter_case, const int32_t *samples, size_t count)
+{
+    int32_t *outputs       = malloc(count * sizeof(*outputs));
+    int32_t *block_outputs = malloc(count * sizeof(*block_outputs));
+    double  *references    = malloc(count * sizeof(*references));
+    JCFW_ASSERT(outputs && block_outputs && references, "error: Out of memory");
+
+    jcfw_filter_t filter;
+    JCFW_ASSERT(
+        jcfw_filter_init(&filter, &filter_case->config) == JCFW_RESULT_OK,
+        "error: Unable to set up %s",
+        filter_case->name);
+
+    // NOTE(Caleb): An untimed pass first, so that neither faulting in the pages of the outputs nor
+    // warming up the caches is timed along with the filter.
+    memset(block_outputs, 0, count * sizeof(*block_outputs));
+    for (size_t i = 0; i < count; i++)
+    {
+        outputs[i] = jcfw_filter_apply(&filter, samples[i]);
+    }
+
+    jcfw_filter_reset(&filter);
+    uint64_t start_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < count; i++)
+    {
+        outputs[i] = jcfw_filter_apply(&filter, samples[i]);
+    }
+    const uint64_t apply_us = jcfw_platform_get_time_us() - start_us;
+
+    jcfw_filter_reset(&filter);
+    start_us = jcfw_platform_get_time_us();
+    jcfw_filter_apply_block(&filter, samples, block_outputs, count);
+    const uint64_t block_us = jcfw_platform_get_time_us() - start_us;
+
+    // NOTE(Caleb): The timed batch is one long one, so check again with batches which end part way
+    // through the windows.
+    jcfw_filter_reset(&filter);
+    for (size_t i = 0; i < count; i += FILTER_BENCH_BLOCK_SIZE)
+    {
+        const size_t block_count = JCFW_MIN(count - i, (size_t)FILTER_BENCH_BLOCK_SIZE);
+        jcfw_filter_apply_block(&filter, &samples[i], &block_outputs[i], block_count);
+    }
+    const bool is_block_ok = memcmp(outputs, block_outputs, count * sizeof(*outputs)) == 0;
+
+    filter_case->reference(&filter_case->config, samples, references, count);
+
+    double error_max   = 0.0;
+    size_t error_index = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const double error = fabs((double)outputs[i] - references[i]);
+        if (error > error_max)
+        {
+            error_max   = error;
+            error_index = i;
+        }
+    }
+
+    printf(
+        "%-8s %8.3f %8.3f %10.2f %10.2f\n",
+        filter_case->name,
+        error_max,
+        filter_case->error_max,
+        (double)apply_us * 1000.0 / (double)count,
+        (double)block_us * 1000.0 / (double)count);
+
+    const double reference = references[error_index];
+    const int    output    = outputs[error_index];
+
+    free(outputs);
+    free(block_outputs);
+    free(references);
+
+    JCFW_ERROR_IF_FALSE(
+        is_block_ok, false, "%s: Filtering in batches changed the output", filter_case->name);
+    JCFW_ERROR_IF_FALSE(
+        error_max <= filter_case->error_max,
+        false,
+        "%s: Sample %lu filtered to %d instead of %.3f",
+        filter_case->name,
+        (unsigned long)error_index,
+        output,
+        reference);
+
+    return true;
+}
+
+static void reference_none(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        o_outputs[i] = samples[i];
+    }
+}
+
+static void reference_ema(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count)
+{
+    const double alpha = config->ema.alpha_q16 / 65536.0;
+    double       value = samples[0];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        value        += alpha * (samples[i] - value);
+        o_outputs[i]  = value;
+    }
+}
+
+static void reference_moving_average(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count)
+{
+    const size_t length = config->moving_average.length;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t window_count = JCFW_MIN(i + 1, length);
+        double       sum          = 0.0;
+        for (size_t j = 0; j < window_count; j++)
+        {
+            sum += samples[i - j];
+        }
+
+        o_outputs[i] = sum / (double)window_count;
+    }
+}
+
+/// @brief The median of the last `length` samples; Until the window fills, the median of an even
+/// number of samples is the mean of the middle two.
+static void reference_median(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count)
+{
+    const size_t length = config->median.length;
+    double       window[JCFW_FILTER_LENGTH_MAX];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t window_count = JCFW_MIN(i + 1, length);
+        for (size_t j = 0; j < window_count; j++)
+        {
+            window[j] = samples[i - j];
+        }
+        qsort(window, window_count, sizeof(window[0]), compare_doubles);
+
+        const size_t middle = window_count / 2;
+        o_outputs[i]        = (window_count % 2) ? window[middle]
+                                                 : (window[middle - 1] + window[middle]) / 2.0;
+    }
+}
+
+static void reference_hysteresis(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count)
+{
+    double value = samples[0];
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (fabs(samples[i] - value) > config->hysteresis.threshold)
+        {
+            value = samples[i];
+        }
+
+        o_outputs[i] = value;
+    }
+}
+
+/// @brief A one-dimensional Kalman filter; The first sample is taken as the value, with the
+/// variance of a measurement.
+static void reference_kalman(
+    const jcfw_filter_config_t *config, const int32_t *samples, double *o_outputs, size_t count)
+{
+    const double process_variance     = config->kalman.process_variance_q8 / 256.0;
+    const double measurement_variance = config->kalman.measurement_variance_q8 / 256.0;
+    double       value                = samples[0];
+    double       variance             = measurement_variance;
+
+    o_outputs[0] = value;
+    for (size_t i = 1; i < count; i++)
+    {
+        variance += process_variance;
+
+        const double gain  = variance / (variance + measurement_variance);
+        value             += gain * (samples[i] - value);
+        variance          *= 1.0 - gain;
+
+        o_outputs[i] = value;
+    }
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    const double lhs = *(const double *)a;
+    const double rhs = *(const double *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/// @brief ALS readings under slowly changing light, with sensor noise, the odd dip and steps.
+static void generate(int32_t *o_samples, size_t count)
+{
+    double base = 2000.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // NOTE(Caleb): A light switched on or off, now and then.
+        if (random_u32() % 20000 == 0)
+        {
+            base = (base > 2000.0) ? 1500.0 : 3500.0;
+        }
+
+        double level = base + 1000.0 * sin((double)i / 5000.0) + (int)(random_u32() % 201) - 100;
+        if (random_u32() % 100 == 0)
+        {
+            level -= 1500.0;
+        }
+
+        o_samples[i] = (int32_t)lround(level);
+    }
+}
+
+static uint32_t random_u32(void)
+{
+    // NOTE(Caleb): xorshift32, so that every run (and every host) sees the same data.
+    s_random_state ^= s_random_state << 13;
+    s_random_state ^= s_random_state >> 17;
+    s_random_state ^= s_random_state << 5;
+    return s_random_state;
+}
@@ -0,0 +1,88 @@
+#include "host_harness.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+
+// -------------------------------------------------------------------------------------------------
+
+#define _HOST_HARNESS_WEAK __attribute__((weak))
+
+// -------------------------------------------------------------------------------------------------
+
+static void _host_harness_putchar(void *arg, char c, bool flush);
+
+// -------------------------------------------------------------------------------------------------
+
+void host_harness_init(void)
+{
+    jcfw_trace_init(_host_harness_putchar, NULL);
+}
+
+long host_harness_get_env_long(const char *name, long default_value)
+{
+    const char *value = getenv(name);
+    return value ? strtol(value, NULL, 0) : default_value;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void _host_harness_putchar(void *arg, char c, bool flush)
+{
+    putc(c, stdout);
+
+    if (flush)
+    {
+        fflush(stdout);
+    }
+}
+
+// PLATFORM ----------------------------------------------------------------------------------------
+
+_HOST_HARNESS_WEAK jcfw_result_e jcfw_platform_init(void)
+{
+    return JCFW_RESULT_OK;
+}
+
+_HOST_HARNESS_WEAK void jcfw_platform_on_assert(const char *file, int line, const char *format, ...)
+{
+    printf("ASSERTION FAILED at %s:%d - ", file, line);
+
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    abort();
+}
+
+_HOST_HARNESS_WEAK void jcfw_platform_crash(void)
+{
+    abort();
+}
+
+_HOST_HARNESS_WEAK bool jcfw_platform_trace_validate(const char *tag)
+{
+    return true;
+}
+
+_HOST_HARNESS_WEAK void jcfw_platform_delay_ms(uint32_t delay_ms)
+{
+    const struct timespec delay = {
+        .tv_sec  = delay_ms / 1000,
+        .tv_nsec = (long)(delay_ms % 1000) * 1000 * 1000,
+    };
+    nanosleep(&delay, NULL);
+}
+
+_HOST_HARNESS_WEAK uint64_t jcfw_platform_get_time_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 * 1000 + now.tv_nsec / 1000;
+}
@@ -0,0 +1,27 @@
+#ifndef __HOST_HARNESS_H__
+#define __HOST_HARNESS_H__
+
+#include "jcfw/detail/common.h"
+
+/* Notes:
+ * What the host-side tools (see: tools/) have in common. Each tool is an ESP-IDF project for the
+ * linux target; Build and run one with `idf.py --preview set-target linux && idf.py build monitor`
+ * from its directory. The tools which check something exit with a non-zero status if the check
+ * fails.
+ *
+ * The harness implements the platform functions which jcfw leaves to the application (see:
+ * jcfw/platform/platform.h): Traces and failed assertions are printed to stdout (and the latter
+ * abort), every trace tag is output, and time is the monotonic clock of the host. Each of them is
+ * weak, so a tool can replace it (e.g. with a virtual clock, or to silence the traces of jcfw).
+ */
+
+/// @brief Set up the harness. Call it first thing in app_main().
+void host_harness_init(void);
+
+/// @brief Get a number from the environment, for overriding the defaults of a tool.
+/// @param name The name of the environment variable.
+/// @param default_value The value to return if the variable isn't set.
+/// @return The value of the variable (in any base which strtol() accepts), or `default_value`.
+long host_harness_get_env_long(const char *name, long default_value);
+
+#endif // __HOST_HARNESS_H__
@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_harness.h"
+#include "jcfw/platform/i2c.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/platform/posix/i2c.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+/* Notes:
+ * A check that asynchronous I2C transactions (see: jcfw/platform/i2c.h) overlap with the work of
+ * the task which submits them, and with the transactions of other buses, on the host backend with
+ * its simulated bus time. Every transaction is a read of I2C_OVERLAP_DATA_SIZE bytes from a slow
+ * simulated device, and takes L (its bus time) on the bus. For I2C_OVERLAP_XFER_COUNT (N)
+ * transactions, it checks that:
+ *
+ *     submit      Submitting all N takes well under N * L, so the submitter doesn't stall on the
+ *                 bus, and they still all complete, one after another, in about N * L
+ *     pipeline    Submitting all N and then doing L worth of work for each takes well under
+ *                 running the blocking reads with the same work in between (about 2 * N * L)
+ *     buses       Splitting the N between two buses completes them in well under N * L
+ *
+ * "Well under" is I2C_OVERLAP_RATIO_MAX_PCT percent of the time without any overlap.
+ */
+
+#define TRACE_TAG                "I2C-OVERLAP"
+
+#define I2C_OVERLAP_XFER_COUNT   JCFW_I2C_QUEUE_DEPTH
+#define I2C_OVERLAP_DATA_SIZE    8
+
+/// @brief The SCL frequency of the simulated device; Slow, so that the bus time of each transaction
+/// dwarfs the scheduling noise of the host.
+#define I2C_OVERLAP_SCL_SPEED_HZ 10000
+
+#define I2C_OVERLAP_RATIO_MAX_PCT 75
+
+// -------------------------------------------------------------------------------------------------
+
+static bool     check_submit(uint64_t xfer_us);
+static bool     check_pipeline(uint64_t xfer_us);
+static bool     check_buses(uint64_t xfer_us);
+static bool     check_ratio(const char *name, uint64_t measured_us, uint64_t serial_us);
+static void     prepare_read(jcfw_i2c_xfer_t *xfer, jcfw_i2c_device_t *dev, uint8_t *o_data);
+static bool     wait_all(jcfw_i2c_xfer_t *xfers, size_t count);
+static void     work_us(uint64_t duration_us);
+static uint64_t elapsed_us(uint64_t start_us);
+
+static jcfw_result_e sim_read(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size);
+static jcfw_result_e sim_write(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size);
+
+// -------------------------------------------------------------------------------------------------
+
+static const uint8_t S_MEM_ADDR = 0x00;
+
+static jcfw_posix_i2c_device_t s_sim = {
+    .read         = sim_read,
+    .write        = sim_write,
+    .scl_speed_hz = I2C_OVERLAP_SCL_SPEED_HZ,
+};
+
+static jcfw_i2c_bus_t   *s_buses[2];
+static jcfw_i2c_device_t s_devices[2];
+
+static uint8_t s_data[I2C_OVERLAP_XFER_COUNT][I2C_OVERLAP_DATA_SIZE];
+
+void app_main(void)
+{
+    host_harness_init();
+
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(s_buses); i++)
+    {
+        JCFW_ASSERT(
+            jcfw_platform_i2c_bus_create(NULL, &s_buses[i]) == JCFW_RESULT_OK,
+            "error: Unable to create bus %lu",
+            (unsigned long)i);
+        JCFW_ASSERT(
+            jcfw_platform_i2c_device_init(&s_devices[i], s_buses[i], &s_sim, 0) == JCFW_RESULT_OK,
+            "error: Unable to register device %lu",
+            (unsigned long)i);
+    }
+
+    const uint64_t xfer_us =
+        jcfw_posix_i2c_bus_time_us(&s_sim, true, sizeof(S_MEM_ADDR), I2C_OVERLAP_DATA_SIZE);
+    printf(
+        "%lu transactions of %.2f ms each\n\n%-10s %10s %10s %8s\n",
+        (unsigned long)I2C_OVERLAP_XFER_COUNT,
+        (double)xfer_us / 1000.0,
+        "check",
+        "serial ms",
+        "ms",
+        "ratio");
+
+    bool is_ok  = true;
+    is_ok      &= check_submit(xfer_us);
+    is_ok      &= check_pipeline(xfer_us);
+    is_ok      &= check_buses(xfer_us);
+
+    exit(is_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool check_submit(uint64_t xfer_us)
+{
+    jcfw_i2c_xfer_t xfers[I2C_OVERLAP_XFER_COUNT];
+
+    const uint64_t start_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < I2C_OVERLAP_XFER_COUNT; i++)
+    {
+        prepare_read(&xfers[i], &s_devices[0], s_data[i]);
+        JCFW_ASSERT(
+            jcfw_platform_i2c_submit(&xfers[i]) == JCFW_RESULT_OK, "error: Unable to submit");
+    }
+    const uint64_t submit_us = elapsed_us(start_us);
+
+    bool is_ok = wait_all(xfers, I2C_OVERLAP_XFER_COUNT);
+
+    // NOTE(Caleb): One bus, so the transactions themselves can't overlap; They take as long as the
+    // simulated bus says, however they were submitted.
+    const uint64_t serial_us = I2C_OVERLAP_XFER_COUNT * xfer_us;
+    const uint64_t done_us   = elapsed_us(start_us);
+    is_ok &= check_ratio("submit", submit_us, serial_us);
+    JCFW_ERROR_IF_FALSE(
+        done_us >= serial_us * 9 / 10,
+        false,
+        "submit: Completed in %.2f ms, faster than the bus allows",
+        (double)done_us / 1000.0);
+
+    return is_ok;
+}
+
+static bool check_pipeline(uint64_t xfer_us)
+{
+    jcfw_i2c_xfer_t xfers[I2C_OVERLAP_XFER_COUNT];
+
+    uint64_t start_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < I2C_OVERLAP_XFER_COUNT; i++)
+    {
+        JCFW_ASSERT(
+            jcfw_platform_i2c_mstr_mem_read(
+                &s_devices[0],
+                &S_MEM_ADDR,
+                sizeof(S_MEM_ADDR),
+                s_data[i],
+                I2C_OVERLAP_DATA_SIZE,
+                JCFW_I2C_WAIT_FOREVER)
+                == JCFW_RESULT_OK,
+            "error: Unable to read");
+        work_us(xfer_us);
+    }
+    const uint64_t serial_us = elapsed_us(start_us);
+
+    start_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < I2C_OVERLAP_XFER_COUNT; i++)
+    {
+        prepare_read(&xfers[i], &s_devices[0], s_data[i]);
+        JCFW_ASSERT(
+            jcfw_platform_i2c_submit(&xfers[i]) == JCFW_RESULT_OK, "error: Unable to submit");
+    }
+    for (size_t i = 0; i < I2C_OVERLAP_XFER_COUNT; i++)
+    {
+        work_us(xfer_us);
+    }
+    bool is_ok = wait_all(xfers, I2C_OVERLAP_XFER_COUNT);
+
+    return check_ratio("pipeline", elapsed_us(start_us), serial_us) && is_ok;
+}
+
+static bool check_buses(uint64_t xfer_us)
+{
+    jcfw_i2c_xfer_t xfers[I2C_OVERLAP_XFER_COUNT];
+
+    const uint64_t start_us = jcfw_platform_get_time_us();
+    for (size_t i = 0; i < I2C_OVERLAP_XFER_COUNT; i++)
+    {
+        prepare_read(&xfers[i], &s_devices[i % JCFW_ARRAYSIZE(s_devices)], s_data[i]);
+        JCFW_ASSERT(
+            jcfw_platform_i2c_submit(&xfers[i]) == JCFW_RESULT_OK, "error: Unable to submit");
+    }
+    bool is_ok = wait_all(xfers, I2C_OVERLAP_XFER_COUNT);
+
+    return check_ratio("buses", elapsed_us(start_us), I2C_OVERLAP_XFER_COUNT * xfer_us) && is_ok;
+}
+
+static bool check_ratio(const char *name, uint64_t measured_us, uint64_t serial_us)
+{
+    const double ratio = (double)measured_us / (double)serial_us;
+    printf(
+        "%-10s %10.2f %10.2f %8.2f\n",
+        name,
+        (double)serial_us / 1000.0,
+        (double)measured_us / 1000.0,
+        ratio);
+
+    JCFW_ERROR_IF_FALSE(
+        measured_us * 100 <= serial_us * I2C_OVERLAP_RATIO_MAX_PCT,
+        false,
+        "%s: Took %.2f of the time without overlap",
+        name,
+        ratio);
+
+    return true;
+}
+
+static void prepare_read(jcfw_i2c_xfer_t *xfer, jcfw_i2c_device_t *dev, uint8_t *o_data)
+{
+    *xfer = (jcfw_i2c_xfer_t){
+        .device        = dev,
+        .type          = JCFW_I2C_XFER_TYPE_READ,
+        .mem_addr      = &S_MEM_ADDR,
+        .mem_addr_size = sizeof(S_MEM_ADDR),
+        .o_data        = o_data,
+        .data_size     = I2C_OVERLAP_DATA_SIZE,
+        .timeout_ms    = JCFW_I2C_WAIT_FOREVER,
+    };
+}
+
+static bool wait_all(jcfw_i2c_xfer_t *xfers, size_t count)
+{
+    const struct timespec poll = {.tv_sec = 0, .tv_nsec = 100 * 1000};
+
+    bool is_ok = true;
+    for (size_t i = 0; i < count; i++)
+    {
+        while (!jcfw_platform_i2c_is_done(&xfers[i]))
+        {
+            nanosleep(&poll, NULL);
+        }
+
+        is_ok &= xfers[i].result == JCFW_RESULT_OK;
+    }
+
+    JCFW_ERROR_IF_FALSE(is_ok, false, "error: A transaction failed");
+    return true;
+}
+
+/// @brief Stand in for the work of the submitting task, e.g. processing the last reading.
+static void work_us(uint64_t duration_us)
+{
+    const uint64_t start_us = jcfw_platform_get_time_us();
+    while (elapsed_us(start_us) < duration_us)
+    {
+    }
+}
+
+static uint64_t elapsed_us(uint64_t start_us)
+{
+    return jcfw_platform_get_time_us() - start_us;
+}
+
+static jcfw_result_e sim_read(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size)
+{
+    memset(o_data, mem_addr[0], data_size);
+    return JCFW_RESULT_OK;
+}
+
+static jcfw_result_e sim_write(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size)
+{
+    return JCFW_RESULT_OK;
+}
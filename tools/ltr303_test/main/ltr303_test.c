@@ -0,0 +1,411 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "host_harness.h"
+#include "jcfw/driver/als/ltr303.h"
+#include "jcfw/platform/i2c.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/platform/posix/i2c.h"
+#include "jcfw/platform/posix/ltr303_sim.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+/* Notes:
+ * A test of the LTR303 driver (jcfw/driver/als/ltr303.h) for the host (the linux target). The
+ * driver talks to the simulated sensor (see: jcfw/platform/posix/ltr303_sim.h) through a managed
+ * I2C bus, exactly as it would to the real one, and each case checks what the driver did against
+ * what the simulation saw:
+ *
+ *     probe       The identity check, which must not change the state of the device, and a device
+ *                 which does not answer
+ *     apply       Configuration through jcfw_ltr303_apply_config(), and that re-applying a
+ *                 configuration only writes the registers which changed
+ *     interrupt   Fixed thresholds; Every conversion outside of them raises exactly one interrupt,
+ *                 and the INT line follows
+ *     window      The adaptive window; Steady light raises no interrupts and writes nothing, and a
+ *                 step raises exactly the interrupts that the window predicts
+ *
+ * The simulation runs on a virtual clock (jcfw_platform_delay_ms() advances it too), and the
+ * simulated bus time is disabled, so the whole run takes a fraction of a second.
+ *
+ * It exits with a non-zero status if any check fails.
+ */
+
+#define TRACE_TAG                  "LTR303-TEST"
+
+#define TEST_I2C_TIMEOUT_MS        10
+
+/// @brief The adaptive window used by the window case.
+#define TEST_WINDOW_DEADBAND_PCT   20
+#define TEST_WINDOW_DEADBAND_ABS   10
+
+#define TEST_CHECK(cond)           check((cond), #cond, __LINE__)
+
+// -------------------------------------------------------------------------------------------------
+
+static void test_probe(void);
+static void test_apply(void);
+static void test_interrupt(void);
+static void test_window(void);
+
+static void     setup(const jcfw_posix_ltr303_sim_sample_t *trace, size_t trace_len);
+static void     teardown(void);
+static void     advance_to_next_conversion(void);
+static void     wait_for_async_write(void);
+static bool     is_int_asserted(void);
+static uint16_t read_channel0(void);
+static void     check(bool is_ok, const char *expression, int line);
+static uint64_t get_sim_time_us(void *ctx);
+
+static jcfw_result_e dead_read(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size);
+static jcfw_result_e dead_write(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size);
+
+// -------------------------------------------------------------------------------------------------
+
+static const jcfw_posix_ltr303_sim_sample_t S_STEADY_TRACE[] = {
+    {.time_us = 0, .lux = 200.0f, .ir_ratio = 0.25f},
+};
+
+// NOTE(Caleb): 100 lux, then a step to 1000 lux for a second, then back to 100 lux.
+static const jcfw_posix_ltr303_sim_sample_t S_STEP_TRACE[] = {
+    {.time_us = 0, .lux = 100.0f, .ir_ratio = 0.25f},
+    {.time_us = 999999, .lux = 100.0f, .ir_ratio = 0.25f},
+    {.time_us = 1000000, .lux = 1000.0f, .ir_ratio = 0.25f},
+    {.time_us = 1999999, .lux = 1000.0f, .ir_ratio = 0.25f},
+    {.time_us = 2000000, .lux = 100.0f, .ir_ratio = 0.25f},
+};
+
+// NOTE(Caleb): 200 lux, a slow drift which stays inside of the window, then a step out of it.
+static const jcfw_posix_ltr303_sim_sample_t S_WINDOW_TRACE[] = {
+    {.time_us = 0, .lux = 200.0f, .ir_ratio = 0.25f},
+    {.time_us = 1000000, .lux = 200.0f, .ir_ratio = 0.25f},
+    {.time_us = 2000000, .lux = 220.0f, .ir_ratio = 0.25f},
+    {.time_us = 2999999, .lux = 220.0f, .ir_ratio = 0.25f},
+    {.time_us = 3000000, .lux = 2000.0f, .ir_ratio = 0.25f},
+};
+
+static uint64_t                s_sim_time_us = 0;
+static jcfw_posix_ltr303_sim_t s_sim;
+static jcfw_i2c_bus_t         *s_bus = NULL;
+static jcfw_i2c_device_t       s_device;
+static jcfw_ltr303_t           s_ltr303;
+static uint32_t                s_check_count   = 0;
+static uint32_t                s_failure_count = 0;
+
+void app_main(void)
+{
+    host_harness_init();
+    jcfw_posix_i2c_set_time_scale(0);
+
+    jcfw_result_e err = jcfw_platform_i2c_bus_create(NULL, &s_bus);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to create the I2C bus (rc %u)", err);
+
+    // NOTE(Caleb): Each case sets the simulation up again, but the device stays where it is, so it
+    // is only registered once.
+    err = jcfw_platform_i2c_device_init(
+        &s_device, s_bus, jcfw_posix_ltr303_sim_get_device(&s_sim), 1);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to register the device (rc %u)", err);
+
+    test_probe();
+    test_apply();
+    test_interrupt();
+    test_window();
+
+    printf(
+        "%lu checks, %lu failed\n",
+        (unsigned long)s_check_count,
+        (unsigned long)s_failure_count);
+    exit((s_failure_count == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void test_probe(void)
+{
+    JCFW_TRACELN_INFO(TRACE_TAG, "probe");
+
+    setup(S_STEADY_TRACE, JCFW_ARRAYSIZE(S_STEADY_TRACE));
+
+    TEST_CHECK(jcfw_ltr303_probe(&s_ltr303, &s_device, TEST_I2C_TIMEOUT_MS) == JCFW_RESULT_OK);
+
+    jcfw_posix_ltr303_sim_stats_t stats;
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &stats);
+    TEST_CHECK(stats.read_count == 1);
+    TEST_CHECK(stats.write_count == 0);
+
+    teardown();
+
+    // NOTE(Caleb): A device which NAKs everything, as if nothing were on the bus.
+    static jcfw_posix_i2c_device_t dead = {.read = dead_read, .write = dead_write};
+    static jcfw_i2c_device_t       dead_device;
+
+    jcfw_platform_i2c_device_init(&dead_device, s_bus, &dead, 1);
+    TEST_CHECK(jcfw_ltr303_probe(&s_ltr303, &dead_device, TEST_I2C_TIMEOUT_MS) != JCFW_RESULT_OK);
+}
+
+static void test_apply(void)
+{
+    JCFW_TRACELN_INFO(TRACE_TAG, "apply");
+
+    setup(S_STEADY_TRACE, JCFW_ARRAYSIZE(S_STEADY_TRACE));
+    TEST_CHECK(jcfw_ltr303_init(&s_ltr303, &s_device, TEST_I2C_TIMEOUT_MS) == JCFW_RESULT_OK);
+
+    jcfw_ltr303_config_t cfg = JCFW_LTR303_CONFIG_DEFAULT;
+    cfg.mode                 = JCFW_LTR303_MODE_ACTIVE;
+    cfg.gain                 = JCFW_LTR303_GAIN_2X;
+    cfg.measurement_rate     = JCFW_LTR303_MEAS_RATE_100MS;
+    cfg.interrupt_enable     = true;
+    cfg.threshold_low        = 100;
+    cfg.threshold_high       = 1000;
+    TEST_CHECK(jcfw_ltr303_apply_config(&s_ltr303, &cfg, true) == JCFW_RESULT_OK);
+
+    jcfw_ltr303_mode_e mode = JCFW_LTR303_MODE_STANDBY;
+    TEST_CHECK(jcfw_ltr303_get_mode(&s_ltr303, &mode) == JCFW_RESULT_OK);
+    TEST_CHECK(mode == JCFW_LTR303_MODE_ACTIVE);
+
+    // NOTE(Caleb): 200 lux at 2x is 400 counts, inside of the thresholds.
+    advance_to_next_conversion();
+    uint8_t  gain_factor = 0;
+    uint16_t channel0    = 0;
+    TEST_CHECK(jcfw_ltr303_read(&s_ltr303, &channel0, NULL, &gain_factor) == JCFW_RESULT_OK);
+    TEST_CHECK(gain_factor == 2);
+    TEST_CHECK(channel0 == 400);
+    TEST_CHECK(!is_int_asserted());
+
+    jcfw_posix_ltr303_sim_stats_t before;
+    jcfw_posix_ltr303_sim_stats_t after;
+
+    // NOTE(Caleb): Nothing changed, so nothing is written.
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &before);
+    TEST_CHECK(jcfw_ltr303_apply_config(&s_ltr303, &cfg, true) == JCFW_RESULT_OK);
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &after);
+    TEST_CHECK(after.write_count == before.write_count);
+
+    // NOTE(Caleb): Only the upper threshold changed, which is one write.
+    cfg.threshold_high = 300;
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &before);
+    TEST_CHECK(jcfw_ltr303_apply_config(&s_ltr303, &cfg, true) == JCFW_RESULT_OK);
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &after);
+    TEST_CHECK(after.write_count == before.write_count + 1);
+
+    advance_to_next_conversion();
+    TEST_CHECK(is_int_asserted());
+
+    teardown();
+}
+
+static void test_interrupt(void)
+{
+    JCFW_TRACELN_INFO(TRACE_TAG, "interrupt");
+
+    setup(S_STEP_TRACE, JCFW_ARRAYSIZE(S_STEP_TRACE));
+    TEST_CHECK(jcfw_ltr303_init(&s_ltr303, &s_device, TEST_I2C_TIMEOUT_MS) == JCFW_RESULT_OK);
+
+    jcfw_ltr303_config_t cfg = JCFW_LTR303_CONFIG_DEFAULT;
+    cfg.mode                 = JCFW_LTR303_MODE_ACTIVE;
+    cfg.measurement_rate     = JCFW_LTR303_MEAS_RATE_100MS;
+    cfg.interrupt_enable     = true;
+    cfg.threshold_low        = 50;
+    cfg.threshold_high       = 500;
+    cfg.persistance          = 0;
+    TEST_CHECK(jcfw_ltr303_apply_config(&s_ltr303, &cfg, true) == JCFW_RESULT_OK);
+
+    uint32_t expected_count = 0;
+    for (int i = 0; i < 30; i++)
+    {
+        advance_to_next_conversion();
+
+        // NOTE(Caleb): The INT line is checked before the read clears it.
+        const bool     is_asserted = is_int_asserted();
+        const uint16_t channel0    = read_channel0();
+        const bool     is_outside  = channel0 < cfg.threshold_low || channel0 > cfg.threshold_high;
+
+        TEST_CHECK(is_asserted == is_outside);
+        expected_count += is_outside;
+    }
+
+    jcfw_posix_ltr303_sim_stats_t stats;
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &stats);
+    TEST_CHECK(expected_count >= 9);
+    TEST_CHECK(stats.interrupt_count == expected_count);
+    TEST_CHECK(stats.missed_count == 0);
+
+    teardown();
+}
+
+static void test_window(void)
+{
+    JCFW_TRACELN_INFO(TRACE_TAG, "window");
+
+    setup(S_WINDOW_TRACE, JCFW_ARRAYSIZE(S_WINDOW_TRACE));
+    TEST_CHECK(jcfw_ltr303_init(&s_ltr303, &s_device, TEST_I2C_TIMEOUT_MS) == JCFW_RESULT_OK);
+
+    jcfw_ltr303_config_t cfg = JCFW_LTR303_CONFIG_DEFAULT;
+    cfg.mode                 = JCFW_LTR303_MODE_ACTIVE;
+    cfg.measurement_rate     = JCFW_LTR303_MEAS_RATE_100MS;
+    cfg.interrupt_enable     = true;
+    TEST_CHECK(jcfw_ltr303_apply_config(&s_ltr303, &cfg, true) == JCFW_RESULT_OK);
+
+    const jcfw_ltr303_window_config_t window = {
+        .deadband_percent = TEST_WINDOW_DEADBAND_PCT,
+        .deadband_abs     = TEST_WINDOW_DEADBAND_ABS,
+        .persistance      = 0,
+    };
+    TEST_CHECK(jcfw_ltr303_enable_adaptive_window(&s_ltr303, &window) == JCFW_RESULT_OK);
+
+    // NOTE(Caleb): Until the first read, the configured thresholds (the full range) apply.
+    uint32_t threshold_low  = cfg.threshold_low;
+    uint32_t threshold_high = cfg.threshold_high;
+    uint32_t expected_count = 0;
+    uint32_t steady_writes  = 0;
+    uint16_t last_channel0  = 0;
+
+    for (int i = 0; i < 40; i++)
+    {
+        advance_to_next_conversion();
+
+        jcfw_posix_ltr303_sim_stats_t before;
+        jcfw_posix_ltr303_sim_get_stats(&s_sim, &before);
+
+        const bool     is_asserted = is_int_asserted();
+        const uint16_t channel0    = read_channel0();
+        const bool     is_outside  = channel0 < threshold_low || channel0 > threshold_high;
+        wait_for_async_write();
+
+        jcfw_posix_ltr303_sim_stats_t after;
+        jcfw_posix_ltr303_sim_get_stats(&s_sim, &after);
+
+        TEST_CHECK(is_asserted == is_outside);
+        expected_count += is_outside;
+
+        // NOTE(Caleb): A reading which did not move re-centers the window on the same thresholds.
+        if (i > 0 && channel0 == last_channel0)
+        {
+            steady_writes += after.write_count - before.write_count;
+        }
+
+        uint32_t deadband = (uint32_t)channel0 * TEST_WINDOW_DEADBAND_PCT / 100;
+        deadband          = JCFW_MAX(deadband, TEST_WINDOW_DEADBAND_ABS);
+        threshold_low     = (channel0 > deadband) ? channel0 - deadband : 0;
+        threshold_high    = JCFW_MIN(channel0 + deadband, 0xFFFFu);
+        last_channel0     = channel0;
+    }
+
+    jcfw_posix_ltr303_sim_stats_t stats;
+    jcfw_posix_ltr303_sim_get_stats(&s_sim, &stats);
+    TEST_CHECK(steady_writes == 0);
+    TEST_CHECK(expected_count >= 1);
+    TEST_CHECK(stats.interrupt_count == expected_count);
+    TEST_CHECK(stats.missed_count == 0);
+
+    teardown();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void setup(const jcfw_posix_ltr303_sim_sample_t *trace, size_t trace_len)
+{
+    s_sim_time_us = 0;
+
+    const jcfw_posix_ltr303_sim_config_t cfg = {
+        .trace       = trace,
+        .trace_len   = trace_len,
+        .get_time_us = get_sim_time_us,
+    };
+
+    jcfw_result_e err = jcfw_posix_ltr303_sim_init(&s_sim, &cfg);
+    JCFW_ASSERT(err == JCFW_RESULT_OK, "error: Unable to set up the simulation (rc %u)", err);
+}
+
+static void teardown(void)
+{
+    wait_for_async_write();
+    jcfw_posix_ltr303_sim_deinit(&s_sim);
+}
+
+static void advance_to_next_conversion(void)
+{
+    const uint64_t next_us = jcfw_posix_ltr303_sim_get_next_conversion_us(&s_sim);
+    JCFW_ASSERT(next_us != UINT64_MAX, "error: The simulated device is in standby");
+
+    s_sim_time_us = JCFW_MAX(s_sim_time_us, next_us);
+    jcfw_posix_ltr303_sim_update(&s_sim);
+}
+
+static void wait_for_async_write(void)
+{
+    while (s_ltr303.async_xfer.state == JCFW_I2C_XFER_STATE_QUEUED
+           || s_ltr303.async_xfer.state == JCFW_I2C_XFER_STATE_ACTIVE)
+    {
+        jcfw_platform_delay_ms(0);
+    }
+}
+
+static bool is_int_asserted(void)
+{
+    // NOTE(Caleb): Every case leaves the interrupt polarity at its default (active low).
+    return !jcfw_posix_ltr303_sim_get_int_level(&s_sim);
+}
+
+static uint16_t read_channel0(void)
+{
+    bool is_data_ready = false;
+    TEST_CHECK(jcfw_ltr303_is_data_ready(&s_ltr303, &is_data_ready) == JCFW_RESULT_OK);
+    TEST_CHECK(is_data_ready);
+
+    uint16_t channel0 = 0;
+    TEST_CHECK(jcfw_ltr303_read(&s_ltr303, &channel0, NULL, NULL) == JCFW_RESULT_OK);
+
+    return channel0;
+}
+
+static void check(bool is_ok, const char *expression, int line)
+{
+    s_check_count++;
+
+    if (!is_ok)
+    {
+        s_failure_count++;
+        JCFW_TRACELN_ERROR(TRACE_TAG, "Check failed at line %d: %s", line, expression);
+    }
+}
+
+static uint64_t get_sim_time_us(void *ctx)
+{
+    return s_sim_time_us;
+}
+
+static jcfw_result_e dead_read(
+    void *ctx, const uint8_t *mem_addr, size_t mem_addr_size, uint8_t *o_data, size_t data_size)
+{
+    return JCFW_RESULT_ERROR;
+}
+
+static jcfw_result_e dead_write(
+    void          *ctx,
+    const uint8_t *mem_addr,
+    size_t         mem_addr_size,
+    const uint8_t *data,
+    size_t         data_size)
+{
+    return JCFW_RESULT_ERROR;
+}
+
+// PLATFORM ----------------------------------------------------------------------------------------
+
+void jcfw_platform_delay_ms(uint32_t delay_ms)
+{
+    // NOTE(Caleb): The driver's delays (e.g. after a soft reset) are spent on the virtual clock.
+    s_sim_time_us += (uint64_t)delay_ms * 1000;
+
+    const struct timespec yield = {.tv_sec = 0, .tv_nsec = 100 * 1000};
+    nanosleep(&yield, NULL);
+}
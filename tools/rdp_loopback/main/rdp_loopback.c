@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_harness.h"
+#include "jcfw/net/rdp.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+/* Notes:
+ * A loopback test of the reliable datagram protocol (see: jcfw/net/rdp.h) for the host (the linux
+ * target). A sender and a receiver talk to each other through a simulated network, which loses
+ * datagrams in both directions at a given rate and delivers the rest after a random delay (so they
+ * also arrive out of order). Time is virtual, so each run takes a fraction of a second.
+ *
+ * Every payload carries its own number, and the test tracks what became of each one. For every
+ * loss rate, it checks that:
+ * - No payload was delivered more than once.
+ * - Every payload was either delivered, or handed to the drop callback, or both. A payload can be
+ *   both when it arrived but every one of its ACKs was lost, so the sender gave up on it; These are
+ *   counted separately, so that `delivered + dropped - both == sent`.
+ *
+ * The number of payloads per loss rate is RDP_LOOPBACK_PAYLOAD_COUNT, or the value of the
+ * RDP_LOOPBACK_PAYLOAD_COUNT environment variable.
+ *
+ * It exits with a non-zero status if any check fails.
+ */
+
+#define TRACE_TAG                      "RDP-LB"
+
+#define RDP_LOOPBACK_PAYLOAD_COUNT     5000
+#define RDP_LOOPBACK_PAYLOAD_SIZE      64
+
+/// @brief How often a payload is offered to the sender, and how often the sender is polled, in us.
+#define RDP_LOOPBACK_SEND_PERIOD_US    (5 * 1000)
+#define RDP_LOOPBACK_TICK_US           (1 * 1000)
+
+/// @brief The range of delays of the simulated network, in us.
+#define RDP_LOOPBACK_DELAY_MIN_US      (2 * 1000)
+#define RDP_LOOPBACK_DELAY_MAX_US      (5 * 1000)
+
+/// @brief The number of datagrams which the simulated network can hold at once.
+#define RDP_LOOPBACK_NETWORK_DEPTH     256
+
+// -------------------------------------------------------------------------------------------------
+
+typedef enum
+{
+    DIRECTION_TO_RECEIVER = 0,
+    DIRECTION_TO_SENDER,
+} direction_e;
+
+typedef struct
+{
+    uint64_t    arrival_us;
+    direction_e direction;
+    uint16_t    length;
+    uint8_t     datagram[JCFW_RDP_DATAGRAM_SIZE_MAX];
+} in_transit_t;
+
+typedef struct
+{
+    uint8_t delivered_count;
+    bool    is_dropped;
+} payload_fate_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static bool          run(double loss_rate, uint32_t payload_count);
+static jcfw_result_e network_send(const uint8_t *datagram, size_t length, void *arg);
+static void          network_poll(void);
+static void          on_deliver(const uint8_t *payload, size_t length, uint64_t send_us, void *arg);
+static void          on_drop(const uint8_t *payload, size_t length, void *arg);
+static uint32_t      get_payload_number(const uint8_t *payload, size_t length);
+static uint32_t      random_u32(void);
+
+// -------------------------------------------------------------------------------------------------
+
+static const double S_LOSS_RATES[] = {0.0, 0.01, 0.05, 0.2, 0.5, 0.7};
+
+static uint64_t            s_now_us = 0;
+static double              s_loss_rate;
+static in_transit_t        s_network[RDP_LOOPBACK_NETWORK_DEPTH];
+static size_t              s_network_count = 0;
+static jcfw_rdp_sender_t   s_sender;
+static jcfw_rdp_receiver_t s_receiver;
+static payload_fate_t     *s_fates        = NULL;
+static uint32_t            s_payload_count = 0;
+static uint32_t            s_random_state  = 0x12345678;
+
+void app_main(void)
+{
+    host_harness_init();
+
+    const long payload_count =
+        host_harness_get_env_long("RDP_LOOPBACK_PAYLOAD_COUNT", RDP_LOOPBACK_PAYLOAD_COUNT);
+    JCFW_ASSERT(payload_count > 0, "error: Invalid payload count %ld", payload_count);
+
+    printf(
+        "%6s %9s %9s %9s %6s %6s %9s %8s\n",
+        "loss",
+        "sent",
+        "delivered",
+        "dropped",
+        "both",
+        "dups",
+        "rtx",
+        "srtt us");
+
+    bool is_ok = true;
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(S_LOSS_RATES); i++)
+    {
+        is_ok &= run(S_LOSS_RATES[i], (uint32_t)payload_count);
+    }
+
+    exit(is_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool run(double loss_rate, uint32_t payload_count)
+{
+    s_now_us        = 0;
+    s_loss_rate     = loss_rate;
+    s_network_count = 0;
+    s_payload_count = payload_count;
+    s_fates         = calloc(payload_count, sizeof(*s_fates));
+    JCFW_ASSERT(s_fates, "error: Out of memory");
+
+    const jcfw_rdp_sender_config_t sender_config = {
+        .session     = random_u32(),
+        .send_cb     = network_send,
+        .send_cb_arg = (void *)DIRECTION_TO_RECEIVER,
+        .drop_cb     = on_drop,
+    };
+    const jcfw_rdp_receiver_config_t receiver_config = {
+        .deliver_cb  = on_deliver,
+        .send_cb     = network_send,
+        .send_cb_arg = (void *)DIRECTION_TO_SENDER,
+    };
+
+    jcfw_rdp_sender_init(&s_sender, &sender_config);
+    jcfw_rdp_receiver_init(&s_receiver, &receiver_config);
+
+    uint32_t sent_count   = 0;
+    uint64_t next_send_us = 0;
+    while (sent_count < payload_count || jcfw_rdp_sender_get_in_flight(&s_sender) > 0
+           || s_network_count > 0)
+    {
+        // NOTE(Caleb): A payload which doesn't fit the window is offered again next time, just like
+        // the batcher does with a full window.
+        if (sent_count < payload_count && s_now_us >= next_send_us)
+        {
+            uint8_t payload[RDP_LOOPBACK_PAYLOAD_SIZE] = {0};
+            memcpy(payload, &sent_count, sizeof(sent_count));
+
+            if (jcfw_rdp_sender_send(&s_sender, payload, sizeof(payload), s_now_us)
+                == JCFW_RESULT_OK)
+            {
+                sent_count++;
+            }
+
+            next_send_us += RDP_LOOPBACK_SEND_PERIOD_US;
+        }
+
+        network_poll();
+        jcfw_rdp_sender_poll(&s_sender, s_now_us);
+
+        s_now_us += RDP_LOOPBACK_TICK_US;
+    }
+
+    uint32_t delivered_count = 0;
+    uint32_t dropped_count   = 0;
+    uint32_t both_count      = 0;
+    uint32_t duplicate_count = 0;
+    uint32_t missing_count   = 0;
+
+    for (uint32_t i = 0; i < payload_count; i++)
+    {
+        const payload_fate_t *fate = &s_fates[i];
+
+        delivered_count += fate->delivered_count > 0;
+        dropped_count   += fate->is_dropped;
+        both_count      += fate->delivered_count > 0 && fate->is_dropped;
+        duplicate_count += (fate->delivered_count > 1) ? fate->delivered_count - 1 : 0;
+        missing_count   += fate->delivered_count == 0 && !fate->is_dropped;
+    }
+
+    free(s_fates);
+    s_fates = NULL;
+
+    jcfw_rdp_sender_stats_t stats;
+    jcfw_rdp_sender_get_stats(&s_sender, &stats);
+
+    printf(
+        "%5.0f%% %9lu %9lu %9lu %6lu %6lu %9lu %8lu\n",
+        loss_rate * 100.0,
+        (unsigned long)sent_count,
+        (unsigned long)delivered_count,
+        (unsigned long)dropped_count,
+        (unsigned long)both_count,
+        (unsigned long)duplicate_count,
+        (unsigned long)stats.retransmit_count,
+        (unsigned long)stats.srtt_us);
+
+    JCFW_ERROR_IF_FALSE(
+        duplicate_count == 0,
+        false,
+        "%.0f%% loss: %lu payloads were delivered more than once",
+        loss_rate * 100.0,
+        (unsigned long)duplicate_count);
+    JCFW_ERROR_IF_FALSE(
+        missing_count == 0,
+        false,
+        "%.0f%% loss: %lu payloads were neither delivered nor dropped",
+        loss_rate * 100.0,
+        (unsigned long)missing_count);
+    JCFW_ERROR_IF_FALSE(
+        delivered_count + dropped_count - both_count == sent_count,
+        false,
+        "%.0f%% loss: delivered + dropped != sent",
+        loss_rate * 100.0);
+    JCFW_ERROR_IF_FALSE(
+        dropped_count == stats.drop_count,
+        false,
+        "%.0f%% loss: %lu payloads dropped, but the sender counted %lu",
+        loss_rate * 100.0,
+        (unsigned long)dropped_count,
+        (unsigned long)stats.drop_count);
+
+    return true;
+}
+
+static jcfw_result_e network_send(const uint8_t *datagram, size_t length, void *arg)
+{
+    // NOTE(Caleb): A lost datagram was still sent as far as the protocol can tell.
+    if ((double)random_u32() / (double)UINT32_MAX < s_loss_rate)
+    {
+        return JCFW_RESULT_OK;
+    }
+
+    JCFW_ASSERT(s_network_count < RDP_LOOPBACK_NETWORK_DEPTH, "error: The network is full");
+    JCFW_ASSERT(
+        length <= JCFW_RDP_DATAGRAM_SIZE_MAX,
+        "error: Datagram too long (%lu)",
+        (unsigned long)length);
+
+    const uint32_t delay_us =
+        RDP_LOOPBACK_DELAY_MIN_US
+        + random_u32() % (RDP_LOOPBACK_DELAY_MAX_US - RDP_LOOPBACK_DELAY_MIN_US + 1);
+
+    in_transit_t *in_transit = &s_network[s_network_count++];
+    in_transit->arrival_us   = s_now_us + delay_us;
+    in_transit->direction    = (direction_e)(uintptr_t)arg;
+    in_transit->length       = (uint16_t)length;
+    memcpy(in_transit->datagram, datagram, length);
+
+    return JCFW_RESULT_OK;
+}
+
+static void network_poll(void)
+{
+    size_t i = 0;
+    while (i < s_network_count)
+    {
+        if (s_network[i].arrival_us > s_now_us)
+        {
+            i++;
+            continue;
+        }
+
+        // NOTE(Caleb): Copied out first, since handling it may send more datagrams.
+        in_transit_t in_transit = s_network[i];
+        s_network[i]            = s_network[--s_network_count];
+
+        if (in_transit.direction == DIRECTION_TO_RECEIVER)
+        {
+            jcfw_rdp_receiver_on_receive(&s_receiver, in_transit.datagram, in_transit.length);
+        }
+        else
+        {
+            jcfw_rdp_sender_on_receive(
+                &s_sender, in_transit.datagram, in_transit.length, s_now_us);
+        }
+    }
+}
+
+static void on_deliver(const uint8_t *payload, size_t length, uint64_t send_us, void *arg)
+{
+    s_fates[get_payload_number(payload, length)].delivered_count++;
+}
+
+static void on_drop(const uint8_t *payload, size_t length, void *arg)
+{
+    s_fates[get_payload_number(payload, length)].is_dropped = true;
+}
+
+static uint32_t get_payload_number(const uint8_t *payload, size_t length)
+{
+    JCFW_ASSERT(
+        length == RDP_LOOPBACK_PAYLOAD_SIZE, "error: Payload length %lu", (unsigned long)length);
+
+    uint32_t number;
+    memcpy(&number, payload, sizeof(number));
+    JCFW_ASSERT(number < s_payload_count, "error: Payload number %lu", (unsigned long)number);
+
+    return number;
+}
+
+static uint32_t random_u32(void)
+{
+    // NOTE(Caleb): xorshift32, so that every run (and every host) sees the same losses.
+    s_random_state ^= s_random_state << 13;
+    s_random_state ^= s_random_state >> 17;
+    s_random_state ^= s_random_state << 5;
+    return s_random_state;
+}
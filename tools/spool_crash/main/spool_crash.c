@@ -0,0 +1,413 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "host_harness.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/platform/posix/flash.h"
+#include "jcfw/telemetry/spool.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+#include "jcfw/util/math.h"
+
+/* Notes:
+ * A crash consistency test of the telemetry spool (see: jcfw/telemetry/spool.h) for the host (the
+ * linux target). For each scenario, a spool is brought into some state and saved, and then one
+ * operation (an append or a consume) is run on it over and over, each time from the saved state
+ * and with the power cut after one more byte (see: jcfw_posix_flash_set_power_budget()), until the
+ * operation completes. So the power goes out at every byte of every write and erase which the
+ * operation does. After every cut, the spool is reopened and drained, and:
+ * - Every record which comes back must be intact, and come back at most once and in order.
+ * - No record other than those which were pending, and the one being appended, may come back.
+ * - No pending record may be lost, except for the oldest ones when the append had to drop them,
+ *   or the head when it was being consumed.
+ * - The record being appended must come back (and the head must not) if the operation completed.
+ * - A record appended after recovering must survive another reopen.
+ *
+ * The scenarios cover an append onto an empty region, an append in the middle of a segment, a
+ * consume, an append which starts a new segment in place of one which has been consumed, and an
+ * append which starts a new segment by dropping the oldest records.
+ *
+ * The spool is kept in SPOOL_CRASH_PATH, or in the file named by the SPOOL_CRASH_PATH environment
+ * variable, which is removed afterwards. The region is only SPOOL_CRASH_SECTOR_COUNT sectors, so
+ * that the full scenarios drain quickly after each of the thousands of cuts.
+ *
+ * It exits with a non-zero status if any record is torn, duplicated, reordered, lost or made up
+ * after any cut.
+ */
+
+#define TRACE_TAG                      "SPOOL"
+
+#define SPOOL_CRASH_PATH               "spool_crash.bin"
+
+/// @brief The size of the region, in sectors.
+#define SPOOL_CRASH_SECTOR_COUNT       4
+#define SPOOL_CRASH_REGION_SIZE        (SPOOL_CRASH_SECTOR_COUNT * JCFW_FLASH_POSIX_SECTOR_SIZE)
+
+/// @brief The most records that the region can hold.
+#define SPOOL_CRASH_RECORD_COUNT_MAX                                                               \
+    (SPOOL_CRASH_REGION_SIZE / JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE)
+
+/// @brief The number of records pending before the appends and consumes in the middle of a
+/// segment.
+#define SPOOL_CRASH_PENDING_COUNT      3
+
+// -------------------------------------------------------------------------------------------------
+
+typedef enum
+{
+    OP_APPEND,
+    OP_CONSUME,
+} op_e;
+
+typedef void (*setup_f)(jcfw_telemetry_spool_t *spool);
+
+typedef struct
+{
+    const char *name;
+    setup_f     setup;
+    op_e        op;
+
+    /// @brief Whether the operation may drop the oldest pending records.
+    bool may_drop;
+} scenario_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static bool     run(const scenario_t *scenario, const char *path);
+static bool     check(
+    const scenario_t *scenario,
+    const char       *path,
+    const uint32_t   *pending_ids,
+    size_t            pending_count,
+    bool              is_done);
+static bool     drain(jcfw_telemetry_spool_t *spool, uint32_t *o_ids, size_t *o_count);
+static void     setup_empty(jcfw_telemetry_spool_t *spool);
+static void     setup_pending(jcfw_telemetry_spool_t *spool);
+static void     setup_consumed(jcfw_telemetry_spool_t *spool);
+static void     setup_full(jcfw_telemetry_spool_t *spool);
+static bool     will_start_segment(const jcfw_telemetry_spool_t *spool, uint32_t id);
+static void     append(jcfw_telemetry_spool_t *spool, uint32_t id);
+static size_t   make_record(uint32_t id, uint8_t *o_record);
+static bool     load_image(const char *path, uint8_t *o_image);
+static bool     store_image(const char *path, const uint8_t *image);
+
+// -------------------------------------------------------------------------------------------------
+
+static const scenario_t S_SCENARIOS[] = {
+    {.name = "append, empty", .setup = setup_empty, .op = OP_APPEND},
+    {.name = "append", .setup = setup_pending, .op = OP_APPEND},
+    {.name = "consume", .setup = setup_pending, .op = OP_CONSUME},
+    {.name = "append, erase", .setup = setup_consumed, .op = OP_APPEND},
+    {.name = "append, drop", .setup = setup_full, .op = OP_APPEND, .may_drop = true},
+};
+
+/// @brief The id of the next record to append.
+static uint32_t s_next_id = 1;
+
+static uint8_t s_image[SPOOL_CRASH_REGION_SIZE];
+
+void app_main(void)
+{
+    host_harness_init();
+
+    const char *path = getenv("SPOOL_CRASH_PATH");
+    path             = path ? path : SPOOL_CRASH_PATH;
+
+    bool is_ok = true;
+    for (size_t i = 0; i < JCFW_ARRAYSIZE(S_SCENARIOS); i++)
+    {
+        is_ok &= run(&S_SCENARIOS[i], path);
+    }
+
+    unlink(path);
+    exit(is_ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static bool run(const scenario_t *scenario, const char *path)
+{
+    jcfw_telemetry_spool_t spool;
+
+    // NOTE(Caleb): Start from an erased region. The posix flash takes the size of the region from
+    // the file, unless the file is new.
+    memset(s_image, 0xFF, sizeof(s_image));
+    JCFW_ASSERT(store_image(path, s_image), "Unable to create %s", path);
+    JCFW_ASSERT(jcfw_telemetry_spool_open(&spool, path) == JCFW_RESULT_OK, "Unable to open spool");
+    scenario->setup(&spool);
+    jcfw_telemetry_spool_close(&spool);
+    JCFW_ASSERT(load_image(path, s_image), "Unable to save %s", path);
+
+    // NOTE(Caleb): Draining consumes the records, but every cut starts from the image saved above.
+    static uint32_t pending_ids[SPOOL_CRASH_RECORD_COUNT_MAX];
+    size_t          pending_count = 0;
+    JCFW_ASSERT(jcfw_telemetry_spool_open(&spool, path) == JCFW_RESULT_OK, "Unable to open spool");
+    JCFW_ASSERT(drain(&spool, pending_ids, &pending_count), "Unable to drain the initial spool");
+    jcfw_telemetry_spool_close(&spool);
+
+    const uint32_t id        = s_next_id++;
+    size_t         cut_count = 0;
+    bool           is_done   = false;
+    bool           is_ok     = true;
+    for (size_t budget = 0; !is_done && is_ok; budget++)
+    {
+        JCFW_ASSERT(store_image(path, s_image), "Unable to restore %s", path);
+        JCFW_ASSERT(
+            jcfw_telemetry_spool_open(&spool, path) == JCFW_RESULT_OK, "Unable to open spool");
+        jcfw_posix_flash_set_power_budget(&spool.region, budget);
+
+        jcfw_result_e err = JCFW_RESULT_ERROR;
+        if (scenario->op == OP_APPEND)
+        {
+            uint8_t      record[JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX];
+            const size_t size = make_record(id, record);
+            err               = jcfw_telemetry_spool_append(&spool, record, size);
+        }
+        else
+        {
+            err = jcfw_telemetry_spool_consume(&spool);
+        }
+        jcfw_telemetry_spool_close(&spool);
+
+        is_done    = err == JCFW_RESULT_OK;
+        is_ok      = check(scenario, path, pending_ids, pending_count, is_done);
+        cut_count += is_done ? 0 : 1;
+    }
+
+    printf(
+        "%-14s %4lu pending, %5lu cuts: %s\n",
+        scenario->name,
+        (unsigned long)pending_count,
+        (unsigned long)cut_count,
+        is_ok ? "ok" : "FAILED");
+
+    return is_ok;
+}
+
+/// @brief Reopen the spool after a cut and check what it recovered.
+/// @param pending_ids The ids of the records which were pending before the operation, oldest first.
+/// @param is_done Whether the operation completed before the power went out.
+static bool check(
+    const scenario_t *scenario,
+    const char       *path,
+    const uint32_t   *pending_ids,
+    size_t            pending_count,
+    bool              is_done)
+{
+    static uint32_t ids[SPOOL_CRASH_RECORD_COUNT_MAX];
+    size_t          count = 0;
+    const uint32_t  id    = s_next_id - 1;
+
+    jcfw_telemetry_spool_t spool;
+    JCFW_ASSERT(jcfw_telemetry_spool_open(&spool, path) == JCFW_RESULT_OK, "Unable to reopen");
+
+    const uint32_t recovered_count = jcfw_telemetry_spool_get_pending_count(&spool);
+    bool           is_ok           = drain(&spool, ids, &count);
+    if (is_ok && count != recovered_count)
+    {
+        JCFW_TRACELN_ERROR(
+            TRACE_TAG,
+            "%s: %lu records pending but %lu read",
+            scenario->name,
+            (unsigned long)recovered_count,
+            (unsigned long)count);
+        is_ok = false;
+    }
+
+    // NOTE(Caleb): The ids are consecutive, so the records which may come back are a run of them,
+    // and drain() already checked that they come back in order.
+    const bool   has_id     = count > 0 && ids[count - 1] == id && scenario->op == OP_APPEND;
+    const size_t kept_count = count - (has_id ? 1 : 0);
+    const size_t lost_count = pending_count - JCFW_MIN(kept_count, pending_count);
+
+    size_t lost_max = 0;
+    if (scenario->op == OP_CONSUME)
+    {
+        lost_max = 1;
+    }
+    else if (scenario->may_drop)
+    {
+        lost_max = pending_count;
+    }
+
+    bool is_recovered = kept_count <= pending_count && lost_count <= lost_max;
+    for (size_t i = 0; is_recovered && i < kept_count; i++)
+    {
+        is_recovered = ids[i] == pending_ids[lost_count + i];
+    }
+
+    if (is_ok && !is_recovered)
+    {
+        JCFW_TRACELN_ERROR(
+            TRACE_TAG,
+            "%s: Recovered %lu of %lu pending records, %lu lost",
+            scenario->name,
+            (unsigned long)kept_count,
+            (unsigned long)pending_count,
+            (unsigned long)lost_count);
+        is_ok = false;
+    }
+
+    const bool is_complete = (scenario->op == OP_APPEND) ? has_id : lost_count == 1;
+    if (is_ok && is_done && !is_complete)
+    {
+        JCFW_TRACELN_ERROR(TRACE_TAG, "%s: A completed operation did not persist", scenario->name);
+        is_ok = false;
+    }
+
+    // NOTE(Caleb): The spool must still take new records, even when the last one was torn.
+    const uint32_t next_id = id + 1;
+    append(&spool, next_id);
+    jcfw_telemetry_spool_close(&spool);
+
+    JCFW_ASSERT(jcfw_telemetry_spool_open(&spool, path) == JCFW_RESULT_OK, "Unable to reopen");
+    is_ok &= drain(&spool, ids, &count);
+    jcfw_telemetry_spool_close(&spool);
+
+    if (is_ok && (count != 1 || ids[0] != next_id))
+    {
+        JCFW_TRACELN_ERROR(
+            TRACE_TAG, "%s: A record appended after recovering was lost", scenario->name);
+        is_ok = false;
+    }
+
+    return is_ok;
+}
+
+/// @brief Consume every record of a spool, checking that each is intact and newer than the last.
+static bool drain(jcfw_telemetry_spool_t *spool, uint32_t *o_ids, size_t *o_count)
+{
+    uint8_t record[JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX];
+    uint8_t expected[JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX];
+    size_t  size = 0;
+
+    *o_count = 0;
+    while (jcfw_telemetry_spool_peek(spool, record, sizeof(record), &size) == JCFW_RESULT_OK)
+    {
+        uint32_t id = 0;
+        memcpy(&id, record, JCFW_MIN(sizeof(id), size));
+
+        if (size < sizeof(id) || make_record(id, expected) != size
+            || memcmp(record, expected, size) != 0)
+        {
+            JCFW_TRACELN_ERROR(TRACE_TAG, "Record %lu is torn", (unsigned long)*o_count);
+            return false;
+        }
+
+        if (*o_count > 0 && id <= o_ids[*o_count - 1])
+        {
+            JCFW_TRACELN_ERROR(
+                TRACE_TAG,
+                "Record %lu came back after record %lu",
+                (unsigned long)id,
+                (unsigned long)o_ids[*o_count - 1]);
+            return false;
+        }
+
+        JCFW_ASSERT(*o_count < SPOOL_CRASH_RECORD_COUNT_MAX, "Too many records came back");
+        o_ids[(*o_count)++] = id;
+
+        JCFW_ASSERT(jcfw_telemetry_spool_consume(spool) == JCFW_RESULT_OK, "Unable to consume");
+    }
+
+    return true;
+}
+
+static void setup_empty(jcfw_telemetry_spool_t *spool)
+{
+}
+
+static void setup_pending(jcfw_telemetry_spool_t *spool)
+{
+    for (size_t i = 0; i < SPOOL_CRASH_PENDING_COUNT; i++)
+    {
+        append(spool, s_next_id++);
+    }
+}
+
+/// @brief Fill the region, then consume the oldest segment, so that the next append erases it.
+static void setup_consumed(jcfw_telemetry_spool_t *spool)
+{
+    setup_full(spool);
+
+    const uint32_t read_segment = spool->read_segment;
+    while (spool->read_segment == read_segment)
+    {
+        JCFW_ASSERT(jcfw_telemetry_spool_consume(spool) == JCFW_RESULT_OK, "Unable to consume");
+    }
+}
+
+/// @brief Fill the region, so that the next append drops the oldest segment.
+static void setup_full(jcfw_telemetry_spool_t *spool)
+{
+    while (!will_start_segment(spool, s_next_id)
+           || (spool->write_segment + 1) % spool->segment_count != spool->read_segment)
+    {
+        append(spool, s_next_id++);
+    }
+}
+
+/// @brief Whether appending the record `id` would start a new segment.
+static bool will_start_segment(const jcfw_telemetry_spool_t *spool, uint32_t id)
+{
+    uint8_t      record[JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX];
+    const size_t size = make_record(id, record);
+    const size_t span = JCFW_TELEMETRY_SPOOL_RECORD_HEADER_SIZE + ((size + 3) & ~3);
+    return !spool->has_segment || spool->write_offset + span > spool->segment_size;
+}
+
+static void append(jcfw_telemetry_spool_t *spool, uint32_t id)
+{
+    uint8_t      record[JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX];
+    const size_t size = make_record(id, record);
+    JCFW_ASSERT(
+        jcfw_telemetry_spool_append(spool, record, size) == JCFW_RESULT_OK, "Unable to append");
+}
+
+/// @brief Make the record `id`: The id, then bytes which depend on it, of a length which does too.
+static size_t make_record(uint32_t id, uint8_t *o_record)
+{
+    const size_t size = 20 + (id * 37) % (JCFW_TELEMETRY_SPOOL_RECORD_SIZE_MAX - 20 + 1);
+
+    memcpy(o_record, &id, sizeof(id));
+    for (size_t i = sizeof(id); i < size; i++)
+    {
+        o_record[i] = (uint8_t)(id * 31 + i);
+    }
+
+    return size;
+}
+
+static bool load_image(const char *path, uint8_t *o_image)
+{
+    FILE *file = fopen(path, "rb");
+    JCFW_RETURN_IF_FALSE(file, false);
+
+    const bool is_ok = fread(o_image, 1, SPOOL_CRASH_REGION_SIZE, file)
+                    == SPOOL_CRASH_REGION_SIZE;
+    fclose(file);
+
+    return is_ok;
+}
+
+static bool store_image(const char *path, const uint8_t *image)
+{
+    FILE *file = fopen(path, "wb");
+    JCFW_RETURN_IF_FALSE(file, false);
+
+    const bool is_ok = fwrite(image, 1, SPOOL_CRASH_REGION_SIZE, file)
+                    == SPOOL_CRASH_REGION_SIZE;
+    fclose(file);
+
+    return is_ok;
+}
+
+// PLATFORM ----------------------------------------------------------------------------------------
+
+bool jcfw_platform_trace_validate(const char *tag)
+{
+    // NOTE(Caleb): The spool traces every torn record it recovers, and there are thousands.
+    return strcmp(tag, TRACE_TAG) == 0;
+}
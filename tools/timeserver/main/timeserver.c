@@ -0,0 +1,146 @@
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "host_harness.h"
+#include "jcfw/net/timesync.h"
+#include "jcfw/platform/platform.h"
+#include "jcfw/trace.h"
+#include "jcfw/util/assert.h"
+
+/* Notes:
+ * A stand-in for the collector's time server (see: jcfw/net/timesync.h), for testing clock
+ * synchronization on the host without a network. It answers clock probes, and nothing else, on a
+ * clock of its own which can be set apart from the host's, over a network which it simulates.
+ *
+ * It is configured through the environment:
+ *
+ *     TIMESERVER_PORT        The UDP port to answer on (default 5000)
+ *     TIMESERVER_OFFSET_US   How far ahead of the host's monotonic clock its clock starts
+ *     TIMESERVER_DRIFT_PPM   How much faster than the host's clock its clock runs, in ppm
+ *     TIMESERVER_DELAY_US    The delay of each leg of a trip, in us
+ *     TIMESERVER_JITTER_US   The largest extra (random) delay of each leg, in us, which makes
+ *                            trips lopsided the way Wi-Fi queueing does
+ *
+ * The legs are simulated by holding on to each request before stamping it, and to each response
+ * after stamping it, so one probe is handled at a time.
+ */
+
+#define TRACE_TAG            "TIME"
+
+#define TIMESERVER_PORT      5000
+
+typedef struct
+{
+    int      port;
+    int64_t  offset_us;
+    int32_t  drift_ppm;
+    uint32_t delay_us;
+    uint32_t jitter_us;
+} timeserver_config_t;
+
+// -------------------------------------------------------------------------------------------------
+
+static uint64_t get_server_time_us(void);
+static void     delay_leg(void);
+
+// -------------------------------------------------------------------------------------------------
+
+static timeserver_config_t s_config;
+static uint64_t            s_start_us;
+
+void app_main(void)
+{
+    host_harness_init();
+
+    s_config = (timeserver_config_t) {
+        .port      = (int)host_harness_get_env_long("TIMESERVER_PORT", TIMESERVER_PORT),
+        .offset_us = host_harness_get_env_long("TIMESERVER_OFFSET_US", 0),
+        .drift_ppm = (int32_t)host_harness_get_env_long("TIMESERVER_DRIFT_PPM", 0),
+        .delay_us  = (uint32_t)host_harness_get_env_long("TIMESERVER_DELAY_US", 0),
+        .jitter_us = (uint32_t)host_harness_get_env_long("TIMESERVER_JITTER_US", 0),
+    };
+    s_start_us = jcfw_platform_get_time_us();
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    JCFW_ASSERT(sock >= 0, "error: Unable to create a socket; errno %d", errno);
+
+    struct sockaddr_in local = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(s_config.port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    JCFW_ASSERT(
+        bind(sock, (struct sockaddr *)&local, sizeof(local)) == 0,
+        "error: Unable to bind port %d; errno %d",
+        s_config.port,
+        errno);
+
+    JCFW_TRACELN_INFO(
+        TRACE_TAG,
+        "Answering on port %d; offset %lld us, drift %ld ppm, delay %lu us + up to %lu us",
+        s_config.port,
+        (long long)s_config.offset_us,
+        (long)s_config.drift_ppm,
+        (unsigned long)s_config.delay_us,
+        (unsigned long)s_config.jitter_us);
+
+    uint32_t answer_count = 0;
+    while (1)
+    {
+        uint8_t                 request[JCFW_TIMESYNC_REQUEST_SIZE];
+        struct sockaddr_storage source;
+        socklen_t               source_len = sizeof(source);
+        ssize_t                 length     = recvfrom(
+            sock, request, sizeof(request), 0, (struct sockaddr *)&source, &source_len);
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        // NOTE(Caleb): The request "arrives" once its leg is over, and the response "leaves" when
+        // it is stamped, so the client sees both legs.
+        delay_leg();
+        const uint64_t receive_us = get_server_time_us();
+
+        uint8_t response[JCFW_TIMESYNC_RESPONSE_SIZE];
+        if (jcfw_timesync_respond(request, length, receive_us, get_server_time_us(), response)
+            != JCFW_RESULT_OK)
+        {
+            continue;
+        }
+
+        delay_leg();
+        sendto(sock, response, sizeof(response), 0, (struct sockaddr *)&source, source_len);
+
+        answer_count++;
+        JCFW_TRACELN_DEBUG(TRACE_TAG, "Answered probe %lu", (unsigned long)answer_count);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static uint64_t get_server_time_us(void)
+{
+    const uint64_t now_us     = jcfw_platform_get_time_us();
+    const int64_t  elapsed_us = (int64_t)(now_us - s_start_us);
+    return now_us + s_config.offset_us + elapsed_us * s_config.drift_ppm / 1000000;
+}
+
+static void delay_leg(void)
+{
+    uint32_t delay_us = s_config.delay_us;
+    if (s_config.jitter_us)
+    {
+        delay_us += (uint32_t)(rand() % (s_config.jitter_us + 1));
+    }
+
+    const struct timespec delay = {
+        .tv_sec  = delay_us / (1000 * 1000),
+        .tv_nsec = (long)(delay_us % (1000 * 1000)) * 1000,
+    };
+    nanosleep(&delay, NULL);
+}